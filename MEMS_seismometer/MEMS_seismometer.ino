@@ -1,6 +1,6 @@
 #define PROGNAME "MEMS_seismometer"
-#define VERSION "0.4.0" 
-#define VERDATE "2024-04-16"
+#define VERSION "0.8.1" 
+#define VERDATE "2026-10-18"
 #define PROGMONIKER "SEISMO"
 
 /* from LSM303DLH Example Code and /tests/_hardware_specific/accelerometer_magnetometer_LSM303DLH
@@ -40,6 +40,18 @@
     2024-04-02 cbm 0.2.0 merging in ESP8266_basic
     2024-04-12 cbm 0.3.0 sample at 1000Hz for 250ms every second
     2024-04-16 cbm 0.3.6 charting
+    2026-10-17 cbm 0.5.0 sampling from a timer interrupt ( cbmAcquisition.h )
+                         instead of pacing loop () with delay; jitter and
+                         dropped-sample telemetry
+    2026-10-17 cbm 0.6.0 400 Hz: burst reads of raw counts on a 400 kHz bus
+    2026-10-17 cbm 0.7.0 periodic jobs run by TimedScheduler, which waits for
+                         the next one instead of delay ( 10 )
+    2026-10-17 cbm 0.8.0 band energies: the filtered samples through a
+                         streaming FFT ( FFT_STFT.h ), Welch-averaged over
+                         each reporting interval, published alongside the
+                         broadband energy
+    2026-10-18 cbm 0.8.1 a failed read is the accelerometer's status, not a
+                         negative energy, so the TESTING cosine is all sampled
     
 */
 
@@ -81,10 +93,14 @@
 #include <cbmNTP.h>
 #include <cbmNetworkInfo.h>
 #include <cbmCircularBuffer.h>  
+#include <cbmAcquisition.h>
+#include <TimedScheduler.h>
+#include <FFT_STFT.h>
 
 #include <LSM303DLH.h>
 
 #include <EWMA.h>
+#include <EWMA_T.h>
 
 #include <Stats.h>
 
@@ -340,15 +356,20 @@ bool forceWSUpdate = false;
 #pragma mark -> vars app-specific
 
 LSM303DLH accelerometer;
-BPF filtered_energy;
+BPF_T<float> filtered_energy;   // double is 64-bit software FP on the ESP8266
 EWMA peak_EWMA;
 // Stats energyStats;
 Stats loop_time_stats;
+unsigned long lastLoopTook_ms = 0UL;
+
+// the periodic jobs; loop () does what must be done every time through, then Run ()
+TimedScheduler scheduler;
+#define SECOND_us ( 1000000UL )
 
 #pragma mark MM energy - num datapoints
 
 const size_t chart_num_datapoints = 20;
-CircularBuffer<float> energies ( chart_num_datapoints );
+CircularBuffer<float, chart_num_datapoints> energies;   // static: no heap fragmentation
 
 float calibrated_mean = 0.0;
 float calibrated_stDev = 0.0;
@@ -356,12 +377,36 @@ float calibrated_stDev = 0.0;
 float realEnergy[3], realMag[3];  // calculated acceleration values here
 
 static float peakDuringInterval              =   0.0;
-    
-const float F_sampling = 62;  // high-speed: 389.7;
-const float T_sampling = 1.0 / F_sampling;
-// NOTE: needs checking!!!
-// int loopDelay_ms = 5;  // at 0, get 1000 iterations in 6 seconds => 177Hz
-const unsigned long loopDelay_ms = (unsigned long) 1000.0 * T_sampling;
+
+// samples are taken by a timer interrupt, not by loop (); loop () may fall
+// up to acquisitionRingLen samples behind without losing any
+// the accelerometer's output data rate is one of 50, 100, 400, or 1000 Hz;
+// the timer samples it at the same rate. The two clocks are independent, so
+// now and then a sample is read twice or not at all; clocking the
+// acquisition from the accelerometer's data-ready pin ( INT1,
+// ACQUISITION_EXTERNAL ) would avoid that where a pin is free
+const int accelerometerODR_Hz = 400;
+const float F_sampling = accelerometerODR_Hz;
+const size_t acquisitionRingLen = 64;   // a power of two
+const size_t acquisitionBlockLen = 16;
+Acquisition<float, acquisitionRingLen> acquisition;
+
+// the spectrum of the filtered samples: frames of 256 ( 0.64 s ) every 128,
+// bins of 1.5625 Hz, in 8 logarithmic bands from bin 1 to 128 ( 1.6 - 200 Hz ).
+// The samples go in as Q15, stftScale counts to a unit of filtered energy;
+// the band energies are the mean square within each band, in those units,
+// averaged over the frames since the last report
+const uint16_t stftN = 256;
+const uint16_t stftHop = stftN / 2;
+const uint16_t stftRingLen = 512;       // a power of two, at least stftN + stftHop
+const uint8_t stftBands = 8;
+const float stftScale = 1000.0;
+volatile int16_t stftRing [ stftRingLen ];
+int16_t stftFrame [ stftN ], stftHann [ stftN / 2 + 1 ];
+uint32_t stftPower [ stftN / 2 ], stftWelch [ stftN / 2 ], stftBandPower [ stftBands ];
+uint16_t stftEdges [ stftBands + 1 ];
+FFT_Bands stftBandEdges ( stftEdges, stftBands );
+FFT_STFT<stftN> stft ( stftRing, stftRingLen, stftFrame, stftPower, stftHop );
 
 /**************************** Function Prototypes *****************************/
 #pragma mark -> function prototypes
@@ -392,11 +437,22 @@ void webSocketEvent ( uint8_t num, WStype_t type, uint8_t * payload, size_t leng
 void update_WebSocket ();
 void update_WebSocketArray ();
 
-float getTotalEnergy ( LSM303DLH accelerometer = accelerometer );
+bool getTotalEnergy ( float & energy, LSM303DLH & accelerometer = accelerometer );
+bool readEnergy ( float & energy );
+void processSample ( float energy );
+void reportAcquisition ();
 // void initializeStatistics ( unsigned long initializationPeriod_ms = 10 * SECOND_ms );
 
 void indicateConnecting ( int value );
 void reportSystemStatus();
+void checkTime ( void * );
+void sendWebSocket ( void * );
+void sendStatus ( void * );
+void sendEnergy ( void * );
+void sendBandEnergies ( void * );
+void recordEnergy ( void * );
+void sendLoopTime ( void * );
+void sendAcquisition ( void * );
 int availableMemory();
 
 // magic juju to return array size
@@ -424,11 +480,35 @@ void setup() {
   yield();
   
   accelerometer.init ( ACCELERATION_FULL_SCALE_g, SA0_BRIDGE_VALUE, pdSDA, pdSCL );
+  Wire.setClock ( 400000 );   // the LSM303DLH's fast mode
+  accelerometer.setDataRate ( accelerometerODR_Hz );
   
   filtered_energy.init ( low_cutoff, high_cutoff, F_sampling );
 
   peak_EWMA.setAlpha ( peak_EWMA.alpha ( 1000 ) );  // n periods of half-life
 
+  FFT_Window::Make ( stftHann, stftN, FFT_WINDOW_HANN );
+  stftBandEdges.Set_Log ( 1, stftN / 2 );
+  stft.Set_Window ( stftHann );
+  stft.Set_Bands ( &stftBandEdges, stftBandPower );
+  stft.Set_Welch ( stftWelch );
+
+  if ( ! acquisition.begin ( F_sampling, readEnergy ) ) {
+    Serial.println ( F ( "acquisition: could not start the sampling timer" ) );
+  }
+  
+  // period, and phase: the first run; staggered so that no two fall due together
+  scheduler.Add ( checkTime,       300UL * SECOND_us, 300UL * SECOND_us );
+  #ifdef USE_WEBSOCKETS
+    scheduler.Add ( sendWebSocket,   5UL * SECOND_us );
+  #endif
+  scheduler.Add ( sendStatus,      300UL * SECOND_us, 300UL * SECOND_us + 100000UL );
+  scheduler.Add ( sendEnergy,        2UL * SECOND_us,   2UL * SECOND_us + 200000UL );
+  scheduler.Add ( recordEnergy,      1UL * SECOND_us,   1UL * SECOND_us + 300000UL );
+  scheduler.Add ( sendLoopTime,      2UL * SECOND_us,   2UL * SECOND_us + 400000UL );
+  scheduler.Add ( sendAcquisition,  60UL * SECOND_us,  60UL * SECOND_us + 500000UL );
+  scheduler.Add ( sendBandEnergies,  2UL * SECOND_us,   2UL * SECOND_us + 600000UL );
+
   #if VERBOSE > 100
   
     /************************** Report successful init **************************/
@@ -455,15 +535,6 @@ void setup() {
 
 void loop() {
 
-  const unsigned long wsSendInterval_ms        =   5UL * SECOND_ms;
-  static unsigned long lastWSSendAt_ms         =   0UL;
-
-  const unsigned long statusDelay_ms           =   5UL * MINUTE_ms;
-  static unsigned long lastStatusAt_ms         =   0UL;
-        
-  const unsigned long timeCheckDelay_ms        =   5UL * MINUTE_ms;
-  static unsigned long timeCheckStatusAt_ms    =   0UL;
-
   const unsigned long peakHoldInterval_ms      =   1UL * MINUTE_ms;
   static unsigned long newPeakAt_ms            =   0UL;
   
@@ -488,145 +559,50 @@ void loop() {
   if ( ! connect_MQTT () ) return;
     
   conn_MQTT.loop();
-  delay ( 10 );  // fix some issues with WiFi stability
   yield();
   
   /****************************************************************************/
 
-  if ( ( millis() - timeCheckStatusAt_ms ) > timeCheckDelay_ms ) {
-    if ( timeStatus() != timeSet ) {
-      getUnixTime ();
-    }
-    timeCheckStatusAt_ms = millis();
-  }
-
-  /****************************************************************************/
-
   htmlServer.handleClient();
   
   #ifdef USE_WEBSOCKETS
   
     webSocket.loop();
     yield();
-      
-    /***********/
-  
-    if ( ( forceWSUpdate ) || ( lastWSSendAt_ms == 0UL ) 
-        || ( ( millis() - lastWSSendAt_ms ) > wsSendInterval_ms ) ) {
-      
-      if ( ( VERBOSE >= 15 ) && forceWSUpdate ) Serial.println ( F ( "forced WS update" ) );
-
-      update_WebSocket ();
-      update_WebSocketArray ();
-      lastWSSendAt_ms = millis();
-
+    
+    // a forced update goes now; the regular ones are sendWebSocket's
+    if ( forceWSUpdate ) {
+      if ( VERBOSE >= 15 ) Serial.println ( F ( "forced WS update" ) );
+      sendWebSocket ( NULL );
     }
   
     yield ();
   #endif
 
-  /****************************************************************************/  
-   
-  if ( ( millis() - lastStatusAt_ms ) > statusDelay_ms ) {
-    reportSystemStatus();
-    lastStatusAt_ms = millis();
-  }
-
   /****************************************************************************/
 
-  #undef HIGH_SPEED_SAMPLING
-
-  #ifdef HIGH_SPEED_SAMPLING
-
-    // measure for the first quarter of every second
-  
-    if ( ( millis() % 1000 ) < 250UL ) {
-      // we're within the first quarter of a second...
-      // WAH max speed seems to be only 99 iters per quarter-second
-    
-      const unsigned long highSpeedDuration_ms = 250UL;
-      unsigned long highSpeedBeganAt_ms = millis();
-      unsigned long highSpeedIterationCount = 0UL;
-    
-      while ( ( millis() - highSpeedBeganAt_ms ) < highSpeedDuration_ms ) {
-      
-        float totalEnergy;
-        // total energy is the *square* resultant of 3 axes, including gravity
-        if ( TESTING ) {
-          totalEnergy = 5.0 * cos ( (float) highSpeedIterationCount * 0.02 );
-        } else {
-          totalEnergy = getTotalEnergy ( accelerometer );
-        }
-
-        // we *could* turn it into m/s acceleration, but maybe we want energy...
-        // totalEnergy = sqrt ( totalEnergy ) * float ( ACCELERATION_FULL_SCALE_g ) * 9.8;
-
-        // Serial.print ( "  ==> " ); Serial.println ( totalEnergy );
-
-        // remove gravitational energy to get net acceleration of the ground
-        // filtered_energy MAY be negative!!
-
-        // multiply for better MQTT scaling
-        filtered_energy.record ( totalEnergy * 1e2 );
-
-        // energyStats.record ( filtered_energy.value() );  // of a wave, probably not appropriate...
-      
-        highSpeedIterationCount++;
-      }
-    
-      snprintf ( topic, mqttTopicLen, "%s/%s", mqtt_baseTopic, "telemetry/millis" );
-      sendValueToMQTT (  topic, millis(), "millis" );
-      snprintf ( topic, mqttTopicLen, "%s/%s", mqtt_baseTopic, "telemetry/high_speed_iteration_count" );
-      sendValueToMQTT (  topic, highSpeedIterationCount, "iterations" );
-      snprintf ( topic, mqttTopicLen, "%s/%s", mqtt_baseTopic, "telemetry/high_speed_frequency" );
-      snprintf ( fBuf, fBufLen, "%6.1f", 1000.0 * highSpeedIterationCount / ( millis() - highSpeedBeganAt_ms ) );
-      sendValueToMQTT ( topic, fBuf , "frequency" );
-      delay ( 2 );
-    }
-
-  #else
-
-    float totalEnergy;
-    // total energy is the *square* resultant of 3 axes, including gravity
-    totalEnergy = getTotalEnergy ( accelerometer );
-    
-    // we *could* turn it into m/s acceleration, but maybe we want energy...
-    // totalEnergy = sqrt ( totalEnergy ) * float ( ACCELERATION_FULL_SCALE_g ) * 9.8;
-    
-    // Serial.print ( "  ==> " ); Serial.println ( totalEnergy );
-    
+  // everything the timer has sampled since the last time through, a block at
+  // a time
+  AcquisitionSample<float> block [ acquisitionBlockLen ];
+  size_t n;
+  while ( ( n = acquisition.read ( block, acquisitionBlockLen ) ) > 0 ) {
+    float in [ acquisitionBlockLen ], out [ acquisitionBlockLen ];
+    // multiply for better MQTT scaling
+    for ( size_t i = 0; i < n; i++ ) in [ i ] = block [ i ].value * 1e2;
     // remove gravitational energy to get net acceleration of the ground
     // filtered_energy MAY be negative!!
-    
-    // multiply for better MQTT scaling
-    filtered_energy.record ( totalEnergy * 1e2 );
-      
-    // energyStats.record ( filtered_energy.value() );  // of a wave, probably not appropriate...
-    
-  #endif
-  
-  // DISPLAY: update smooth peak value using EWMA
-  float sqEnergy = filtered_energy.value() * filtered_energy.value();
-  if ( sqEnergy > peak_EWMA.value() ) {
-    peak_EWMA.reset();  // to latch the high value
-  }
-  peak_EWMA.record ( sqEnergy );
-  
-  const unsigned long sendInterval_ms = 2UL * SECOND_ms;
-  static unsigned long lastSendAt_ms = millis();
-  if ( ( millis() - lastSendAt_ms ) > sendInterval_ms ) {
-    snprintf ( pBuf, pBufLen, "%6.4f", peak_EWMA.value() );
-    sendValueToMQTT ( mqttEnergyTopic, pBuf, "EWMA_PeakEnergy" );
-    lastSendAt_ms = millis();
+    filtered_energy.record ( in, out, n );
+    for ( size_t i = 0; i < n; i++ ) processSample ( out [ i ] );
+    for ( size_t i = 0; i < n; i++ ) {
+      float q = out [ i ] * stftScale;
+      stft.Push ( q >= 32767.0 ? 32767 : ( q <= -32768.0 ? -32768 : ( int16_t ) q ) );
+    }
+    yield ();
   }
   
-  #pragma mark MM energy - load
-  const unsigned long recordInterval_ms = 1UL * SECOND_ms;
-  static unsigned long lastRecordAt_ms = millis();
-  if ( ( millis() - lastRecordAt_ms ) > recordInterval_ms ) {
-    energies.store ( peak_EWMA.value() );
-    lastRecordAt_ms = millis();
-  }
+  // a frame every stftHop samples; meanwhile the timer goes on sampling into
+  // acquisition's ring, and loop () into stft's
+  while ( stft.Process () ) yield ();
   
   // if ( totalEnergy < 0
   //   || filtered_energy.value() < 0
@@ -641,12 +617,6 @@ void loop() {
   // }
   
   
-  // REPORTING: monitor peak during protracted interval = reporting period
-  // REPORTING means for web page display
-  
-  if ( filtered_energy.value() > peakDuringInterval ) {
-    peakDuringInterval = filtered_energy.value();
-  }
   // if ( ( millis() - newPeakAt_ms ) > peakHoldInterval_ms ) {
   //   // Serial.println ( peakDuringInterval );
   //   peakDuringInterval = 0UL;
@@ -682,53 +652,142 @@ void loop() {
   // }
   
   unsigned long now = millis();
-  unsigned long lastLoopTook_ms = now - lastLoopAt_ms;
+  lastLoopTook_ms = now - lastLoopAt_ms;
   lastLoopAt_ms = now;
   
   static int loopInitializationCount = 20;
   
   if ( loopInitializationCount == 0 ) {
-    loop_time_stats.record ( lastLoopTook_ms );
+    loop_time_stats.recordInt ( lastLoopTook_ms );
   } else {
     // skip the first few loops until things stabilize
     loopInitializationCount--;
   }
   
-  const unsigned long loopReportInterval_ms = 2UL * SECOND_ms;
-  static unsigned long lastLoopReportAt_ms = millis();
-  if ( ( millis() - lastLoopReportAt_ms ) > loopReportInterval_ms ) {
-    snprintf ( pBuf, pBufLen, "%s/%s", mqtt_baseTopic, "telemetry/loop_time_ms" );
-    sendValueToMQTT ( pBuf, lastLoopTook_ms, "loop time", false );
-    lastLoopReportAt_ms = millis();
+  // the jobs that are due, then wait for the next one; delay () within lets the WiFi
+  // run, as the old delay ( 10 ) did, but no job waits on it, and the samples
+  // don't wait more than 10 ms
+  scheduler.Run ( 10000UL );
+  
+}
+
+/******************************************************************************/
+#pragma mark periodic jobs
+
+void checkTime ( void * ) {
+  if ( timeStatus() != timeSet ) {
+    getUnixTime ();
   }
+}
 
-  if ( loopDelay_ms > lastLoopTook_ms ) {
-    delay ( loopDelay_ms - lastLoopTook_ms );
-  } else {
-    const unsigned long printInterval_ms = 5UL * SECOND_ms;
-    static unsigned long printedAt_ms = millis();
-    if ( ( millis() - printedAt_ms ) > printInterval_ms ) {
-      Serial.printf ( "Loop took excessive time: %lu > %lu\n", lastLoopTook_ms, loopDelay_ms );
-      printedAt_ms = millis();
-    }
-    // and don't delay any more...
+void sendWebSocket ( void * ) {
+  #ifdef USE_WEBSOCKETS
+    update_WebSocket ();
+    update_WebSocketArray ();
+  #endif
+}
+
+void sendStatus ( void * ) {
+  reportSystemStatus();
+  if ( VERBOSE >= 4 ) scheduler.Report ( Serial );
+}
+
+void sendEnergy ( void * ) {
+  snprintf ( pBuf, pBufLen, "%6.4f", peak_EWMA.value() );
+  sendValueToMQTT ( mqttEnergyTopic, pBuf, "EWMA_PeakEnergy" );
+}
+
+void sendBandEnergies ( void * ) {
+  // seismo/.../band_energy/<low edge>_Hz
+  if ( stft.Welch_Frames () == 0 ) return;
+  for ( uint8_t b = 0; b < stftBands; b++ ) {
+    float meanSquare = stft.Welch_Mean_Square ( stftBandEdges.First ( b ), stftBandEdges.End ( b ) )
+                     / ( stftScale * stftScale );
+    snprintf ( topic, mqttTopicLen, "%s/band_energy/%.1f_Hz", mqtt_baseTopic,
+               stftBandEdges.First ( b ) * F_sampling / stftN );
+    snprintf ( pBuf, pBufLen, "%8.6f", meanSquare );
+    sendValueToMQTT ( topic, pBuf, "band energy" );
   }
-  
+  stft.Welch_Reset ();
+}
+
+#pragma mark MM energy - load
+void recordEnergy ( void * ) {
+  energies.store ( peak_EWMA.value() );
+}
+
+void sendLoopTime ( void * ) {
+  snprintf ( pBuf, pBufLen, "%s/%s", mqtt_baseTopic, "telemetry/loop_time_ms" );
+  sendValueToMQTT ( pBuf, lastLoopTook_ms, "loop time", false );
+}
+
+void sendAcquisition ( void * ) {
+  reportAcquisition ();
 }
 
-float getTotalEnergy ( LSM303DLH accelerometer ) {
-  float realEnergy [ 3 ];
-  float totalEnergy = 0.0;
+bool readEnergy ( float & energy ) {
+  // from the timer interrupt
+  static unsigned long count = 0;
+  // total energy is the *square* resultant of 3 axes, including gravity
+  // the test signal may be negative: only a failed read is a failure
+  if ( TESTING ) {
+    energy = 5.0 * cos ( (float) count++ * 0.02 );
+    return true;
+  }
+  return getTotalEnergy ( energy, accelerometer );
+}
+
+void processSample ( float energy ) {
+  // energy is filtered_energy's output for one sample
+
+  // DISPLAY: update smooth peak value using EWMA
+  float sqEnergy = energy * energy;
+  if ( sqEnergy > peak_EWMA.value() ) {
+    peak_EWMA.reset();  // to latch the high value
+  }
+  peak_EWMA.record ( sqEnergy );
   
-  // the three values are calibrated and in m/s2 units
-  accelerometer.getAccel ( realEnergy );
+  // REPORTING: monitor peak during protracted interval = reporting period
+  // REPORTING means for web page display
+  
+  if ( energy > peakDuringInterval ) {
+    peakDuringInterval = energy;
+  }
+}
+
+void reportAcquisition () {
+  // the counters only grow; maxJitter_us is since the last report
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/samples", mqtt_baseTopic );
+  sendValueToMQTT ( topic, acquisition.samples (), "samples" );
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/dropped", mqtt_baseTopic );
+  sendValueToMQTT ( topic, acquisition.dropped (), "dropped samples" );
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/late", mqtt_baseTopic );
+  sendValueToMQTT ( topic, acquisition.late (), "late samples" );
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/max_jitter_us", mqtt_baseTopic );
+  sendValueToMQTT ( topic, acquisition.maxJitter_us (), "max jitter" );
+  acquisition.clearJitter ();
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/high_water", mqtt_baseTopic );
+  sendValueToMQTT ( topic, acquisition.highWater (), "ring high water" );
+  snprintf ( topic, mqttTopicLen, "%s/telemetry/acquisition/stft_overruns", mqtt_baseTopic );
+  sendValueToMQTT ( topic, stft.Overruns (), "spectrum frames skipped" );
+}
+
+bool getTotalEnergy ( float & energy, LSM303DLH & accelerometer ) {
+  // false if the accelerometer could not be read
+  int16_t raw [ 3 ];
+  if ( ! accelerometer.getAccelRaw ( raw ) ) return false;
   
+  // the sum of the squares of the counts, exactly: each square is at most
+  // 2^30, so the sum fits in 32 bits unsigned
+  uint32_t sumSq = 0;
   for ( int i = 0; i < 3; i++ ) {
-    totalEnergy += realEnergy[i] * realEnergy[i];
+    sumSq += ( int32_t ) raw [ i ] * raw [ i ];
   }
   
-  // totalEnergy is proportional to energy
-  return totalEnergy;  
+  // in getAccel's units, squared; totalEnergy is proportional to energy
+  float scale = accelerometer.accelScale ();
+  energy = sumSq * scale * scale;
+  return true;
 }
 
 // void initializeStatistics ( unsigned long initializationPeriod_ms ) {
@@ -903,6 +962,8 @@ void initializeOTA () {
     ArduinoOTA.setPassword ( (const char *) CBM_OTA_KEY );
 
     ArduinoOTA.onStart([]() {
+      // no sampling from flash-resident code while the flash is being written
+      acquisition.end ();
       Serial.println ( F ("OTA Start") );
     });
   
@@ -915,6 +976,7 @@ void initializeOTA () {
     });
   
     ArduinoOTA.onError([](ota_error_t error) {
+      acquisition.begin ( F_sampling, readEnergy );
       Serial.printf("Error[%u]: ", error);
            if (error == OTA_AUTH_ERROR)    Serial.println ( F ("OTA Auth Failed") );
       else if (error == OTA_BEGIN_ERROR)   Serial.println ( F ("OTA Begin Failed") );
@@ -1948,14 +2010,14 @@ void update_WebSocketArray () {
   doc["ENERGY_LIST_N"] = ( energies.count() < energies.bufSize() ) ? energies.count() : energies.bufSize();
   JsonArray energies_json = doc["PEAK_ENERGY_LIST"].to<JsonArray>();
   {
-    // wah that we have to do it this way...
-    float energies_linearArray [ chart_num_datapoints ];
-    energies.entries ( energies_linearArray );
-
-
-    for ( int i = 0; i < chart_num_datapoints; i++ ) {
-      energies_json.add ( energies_linearArray [ i ] );
-    }
+    // straight from the buffer, oldest first, then zeros to fill the chart
+    float * p;
+    size_t n = energies.firstSpan ( p );
+    for ( size_t i = 0; i < n; i++ ) energies_json.add ( p [ i ] );
+    size_t nAdded = n;
+    n = energies.secondSpan ( p );
+    for ( size_t i = 0; i < n; i++ ) energies_json.add ( p [ i ] );
+    for ( nAdded += n; nAdded < chart_num_datapoints; nAdded++ ) energies_json.add ( 0.0f );
   }
   
   serializeJson ( doc, jsonString );
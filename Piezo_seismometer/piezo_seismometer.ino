@@ -12,15 +12,22 @@
 */
 
 #define PROGNAME "piezo_seismometer"
-#define VERSION "0.2.1" 
-#define VERDATE "2024-05-20"
+#define VERSION "0.3.1" 
+#define VERDATE "2026-10-18"
 #define PROGMONIKER "PSEISMO"
 
+// 2026-10-17 cbm 0.3.0 band energies from a streaming FFT ( FFT_STFT.h ) of
+//                      the signal sampled at 250 Hz, alongside the peak counts
+// 2026-10-18 cbm 0.3.1 publish the frames skipped ( stft_overruns ) and the
+//                      late resyncs of the polled sampling ( stft_late ); a
+//                      late resync splices the frame it falls in
+
 #include <RTClib.h>
 #include <SPI.h>
 #include <SD.h>
 
 #include <cbmThrobber.h>
+#include <FFT_STFT.h>
 
 
 #define SECOND_ms  ( 1000UL )
@@ -76,6 +83,21 @@ char dBuf [ dBufLen ];
 //                         pin            inverted_P         PWM_P
 cbmThrobber throbber ( pdThrobber, throbberIsInverted_P, throbberPWM_P );
 
+// the spectrum of the signal: analogRead every 4 ms, frames of 64 ( 256 ms )
+// every 32, bins of 3.9 Hz, in 4 logarithmic bands from bin 1 to 32
+// ( 3.9 - 125 Hz ). Small, for the RAM the SD card leaves: the power is
+// written over the frame. The band energies are the mean square within each
+// band, in counts squared, averaged over the reporting interval
+#define STFT_N 64
+#define STFT_BANDS 4
+FFT_Analog_Source piezo ( paSignal, 4000UL );
+volatile int16_t stftRing [ 2 * STFT_N ];
+int16_t stftFrame [ STFT_N ], stftHann [ STFT_N / 2 + 1 ];
+uint32_t stftWelch [ STFT_N / 2 ], stftBandPower [ STFT_BANDS ];
+uint16_t stftEdges [ STFT_BANDS + 1 ];
+FFT_Bands stftBandEdges ( stftEdges, STFT_BANDS );
+FFT_STFT<STFT_N> stft ( stftRing, 2 * STFT_N, stftFrame, ( uint32_t * ) stftFrame, STFT_N / 2 );
+
 /**************************** Function Prototypes *****************************/
 #pragma mark -> function prototypes
 
@@ -94,6 +116,12 @@ void setup() {
   initializeTime();
   initializeSD();
 
+  FFT_Window::Make ( stftHann, STFT_N, FFT_WINDOW_HANN );
+  stftBandEdges.Set_Log ( 1, STFT_N / 2 );
+  stft.Set_Window ( stftHann );
+  stft.Set_Bands ( &stftBandEdges, stftBandPower );
+  stft.Set_Welch ( stftWelch );
+
   #ifdef EXPECT_TEXT_TO_MQTT
     // no longer need to connect
   #endif
@@ -117,6 +145,9 @@ void loop() {
   int threshold = analogRead ( paPot ) / 2;  
   int counts = analogRead ( paSignal );
   
+  // the samples that are due, and a frame when there is one
+  stft.Poll ( &piezo );
+  
   static unsigned long maxCountsForPrinting = 0UL;
   maxCountsForPrinting = ( (unsigned long)counts > maxCountsForPrinting ) ? (unsigned long) counts : maxCountsForPrinting;
   static unsigned long maxCountsForLogging = 0UL;
@@ -131,6 +162,22 @@ void loop() {
       snprintf ( pBuf, pBufLen, "%d", threshold );
       printForMQTT ( "threshold", pBuf );
       printForMQTT ( "triggered", maxCountsForPrinting > threshold ? "1" : "0" );
+      if ( stft.Welch_Frames () ) {
+        // the bands' mean squares, lowest first, separated by commas; Q15 is counts << 6
+        pBuf [ 0 ] = '\0';
+        for ( uint8_t b = 0; b < STFT_BANDS; b++ ) {
+          float meanSquare = stft.Welch_Mean_Square ( stftBandEdges.First ( b ), stftBandEdges.End ( b ) ) / 4096.0;
+          if ( b ) strcat ( pBuf, "," );
+          dtostrf ( meanSquare, 1, 2, pBuf + strlen ( pBuf ) );
+        }
+        printForMQTT ( "band_energy", pBuf );
+        stft.Welch_Reset ();
+      }
+      // sampled from loop (), so a slow pass makes the source resync late
+      snprintf ( pBuf, pBufLen, "%lu", stft.Overruns () );
+      printForMQTT ( "stft_overruns", pBuf );
+      snprintf ( pBuf, pBufLen, "%lu", piezo.Late () );
+      printForMQTT ( "stft_late", pBuf );
     #else
       snprintf ( pBuf, pBufLen, "%d, %5lu", threshold, maxCountsForPrinting );
       Serial.println ( pBuf );
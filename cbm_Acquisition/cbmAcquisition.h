@@ -0,0 +1,192 @@
+/*
+	cbmAcquisition.h - fixed-rate sampling from a hardware timer into a ring
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+  Sampling in loop () with delay ( period - lastLoopTook ) gets a rate that
+  wanders with everything else loop () does, and whenever WiFi, MQTT, or the
+  web server holds loop () up, samples are simply never taken. Here a timer
+  interrupt takes each sample on time, stamps it with micros (), and pushes
+  it into an SPSCRing ( see cbmSPSCRing.h ); loop () reads them out in blocks
+  whenever it gets around to it, and can be as slow as it likes for up to N
+  sample periods.
+
+    bool readEnergy ( float & e ) {                 // called from the ISR
+      e = ...;
+      return true;                                  // false: count a failure
+    }
+
+    Acquisition<float, 64> acquisition;             // N a power of two
+
+    setup:  acquisition.begin ( 400.0, readEnergy );
+
+    loop:   AcquisitionSample<float> block [ 16 ];
+            size_t n;
+            while ( ( n = acquisition.read ( block, 16 ) ) > 0 ) {
+              ... block [ 0 ].t_us is when the block began ...
+              ... block [ i ].value, i < n ...
+            }
+
+  The clock:
+    ACQUISITION_TIMER     ( default ) the hardware timer, on the ESP8266
+                          timer1 at 5 MHz, so any rate up to several kHz
+    ACQUISITION_EXTERNAL  no timer; call tick () yourself from some other
+                          interrupt, e.g. a sensor's data-ready pin:
+                            attachInterrupt ( digitalPinToInterrupt ( pd ),
+                                              drdyISR, RISING );
+                          rate is then only what jitter is measured against
+  On the AVR, whose timer vectors can't be claimed from a header, only
+  ACQUISITION_EXTERNAL is available: call tick () from your own ISR.
+
+  Counters, all of which only grow, for telemetry:
+    samples ()       ticks taken
+    overruns ()      samples lost because loop () let the ring fill
+    readFailures ()  ticks on which the reader returned false
+    dropped ()       the sum of those two
+    late ()          ticks more than half a period late, each of which is a
+                     sample the rate promised and didn't get
+    maxJitter_us ()  the largest | interval - period | since it was last
+                     cleared ( clearJitter () )
+    highWater ()     the most samples ever waiting at once; N means trouble
+
+  The reader runs in interrupt context and must be short; on the ESP8266 an
+  I2C read of a few bytes at 400 kHz is about 200 us. Stop the timer ( end ()
+  ) before writing flash, e.g. at the start of an OTA update, since code in
+  flash can't run from an interrupt while the flash is busy.
+*/
+
+#ifndef Acquisition_h
+#define Acquisition_h
+
+#define Acquisition_VERSION "1.000.000"
+// 2026-10-17 1.000.000 created
+
+#include "Arduino.h"
+#include <cbmSPSCRing.h>
+
+#define ACQUISITION_TIMER    0
+#define ACQUISITION_EXTERNAL 1
+
+#if defined ( ESP8266 )
+  #define Acquisition_ISR_ATTR IRAM_ATTR
+#else
+  #define Acquisition_ISR_ATTR
+#endif
+
+template <typename S>
+struct AcquisitionSample {
+  unsigned long t_us;       // micros () when taken
+  S value;
+};
+
+template <typename S, size_t N>
+class Acquisition
+{
+  public:
+    typedef bool ( * reader_t ) ( S & value );
+
+    Acquisition () { _reader = NULL; _running = false; _period_us = 0; _reset (); }
+
+    bool begin ( float rate_Hz, reader_t reader, int clock = ACQUISITION_TIMER ) {
+      if ( rate_Hz <= 0.0 || reader == NULL ) return false;
+      end ();
+      _reader = reader;
+      _period_us = ( unsigned long ) ( 1e6 / rate_Hz + 0.5 );
+      _reset ();
+      _self = this;
+      _running = true;
+      if ( clock == ACQUISITION_EXTERNAL ) return true;
+      #if defined ( ESP8266 )
+        // 80 MHz / 16: 5 ticks per us, and 23 bits of them
+        unsigned long ticks = ( unsigned long ) ( 5e6 / rate_Hz + 0.5 );
+        if ( ticks < 50 || ticks > 0x7fffffUL ) { _running = false; return false; }
+        timer1_isr_init ();
+        timer1_attachInterrupt ( _isr );
+        timer1_enable ( TIM_DIV16, TIM_EDGE, TIM_LOOP );
+        timer1_write ( ticks );
+        return true;
+      #else
+        _running = false;
+        return false;
+      #endif
+    }
+
+    void end () {
+      #if defined ( ESP8266 )
+        if ( _running && _self == this ) timer1_disable ();
+      #endif
+      _running = false;
+    }
+
+    bool running () { return _running; }
+    unsigned long period_us () { return _period_us; }
+
+    // one sample: from the timer ISR, or from yours with ACQUISITION_EXTERNAL
+    void Acquisition_ISR_ATTR tick () {
+      if ( ! _running ) return;
+      unsigned long now = micros ();
+      if ( _clearJitter ) { _maxJitter_us = 0; _clearJitter = false; }
+      if ( _samples > 0 ) {
+        long dev = ( long ) ( now - _lastTick_us ) - ( long ) _period_us;
+        unsigned long jitter = dev < 0 ? -dev : dev;
+        if ( jitter > _maxJitter_us ) _maxJitter_us = jitter;
+        if ( dev > ( long ) ( _period_us / 2 ) ) _late++;
+      }
+      _lastTick_us = now;
+      _samples++;
+      AcquisitionSample<S> s;
+      s.t_us = now;
+      if ( ! _reader ( s.value ) ) {
+        _readFailures++;
+        return;
+      }
+      _ring.push ( s );
+    }
+
+    // up to maxN samples, oldest first; returns how many
+    size_t read ( AcquisitionSample<S> * out, size_t maxN ) { return _ring.pop ( out, maxN ); }
+    size_t available () { return _ring.available (); }
+
+    unsigned long samples () { return _atomic ( _samples ); }
+    unsigned long overruns () { return _ring.overruns (); }
+    unsigned long readFailures () { return _atomic ( _readFailures ); }
+    unsigned long dropped () { return overruns () + readFailures (); }
+    unsigned long late () { return _atomic ( _late ); }
+    unsigned long maxJitter_us () { return _atomic ( _maxJitter_us ); }
+    void clearJitter () { _clearJitter = true; }
+    size_t highWater () { return _ring.highWater (); }
+
+  private:
+    static void Acquisition_ISR_ATTR _isr () { if ( _self ) _self->tick (); }
+
+    // only while the clock is stopped
+    void _reset () {
+      _ring.reset ();
+      _samples = _readFailures = _late = 0;
+      _maxJitter_us = 0;
+      _clearJitter = false;
+      _lastTick_us = 0;
+    }
+    // more than one byte on the AVR: read until two reads agree
+    unsigned long _atomic ( volatile unsigned long & v ) {
+      unsigned long a, b;
+      do { a = v; b = v; } while ( a != b );
+      return a;
+    }
+
+    static Acquisition * volatile _self;
+    SPSCRing<AcquisitionSample<S>, N> _ring;
+    reader_t _reader;
+    volatile bool _running;
+    unsigned long _period_us;
+    // written by tick () only, except as noted
+    volatile unsigned long _samples, _readFailures, _late;
+    volatile unsigned long _maxJitter_us;
+    volatile bool _clearJitter;               // set by clearJitter, cleared by tick
+    unsigned long _lastTick_us;
+};
+
+template <typename S, size_t N>
+Acquisition<S, N> * volatile Acquisition<S, N>::_self = NULL;
+
+#endif
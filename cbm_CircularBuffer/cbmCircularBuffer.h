@@ -2,6 +2,36 @@
 	cbmCircularBuffer.h - library for maintaining a circular buffer
 	Created by Charles B. Malloch, PhD, April 13, 2024
 	Released into the public domain
+
+  Two flavors, one interface:
+    CircularBuffer<float> energies ( 20 );   // storage malloc'd at run time
+    CircularBuffer<float, 20> energies;      // storage inside the object
+  The second is the one to use on the ESP8266, whose heap fragments: the
+  storage is static ( or on the stack, or inside whatever contains it ),
+  and when N is a power of two, wrapping an index is a mask instead of a
+  compare and subtract.
+
+  store ( x ) appends, overwriting the oldest entry when full, as always.
+  As a deque:
+    push ( x )      append at the end ( newest ); false if full
+    pop ( x )       remove from the end; false if empty
+    unshift ( x )   insert at the front ( oldest ); false if full
+    shift ( x )     remove from the front; false if empty
+    peek ()         the oldest entry; peekLast () the newest
+    [ i ]           the i-th oldest entry, i < size ()
+  count () is the number ever added ( store, push, unshift ), including any
+  since overwritten or removed; size () is the number held now; firstIndex ()
+  is count () - size (), which is the sequence number of the oldest entry
+  held as long as entries are added at the end and removed from the front.
+  reset ( count ) empties the buffer and starts count () there instead of 0.
+
+  entries ( out ) copies everything out, oldest first. To look without
+  copying, the held entries are at most two contiguous runs:
+    float * p;
+    size_t n = energies.firstSpan ( p );   // oldest first
+    ... p [ 0 ] .. p [ n - 1 ] ...
+    n = energies.secondSpan ( p );         // 0 if not wrapped
+    ... p [ 0 ] .. p [ n - 1 ] ...
 */
 
 #ifndef CircularBuffer_h
@@ -9,53 +39,114 @@
 
 // #warning GETTING .h file
 
-#define CircularBuffer_VERSION "1.001.001"
+#define CircularBuffer_VERSION "1.004.000"
 // 2023-05-30 1.000.000 created
+// 2026-10-17 1.002.000 added operator [], the i-th oldest retained entry
+// 2026-10-17 1.003.000 CircularBuffer<T, N> with static storage; deque
+//                      operations; spans; default constructor no longer
+//                      frees an uninitialized pointer
+// 2026-10-18 1.004.000 reset ( count ), to start the count somewhere other than 0
 
 #include <stdlib.h>
 #include "Arduino.h"
 
+//******************************************************************************
+// storage: N > 0 inside the object, N == 0 malloc'd
+//******************************************************************************
+
+template <typename T, size_t N>
+class CircularBuffer_storage
+{
+  protected:
+    CircularBuffer_storage () {}
+    CircularBuffer_storage ( size_t bufSize ) { ( void ) bufSize; }
+    size_t _capacity () const { return N; }
+    size_t _wrap ( size_t i ) const {
+      // i < 2N; the mask is chosen at compile time
+      if ( ( N & ( N - 1 ) ) == 0 ) return i & ( N - 1 );
+      return i >= N ? i - N : i;
+    }
+    T _array [ N ];
+};
+
 template <typename T>
-class CircularBuffer
+class CircularBuffer_storage<T, 0>
+{
+  protected:
+    CircularBuffer_storage () { _array = NULL; _size = 0; }
+    CircularBuffer_storage ( size_t bufSize ) {
+      _array = (T *) malloc ( bufSize * sizeof ( T ) );
+      // Serial.printf ( "CircularBuffer: Memory not allocated.\n" );
+      _size = ( _array == NULL ) ? 0 : bufSize;
+    }
+    ~CircularBuffer_storage () { free ( _array ); }
+    size_t _capacity () const { return _size; }
+    size_t _wrap ( size_t i ) const { return i >= _size ? i - _size : i; }
+    T * _array;
+    size_t _size;
+  private:
+    // two copies would free the same storage
+    CircularBuffer_storage ( const CircularBuffer_storage & ) = delete;
+    CircularBuffer_storage & operator= ( const CircularBuffer_storage & ) = delete;
+};
+
+//******************************************************************************
+// CircularBuffer
+//******************************************************************************
+
+template <typename T, size_t N = 0>
+class CircularBuffer : private CircularBuffer_storage<T, N>
 {
   public:
     CircularBuffer();
-    CircularBuffer ( size_t bufSize );
-    ~CircularBuffer();
+    CircularBuffer ( size_t bufSize );   // ignored when N > 0
     unsigned long count ();   // returns total number of points added, including overwritten
     unsigned long bufSize ();
     unsigned long firstIndex ();
-    // overwrite is for future use when we have implemented unshift, shift, push, and pop
+    size_t size ();           // number of entries held now
+    // with overwrite false, a full buffer refuses the new entry
     unsigned long store ( T x, bool overwrite = true );
-    void reset ();
+    void reset ( unsigned long count = 0UL );
     void entries ( T out[] );
+    // i = 0 is the oldest entry still held; no check that i < size ()
+    T operator [] ( size_t i );
+    bool push ( T x );
+    bool pop ( T & x );
+    bool unshift ( T x );
+    bool shift ( T & x );
+    T peek ();
+    T peekLast ();
+    size_t firstSpan ( T * & p );
+    size_t secondSpan ( T * & p );
   protected:
     // anything that needs to be available only to:
     //    the class itself
     //    friend functions and classes
     //    inheritors
     // this-> reportedly not needed
-  
+
   private:
-    size_t _size;
-    size_t _left, _right;
+    typedef CircularBuffer_storage<T, N> storage;
+    using storage::_array;
+    using storage::_capacity;
+    using storage::_wrap;
+    size_t _head;                             // the oldest entry
+    size_t _len;                              // entries held
     unsigned long _n;                         // total entries, including overwritten
-    T * _array;
-    bool _init ( size_t bufSize );
-  
+
 };
 
 //******************************************************************************
 /*
   Note: putting the function defs into the .cpp file as usual doesn't work
-  
-  The reason is that a .cpp file is separately compiled, and it makes the 
+
+  The reason is that a .cpp file is separately compiled, and it makes the
   compiler unhappy to try to compile a templated function before knowing
   what the eventual type will be.
-  
+
   Thus we've included the functions here where they'll be included in the source,
   and removed them from the .cpp file.
-  
+
   See <https://stackoverflow.com/questions/36039/templates-spread-across-multiple-files>
 */
 //******************************************************************************
@@ -63,104 +154,139 @@ class CircularBuffer
 
 // #include <CircularBuffer.h>
 
-template <typename T>
-CircularBuffer<T>::CircularBuffer () {
-}
-
-template <typename T>
-CircularBuffer<T>::CircularBuffer ( size_t bufSize ) {
-  CircularBuffer::_init ( bufSize );
+template <typename T, size_t N>
+CircularBuffer<T, N>::CircularBuffer () {
+  reset ();
 }
 
-template <typename T>
-CircularBuffer<T>::~CircularBuffer () {
-  free ( _array );
+template <typename T, size_t N>
+CircularBuffer<T, N>::CircularBuffer ( size_t bufSize ) : storage ( bufSize ) {
+  reset ();
 }
 
-template <typename T>
-void CircularBuffer<T>::reset () {
-  /*
-    left points to the first occupied spot
-    right points to the last occupied spot
-  */
-  _left = 0;
-  _right = -1;
+template <typename T, size_t N>
+void CircularBuffer<T, N>::reset ( unsigned long count ) {
+  _head = 0;
+  _len = 0;
   // _n is total values added, including those overwritten
-  _n = 0UL;
+  _n = count;
 }
 
-template <typename T>
-bool CircularBuffer<T>::_init ( size_t bufSize ) {
-  bool OK = true;
-  _array = (T *) malloc ( bufSize * sizeof ( T ) );
-  if (_array == NULL) {
-    _size = 0;
-    // Serial.printf ( "CircularBuffer: Memory not allocated.\n" );
-    OK = false;
-  } else {
-    _size = bufSize;
-    CircularBuffer::reset ();
-  }    
-  return OK;
+template <typename T, size_t N>
+unsigned long CircularBuffer<T, N>::bufSize () {
+  return _capacity ();
 }
 
-template <typename T>
-unsigned long CircularBuffer<T>::bufSize () {
-  return _size;
+template <typename T, size_t N>
+unsigned long CircularBuffer<T, N>::count () {
+  return _n;
 }
 
-template <typename T>
-unsigned long CircularBuffer<T>::count () {
-  return _n;
+template <typename T, size_t N>
+unsigned long CircularBuffer<T, N>::firstIndex () {
+  return _n - _len;
 }
 
-template <typename T>
-unsigned long CircularBuffer<T>::firstIndex () {
-  return _n <= _size ? 0 : _n - _size;
+template <typename T, size_t N>
+size_t CircularBuffer<T, N>::size () {
+  return _len;
 }
 
-template <typename T>
-unsigned long CircularBuffer<T>::store ( T x, bool overwrite ) {
-  if ( ( _n >= _size ) && overwrite ) {
-    // full but OK to overwrite
-    // bump right
-    // Serial.printf ( "Overwriting: " );
-    _right++;
-    if ( _right >= _size ) _right -= _size;
-    // bump left
-    _left++;
-    if ( _left >= _size ) _left -= _size;
-    // leave n alone
-    // store the item
-    _array [ _right ] = x;
-    _n++;
-    // Serial.printf ( "n: %2d; L: %2d; R: %2d; val: %2.2f =? %2.2f\n", _n, _left, _right, _array [ _right ], x );
-  } else if ( _n >= _size ) {
-    Serial.printf ( "CircularBuffer: must not add to full buffer\n" );
-  } else {
+template <typename T, size_t N>
+unsigned long CircularBuffer<T, N>::store ( T x, bool overwrite ) {
+  if ( _capacity () == 0 ) return _n;
+  if ( _len < _capacity () ) {
     // not full
-    // Serial.printf ( "Storing: " );
-    // bump right
-    _right++;
-    if ( _right >= _size ) _right -= _size;
-    // store the item
-    _array [ _right ] = x;
+    _array [ _wrap ( _head + _len ) ] = x;
+    _len++;
+    _n++;
+  } else if ( overwrite ) {
+    // full but OK to overwrite: the oldest slot becomes the newest
+    _array [ _head ] = x;
+    _head = _wrap ( _head + 1 );
     _n++;
-    // Serial.printf ( "n: %2d; L: %2d; R: %2d; val: %2.2f =? %2.2f\n", _n, _left, _right, _array [ _right ], x );
+  } else {
+    Serial.printf ( "CircularBuffer: must not add to full buffer\n" );
   }
   return _n;
 }
 
-template <typename T>
-void CircularBuffer<T>::entries ( T out[] ) {
-  size_t ptr = _left;
-  for ( int i = 0; i < _size; i++ ) {
-    out [ i ] = ( i < _n ) ? _array [ ptr ] : 0;
-    ptr++;
-    if ( ptr >= _size ) ptr = 0;
-  }
+template <typename T, size_t N>
+void CircularBuffer<T, N>::entries ( T out[] ) {
+  T * p;
+  size_t i = 0;
+  size_t n = firstSpan ( p );
+  for ( size_t k = 0; k < n; k++ ) out [ i++ ] = p [ k ];
+  n = secondSpan ( p );
+  for ( size_t k = 0; k < n; k++ ) out [ i++ ] = p [ k ];
+  while ( i < _capacity () ) out [ i++ ] = 0;
+}
+
+template <typename T, size_t N>
+T CircularBuffer<T, N>::operator [] ( size_t i ) {
+  return _array [ _wrap ( _head + i ) ];
+}
+
+template <typename T, size_t N>
+bool CircularBuffer<T, N>::push ( T x ) {
+  if ( _len >= _capacity () ) return false;
+  _array [ _wrap ( _head + _len ) ] = x;
+  _len++;
+  _n++;
+  return true;
+}
+
+template <typename T, size_t N>
+bool CircularBuffer<T, N>::pop ( T & x ) {
+  if ( _len == 0 ) return false;
+  _len--;
+  x = _array [ _wrap ( _head + _len ) ];
+  return true;
+}
+
+template <typename T, size_t N>
+bool CircularBuffer<T, N>::unshift ( T x ) {
+  if ( _len >= _capacity () ) return false;
+  _head = _wrap ( _head + _capacity () - 1 );
+  _array [ _head ] = x;
+  _len++;
+  _n++;
+  return true;
+}
+
+template <typename T, size_t N>
+bool CircularBuffer<T, N>::shift ( T & x ) {
+  if ( _len == 0 ) return false;
+  x = _array [ _head ];
+  _head = _wrap ( _head + 1 );
+  _len--;
+  return true;
+}
+
+template <typename T, size_t N>
+T CircularBuffer<T, N>::peek () {
+  return _len > 0 ? _array [ _head ] : T ();
+}
+
+template <typename T, size_t N>
+T CircularBuffer<T, N>::peekLast () {
+  return _len > 0 ? _array [ _wrap ( _head + _len - 1 ) ] : T ();
+}
+
+template <typename T, size_t N>
+size_t CircularBuffer<T, N>::firstSpan ( T * & p ) {
+  p = &_array [ _head ];
+  size_t toEnd = _capacity () - _head;
+  return _len < toEnd ? _len : toEnd;
+}
+
+template <typename T, size_t N>
+size_t CircularBuffer<T, N>::secondSpan ( T * & p ) {
+  p = &_array [ 0 ];
+  size_t toEnd = _capacity () - _head;
+  return _len > toEnd ? _len - toEnd : 0;
 }
 
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,155 @@
+/*
+	cbmSPSCRing.h - single-producer, single-consumer ring for handing samples
+	  from an interrupt service routine to loop ()
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+  A sketch that samples in loop () loses samples whenever WiFi, MQTT, or a
+  WebSocket holds loop () up. Take the samples in a timer ISR instead, push
+  them here, and let loop () pop them whenever it gets around to it:
+
+    SPSCRing<int16_t, 64> samples;          // N must be a power of two
+
+    void timerISR () {                      // the one producer
+      samples.push ( analogRead ( A0 ) );   // never blocks; counts overruns
+    }
+
+    void loop () {                          // the one consumer
+      int16_t x;
+      while ( samples.pop ( x ) ) filter.record ( x );
+      ...
+      Serial.println ( samples.highWater () );   // how close it came
+      Serial.println ( samples.overruns () );    // samples lost
+    }
+
+  No interrupts are disabled anywhere. The producer alone writes the head
+  index and the consumer alone writes the tail index, and each index is
+  written in a single store, so neither side ever sees the other half way
+  through an update; a barrier keeps the data written before the index that
+  publishes it, and read before the index that frees its slot. Both indexes
+  run freely and are masked into the storage, which is why N must be a power
+  of two.
+
+  On the AVR only a byte is read or written in one instruction, so there the
+  indexes are bytes and N may be at most 128. Elsewhere they are 32 bits.
+
+  When the ring is full, push drops the new sample ( the older ones are
+  already promised to the consumer ) and counts an overrun. highWater is the
+  most samples ever waiting at once; if it reaches N, loop () is falling
+  behind. Both counters only grow; overruns and highWater can be read from
+  loop () at any time. reset must only be called while the producer is
+  stopped.
+
+  The storage is that of a CircularBuffer<T, N> ( see cbmCircularBuffer.h ).
+*/
+
+#ifndef SPSCRing_h
+#define SPSCRing_h
+
+#define SPSCRing_VERSION "1.000.000"
+// 2026-10-17 1.000.000 created
+
+#include "cbmCircularBuffer.h"
+
+#if defined ( __AVR__ )
+  typedef uint8_t SPSCRing_index_t;
+  #define SPSCRing_MAX_N 128
+#else
+  typedef uint32_t SPSCRing_index_t;
+  #define SPSCRing_MAX_N 0x80000000UL
+#endif
+
+// acquire after reading the other side's index, release before publishing
+// our own. On a single core with an ISR, keeping the compiler from moving
+// memory accesses across them is all the ordering needed; the host build runs
+// producer and consumer on different cores, and needs real fences.
+#if defined ( __AVR__ ) || defined ( ESP8266 )
+  #define SPSCRing_acquire() __asm__ __volatile__ ( "" ::: "memory" )
+  #define SPSCRing_release() __asm__ __volatile__ ( "" ::: "memory" )
+#else
+  #define SPSCRing_acquire() __atomic_thread_fence ( __ATOMIC_ACQUIRE )
+  #define SPSCRing_release() __atomic_thread_fence ( __ATOMIC_RELEASE )
+#endif
+
+template <typename T, size_t N>
+class SPSCRing : private CircularBuffer_storage<T, N>
+{
+  static_assert ( N > 0 && ( N & ( N - 1 ) ) == 0, "SPSCRing: N must be a power of two" );
+  static_assert ( N <= SPSCRing_MAX_N, "SPSCRing: N too large for the index type" );
+
+  public:
+    SPSCRing () { reset (); }
+
+    // producer side
+    bool push ( T x ) {
+      SPSCRing_index_t head = _head;
+      SPSCRing_index_t waiting = ( SPSCRing_index_t ) ( head - _tail );
+      if ( waiting >= N ) {
+        _overruns++;
+        return false;
+      }
+      SPSCRing_acquire ();
+      _array [ head & ( N - 1 ) ] = x;
+      SPSCRing_release ();
+      _head = ( SPSCRing_index_t ) ( head + 1 );
+      if ( waiting + 1 > _highWater ) _highWater = waiting + 1;
+      return true;
+    }
+
+    // consumer side
+    bool pop ( T & x ) {
+      SPSCRing_index_t tail = _tail;
+      if ( tail == _head ) return false;
+      SPSCRing_acquire ();
+      x = _array [ tail & ( N - 1 ) ];
+      SPSCRing_release ();
+      _tail = ( SPSCRing_index_t ) ( tail + 1 );
+      return true;
+    }
+    // up to maxN at once; returns how many
+    size_t pop ( T * out, size_t maxN ) {
+      SPSCRing_index_t tail = _tail;
+      SPSCRing_index_t waiting = ( SPSCRing_index_t ) ( _head - tail );
+      size_t n = waiting < maxN ? waiting : maxN;
+      SPSCRing_acquire ();
+      for ( size_t i = 0; i < n; i++ ) {
+        out [ i ] = _array [ ( SPSCRing_index_t ) ( tail + i ) & ( N - 1 ) ];
+      }
+      SPSCRing_release ();
+      _tail = ( SPSCRing_index_t ) ( tail + n );
+      return n;
+    }
+    bool peek ( T & x ) {
+      SPSCRing_index_t tail = _tail;
+      if ( tail == _head ) return false;
+      SPSCRing_acquire ();
+      x = _array [ tail & ( N - 1 ) ];
+      return true;
+    }
+    size_t available () { return ( SPSCRing_index_t ) ( _head - _tail ); }
+
+    // either side
+    size_t capacity () { return N; }
+    size_t highWater () { return _highWater; }
+    unsigned long overruns () {
+      // more than one byte on the AVR: read until two reads agree
+      unsigned long a, b;
+      do { a = _overruns; b = _overruns; } while ( a != b );
+      return a;
+    }
+    // only while the producer is stopped
+    void reset () {
+      _head = _tail = 0;
+      _highWater = 0;
+      _overruns = 0;
+    }
+
+  private:
+    using CircularBuffer_storage<T, N>::_array;
+    volatile SPSCRing_index_t _head;          // written by the producer only
+    volatile SPSCRing_index_t _tail;          // written by the consumer only
+    volatile SPSCRing_index_t _highWater;     // producer only
+    volatile unsigned long _overruns;         // producer only
+};
+
+#endif
@@ -15,6 +15,7 @@ CircularBuffer<int> vuhI ( 15 );
 int linearIBuf [ 17 ];
 CircularBuffer<float> vuhF ( 20 );
 float linearFBuf [ 22 ];
+CircularBuffer<int, 8> vuhS;     // static storage; 8 is a power of two
 
 void setup () {
   Serial.begin ( BAUDRATE );
@@ -51,6 +52,23 @@ void setup () {
   Serial.println ( "dumping 30 values set" );
   dumpValues ();
   
+  // as a deque
+  for ( int i = 0; i < 5; i++ ) vuhS.push ( i );        // 0 1 2 3 4
+  vuhS.unshift ( -1 );                                  // -1 0 1 2 3 4
+  int x;
+  vuhS.shift ( x );                                     // x = -1
+  vuhS.pop ( x );                                       // x = 4
+  for ( int i = 10; i < 16; i++ ) vuhS.store ( i );     // 2 3 10 11 12 13 14 15
+  Serial.printf ( "S: size: %u; oldest: %d; newest: %d; [ 2 ]: %d\n",
+    vuhS.size (), vuhS.peek (), vuhS.peekLast (), vuhS [ 2 ] );
+  // without copying: at most two runs
+  int * p;
+  size_t n = vuhS.firstSpan ( p );
+  for ( size_t i = 0; i < n; i++ ) Serial.printf ( "%4d ", p [ i ] );
+  n = vuhS.secondSpan ( p );
+  for ( size_t i = 0; i < n; i++ ) Serial.printf ( "%4d ", p [ i ] );
+  Serial.printf ( "\n" );
+  
 }
   
 void loop () { yield(); }
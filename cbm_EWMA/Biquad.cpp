@@ -0,0 +1,139 @@
+/*
+	Biquad.cpp - designers for the biquad cascades in Biquad.h
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	The sections follow R. Bristow-Johnson's "Audio EQ Cookbook": each is the
+	bilinear transform, prewarped at its own corner, of an analog section.
+	An order-n Butterworth is then ( n / 2 ) sections at the same corner with
+	  Q_k = 1 / ( 2 cos ( ( 2k + 1 ) pi / ( 2n ) ) ),  k = 0 .. n/2 - 1
+	plus, for odd n, a first-order section.
+*/
+
+#include <Math.h>
+#include "Biquad.h"
+
+static void _normalize ( BiquadCoefs * c, double a0 ) {
+  c->b0 /= a0; c->b1 /= a0; c->b2 /= a0;
+  c->a1 /= a0; c->a2 /= a0;
+}
+
+static double _butterworthQ ( int k, int order ) {
+  return ( 1.0 / ( 2.0 * cos ( ( 2 * k + 1 ) * M_PI / ( 2.0 * order ) ) ) );
+}
+
+// highpass false for low-pass
+static int _butterworth ( BiquadCoefs * sos, int order, double cutoff, double F_sampling,
+                          bool highpass ) {
+  if ( order < 1 ) return 0;
+  // no filter at all
+  if ( ! highpass && cutoff >= F_sampling / 2.0 ) return 0;
+  if ( highpass && cutoff <= 0.0 ) return 0;
+
+  double w0 = 2.0 * M_PI * cutoff / F_sampling;
+  double cw = cos ( w0 );
+  double sw = sin ( w0 );
+  int n = 0;
+
+  for ( int k = 0; k < order / 2; k++ ) {
+    BiquadCoefs * c = &sos [ n++ ];
+    double alpha = sw / ( 2.0 * _butterworthQ ( k, order ) );
+    if ( highpass ) {
+      c->b0 = ( 1.0 + cw ) / 2.0;
+      c->b1 = - ( 1.0 + cw );
+    } else {
+      c->b0 = ( 1.0 - cw ) / 2.0;
+      c->b1 = 1.0 - cw;
+    }
+    c->b2 = c->b0;
+    c->a1 = -2.0 * cw;
+    c->a2 = 1.0 - alpha;
+    _normalize ( c, 1.0 + alpha );
+  }
+
+  if ( order & 1 ) {
+    // first-order section
+    BiquadCoefs * c = &sos [ n++ ];
+    double K = tan ( w0 / 2.0 );
+    if ( highpass ) {
+      c->b0 = 1.0 / ( 1.0 + K );
+      c->b1 = - c->b0;
+    } else {
+      c->b0 = K / ( 1.0 + K );
+      c->b1 = c->b0;
+    }
+    c->b2 = 0.0;
+    c->a1 = ( K - 1.0 ) / ( K + 1.0 );
+    c->a2 = 0.0;
+  }
+
+  return n;
+}
+
+int biquadLowpass ( BiquadCoefs * sos, int order, double cutoff, double F_sampling ) {
+  return _butterworth ( sos, order, cutoff, F_sampling, false );
+}
+
+int biquadHighpass ( BiquadCoefs * sos, int order, double cutoff, double F_sampling ) {
+  return _butterworth ( sos, order, cutoff, F_sampling, true );
+}
+
+// for an odd order, the high-pass's first-order section ( its last ) times the low-pass's
+// ( its last ) is a second-order one: ( b0 + b1 z ) ( c0 + c1 z ) over ( 1 + a1 z ) ( 1 + d1 z )
+int biquadBandpass ( BiquadCoefs * sos, int order,
+                     double low_cutoff, double high_cutoff, double F_sampling ) {
+  int nh = biquadHighpass ( sos, order, low_cutoff, F_sampling );
+  int nl = biquadLowpass ( &sos [ nh ], order, high_cutoff, F_sampling );
+  if ( ! ( order & 1 ) || nh == 0 || nl == 0 ) return nh + nl;
+  BiquadCoefs & h = sos [ nh - 1 ];
+  const BiquadCoefs & l = sos [ nh + nl - 1 ];
+  BiquadCoefs c;
+  c.b0 = h.b0 * l.b0;
+  c.b1 = h.b0 * l.b1 + h.b1 * l.b0;
+  c.b2 = h.b1 * l.b1;
+  c.a1 = h.a1 + l.a1;
+  c.a2 = h.a1 * l.a1;
+  h = c;
+  return nh + nl - 1;
+}
+
+int biquadBandpassQ ( BiquadCoefs * sos, double center, double Q, double F_sampling ) {
+  // constant 0 dB peak gain
+  double w0 = 2.0 * M_PI * center / F_sampling;
+  double alpha = sin ( w0 ) / ( 2.0 * Q );
+  sos->b0 = alpha;
+  sos->b1 = 0.0;
+  sos->b2 = -alpha;
+  sos->a1 = -2.0 * cos ( w0 );
+  sos->a2 = 1.0 - alpha;
+  _normalize ( sos, 1.0 + alpha );
+  return 1;
+}
+
+int biquadNotch ( BiquadCoefs * sos, double center, double Q, double F_sampling ) {
+  double w0 = 2.0 * M_PI * center / F_sampling;
+  double alpha = sin ( w0 ) / ( 2.0 * Q );
+  sos->b0 = 1.0;
+  sos->b1 = -2.0 * cos ( w0 );
+  sos->b2 = 1.0;
+  sos->a1 = -2.0 * cos ( w0 );
+  sos->a2 = 1.0 - alpha;
+  _normalize ( sos, 1.0 + alpha );
+  return 1;
+}
+
+double biquadGain ( const BiquadCoefs * sos, int nSections, double f, double F_sampling ) {
+  // | H ( e^jw ) |, with z^-1 = cos w - j sin w
+  double w = 2.0 * M_PI * f / F_sampling;
+  double c1 = cos ( w ), s1 = sin ( w ), c2 = cos ( 2.0 * w ), s2 = sin ( 2.0 * w );
+  double gain = 1.0;
+  for ( int s = 0; s < nSections; s++ ) {
+    const BiquadCoefs & c = sos [ s ];
+    double nr = c.b0 + c.b1 * c1 + c.b2 * c2;
+    double ni = - c.b1 * s1 - c.b2 * s2;
+    double dr = 1.0 + c.a1 * c1 + c.a2 * c2;
+    double di = - c.a1 * s1 - c.a2 * s2;
+    gain *= sqrt ( ( nr * nr + ni * ni ) / ( dr * dr + di * di ) );
+  }
+  return gain;
+}
@@ -0,0 +1,284 @@
+/*
+	Biquad.h - cascades of second-order IIR sections ( biquads ), with
+	  Butterworth low-pass, high-pass, and band-pass designers and a notch
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	The EWMA-based LPF / HPF / BPF in EWMA.h are first-order: they roll off at
+	6 dB per octave, and the BPF's two edges smear into each other. A cascade
+	of biquads gives any even-order Butterworth response ( 12 dB per octave
+	per section ) for five multiplies per section per sample.
+
+	Each section computes
+	    y = b0 * x + b1 * x(t-1) + b2 * x(t-2) - a1 * y(t-1) - a2 * y(t-2)
+	with the coefficients normalized so that a0 is 1.
+
+	Designers ( Biquad.cpp ), which fill in an array of BiquadCoefs and return
+	the number of sections used:
+	  biquadLowpass   ( sos, order, cutoff, F_sampling )
+	  biquadHighpass  ( sos, order, cutoff, F_sampling )
+	  biquadBandpass  ( sos, order, low_cutoff, high_cutoff, F_sampling )
+	      a Butterworth high-pass at low_cutoff cascaded with a Butterworth
+	      low-pass at high_cutoff, order each; right for wide bands such as
+	      the seismometer's 0.01 - 40 Hz; order sections, as for an odd order
+	      the two first-order sections are joined into one
+	  biquadBandpassQ ( sos, center, Q, F_sampling )
+	      one section, unity gain at center, bandwidth center / Q;
+	      right for narrow bands such as a lock-in at a known frequency
+	  biquadNotch     ( sos, center, Q, F_sampling )
+	order n takes ( n + 1 ) / 2 sections; an odd order ends in a first-order
+	section. A low-pass cutoff at or above F_sampling / 2, or a high-pass
+	cutoff at or below 0, is no filter at all, and takes no sections.
+
+	Kernels, chosen by the sample type of Biquad<T, maxSections>:
+	  float, double: direct form II transposed, 2 state variables per section
+	  int16_t ( also q15_t ): coefficients Q14 ( range -2 .. +2 ), 32-bit
+	      accumulator, direct form I, 4 state variables per section
+	  int32_t ( also q31_t ): coefficients Q28 ( range -8 .. +8 ), 64-bit
+	      accumulator, direct form I
+	The integer kernels accumulate modulo 2^32 ( 2^64 ), which is exact as long
+	as the section's output fits in T, and keep the bits shifted off each
+	output to add back into the next ( "fraction saving" ), which stops the
+	quantization noise of a pole close to z = 1 from swamping a low cutoff.
+	Output that does not fit in T is saturated.
+
+	Choosing a type: coefficient resolution sets how low a cutoff a section
+	can hold.
+	  int16_t: cutoffs down to about F_sampling / 100, with the DC gain of a
+	           low-pass accurate to a few percent there
+	  int32_t: cutoffs down to about F_sampling / 10000 ( the seismometer's
+	           0.01 Hz at 62 Hz is F_sampling / 6200 )
+	  float:   F_sampling / 10000 and below
+
+	Synopsis
+	  #include <Biquad.h>
+	  Biquad<float, 4> band;                      // up to 4 sections
+	  band.bandpass ( 2, 0.5, 10.0, 62.0 );       // order 2 at each edge
+	  float y = band.record ( x );
+	  band.record ( block, block, 64 );           // a block at a time
+
+	  BiquadCoefs sos [ 2 ];                      // or design it yourself
+	  int n = biquadLowpass ( sos, 4, 5.0, 62.0 );
+	  Biquad<int16_t, 2> lp ( sos, n );
+
+	See the note in cbmCircularBuffer.h on why a template lives entirely in
+	its header file.
+*/
+
+#ifndef Biquad_h
+#define Biquad_h
+
+#define BIQUAD_VERSION "1.001.000"
+// 2026-10-17 1.000.000 created
+// 2026-10-18 1.001.000 an odd-order band-pass in order sections, not order + 1; bandpass ()
+//                      clamps the order to maxSections, so Biquad<T, 1> gets an order-1 band
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+struct BiquadCoefs {
+  double b0, b1, b2, a1, a2;
+};
+
+int biquadLowpass ( BiquadCoefs * sos, int order, double cutoff, double F_sampling );
+int biquadHighpass ( BiquadCoefs * sos, int order, double cutoff, double F_sampling );
+int biquadBandpass ( BiquadCoefs * sos, int order,
+                     double low_cutoff, double high_cutoff, double F_sampling );
+int biquadBandpassQ ( BiquadCoefs * sos, double center, double Q, double F_sampling );
+int biquadNotch ( BiquadCoefs * sos, double center, double Q, double F_sampling );
+
+// gain of a cascade at frequency f, for checking a design
+double biquadGain ( const BiquadCoefs * sos, int nSections, double f, double F_sampling );
+
+//******************************************************************************
+// one section, per sample type
+//******************************************************************************
+
+template <typename T>
+class BiquadSection
+{
+  // float and double: direct form II transposed
+  public:
+    void init ( const BiquadCoefs & c ) {
+      _b0 = c.b0; _b1 = c.b1; _b2 = c.b2; _a1 = c.a1; _a2 = c.a2;
+      reset ();
+    }
+    void reset () { _z1 = _z2 = 0; }
+    T record ( T x ) {
+      T y = _b0 * x + _z1;
+      _z1 = _b1 * x - _a1 * y + _z2;
+      _z2 = _b2 * x - _a2 * y;
+      return y;
+    }
+    void record ( const T * in, T * out, size_t n ) {
+      T b0 = _b0, b1 = _b1, b2 = _b2, a1 = _a1, a2 = _a2;
+      T z1 = _z1, z2 = _z2;
+      for ( size_t i = 0; i < n; i++ ) {
+        T x = in [ i ];
+        T y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        out [ i ] = y;
+      }
+      _z1 = z1; _z2 = z2;
+    }
+  private:
+    T _b0, _b1, _b2, _a1, _a2;
+    T _z1, _z2;
+};
+
+// direct form I in integers; see the header comment
+template <typename T, typename coef_t, typename acc_t, typename uacc_t, int fracBits>
+class BiquadSection_int
+{
+  public:
+    void init ( const BiquadCoefs & c ) {
+      _b0 = coef ( c.b0 ); _b1 = coef ( c.b1 ); _b2 = coef ( c.b2 );
+      _a1 = coef ( c.a1 ); _a2 = coef ( c.a2 );
+      reset ();
+    }
+    void reset () { _x1 = _x2 = _y1 = _y2 = 0; _err = 0; }
+    T record ( T x ) {
+      T y = step ( x, _x1, _x2, _y1, _y2, _err );
+      _x2 = _x1; _x1 = x;
+      _y2 = _y1; _y1 = y;
+      return y;
+    }
+    void record ( const T * in, T * out, size_t n ) {
+      T x1 = _x1, x2 = _x2, y1 = _y1, y2 = _y2;
+      acc_t err = _err;
+      for ( size_t i = 0; i < n; i++ ) {
+        T x = in [ i ];   // out may be in
+        T y = step ( x, x1, x2, y1, y2, err );
+        x2 = x1; x1 = x;
+        y2 = y1; y1 = y;
+        out [ i ] = y;
+      }
+      _x1 = x1; _x2 = x2; _y1 = y1; _y2 = y2;
+      _err = err;
+    }
+  private:
+    static coef_t coef ( double c ) {
+      double maxCoef = ( double ) ( ( ( acc_t ) 1 << ( 8 * sizeof ( coef_t ) - 1 ) ) - 1 );
+      double q = floor ( c * ( ( acc_t ) 1 << fracBits ) + 0.5 );
+      if ( q > maxCoef ) q = maxCoef;
+      if ( q < -maxCoef ) q = -maxCoef;
+      return ( coef_t ) q;
+    }
+    inline T step ( T x, T x1, T x2, T y1, T y2, acc_t & err ) {
+      // unsigned, so that intermediate overflow wraps rather than being
+      // undefined; the true sum is y << fracBits, which fits
+      uacc_t acc = ( uacc_t ) err
+                 + ( uacc_t ) ( ( acc_t ) _b0 * x )
+                 + ( uacc_t ) ( ( acc_t ) _b1 * x1 )
+                 + ( uacc_t ) ( ( acc_t ) _b2 * x2 )
+                 - ( uacc_t ) ( ( acc_t ) _a1 * y1 )
+                 - ( uacc_t ) ( ( acc_t ) _a2 * y2 );
+      acc_t a = ( acc_t ) acc;
+      acc_t y = a >> fracBits;
+      const acc_t yMax = ( ( acc_t ) 1 << ( 8 * sizeof ( T ) - 1 ) ) - 1;
+      if ( y > yMax ) { err = 0; return ( T ) yMax; }
+      if ( y < -yMax - 1 ) { err = 0; return ( T ) ( -yMax - 1 ); }
+      err = a - y * ( ( acc_t ) 1 << fracBits );
+      return ( T ) y;
+    }
+    coef_t _b0, _b1, _b2, _a1, _a2;
+    T _x1, _x2, _y1, _y2;
+    acc_t _err;
+};
+
+template <>
+class BiquadSection<int16_t>
+  : public BiquadSection_int<int16_t, int16_t, int32_t, uint32_t, 14> {};
+
+template <>
+class BiquadSection<int32_t>
+  : public BiquadSection_int<int32_t, int32_t, int64_t, uint64_t, 28> {};
+
+//******************************************************************************
+// Biquad - a cascade of up to maxSections sections
+//******************************************************************************
+
+template <typename T, int maxSections>
+class Biquad
+{
+  public:
+    Biquad () { _nSections = 0; _n = 0; _value = 0; }
+    Biquad ( const BiquadCoefs * sos, int nSections ) { init ( sos, nSections ); }
+    // returns the number of sections in use
+    int init ( const BiquadCoefs * sos, int nSections ) {
+      if ( nSections < 0 ) nSections = 0;
+      if ( nSections > maxSections ) nSections = maxSections;
+      _nSections = nSections;
+      for ( int s = 0; s < _nSections; s++ ) _sections [ s ].init ( sos [ s ] );
+      _n = 0;
+      _value = 0;
+      return _nSections;
+    }
+    int lowpass ( int order, double cutoff, double F_sampling ) {
+      BiquadCoefs sos [ maxSections + 1 ];
+      return init ( sos, biquadLowpass ( sos, clampOrder ( order ), cutoff, F_sampling ) );
+    }
+    int highpass ( int order, double cutoff, double F_sampling ) {
+      BiquadCoefs sos [ maxSections + 1 ];
+      return init ( sos, biquadHighpass ( sos, clampOrder ( order ), cutoff, F_sampling ) );
+    }
+    // order at each edge, and order sections: no more than maxSections
+    int bandpass ( int order, double low_cutoff, double high_cutoff, double F_sampling ) {
+      BiquadCoefs sos [ maxSections + 1 ];
+      int o = clampOrder ( order );
+      if ( o > maxSections ) o = maxSections;
+      return init ( sos, biquadBandpass ( sos, o, low_cutoff, high_cutoff, F_sampling ) );
+    }
+    int bandpassQ ( double center, double Q, double F_sampling ) {
+      BiquadCoefs sos [ 1 ];
+      return init ( sos, biquadBandpassQ ( sos, center, Q, F_sampling ) );
+    }
+    int notch ( double center, double Q, double F_sampling ) {
+      BiquadCoefs sos [ 1 ];
+      return init ( sos, biquadNotch ( sos, center, Q, F_sampling ) );
+    }
+    void reset () {
+      for ( int s = 0; s < _nSections; s++ ) _sections [ s ].reset ();
+      _n = 0;
+      _value = 0;
+    }
+    T record ( T x ) {
+      for ( int s = 0; s < _nSections; s++ ) x = _sections [ s ].record ( x );
+      _n++;
+      return _value = x;
+    }
+    // each section in turn runs over the whole block; out may be in
+    void record ( const T * in, T * out, size_t n ) {
+      if ( n == 0 ) return;
+      const T * src = in;
+      for ( int s = 0; s < _nSections; s++ ) {
+        _sections [ s ].record ( src, out, n );
+        src = out;
+      }
+      if ( src != out ) {
+        for ( size_t i = 0; i < n; i++ ) out [ i ] = in [ i ];
+      }
+      _n += n;
+      _value = out [ n - 1 ];
+    }
+    int sections () { return _nSections; }
+    unsigned long count () { return _n; }
+    T value () { return _value; }
+
+  private:
+    int clampOrder ( int order ) {
+      if ( order > 2 * maxSections ) order = 2 * maxSections;
+      return order < 1 ? 1 : order;
+    }
+    BiquadSection<T> _sections [ maxSections ];
+    int _nSections;
+    unsigned long _n;
+    T _value;
+};
+
+#endif
@@ -11,6 +11,16 @@
 
 //    NOTE: the use of this-> is optional
 
+double EWMA_cutoff_alpha ( double cutoff, double F_sampling ) {
+  // -3dB cutoff frequency
+  double omega3db = 2.0 * M_PI * cutoff / F_sampling;
+  // double k = 2.0 * ( 1 - cos ( 2.0 * M_PI * cutoff / F_sampling ) )
+  // math cos expects radians
+  double k = 2.0 * ( 1.0 - cos ( omega3db ) );
+  // alpha = cos(omega3db) - 1 + sqrt(cos(omega3db)^2 - 4*cos(omega3db) + 3)
+  return ( ( -k + sqrt ( k*k + 4.0 * k ) ) / 2.0 );
+}
+
 double EWMA::periods (int nPeriodsOfHalfLife) {
   // deprecated
   return (alpha (nPeriodsOfHalfLife));
@@ -71,6 +81,25 @@ double EWMA::record(double x) {
 	return (this->_value);
 }
 
+void EWMA::record ( const double * in, double * out, size_t n ) {
+  // same arithmetic as record ( x ), with the state held in locals
+  size_t first = 0;
+  if ( n > 0 && this->_n == 0 ) {
+    // the first sample loads the average
+    out [ 0 ] = record ( in [ 0 ] );
+    first = 1;
+  }
+  double a = this->_alpha;
+  double b = 1.0 - a;
+  double v = this->_value;
+  for ( size_t i = first; i < n; i++ ) {
+    v = v * b + in [ i ] * a;
+    out [ i ] = v;
+  }
+  this->_value = v;
+  this->_n += n - first;
+}
+
 double *EWMA::_internals() {
 	static double ret[2];
 	ret[0] = this->_n;
@@ -124,13 +153,7 @@ void LPF::reset () {
 }
     
 void LPF::init ( double cutoff, double F_sampling ) {
-  // -3dB cutoff frequency
-  double omega3db = 2.0 * M_PI * cutoff / F_sampling;
-  // double k = 2.0 * ( 1 - cos ( 2.0 * M_PI * cutoff / F_sampling ) )
-  // math cos expects radians
-  double k = 2.0 * ( 1.0 - cos ( omega3db ) );
-  // alpha = cos(omega3db) - 1 + sqrt(cos(omega3db)^2 - 4*cos(omega3db) + 3)
-  this->_ewma.setAlpha ( ( -k + sqrt ( k*k + 4.0 * k ) ) / 2.0 );
+  this->_ewma.setAlpha ( EWMA_cutoff_alpha ( cutoff, F_sampling ) );
   this->reset ();
 }
   
@@ -140,6 +163,13 @@ void LPF::record ( double x ) {
   this->_value = this->_ewma.value();
 }
 
+void LPF::record ( const double * in, double * out, size_t n ) {
+  if ( n == 0 ) return;
+  this->_ewma.record ( in, out, n );
+  this->_n += n;
+  this->_value = this->_ewma.value();
+}
+
 unsigned long LPF::count() {
 	return (this->_n);
 }
@@ -184,6 +214,34 @@ void HPF::record ( double x ) {
   this->_lpf.record ( x );
   this->_value = x - this->_lpf.value();
 }
+
+void HPF::record ( const double * in, double * out, size_t n ) {
+  if ( n == 0 ) return;
+  // one loop over LPF and subtraction, bypassing LPF::record and EWMA::record
+  EWMA & e = this->_lpf._ewma;
+  size_t first = 0;
+  if ( e._n == 0 ) {
+    // the first sample loads the LPF
+    record ( in [ 0 ] );
+    out [ 0 ] = this->_value;
+    first = 1;
+  }
+  double a = e._alpha;
+  double b = 1.0 - a;
+  double lp = e._value;
+  for ( size_t i = first; i < n; i++ ) {
+    double x = in [ i ];   // out may be in
+    lp = lp * b + x * a;
+    out [ i ] = x - lp;
+  }
+  size_t m = n - first;
+  e._value = lp;
+  e._n += m;
+  this->_lpf._value = lp;
+  this->_lpf._n += m;
+  this->_value = out [ n - 1 ];
+  this->_n += m;
+}
     
 unsigned long HPF::count() {
 	return (this->_n);
@@ -230,6 +288,41 @@ void BPF::record ( double x ) {
   this->_value = this->_hpf.value();
 }
 
+void BPF::record ( const double * in, double * out, size_t n ) {
+  // both EWMAs of the cascade in one loop:
+  //   hi = EWMA at the high cutoff ( _lpf ), lo = EWMA at the low cutoff
+  //   of the HPF's LPF, y = hi - lo
+  if ( n == 0 ) return;
+  EWMA & eHi = this->_lpf._ewma;
+  EWMA & eLo = this->_hpf._lpf._ewma;
+  size_t first = 0;
+  if ( eHi._n == 0 || eLo._n == 0 ) {
+    record ( in [ 0 ] );
+    out [ 0 ] = this->_value;
+    first = 1;
+  }
+  double aHi = eHi._alpha, bHi = 1.0 - aHi, hi = eHi._value;
+  double aLo = eLo._alpha, bLo = 1.0 - aLo, lo = eLo._value;
+  for ( size_t i = first; i < n; i++ ) {
+    hi = hi * bHi + in [ i ] * aHi;
+    lo = lo * bLo + hi * aLo;
+    out [ i ] = hi - lo;
+  }
+  size_t m = n - first;
+  eHi._value = hi;
+  eHi._n += m;
+  this->_lpf._value = hi;
+  this->_lpf._n += m;
+  eLo._value = lo;
+  eLo._n += m;
+  this->_hpf._lpf._value = lo;
+  this->_hpf._lpf._n += m;
+  this->_hpf._value = out [ n - 1 ];
+  this->_hpf._n += m;
+  this->_value = out [ n - 1 ];
+  this->_n += m;
+}
+
 unsigned long BPF::count() {
 	return (this->_n);
 }
@@ -65,6 +65,16 @@ According to the StackExchange article, the -3dB corner of this filter is
 		z = myEWMA.value();
 		myEWMA.results(results);
 		
+		// a block at a time; out may be the same buffer as in
+		BPF band ( 0.01, 40.0, 62.0 );
+		double buf [ 64 ];
+		band.record ( buf, buf, 64 );
+		
+	The block record of each filter gives the same results as calling record
+	on each sample in turn, but runs the whole cascade in one loop with the
+	filter state held in locals rather than going through a chain of calls
+	per sample.
+		
 		
 		
 		
@@ -84,10 +94,17 @@ According to the StackExchange article, the -3dB corner of this filter is
 #ifndef EWMA_h
 #define EWMA_h
 
-#define EWMA_VERSION "1.004.000"
+#define EWMA_VERSION "1.006.000"
 // 2023-05-30 1.002.001 added getter "count"
 // 2024-04-01 1.003.000 added calculation of alpha given 3dB corner frequency
 // 2024-04-07 1.004.000 GOING TO add LPF, HPF, BPF
+// 2026-10-17 1.005.000 added EWMA_cutoff_alpha; templated filters in EWMA_T.h
+// 2026-10-17 1.006.000 added block record ( in, out, n ) to all filters
+
+#include <stddef.h>
+
+// alpha for an EWMA whose -3dB corner is at cutoff ( see above )
+double EWMA_cutoff_alpha ( double cutoff, double F_sampling );
 
 class EWMA
 {
@@ -99,6 +116,7 @@ class EWMA
 		void load ( unsigned long n, double EWMA );
 		// void record( double x );
 		double record ( double x );
+		void record ( const double * in, double * out, size_t n );
 		unsigned long count ();
     double value ();
 		//double *results ();
@@ -124,6 +142,10 @@ class EWMA
     
 		double *_internals();
 		
+		// the block records run the cascade on the members directly
+		friend class HPF;
+		friend class BPF;
+		
 };
 
 class LPF
@@ -134,6 +156,7 @@ class LPF
     void init ( double cutoff, double F_sampling );
     void reset ();
     void record ( double x );
+    void record ( const double * in, double * out, size_t n );
 		unsigned long count ();
     double value ();
   protected:
@@ -142,6 +165,8 @@ class LPF
     unsigned long _n;
     double _value;
     EWMA _ewma;
+    friend class HPF;
+    friend class BPF;
 };
 
 class HPF
@@ -152,6 +177,7 @@ class HPF
     void init ( double cutoff, double F_sampling );
     void reset ();
     void record ( double x );
+    void record ( const double * in, double * out, size_t n );
 		unsigned long count ();
     double value ();
   protected:
@@ -160,6 +186,7 @@ class HPF
     unsigned long _n;
     double _value;
     LPF _lpf;
+    friend class BPF;
 };
 
 class BPF
@@ -170,6 +197,7 @@ class BPF
     void init ( double low_cutoff, double high_cutoff, double F_sampling );
     void reset ();
     void record ( double x );
+    void record ( const double * in, double * out, size_t n );
 		unsigned long count ();
     double value ();
   protected:
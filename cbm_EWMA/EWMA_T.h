@@ -0,0 +1,333 @@
+/*
+	EWMA_T.h - templated EWMA, LPF, HPF, and BPF filters, parameterized on
+	  the sample type, so that a filter stage can run in integer arithmetic
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	The classes in EWMA.h do everything in double, which is software floating
+	point on the AVR and ESP8266 and costs far more per sample than the
+	arithmetic warrants. These do the same filtering with the sample type of
+	your choice:
+
+	  EWMA_T<int16_t>   also Q15  ( q15_t ), e.g. raw ADC or accelerometer counts
+	  EWMA_T<int32_t>   also Q31  ( q31_t )
+	  EWMA_T<float>
+	  EWMA_T<double>    identical to EWMA
+
+	The filter is linear, so a Q15 signal and an int16 signal are filtered by
+	exactly the same code; q15_t and q31_t are just names for the reader.
+
+	How it works
+	  As in EWMA, E(t) = E(t-1) + alpha * ( x - E(t-1) ).
+	  alpha is converted once, in init / setAlpha, into the coefficient type:
+	    int16_t: Q15 ( alpha * 32768 ), state int32_t carrying 15 fraction bits
+	    int32_t: Q24 ( alpha * 2^24 ),  state int64_t carrying 24 fraction bits
+	    float, double: alpha itself
+	  A record() is then a subtract, a rounding shift, one multiply, and an add.
+	  The extra fraction bits in the state are what keep an integer EWMA from
+	  stalling short of its input when alpha * ( x - E ) is less than one count.
+
+	Tolerance, relative to the double-precision EWMA given the same input:
+	  float:   about 1e-6 of the signal magnitude
+	  int16_t: within +/- 1 count when alpha is exactly representable in Q15
+	  int32_t: within +/- 1 count when alpha is exactly representable in Q24
+	Otherwise the error is dominated by alpha being rounded to the coefficient
+	grid: with a half-life of 200 periods ( alpha ~ 0.0035, held to ~0.3% in
+	Q15 ) an int16 EWMA tracks the double one to within 2 or 3 counts on a
+	signal of +/- 10000 counts. The smallest int16 alpha is 1/32768. The
+	quantized alpha actually in use is returned by setAlpha, so compare
+	against a double EWMA built with that value if you need to.
+
+	HPF_T and BPF_T on integer types: x - LPF can exceed the range of T when
+	the input swings full-scale; the result is saturated rather than wrapped.
+	Leave a bit of headroom if that matters.
+
+	Synopsis
+	  #include <EWMA_T.h>
+	  EWMA_T<int16_t> smooth;
+	  smooth.setAlpha ( smooth.alpha ( 200 ) );   // 200 periods of half-life
+	  int16_t y = smooth.record ( analogRead ( A0 ) );
+
+	  BPF_T<float> band ( 0.01, 40.0, 62.0 );     // low, high, F_sampling
+	  band.record ( totalEnergy );
+	  float v = band.value ();
+
+	  int16_t block [ 32 ];                       // a block at a time, in place
+	  smooth.record ( block, block, 32 );
+
+	As in EWMA.h, the block record ( in, out, n ) of each filter gives the same
+	results as n single records, with the cascade in one loop and its state in
+	locals; out may be the same buffer as in.
+
+	See the note in cbmCircularBuffer.h on why a template lives entirely in
+	its header file.
+*/
+
+#ifndef EWMA_T_h
+#define EWMA_T_h
+
+#include <stdint.h>
+#include <math.h>
+#include "EWMA.h"
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+//******************************************************************************
+// per-type arithmetic
+//******************************************************************************
+
+template <typename T>
+struct EWMA_traits {
+  // float and double
+  typedef T state_t;
+  typedef T coef_t;
+  static coef_t coef ( double alpha ) { return ( coef_t ) alpha; }
+  static double alpha ( coef_t a ) { return a; }
+  static state_t load ( T x ) { return x; }
+  static T value ( state_t y ) { return y; }
+  static state_t step ( state_t y, T x, coef_t a ) { return y + a * ( x - y ); }
+  static T difference ( T x, T y ) { return x - y; }
+};
+
+template <>
+struct EWMA_traits<int16_t> {
+  typedef int32_t state_t;
+  typedef int16_t coef_t;
+  static const int fracBits = 15;
+  static coef_t coef ( double alpha ) {
+    long a = lround ( alpha * ( 1L << fracBits ) );
+    if ( a < 1 ) a = 1;
+    if ( a > ( 1L << fracBits ) - 1 ) a = ( 1L << fracBits ) - 1;
+    return ( coef_t ) a;
+  }
+  static double alpha ( coef_t a ) { return ( double ) a / ( 1L << fracBits ); }
+  static state_t load ( int16_t x ) { return ( state_t ) x << fracBits; }
+  static int16_t value ( state_t y ) {
+    return ( int16_t ) ( ( y + ( 1L << ( fracBits - 1 ) ) ) >> fracBits );
+  }
+  static state_t step ( state_t y, int16_t x, coef_t a ) {
+    // error in whole counts, rounded; |e| < 2^16 so e * a < 2^31
+    int32_t e = ( ( ( state_t ) x << fracBits ) - y + ( 1L << ( fracBits - 1 ) ) ) >> fracBits;
+    return y + e * a;
+  }
+  static int16_t difference ( int16_t x, int16_t y ) {
+    int32_t d = ( int32_t ) x - y;
+    if ( d > INT16_MAX ) return INT16_MAX;
+    if ( d < INT16_MIN ) return INT16_MIN;
+    return ( int16_t ) d;
+  }
+};
+
+template <>
+struct EWMA_traits<int32_t> {
+  typedef int64_t state_t;
+  typedef int32_t coef_t;
+  static const int fracBits = 24;
+  static coef_t coef ( double alpha ) {
+    long long a = llround ( alpha * ( 1LL << fracBits ) );
+    if ( a < 1 ) a = 1;
+    if ( a > ( 1LL << fracBits ) - 1 ) a = ( 1LL << fracBits ) - 1;
+    return ( coef_t ) a;
+  }
+  static double alpha ( coef_t a ) { return ( double ) a / ( 1LL << fracBits ); }
+  static state_t load ( int32_t x ) { return ( state_t ) x << fracBits; }
+  static int32_t value ( state_t y ) {
+    return ( int32_t ) ( ( y + ( 1LL << ( fracBits - 1 ) ) ) >> fracBits );
+  }
+  static state_t step ( state_t y, int32_t x, coef_t a ) {
+    // |e| < 2^33 and a < 2^24, so e * a < 2^57
+    int64_t e = ( ( ( state_t ) x << fracBits ) - y + ( 1LL << ( fracBits - 1 ) ) ) >> fracBits;
+    return y + e * a;
+  }
+  static int32_t difference ( int32_t x, int32_t y ) {
+    int64_t d = ( int64_t ) x - y;
+    if ( d > INT32_MAX ) return INT32_MAX;
+    if ( d < INT32_MIN ) return INT32_MIN;
+    return ( int32_t ) d;
+  }
+};
+
+//******************************************************************************
+// EWMA_T
+//******************************************************************************
+
+template <typename T>
+class EWMA_T
+{
+  public:
+    typedef EWMA_traits<T> traits;
+    typedef typename traits::state_t state_t;
+    typedef typename traits::coef_t coef_t;
+
+    EWMA_T () { _a = traits::coef ( 0.5 ); reset (); }
+    EWMA_T ( double alpha ) { init ( alpha ); }
+    void init ( double alpha ) { _a = traits::coef ( alpha ); reset (); }
+    // returns the alpha actually in effect, after quantization
+    double setAlpha ( double alpha ) {
+      if ( alpha > 0.0 && alpha < 1.0 ) _a = traits::coef ( alpha );
+      return traits::alpha ( _a );
+    }
+    void reset () { load ( 0, 0 ); }
+    void load ( unsigned long n, T value ) { _n = n; _y = traits::load ( value ); }
+    T record ( T x ) {
+      _y = ( _n == 0 ) ? traits::load ( x ) : traits::step ( _y, x, _a );
+      _n++;
+      return traits::value ( _y );
+    }
+    void record ( const T * in, T * out, size_t n ) {
+      size_t first = 0;
+      if ( n > 0 && _n == 0 ) {
+        out [ 0 ] = record ( in [ 0 ] );
+        first = 1;
+      }
+      coef_t a = _a;
+      state_t y = _y;
+      for ( size_t i = first; i < n; i++ ) {
+        y = traits::step ( y, in [ i ], a );
+        out [ i ] = traits::value ( y );
+      }
+      _y = y;
+      _n += n - first;
+    }
+    unsigned long count () { return _n; }
+    T value () { return traits::value ( _y ); }
+    // the same half-life formula as EWMA::alpha
+    static double alpha ( unsigned long nPeriodsOfHalfLife ) {
+      return ( 1 - exp ( log ( 0.5 ) / nPeriodsOfHalfLife ) );
+    }
+
+  private:
+    coef_t _a;
+    state_t _y;
+    unsigned long _n;
+    template <typename U> friend class HPF_T;
+    template <typename U> friend class BPF_T;
+};
+
+//******************************************************************************
+// LPF_T - EWMA with alpha given by the -3dB corner ( see EWMA.h )
+//******************************************************************************
+
+template <typename T>
+class LPF_T
+{
+  public:
+    LPF_T () {}
+    LPF_T ( double cutoff, double F_sampling ) { init ( cutoff, F_sampling ); }
+    void init ( double cutoff, double F_sampling ) {
+      _ewma.init ( EWMA_cutoff_alpha ( cutoff, F_sampling ) );
+    }
+    void reset () { _ewma.reset (); }
+    void record ( T x ) { _ewma.record ( x ); }
+    void record ( const T * in, T * out, size_t n ) { _ewma.record ( in, out, n ); }
+    unsigned long count () { return _ewma.count (); }
+    T value () { return _ewma.value (); }
+  private:
+    EWMA_T<T> _ewma;
+    template <typename U> friend class HPF_T;
+    template <typename U> friend class BPF_T;
+};
+
+//******************************************************************************
+// HPF_T - the signal less its LPF
+//******************************************************************************
+
+template <typename T>
+class HPF_T
+{
+  public:
+    HPF_T () { _value = 0; }
+    HPF_T ( double cutoff, double F_sampling ) { init ( cutoff, F_sampling ); }
+    void init ( double cutoff, double F_sampling ) {
+      _lpf.init ( cutoff, F_sampling );
+      reset ();
+    }
+    void reset () { _lpf.reset (); _value = 0; }
+    void record ( T x ) {
+      _lpf.record ( x );
+      _value = EWMA_traits<T>::difference ( x, _lpf.value () );
+    }
+    void record ( const T * in, T * out, size_t n ) {
+      typedef EWMA_traits<T> traits;
+      if ( n == 0 ) return;
+      EWMA_T<T> & e = _lpf._ewma;
+      size_t first = 0;
+      if ( e._n == 0 ) {
+        record ( in [ 0 ] );
+        out [ 0 ] = _value;
+        first = 1;
+      }
+      typename traits::coef_t a = e._a;
+      typename traits::state_t y = e._y;
+      for ( size_t i = first; i < n; i++ ) {
+        T x = in [ i ];   // out may be in
+        y = traits::step ( y, x, a );
+        out [ i ] = traits::difference ( x, traits::value ( y ) );
+      }
+      e._y = y;
+      e._n += n - first;
+      _value = out [ n - 1 ];
+    }
+    unsigned long count () { return _lpf.count (); }
+    T value () { return _value; }
+  private:
+    T _value;
+    LPF_T<T> _lpf;
+    template <typename U> friend class BPF_T;
+};
+
+//******************************************************************************
+// BPF_T - LPF at the high cutoff feeding an HPF at the low cutoff
+//******************************************************************************
+
+template <typename T>
+class BPF_T
+{
+  public:
+    BPF_T () {}
+    BPF_T ( double low_cutoff, double high_cutoff, double F_sampling ) {
+      init ( low_cutoff, high_cutoff, F_sampling );
+    }
+    void init ( double low_cutoff, double high_cutoff, double F_sampling ) {
+      _hpf.init ( low_cutoff, F_sampling );
+      _lpf.init ( high_cutoff, F_sampling );
+    }
+    void reset () { _hpf.reset (); _lpf.reset (); }
+    void record ( T x ) {
+      _lpf.record ( x );
+      _hpf.record ( _lpf.value () );
+    }
+    void record ( const T * in, T * out, size_t n ) {
+      typedef EWMA_traits<T> traits;
+      if ( n == 0 ) return;
+      EWMA_T<T> & eHi = _lpf._ewma;
+      EWMA_T<T> & eLo = _hpf._lpf._ewma;
+      size_t first = 0;
+      if ( eHi._n == 0 || eLo._n == 0 ) {
+        record ( in [ 0 ] );
+        out [ 0 ] = value ();
+        first = 1;
+      }
+      typename traits::coef_t aHi = eHi._a, aLo = eLo._a;
+      typename traits::state_t hi = eHi._y, lo = eLo._y;
+      for ( size_t i = first; i < n; i++ ) {
+        hi = traits::step ( hi, in [ i ], aHi );
+        T h = traits::value ( hi );
+        lo = traits::step ( lo, h, aLo );
+        out [ i ] = traits::difference ( h, traits::value ( lo ) );
+      }
+      eHi._y = hi;
+      eHi._n += n - first;
+      eLo._y = lo;
+      eLo._n += n - first;
+      _hpf._value = out [ n - 1 ];
+    }
+    unsigned long count () { return _lpf.count (); }
+    T value () { return _hpf.value (); }
+  private:
+    LPF_T<T> _lpf;
+    HPF_T<T> _hpf;
+};
+
+#endif
@@ -15,7 +15,25 @@
 #ifndef LSM303DLH_h
 #define LSM303DLH_h
 
-#define LSM303DLH_VERSION "1.002.000"
+#define LSM303DLH_VERSION "1.003.000"
+// 2026-10-17 1.003.000 burst reads; raw counts; output data rate; data-ready
+//                      status and interrupt; block data update
+
+/*
+	Each getAccel or getMag used to be six I2C transactions, one per register.
+	Now all six bytes come in one auto-increment burst, several times less
+	bus time per sample; with Wire.setClock ( 400000 ) another factor of four.
+
+	  int16_t raw [ 3 ];
+	  if ( compass.getAccelRaw ( raw ) ) ...     // counts; * accelScale () for getAccel's units
+	  compass.setDataRate ( 400 );               // 50 ( as init leaves it ), 100, 400, 1000 Hz
+	  compass.setDataReadyInterrupt ( true );    // INT1 goes high with each new sample
+	  if ( compass.accelReady ( &overrun ) ) ...  // or poll for it
+
+	The LSM303DLH has no FIFO ( the LSM303DLHC and LSM303D do ): to stream
+	at the output data rate, read once per data-ready, e.g. from the pin's
+	interrupt, and let accelReady's overrun flag say if one was missed.
+*/
 
 #include <Arduino.h>
 #include <Wire.h>
@@ -35,6 +53,15 @@ class LSM303DLH {
         
     void getAccel ( float * _acceleration_vector_components_g );
     void getMag ( float * _magnetic_field_components_gauss );
+    // raw counts, X, Y, Z, in one burst transaction; false ( and zeros ) if the bus failed
+    bool getAccelRaw ( int16_t * xyz );
+    bool getMagRaw ( int16_t * xyz );
+    float accelScale ();     // getAccel's units per raw count
+
+    bool setDataRate ( int rate_Hz );   // 50, 100, 400, or 1000; false otherwise
+    int dataRate ();
+    bool accelReady ( bool * overrun = NULL );
+    void setDataReadyInterrupt ( bool enable );
 
     float getHeading(float * magValue);
     float getTiltHeading(float * magValue, float * accelValue);
@@ -51,11 +78,13 @@ class LSM303DLH {
     int SA0_bridge_value;
     byte read ( int device_address, byte register_address );
     void write ( byte data, byte device_address, byte register_address );
+    bool readBurst ( byte device_address, byte register_address, byte * buf, byte n );
     
 	private:
 	
 		Print* _printer;
 		byte _acc_scale_bits;
+		byte _odr_bits;
 	  const float _acc_scales [ 4 ] = { 1.0, 2.0, 0.0, 3.9 };
 		float _acceleration_vector_components_g [ 3 ];
 		float _magnetic_field_components_gauss [ 3 ];
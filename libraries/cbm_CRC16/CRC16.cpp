@@ -15,6 +15,15 @@
 */
 #include "CRC16.h"
 
+#if defined ( __AVR__ )
+  #include <avr/pgmspace.h>
+  #define CRC16_FLASH PROGMEM
+  #define CRC16_read_word(addr) pgm_read_word ( addr )
+#else
+  #define CRC16_FLASH
+  #define CRC16_read_word(addr) ( * ( addr ) )
+#endif
+
 static unsigned char auchCRCHi[] = {
 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0, 0x80, 0x41, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81,
 0x40, 0x01, 0xC0, 0x80, 0x41, 0x00, 0xC1, 0x81, 0x40, 0x00, 0xC1, 0x81, 0x40, 0x01, 0xC0,
@@ -62,7 +71,9 @@ CRC::CRC()
 
 }
 
-unsigned short CRC::CRC16 ( unsigned char * puchMsg, unsigned short usDataLen )
+// the original: the two bytes of the CRC kept separately, each with its own table
+
+unsigned short CRC::CRC16_TwoTable ( unsigned char * puchMsg, unsigned short usDataLen )
 {
 unsigned char uchCRCHi = 0xff;
 unsigned char uchCRCLo = 0xff;
@@ -75,4 +86,133 @@ while(usDataLen--)
   
 }
 return (uchCRCHi << 8 | uchCRCLo);
-}
\ No newline at end of file
+}
+
+// the same tables as one of words: the reflected polynomial 0xA001 applied to each byte
+
+static const unsigned short crcTable [ 256 ] CRC16_FLASH = {
+  0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+  0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+  0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+  0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+  0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+  0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+  0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+  0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+  0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+  0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+  0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+  0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+  0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+  0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+  0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+  0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+  0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+  0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+  0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+  0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+  0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+  0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+  0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+  0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+  0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+  0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+  0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+  0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+  0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+  0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+  0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+  0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+unsigned short CRC::CRC16 ( unsigned char * puchMsg, unsigned short usDataLen )
+{
+  return ( CRC16_Table ( puchMsg, usDataLen ) );
+}
+
+unsigned short CRC::Update ( unsigned short crc, unsigned char c )
+{
+  return ( ( crc >> 8 ) ^ CRC16_read_word ( &crcTable [ ( crc ^ c ) & 0xff ] ) );
+}
+
+unsigned short CRC::CRC16_Table ( unsigned char * puchMsg, unsigned short usDataLen )
+{
+  unsigned short crc = CRC16_INIT;
+  while ( usDataLen-- ) {
+    crc = ( crc >> 8 ) ^ CRC16_read_word ( &crcTable [ ( crc ^ *puchMsg++ ) & 0xff ] );
+  }
+  return ( crc );
+}
+
+// four bits at a time: the polynomial applied to each nibble
+
+static const unsigned short crcNibble [ 16 ] = {
+  0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+  0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+unsigned short CRC::CRC16_Nibble ( unsigned char * puchMsg, unsigned short usDataLen )
+{
+  unsigned short crc = CRC16_INIT;
+  while ( usDataLen-- ) {
+    unsigned char c = *puchMsg++;
+    crc = ( crc >> 4 ) ^ crcNibble [ ( crc ^ c ) & 0x0f ];
+    crc = ( crc >> 4 ) ^ crcNibble [ ( crc ^ ( c >> 4 ) ) & 0x0f ];
+  }
+  return ( crc );
+}
+
+#if ! defined ( __AVR__ )
+
+// several bytes at a time: table k is the effect of a byte followed by k zero bytes,
+// so the CRC of n bytes is the sum of n lookups, one in each table. Only the first two
+// bytes of each step meet the CRC so far.
+
+static void fillSlices ( unsigned short ( * t ) [ 256 ], int n )
+{
+  for ( int i = 0; i < 256; i++ ) t [ 0 ] [ i ] = crcTable [ i ];
+  for ( int k = 1; k < n; k++ ) {
+    for ( int i = 0; i < 256; i++ ) {
+      unsigned short prev = t [ k - 1 ] [ i ];
+      t [ k ] [ i ] = ( prev >> 8 ) ^ crcTable [ prev & 0xff ];
+    }
+  }
+}
+
+unsigned short CRC::CRC16_Slice4 ( unsigned char * puchMsg, unsigned short usDataLen )
+{
+  static unsigned short t [ 4 ] [ 256 ];
+  static bool filled = false;
+  if ( ! filled ) { fillSlices ( t, 4 ); filled = true; }
+  
+  unsigned short crc = CRC16_INIT;
+  while ( usDataLen >= 4 ) {
+    crc = t [ 3 ] [ ( crc ^ puchMsg [ 0 ] ) & 0xff ] ^ t [ 2 ] [ ( ( crc >> 8 ) ^ puchMsg [ 1 ] ) & 0xff ]
+        ^ t [ 1 ] [ puchMsg [ 2 ] ] ^ t [ 0 ] [ puchMsg [ 3 ] ];
+    puchMsg += 4;
+    usDataLen -= 4;
+  }
+  while ( usDataLen-- ) crc = ( crc >> 8 ) ^ t [ 0 ] [ ( crc ^ *puchMsg++ ) & 0xff ];
+  return ( crc );
+}
+
+unsigned short CRC::CRC16_Slice8 ( unsigned char * puchMsg, unsigned short usDataLen )
+{
+  static unsigned short t [ 8 ] [ 256 ];
+  static bool filled = false;
+  if ( ! filled ) { fillSlices ( t, 8 ); filled = true; }
+  
+  unsigned short crc = CRC16_INIT;
+  while ( usDataLen >= 8 ) {
+    crc = t [ 7 ] [ ( crc ^ puchMsg [ 0 ] ) & 0xff ] ^ t [ 6 ] [ ( ( crc >> 8 ) ^ puchMsg [ 1 ] ) & 0xff ]
+        ^ t [ 5 ] [ puchMsg [ 2 ] ] ^ t [ 4 ] [ puchMsg [ 3 ] ]
+        ^ t [ 3 ] [ puchMsg [ 4 ] ] ^ t [ 2 ] [ puchMsg [ 5 ] ]
+        ^ t [ 1 ] [ puchMsg [ 6 ] ] ^ t [ 0 ] [ puchMsg [ 7 ] ];
+    puchMsg += 8;
+    usDataLen -= 8;
+  }
+  while ( usDataLen-- ) crc = ( crc >> 8 ) ^ t [ 0 ] [ ( crc ^ *puchMsg++ ) & 0xff ];
+  return ( crc );
+}
+
+#endif
@@ -14,12 +14,51 @@
 	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
 */
 
+/*
+	The same MODBUS CRC, several ways, by what they cost:
+	
+	  method           tables                 where
+	  CRC16_TwoTable   2 x 256 bytes          RAM ( the original )
+	  CRC16_Table      256 words              flash on the AVR, else RAM
+	  CRC16_Nibble     16 words ( 32 bytes )  RAM
+	  CRC16_Slice4     4 x 256 words          RAM, built on first use; not on the AVR
+	  CRC16_Slice8     8 x 256 words          RAM, built on first use; not on the AVR
+	
+	CRC16 is CRC16_Table. A table that is never called for is dropped by the
+	linker. The slices take 4 or 8 bytes per step, which pays on 32-bit
+	processors for frames longer than a few dozen bytes.
+	
+	Update takes one character at a time, so that a receiver can keep the CRC
+	as characters arrive: start from CRC16_INIT. Over a whole frame, including
+	the CRC at its end ( low byte first, as MODBUS sends it ), the result is 0.
+	
+	  unsigned short crc = CRC16_INIT;
+	  ... crc = CRC::Update ( crc, c ); ...
+	  if ( crc == 0 ) ... the frame is good ...
+*/
+
 #ifndef CRC16_h
 #define CRC16_h
+
+#define CRC16_version 2.0.0
+// 2026-10-17 2.0.0 the table in flash on the AVR; nibble and slice-by-4 and -8 variants; Update
+
+#define CRC16_INIT 0xFFFF
+
 class CRC
 {
 	public:
 		CRC();
-		unsigned short CRC16 ( unsigned char * puchMsg, unsigned short usDataLen );
+		static unsigned short CRC16 ( unsigned char * puchMsg, unsigned short usDataLen );
+		
+		static unsigned short CRC16_TwoTable ( unsigned char * puchMsg, unsigned short usDataLen );
+		static unsigned short CRC16_Table ( unsigned char * puchMsg, unsigned short usDataLen );
+		static unsigned short CRC16_Nibble ( unsigned char * puchMsg, unsigned short usDataLen );
+		#if ! defined ( __AVR__ )
+		static unsigned short CRC16_Slice4 ( unsigned char * puchMsg, unsigned short usDataLen );
+		static unsigned short CRC16_Slice8 ( unsigned char * puchMsg, unsigned short usDataLen );
+		#endif
+		
+		static unsigned short Update ( unsigned short crc, unsigned char c );
 };
 #endif
\ No newline at end of file
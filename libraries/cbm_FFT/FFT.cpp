@@ -1,6 +1,7 @@
 // FFT.c
 
 #include <FFT.h>
+#include <FFT_T.h>
 
 // log2 FFT_SIZE   
 #define LOG2_N          6
@@ -129,12 +130,29 @@ uint8_t FFT_print_prefiltered = 0;      // Switch "Print Pre-Filter"
 uint8_t FFT_print_filtered = 0;         // Switch "Print Post-Filter"
 uint8_t FFT_play_from_EEPROM = 0;       // Switch "PLAY" from EEPROM
 
+const FFT_Spectrogram FFT_spectrogram ( &spectrogram_array[0][0], TIME_SZ, NBR_FRQ, 1, TIME_SZ );
+FFT_Matcher * FFT_matcher = NULL;
+int8_t * FFT_match_cells = NULL;
+unsigned long FFT_match_budget_us = 2000UL;
+FFT_Match_Result FFT_match = { -1, "", 0.0f, 0, 0, 0 };
+static uint8_t FFT_matching = 0;        // a capture copied to FFT_match_cells, not yet matched
+
 const     int8_t  EE[3][3] = {                        // EDGE ENHANCEMENT HPF MATRIX 3 x 3
                   {-1, -1, -1  },
                   {-1,  8, -1  },
                   {-1, -1, -1  }
                   };
 
+// Timer2 samples into a ring of a frame, 16 ms, which FFTloop drains; the 31 bins into 16 bands,
+// as the edges of FFT_Bands: bins 1 - 5 one to a band, 6 - 14 two ( 6 alone ), 15 - 31 three
+// ( 15 - 16 two )
+static volatile int8_t FFT_ring [ FFT_SIZE ];
+FFT_Timer2_Source FFT_timer2 ( FFT_ring, FFT_SIZE );
+static unsigned long FFT_overruns = 0;  // as FFTloop last saw them
+static const uint16_t FFT_edges_31_to_16 [ NBR_FRQ + 1 ] = { 1, 2, 3, 4, 5, 6, 7, 9, 11, 13, 15, 17, 20, 23, 26, 29, 32 };
+static uint16_t FFT_edges [ NBR_FRQ + 1 ];
+static FFT_Bands FFT_bands ( FFT_edges, NBR_FRQ );
+
 volatile uint8_t capture = 0;         // Flag "capture in progress"
 volatile uint8_t process = 0;         // Flag "new samples ready"
 volatile uint8_t n_sampl = 0;         // Sampling counter
@@ -150,17 +168,30 @@ long    cross_s = 0;          				// Cross-Correlation Factor Stored
  
 // ************************
                
-void FFTsetup() {
+// ************************
+
+FFT_Timer2_Source * FFT_Timer2_Source::_active = NULL;
+
+FFT_Timer2_Source::FFT_Timer2_Source ( volatile int8_t * ring, uint8_t size ) {
+  _ring = ring;
+  _size = size;
+  _head = _tail = 0;
+  _overruns = 0;
+  _reload = TIMER2;
+}
+
+void FFT_Timer2_Source::Begin ( uint8_t reload ) {
+  _reload = reload;
+  _active = this;
+
   TCCR2A &= ~((1<<WGM21) | (1<<WGM20));
   TCCR2B &= ~(1<<WGM22);
   ASSR   &= ~(1<<AS2);
   TIMSK2  = 0;
-  TIMSK0  = 0;
-  TIMSK1  = 0;
-  
+
   TCCR2B |= ((1<<CS21) | (1<<CS20));
   TCCR2B &= ~(1<<CS22) ;                         // prescaler = 32, tick = 2 microsec.
-  TCNT2   = TIMER2; 
+  TCNT2   = reload;
   TIMSK2 |= (1<<TOIE2);
 
   ADCSRA  = 0x87;
@@ -168,6 +199,50 @@ void FFTsetup() {
   ADCSRA |= (1<<ADSC);
 }
 
+void FFT_Timer2_Source::End () {
+  TIMSK2 &= ~(1<<TOIE2);
+}
+
+// q in Q15; kept as ( ADC - 512 ) / 2, clipped
+void FFT_Timer2_Source::_Sample ( int16_t q ) {
+  if ( ( uint8_t ) ( _head - _tail ) >= _size ) {
+    _overruns++;
+    return;
+  }
+  q >>= 7;
+  if ( q >  127 ) q =  127;
+  if ( q < -128 ) q = -128;
+  _ring [ _head & ( _size - 1 ) ] = q;
+  _head++;
+}
+
+// one reader, one writer, and 8-bit indices, so no need to hold off the interrupt
+uint16_t FFT_Timer2_Source::Read ( int16_t * x, uint16_t n ) {
+  uint16_t got = 0;
+  while ( ( got < n ) && ( _tail != _head ) ) {
+    x [ got++ ] = ( int16_t ) _ring [ _tail & ( _size - 1 ) ] << 7;
+    _tail++;
+  }
+  return ( got );
+}
+
+// four bytes, which the interrupt may change between two of them
+unsigned long FFT_Timer2_Source::Overruns () {
+  unsigned long a, b;
+  do { a = _overruns; b = _overruns; } while ( a != b );
+  return ( a );
+}
+
+void FFT_Timer2_Source::Flush () {
+  _tail = _head;
+}
+
+// timers 0 and 1 are left running, unlike in 1.003 and before; millis () goes on
+void FFTsetup() {
+  FFT_bands.Set ( FFT_edges_31_to_16 );
+  FFT_timer2.Begin ( TIMER2 );
+}
+
 void FFT_print_spg1() {
   for ( int strok = 0; strok < TIME_SZ; strok++ ) {
     for ( int stolb = 0; stolb < NBR_FRQ; stolb++ ) {
@@ -197,40 +272,69 @@ void FFT_print_spg2() {
 }
 
 void FFTloop() {
+  // the samples since the last time, at the int8_t scale of 1.003, ( ADC - 512 ) / 2;
+  // VOX: capture starts on the first loud one, and never reads past the frame
+  while ( ! process ) {
+    // samples dropped ( a stall longer than the ring, printing, say ) are a gap somewhere in the
+    // ring or the frame so far: both go, and the frame starts over on what comes after
+    unsigned long overruns = FFT_timer2.Overruns ();
+    if ( overruns != FFT_overruns ) {
+      FFT_overruns = overruns;
+      FFT_timer2.Flush ();
+      n_sampl = 0;
+    }
+    int16_t q [ 8 ];
+    uint16_t want = ( capture && ( FFT_SIZE - n_sampl < 8 ) ) ? FFT_SIZE - n_sampl : 8;
+    uint16_t got = FFT_timer2.Read ( q, want );
+    if ( got == 0 ) break;
+    for ( uint16_t i = 0; i < got; i++ ) {
+      int16_t temp = q [ i ] >> 7;
+      if ( ( abs ( temp ) > trigger ) && ( ! capture ) ) {
+        capture = 1;
+        n_sampl = 0;
+        // *outs[pdCAPTURING] |= bits[pdCAPTURING]; // digitalWrite( 13, HIGH );
+      }
+      if ( capture ) {
+        if ( temp >  127 ) temp =  127;     // CLIPPING
+        if ( temp < -128 ) temp = -128;
+        FFT_array_time[n_sampl] = temp;
+        n_sampl++;
+      }
+    }
+    if ( n_sampl >= FFT_SIZE ) {
+      n_sampl = 0;
+      process = 1;
+    }
+  }
+
   if ( process ) {
     // *outs[pdPROCESSING] |= bits[pdPROCESSING]; // digitalWrite(12, HIGH);
+    // the samples as Q15, in the 128 bytes of FFT_array_freq, and the real FFT of FFT_T.h in place:
+    // block floating point rather than int8_t halved at every stage
+    int16_t * fx = &FFT_array_freq[0].intl;
     for ( int8_t i = 0; i < FFT_SIZE; i++ ) {
-      FFT_array_freq[i].hb[0] = 0;                   // Image -zero.
-      FFT_array_freq[i].hb[1] = FFT_array_time[i];                // Real - data.
-    }    
-    
-    fix_fftr ( FFT_array_freq, FFT_SIZE );
+      fx[i] = ( int16_t ) FFT_array_time[i] << 8;
+    }
+    int fexp = FFT_Real_T<FFT_SIZE, q15_t>::forward ( fx );
+    FFT_Complex<int16_t> * bins = ( FFT_Complex<int16_t> * ) fx;
+
+    //OPTIMIZED: CALCULUS MAGNITUDE FOR HALF BINS ONLY, in place, to 1.22% with no sqrt; then to
+    // the scale of fix_fftr, the DFT of the int8_t samples / 64
+    uint16_t * mag = ( uint16_t * ) fx;
+    int mexp = FFT_Magnitude_Approx ( bins, FFT_SIZE >> 1, fexp, mag ) - 14;
+    for ( int i = 0; i < (FFT_SIZE >> 1); i++) {
+      uint32_t m = FFT_Scale ( mag[i], mexp );
+      mag[i] = m > 127 ? 127 : m;
+    }
 
+  // Non-Linear Compression 31 Bins to 16 Bands (Memory Limits: 16 x 64 = 1 K. ), FFT_edges_31_to_16
+    uint16_t bands [ NBR_FRQ ];
+    FFT_bands.Map ( mag, bands );
     for ( int s = 0; s < NBR_FRQ; s++) {
-      spectrogram_array[s][spectro] = 0;                              // Clear, Allow to use it as accumulator
-    }    
-
-    for ( int i = 0; i < (FFT_SIZE >> 1); i++) {          //OPTIMIZED: CALCULUS MAGNITUDE FOR HALF BINS ONLY
-       FFT_array_freq[i].hb[1] = sqrt(FFT_array_freq[i].hb[1] * FFT_array_freq[i].hb[1] + FFT_array_freq[i].hb[0] * FFT_array_freq[i].hb[0]);
-  //         if ( FFT_array_freq[i].hb[1] > 2 )                        // NOISE CANCELLER
-  //           spectrogram_array[i>>1][spectro] += (FFT_array_freq[i].hb[1]);
+      spectrogram_array[s][spectro] = bands[s] > 127 ? 127 : bands[s];
     }
-
-  // Non-Linear Compression 31 Bins to 16 Bands (Memory Limits: 16 x 64 = 1 K. ).
-  // 0 - 1  1 - 1  2 - 1  3 - 1  4 - 1  5 - 1  
-  //        6 - 2  7 - 2  8 - 2  9 - 2 10 - 2 
-  //       11 - 3 12 - 3 13 - 3 14 - 3 15 - 3            // Total: 31  
-
-    for ( int ps = 1, pt = 0; ps < 32; ps++ ) {           // No DC, start from 1
-      if ( ps > 14 )  {
-        pt = 10 + ((ps - 14)/3);          
-      } else if ( ps > 5 )  {
-          pt = 5 + ((ps - 5)/2);
-      } else {
-        pt = ps -1;
-      }
-  //     if ( FFT_array_freq[ps].hb[1] > 2 )                           // NOISE CANCELLER
-      spectrogram_array[pt][spectro] += (FFT_array_freq[ps].hb[1]);
+    for ( int i = 0; i < (FFT_SIZE >> 1); i++) {
+      FFT_array_freq[i].intl = mag[i] << 8;           // hb[1], as fix_fftr left it
     }
 
     // *outs[pdPROCESSING] &= ~bits[pdPROCESSING]; // digitalWrite(12, LOW);
@@ -245,6 +349,12 @@ void FFTloop() {
     process = 0;
   }
 
+  // the last capture against the templates, FFT_match_budget_us a pass, as one frame is 16 ms
+  if ( FFT_matching && FFT_matcher && FFT_matcher->Run ( FFT_match_budget_us ) ) {
+    FFT_match = FFT_matcher->Best ();
+    FFT_matching = 0;
+  }
+
   if ( fltcorr ) { 
     // *outs[pdFILTERING] |= bits[pdFILTERING]; // digitalWrite(11, HIGH);
 
@@ -320,6 +430,13 @@ void FFTloop() {
           if ( address >= 1024 ) address = 0;  
         }
       }
+      // and against the store's templates, each abandoned once it cannot be the best: a copy, as
+      // the next capture overwrites spectrogram_array, matched a little on each pass from the next
+      if ( FFT_matcher && FFT_match_cells ) {
+        memcpy ( FFT_match_cells, spectrogram_array, sizeof ( spectrogram_array ) );
+        FFT_matcher->Begin ( FFT_Spectrogram ( FFT_match_cells, TIME_SZ, NBR_FRQ, 1, TIME_SZ ) );
+        FFT_matching = 1;
+      }
     }
     // *outs[pdSPECTROGRAM_STORE_COMPARE] &= ~bits[pdSPECTROGRAM_STORE_COMPARE]; // digitalWrite(10, LOW);
     if ( FFT_print_filtered ) {                             //POST-FILTERED SPECTROGRAM
@@ -376,9 +493,10 @@ void FFTloop() {
 
 }
 
-// this is an interrupt service routine. Probably reacts to the completion of an analog read.
+// Timer 2 overflow: the ADC conversion started last time is done ( ADIF ); take it, and start the next
 ISR(TIMER2_OVF_vect) {
-  TCNT2 = TIMER2;               
+  FFT_Timer2_Source * source = FFT_Timer2_Source::_active;
+  TCNT2 = source ? source->_reload : TIMER2;
 
   if (ADCSRA & 0x10) {
 	
@@ -386,25 +504,8 @@ ISR(TIMER2_OVF_vect) {
 		temp = ADCL;
 		temp += (ADCH << 8);
 		temp -= sdvigDC;
-		temp >>= 1;                  // OPA is not rail-to-rail. ~50% Dynamics only
     ADCSRA |= (1<<ADSC);
 
-		// restart capturing
-    if ((abs(temp) > trigger) && (!capture)) {
-      capture = 1;
-      n_sampl = 0;
-      // *outs[pdCAPTURING] |= bits[pdCAPTURING]; // digitalWrite( 13, HIGH );
-    }
-    if ( capture ) {
-      if ( temp >  127 ) temp =  127;     // CLIPPING
-      if ( temp < -128 ) temp = -128;
-      FFT_array_time[n_sampl]  = temp; 
-      n_sampl++;    
-    }
-  }
-  
-  if ( n_sampl >= FFT_SIZE ) {
-    n_sampl = 0;
-    process = 1;
+    if ( source ) source->_Sample ( temp << 6 );      // Q15
   }
 }
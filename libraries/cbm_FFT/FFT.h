@@ -48,9 +48,18 @@ Here are my additional notes:
 
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
+#include <FFT_Pipeline.h>
+#include <FFT_Match.h>
 //#pragma GCC optimize (always_inline)
 
-#define FFT_VERSION "1.002.000"
+#define FFT_VERSION "1.009.000"
+// 2026-10-17 1.003.000 FFTloop transforms with FFT_Real_T ( FFT_T.h ), Q15 in block floating point
+// 2026-10-17 1.004.000 FFTloop on the stages of FFT_Pipeline.h; FFTsetup leaves timers 0 and 1 running
+// 2026-10-17 1.005.000 FFTloop's magnitudes by FFT_Magnitude_Approx, without sqrt
+// 2026-10-17 1.006.000 FFTloop matches against FFT_matcher's templates ( FFT_Match.h ), if set
+// 2026-10-18 1.007.000 Timer2's ring holds a frame; FFTloop starts a frame over when samples were dropped
+// 2026-10-18 1.008.000 Timer2's ring int8_t, as FFTloop takes the samples: its 64 cost 64 bytes of SRAM
+// 2026-10-18 1.009.000 FFTloop matches a copy of the capture, FFT_match_budget_us a pass, not all at once
 
 // 64 : 4 kHz = 16 msec. time sampling period.
 #define FFT_SIZE   	64
@@ -67,6 +76,47 @@ extern uint8_t FFT_print_prefiltered;      // Switch "Print Pre-Filter"
 extern uint8_t FFT_print_filtered;         // Switch "Print Post-Filter"
 extern uint8_t FFT_play_from_EEPROM;       // Switch "PLAY" from EEPROM
 
+// spectrogram_array, frame by frame, as FFT_Match.h takes it; after each capture, if FFT_matcher and
+// FFT_match_cells are set, FFTloop copies it to FFT_match_cells ( TIME_SZ * NBR_FRQ, the caller's )
+// and matches the copy against the matcher's templates, for up to FFT_match_budget_us on each pass
+// ( Run, in FFT_Match.h ); FFT_match is the best of them once all are done. A capture that ends
+// before then starts the matching over on itself
+extern const FFT_Spectrogram FFT_spectrogram;
+extern FFT_Matcher * FFT_matcher;
+extern int8_t * FFT_match_cells;
+extern unsigned long FFT_match_budget_us;
+extern FFT_Match_Result FFT_match;
+
+// Timer 2 overflows every ( 256 - reload ) * 2 us, takes the last conversion of A0 into a ring
+// that the caller owns, and starts the next. It leaves timers 0 and 1 alone, so millis () goes
+// on, but it takes PWM on pins 3 and 11 and tone (), and analogRead () must not be used.
+// The ring holds int8_t, ( ADC - 512 ) / 2 clipped, as FFTloop has always taken the samples,
+// half the SRAM of Q15; Read gives them as Q15, * 128
+class FFT_Timer2_Source : public FFT_Source {
+  public:
+    // size a power of 2, up to 128
+    FFT_Timer2_Source ( volatile int8_t * ring, uint8_t size );
+    void Begin ( uint8_t reload );
+    void End ();
+    virtual uint16_t Read ( int16_t * x, uint16_t n );
+    // samples dropped because the ring was full
+    unsigned long Overruns ();
+    // drops what the ring holds, e.g. the samples before a gap
+    void Flush ();
+    // from the interrupt
+    void _Sample ( int16_t q );
+    static FFT_Timer2_Source * _active;
+    uint8_t _reload;
+
+  private:
+    volatile int8_t * _ring;
+    uint8_t _size;
+    volatile uint8_t _head, _tail;
+    volatile unsigned long _overruns;
+};
+
+extern FFT_Timer2_Source FFT_timer2;    // FFTsetup's
+
 void FFT ( CMPLX * fr, int16_t fft_n );
 int freeRam ();
 void FFTsetup();
@@ -0,0 +1,63 @@
+/*
+	FFT_Kernels.cpp - integer magnitude, square root, log2 and dB
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+*/
+
+#include <FFT_Kernels.h>
+#include <FFT_T.h>
+
+// log2 ( 1 + i / 16 ) in Q15, for i = 0 .. 16; 1 is 32767
+static const int16_t FFT_log2_table [ 17 ] FFT_FLASH = {
+      0,  2866,  5568,  8124, 10549, 12855, 15055, 17156,
+  19168, 21098, 22952, 24736, 26455, 28114, 29717, 31267,
+  32767
+};
+
+// a bit of the root at a time, from the top; what is left of x at the end is x - r^2
+uint16_t FFT_isqrt ( uint32_t x ) {
+  uint32_t r = 0;
+  uint32_t bit = 1UL << 30;
+  while ( bit > x ) bit >>= 2;
+  while ( bit ) {
+    if ( x >= r + bit ) {
+      x -= r + bit;
+      r = ( r >> 1 ) + bit;
+    } else {
+      r >>= 1;
+    }
+    bit >>= 2;
+  }
+  // up if x >= ( r + 1/2 )^2, that is, if what is left is more than r
+  if ( ( x > r ) && ( r < 0xFFFF ) ) r++;
+  return ( ( uint16_t ) r );
+}
+
+int16_t FFT_log2_Q8 ( uint32_t x ) {
+  if ( x == 0 ) return ( FFT_LOG_ZERO );
+  // the leading one to bit 31, a byte at a time where it can be
+  int16_t n = 31;
+  while ( ! ( x & 0xFF000000UL ) ) { x <<= 8; n -= 8; }
+  while ( ! ( x & 0x80000000UL ) ) { x <<= 1; n--; }
+  // the 4 bits after the leading one pick the segment, the next 8 where in it
+  uint8_t i = ( x >> 27 ) & 0x0F;
+  uint8_t f = ( x >> 19 ) & 0xFF;
+  int16_t a = FFT_read_word ( &FFT_log2_table [ i ] );
+  int16_t b = FFT_read_word ( &FFT_log2_table [ i + 1 ] );
+  int32_t frac = a + ( ( ( int32_t ) ( b - a ) * f + 128 ) >> 8 );
+  return ( ( n << 8 ) + ( int16_t ) ( ( frac + 64 ) >> 7 ) );
+}
+
+// log2 in 1/256ths times 10 log10 ( 2 ) * 16 / 256, which is 12330 / 65536
+int16_t FFT_dB_Q4 ( uint32_t p, int exponent ) {
+  if ( p == 0 ) return ( FFT_LOG_ZERO );
+  int32_t l = FFT_log2_Q8 ( p ) + ( int32_t ) exponent * 256;
+  int32_t dB = ( l * 12330L + 32768L ) >> 16;
+  if ( dB > 32767 ) dB = 32767;
+  if ( dB < -32767 ) dB = -32767;
+  return ( ( int16_t ) dB );
+}
+
+void FFT_Power_dB ( const uint32_t * power, uint16_t n, int exponent, int16_t * dB ) {
+  for ( uint16_t k = 0; k < n; k++ ) dB [ k ] = FFT_dB_Q4 ( power [ k ], exponent );
+}
@@ -0,0 +1,74 @@
+/*
+	FFT_Kernels.h - integer magnitude, square root, log2 and dB, for the
+	  post-processing of spectra on 8-bit MCUs
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	The AVR has no floating point: sqrt ( float ) is a few hundred cycles
+	of library code a bin, and log10 more. These are integer, with the
+	error bounds below ( the host benchmark measures them ):
+
+	  FFT_Approx_Magnitude ( re, im )
+	    alpha max plus beta min, in two pieces, the larger of
+	      max + 5/32 min   and   27/32 max + 71/128 min
+	    within +-1.22% of sqrt ( re^2 + im^2 ), and half a count of
+	    rounding ( Q15 ) or three counts of truncation ( Q31 ); shifts and
+	    adds only, no multiplies
+	  FFT_isqrt ( x )
+	    sqrt ( x ) rounded to the nearest integer, exactly: 16 steps of
+	    shifts and subtractions
+	  FFT_log2_Q8 ( x )
+	    log2 ( x ) in 1/256ths: a table of 17 values of log2 ( 1 + i/16 ),
+	    in flash, interpolated; within 0.8 of the last place ( 0.003 )
+	  FFT_dB_Q4 ( p, e )
+	    10 log10 ( p * 2 ^ e ) in 1/16ths of a dB, within 0.05 dB
+
+	Zero has no log: FFT_log2_Q8 and FFT_dB_Q4 give FFT_LOG_ZERO for it,
+	below any other value.
+
+	The block versions of the magnitude, which take the bins out of FFT_T,
+	are with FFT_Power and FFT_Magnitude in FFT_Pipeline.h.
+*/
+
+#ifndef FFT_Kernels_h
+#define FFT_Kernels_h
+
+#define FFT_KERNELS_VERSION "1.000.000"
+// 2026-10-17 1.000.000 created
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#define FFT_LOG_ZERO ( ( int16_t ) -32768 )
+
+// a the larger of | re | and | im |, b the smaller: unsigned, so that -32768 is 32768.
+// In 1/128ths, so that no shift drops a bit, then rounded
+inline uint16_t FFT_Approx_Magnitude ( int16_t re, int16_t im ) {
+  uint32_t a = re < 0 ? ( uint32_t ) ( - ( int32_t ) re ) : ( uint32_t ) re;
+  uint32_t b = im < 0 ? ( uint32_t ) ( - ( int32_t ) im ) : ( uint32_t ) im;
+  if ( a < b ) { uint32_t t = a; a = b; b = t; }
+  uint32_t m0 = ( a << 7 ) + ( b << 4 ) + ( b << 2 );                                // 128 a + 20 b
+  uint32_t m1 = ( a << 7 ) - ( a << 4 ) - ( a << 2 ) + ( b << 6 ) + ( b << 3 ) - b;   // 108 a + 71 b
+  return ( ( uint16_t ) ( ( ( m0 > m1 ? m0 : m1 ) + 64 ) >> 7 ) );
+}
+// as the above, but in place of 1/128ths, the shifts truncate
+inline uint32_t FFT_Approx_Magnitude ( int32_t re, int32_t im ) {
+  uint32_t a = re < 0 ? ( uint32_t ) ( - ( int64_t ) re ) : ( uint32_t ) re;
+  uint32_t b = im < 0 ? ( uint32_t ) ( - ( int64_t ) im ) : ( uint32_t ) im;
+  if ( a < b ) { uint32_t t = a; a = b; b = t; }
+  uint32_t m0 = a + ( b >> 3 ) + ( b >> 5 );
+  uint32_t m1 = a - ( a >> 3 ) - ( a >> 5 ) + ( b >> 1 ) + ( b >> 4 ) - ( b >> 7 );
+  return ( m0 > m1 ? m0 : m1 );
+}
+
+uint16_t FFT_isqrt ( uint32_t x );
+int16_t FFT_log2_Q8 ( uint32_t x );
+int16_t FFT_dB_Q4 ( uint32_t p, int exponent );
+
+// each power [ k ] * 2 ^ exponent in dB, as FFT_dB_Q4; dB may be the powers themselves
+void FFT_Power_dB ( const uint32_t * power, uint16_t n, int exponent, int16_t * dB );
+
+#endif
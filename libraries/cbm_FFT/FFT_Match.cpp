@@ -0,0 +1,240 @@
+/*
+	FFT_Match.cpp - a store of labelled spectrograms, and the matching of a
+	  live spectrogram against them
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+*/
+
+#include <FFT_Match.h>
+
+// ******************************************************************************
+// in flash
+
+FFT_Flash_Store::FFT_Flash_Store ( const FFT_Flash_Template * table, uint8_t count ) {
+  _table = table;
+  _count = count;
+  _cells = NULL;
+  _left = 0;
+}
+
+uint8_t FFT_Flash_Store::Count () {
+  return ( _count );
+}
+
+bool FFT_Flash_Store::Open ( uint8_t i, FFT_Template_Info & info ) {
+  if ( i >= _count ) return ( false );
+  const FFT_Flash_Template * t = _table + i;
+  const char * label = ( const char * ) FFT_read_ptr ( &t->label );
+  uint8_t j = 0;
+  for ( ; j < FFT_LABEL_LEN; j++ ) {
+    info.label [ j ] = ( char ) FFT_read_byte ( label + j );
+    if ( ! info.label [ j ] ) break;
+  }
+  info.label [ j < FFT_LABEL_LEN ? j : FFT_LABEL_LEN ] = '\0';
+  info.frames = ( uint8_t ) FFT_read_byte ( &t->frames );
+  info.bands = ( uint8_t ) FFT_read_byte ( &t->bands );
+  _cells = ( const int8_t * ) FFT_read_ptr ( &t->cells );
+  _left = ( uint16_t ) info.frames * info.bands;
+  info.sum = info.sumSq = 0;
+  for ( uint16_t k = 0; k < _left; k++ ) {
+    int8_t c = FFT_read_byte ( _cells + k );
+    info.sum += c;
+    info.sumSq += ( int16_t ) c * c;
+  }
+  return ( true );
+}
+
+uint16_t FFT_Flash_Store::Read ( int8_t * cells, uint16_t n ) {
+  if ( n > _left ) n = _left;
+  for ( uint16_t k = 0; k < n; k++ ) cells [ k ] = FFT_read_byte ( _cells + k );
+  _cells += n;
+  _left -= n;
+  return ( n );
+}
+
+// ******************************************************************************
+// the matcher
+
+FFT_Matcher::FFT_Matcher ( FFT_Template_Store & store, int8_t * frame, uint32_t * rows ) : _store ( store ) {
+  _frame = frame;
+  _rows = rows;
+  _method = FFT_MATCH_NCC;
+  _window = 8;
+  _sum = _sumSq = 0;
+  _next = 0;
+  _best.index = -1;
+  _best.label [ 0 ] = '\0';
+  _best.score = 0.0f;
+  _best.compared = _best.abandoned = _best.skipped = 0;
+}
+
+void FFT_Matcher::Set_Method ( FFT_Match_Method method, uint8_t window ) {
+  _method = method;
+  _window = window;
+}
+
+void FFT_Matcher::Begin ( const FFT_Spectrogram & live ) {
+  _live = live;
+  _sum = _sumSq = 0;
+  for ( uint8_t f = 0; f < live.frames; f++ ) {
+    for ( uint8_t b = 0; b < live.bands; b++ ) {
+      int8_t c = live.Cell ( f, b );
+      _sum += c;
+      _sumSq += ( int16_t ) c * c;
+    }
+  }
+  _next = 0;
+  _best.index = -1;
+  _best.label [ 0 ] = '\0';
+  _best.score = 0.0f;
+  _best.compared = _best.abandoned = _best.skipped = 0;
+}
+
+bool FFT_Matcher::Run ( unsigned long budget_us ) {
+  unsigned long start = micros ();
+  while ( _next < _store.Count () ) {
+    if ( budget_us && ( micros () - start >= budget_us ) ) return ( false );
+    uint8_t i = _next++;
+    FFT_Template_Info info;
+    if ( ! _store.Open ( i, info ) ) {
+      _best.skipped++;
+      continue;
+    }
+    float score = 0.0f;
+    int8_t done = _method == FFT_MATCH_NCC ? _NCC ( info, score ) : _DTW ( info, score );
+    if ( done < 0 ) {
+      _best.skipped++;
+      continue;
+    }
+    if ( done == 0 ) {
+      _best.abandoned++;
+      continue;
+    }
+    _best.compared++;
+    bool better = _best.index < 0
+                  || ( _method == FFT_MATCH_NCC ? score > _best.score : score < _best.score );
+    if ( better ) {
+      _best.index = i;
+      _best.score = score;
+      memcpy ( _best.label, info.label, sizeof ( _best.label ) );
+    }
+  }
+  return ( true );
+}
+
+bool FFT_Matcher::Done () {
+  return ( _next >= _store.Count () );
+}
+
+const FFT_Match_Result & FFT_Matcher::Best () {
+  return ( _best );
+}
+
+const FFT_Match_Result & FFT_Matcher::Match ( const FFT_Spectrogram & live ) {
+  Begin ( live );
+  Run ( 0 );
+  return ( _best );
+}
+
+// The correlation of x ( live ) and y ( template ) over n cells:
+//   r = sum ( x - mx ) ( y - my ) / sqrt ( sum ( x - mx )^2 sum ( y - my )^2 )
+// The sums of the template's are known before its cells are read, so what is yet to come of
+// sum ( x - mx )^2 and sum ( y - my )^2 is too, and the rest of the numerator can add no more
+// than the square root of their product. Every 8 frames: if even that would not reach the
+// best so far, the template is dropped. Squared, so as to need no square root
+int8_t FFT_Matcher::_NCC ( const FFT_Template_Info & t, float & score ) {
+  if ( ( t.frames != _live.frames ) || ( t.bands != _live.bands ) || ( t.frames == 0 ) ) return ( -1 );
+  float n = ( float ) t.frames * t.bands;
+  float mx = _sum / n, my = t.sum / n;
+  float vx = _sumSq - _sum * mx;
+  float vy = t.sumSq - t.sum * my;
+  bool flat = ( vx <= 0.0f ) || ( vy <= 0.0f );
+  bool prune = ( _best.index >= 0 ) && ! flat;
+  float target = prune ? _best.score * sqrt ( vx * vy ) : 0.0f;
+
+  int32_t pxy = 0, px = 0, py = 0, pxx = 0, pyy = 0;
+  for ( uint8_t f = 0; f < t.frames; f++ ) {
+    if ( _store.Read ( _frame, t.bands ) != t.bands ) return ( -1 );
+    for ( uint8_t b = 0; b < t.bands; b++ ) {
+      int16_t x = _live.Cell ( f, b ), y = _frame [ b ];
+      pxy += x * y;
+      px += x;
+      py += y;
+      pxx += x * x;
+      pyy += y * y;
+    }
+    if ( prune && ( ( f & 7 ) == 7 ) && ( f + 1 < t.frames ) ) {
+      float k = ( float ) ( f + 1 ) * t.bands, rest = n - k;
+      float sofar = pxy - my * px - mx * py + k * mx * my;
+      float rx = ( _sumSq - pxx ) - 2.0f * mx * ( _sum - px ) + rest * mx * mx;
+      float ry = ( t.sumSq - pyy ) - 2.0f * my * ( t.sum - py ) + rest * my * my;
+      float gap = target - sofar;
+      if ( ( gap > 0.0f ) && ( ( rx <= 0.0f ) || ( ry <= 0.0f ) || ( rx * ry < gap * gap ) ) ) return ( 0 );
+    }
+  }
+  score = flat ? 0.0f : ( pxy - n * mx * my ) / sqrt ( vx * vy );
+  return ( 1 );
+}
+
+// D ( i, j ) = d ( i, j ) + min ( D ( i - 1, j ), D ( i, j - 1 ), D ( i - 1, j - 1 ) ), i the live
+// frames, j the template's, a row of i for each j, and within window frames of the diagonal.
+// The score is D at the end over ( n + m ) * bands. Costs only grow along a path, so
+// once the cheapest of a row is over the best so far, so is the end
+int8_t FFT_Matcher::_DTW ( const FFT_Template_Info & t, float & score ) {
+  if ( ( t.bands != _live.bands ) || ( t.frames == 0 ) || ( _live.frames == 0 ) || ! _rows ) return ( -1 );
+  const uint32_t INF = 0xFFFFFFFFUL;
+  uint8_t n = _live.frames, m = t.frames;
+  uint16_t w = _window;
+  // the diagonal may step by as much as ( n - 1 ) / ( m - 1 ) frames a row
+  if ( m > 1 ) {
+    uint16_t step = ( n - 1 + m - 2 ) / ( m - 1 );
+    if ( w < step ) w = step;
+  } else {
+    w = n;
+  }
+  float scale = ( float ) ( n + m ) * t.bands;
+  float limit = _best.index >= 0 ? _best.score * scale : -1.0f;
+  uint32_t * prev = _rows, * cur = _rows + n;
+
+  for ( uint8_t j = 0; j < m; j++ ) {
+    if ( _store.Read ( _frame, t.bands ) != t.bands ) return ( -1 );
+    uint16_t c = m > 1 ? ( uint16_t ) ( ( uint32_t ) j * ( n - 1 ) / ( m - 1 ) ) : 0;
+    uint16_t lo = c > w ? c - w : 0;
+    uint16_t hi = c + w < n ? c + w : n - 1;
+    uint32_t rowMin = INF;
+    for ( uint16_t i = 0; i < n; i++ ) {
+      if ( ( i < lo ) || ( i > hi ) ) {
+        cur [ i ] = INF;
+        continue;
+      }
+      uint32_t p;
+      if ( j == 0 ) {
+        p = i == 0 ? 0 : cur [ i - 1 ];
+      } else {
+        p = prev [ i ];
+        if ( i ) {
+          if ( prev [ i - 1 ] < p ) p = prev [ i - 1 ];
+          if ( cur [ i - 1 ] < p ) p = cur [ i - 1 ];
+        }
+      }
+      if ( p == INF ) {
+        cur [ i ] = INF;
+        continue;
+      }
+      uint32_t d = 0;
+      for ( uint8_t b = 0; b < t.bands; b++ ) {
+        int16_t diff = ( int16_t ) _live.Cell ( i, b ) - _frame [ b ];
+        d += diff < 0 ? -diff : diff;
+      }
+      cur [ i ] = p + d;
+      if ( cur [ i ] < rowMin ) rowMin = cur [ i ];
+    }
+    if ( ( limit >= 0.0f ) && ( j + 1 < m ) && ( ( float ) rowMin >= limit ) ) return ( 0 );
+    uint32_t * swap = prev;
+    prev = cur;
+    cur = swap;
+  }
+  if ( prev [ n - 1 ] == INF ) return ( -1 );
+  score = prev [ n - 1 ] / scale;
+  return ( 1 );
+}
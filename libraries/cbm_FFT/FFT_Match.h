@@ -0,0 +1,282 @@
+/*
+	FFT_Match.h - a store of labelled spectrograms, in flash or in a file on
+	  an SD card, and the matching of a live spectrogram against them all
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	FFTloop keeps one spectrogram in EEPROM ( FFT_record_to_EEPROM ) and
+	gives one figure against it ( cross_c against cross_s ). Here there are
+	as many as the store holds, each with a label of up to 8 characters:
+
+	  FFT_Flash_Store         a table of them in flash, compiled in
+	  FFT_File_Store<File>    a file of them, on the SD card, say, added to
+	                          while running; any class with read, write,
+	                          seek, size and flush as SD's File has them
+
+	A spectrogram is int8_t cells, frames by bands. FFT_Spectrogram says where
+	they are: cell ( f, b ) is cells [ f * frameStride + b * bandStride ],
+	so FFTloop's spectrogram_array [ band ][ frame ] needs no copy
+	( FFT_spectrogram, in FFT.h ).
+
+	FFT_Matcher compares the live spectrogram with each template and keeps
+	the best, by one of:
+
+	  FFT_MATCH_NCC   the correlation coefficient of the cells, -1 .. 1,
+	                  higher better; the same frames and bands only
+	  FFT_MATCH_DTW   dynamic time warping: the frames of the template
+	                  against those of the live spectrogram, stretched or
+	                  squeezed in time by up to window frames, the distance
+	                  of two frames the sum of | differences | of their
+	                  cells; the score is the path's cost a cell, lower
+	                  better; the same bands, any number of frames
+
+	Both stop on a template as soon as it cannot beat the best so far: the
+	correlation when what it has yet to read, at the most it could add
+	( by Cauchy-Schwarz ), would not lift it to the best; the warping when
+	the cheapest path so far already costs more. A template's frames are
+	read one at a time, into a frame of the caller's, so nothing need hold
+	a whole template; the warping keeps two rows of costs as well.
+
+	Run ( budget_us ) goes on from template to template until they are all
+	done or the time is up, so the matching can be spread over frames:
+	16 ms at FFTloop's 4 kHz. Match () does them all at once.
+
+	Synopsis
+	  int8_t frame [ NBR_FRQ ];
+	  uint32_t rows [ 2 * TIME_SZ ];                    // for FFT_MATCH_DTW
+	  File file = SD.open ( "words.spg", FILE_WRITE );
+	  uint32_t offsets [ 20 ];
+	  FFT_File_Store<File> words ( file, offsets, 20 );
+	  FFT_Matcher matcher ( words, frame, rows );
+
+	  setup:  words.Begin ();
+	          matcher.Set_Method ( FFT_MATCH_DTW, 8 );
+	  record: words.Add ( "hello", FFT_spectrogram );
+	  match:  const FFT_Match_Result & best = matcher.Match ( FFT_spectrogram );
+	          ... best.label, best.score ...
+*/
+
+#ifndef FFT_Match_h
+#define FFT_Match_h
+
+#define FFT_MATCH_VERSION "1.000.000"
+// 2026-10-17 1.000.000 created
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include <FFT_T.h>
+
+#define FFT_LABEL_LEN 8
+
+//******************************************************************************
+// spectrograms and templates
+//******************************************************************************
+
+struct FFT_Spectrogram {
+  FFT_Spectrogram () : cells ( NULL ), frames ( 0 ), bands ( 0 ), frameStride ( 0 ), bandStride ( 0 ) { }
+  FFT_Spectrogram ( const int8_t * c, uint8_t f, uint8_t b, int16_t fs, int16_t bs ) :
+    cells ( c ), frames ( f ), bands ( b ), frameStride ( fs ), bandStride ( bs ) { }
+  int8_t Cell ( uint8_t f, uint8_t b ) const { return cells [ ( int16_t ) f * frameStride + ( int16_t ) b * bandStride ]; }
+
+  const int8_t * cells;
+  uint8_t frames, bands;
+  int16_t frameStride, bandStride;
+};
+
+// what a store says of a template before its cells are read: the sums of the cells and of their squares
+struct FFT_Template_Info {
+  char label [ FFT_LABEL_LEN + 1 ];
+  uint8_t frames, bands;
+  int32_t sum, sumSq;
+};
+
+class FFT_Template_Store {
+  public:
+    virtual uint8_t Count () = 0;
+    // template i's info, and its cells ready to be read from the first frame on
+    virtual bool Open ( uint8_t i, FFT_Template_Info & info ) = 0;
+    // the next n cells, frame by frame; returns how many
+    virtual uint16_t Read ( int8_t * cells, uint16_t n ) = 0;
+};
+
+//******************************************************************************
+// in flash
+//******************************************************************************
+
+// label and cells in flash as well, frame by frame:
+//   const char helloLabel [] FFT_FLASH = "hello";
+//   const int8_t helloCells [ 64 * 16 ] FFT_FLASH = { ... };
+//   const FFT_Flash_Template words [] FFT_FLASH = { { helloLabel, helloCells, 64, 16 }, ... };
+struct FFT_Flash_Template {
+  const char * label;
+  const int8_t * cells;
+  uint8_t frames, bands;
+};
+
+class FFT_Flash_Store : public FFT_Template_Store {
+  public:
+    FFT_Flash_Store ( const FFT_Flash_Template * table, uint8_t count );
+    virtual uint8_t Count ();
+    // the sums are worked out here, from the cells
+    virtual bool Open ( uint8_t i, FFT_Template_Info & info );
+    virtual uint16_t Read ( int8_t * cells, uint16_t n );
+
+  private:
+    const FFT_Flash_Template * _table;
+    uint8_t _count;
+    const int8_t * _cells;
+    uint16_t _left;
+};
+
+//******************************************************************************
+// in a file
+//******************************************************************************
+
+// the file is a run of templates, each a header of FFT_FILE_HEADER bytes and its cells, frame
+// by frame: 'T', frames, bands, 0, the label ( zero-padded ), and sum and sumSq, little-endian
+#define FFT_FILE_HEADER ( 4 + FFT_LABEL_LEN + 8 )
+
+template <class FileT>
+class FFT_File_Store : public FFT_Template_Store {
+  public:
+    // offsets: where each template starts, the caller's; maxTemplates of them
+    FFT_File_Store ( FileT & file, uint32_t * offsets, uint8_t maxTemplates ) :
+      _file ( file ), _offsets ( offsets ), _max ( maxTemplates ), _count ( 0 ) { }
+
+    // finds the templates already in the file; returns how many
+    uint8_t Begin () {
+      uint32_t at = 0, size = _file.size ();
+      uint8_t h [ FFT_FILE_HEADER ];
+      _count = 0;
+      while ( ( _count < _max ) && ( at + FFT_FILE_HEADER <= size ) ) {
+        _file.seek ( at );
+        if ( _file.read ( h, FFT_FILE_HEADER ) != FFT_FILE_HEADER || h [ 0 ] != 'T' ) break;
+        _offsets [ _count++ ] = at;
+        at += FFT_FILE_HEADER + ( uint32_t ) h [ 1 ] * h [ 2 ];
+      }
+      return ( _count );
+    }
+    // appends a template; returns its index, or -1 if the store is full or the write failed
+    int16_t Add ( const char * label, const FFT_Spectrogram & s ) {
+      if ( _count >= _max ) return ( -1 );
+      uint8_t h [ FFT_FILE_HEADER ];
+      int32_t sum = 0, sumSq = 0;
+      for ( uint8_t f = 0; f < s.frames; f++ ) {
+        for ( uint8_t b = 0; b < s.bands; b++ ) {
+          int8_t c = s.Cell ( f, b );
+          sum += c;
+          sumSq += ( int16_t ) c * c;
+        }
+      }
+      h [ 0 ] = 'T';
+      h [ 1 ] = s.frames;
+      h [ 2 ] = s.bands;
+      h [ 3 ] = 0;
+      uint8_t i = 0;
+      for ( ; i < FFT_LABEL_LEN && label [ i ]; i++ ) h [ 4 + i ] = label [ i ];
+      for ( ; i < FFT_LABEL_LEN; i++ ) h [ 4 + i ] = 0;
+      _Put ( h + 4 + FFT_LABEL_LEN, sum );
+      _Put ( h + 8 + FFT_LABEL_LEN, sumSq );
+      uint32_t at = _file.size ();
+      _file.seek ( at );
+      if ( _file.write ( h, FFT_FILE_HEADER ) != FFT_FILE_HEADER ) return ( -1 );
+      for ( uint8_t f = 0; f < s.frames; f++ ) {
+        uint8_t row [ 16 ];
+        for ( uint8_t b = 0; b < s.bands; ) {
+          uint8_t n = 0;
+          while ( n < sizeof ( row ) && b < s.bands ) row [ n++ ] = ( uint8_t ) s.Cell ( f, b++ );
+          if ( _file.write ( row, n ) != n ) return ( -1 );
+        }
+      }
+      _file.flush ();
+      _offsets [ _count ] = at;
+      return ( _count++ );
+    }
+    virtual uint8_t Count () { return ( _count ); }
+    virtual bool Open ( uint8_t i, FFT_Template_Info & info ) {
+      if ( i >= _count ) return ( false );
+      uint8_t h [ FFT_FILE_HEADER ];
+      _file.seek ( _offsets [ i ] );
+      if ( _file.read ( h, FFT_FILE_HEADER ) != FFT_FILE_HEADER ) return ( false );
+      info.frames = h [ 1 ];
+      info.bands = h [ 2 ];
+      for ( uint8_t j = 0; j < FFT_LABEL_LEN; j++ ) info.label [ j ] = ( char ) h [ 4 + j ];
+      info.label [ FFT_LABEL_LEN ] = '\0';
+      info.sum = _Get ( h + 4 + FFT_LABEL_LEN );
+      info.sumSq = _Get ( h + 8 + FFT_LABEL_LEN );
+      return ( true );
+    }
+    virtual uint16_t Read ( int8_t * cells, uint16_t n ) {
+      int got = _file.read ( ( uint8_t * ) cells, n );
+      return ( got > 0 ? ( uint16_t ) got : 0 );
+    }
+
+  private:
+    static void _Put ( uint8_t * p, int32_t v ) {
+      for ( uint8_t j = 0; j < 4; j++ ) p [ j ] = ( uint8_t ) ( ( uint32_t ) v >> ( 8 * j ) );
+    }
+    static int32_t _Get ( const uint8_t * p ) {
+      uint32_t v = 0;
+      for ( uint8_t j = 0; j < 4; j++ ) v |= ( uint32_t ) p [ j ] << ( 8 * j );
+      return ( ( int32_t ) v );
+    }
+
+    FileT & _file;
+    uint32_t * _offsets;
+    uint8_t _max, _count;
+};
+
+//******************************************************************************
+// the matcher
+//******************************************************************************
+
+enum FFT_Match_Method {
+  FFT_MATCH_NCC,
+  FFT_MATCH_DTW
+};
+
+struct FFT_Match_Result {
+  int16_t index;                        // the best template, or -1 for none
+  char label [ FFT_LABEL_LEN + 1 ];
+  float score;
+  uint8_t compared;                     // to the end
+  uint8_t abandoned;                    // stopped early, as they could not be the best
+  uint8_t skipped;                      // not comparable: other dimensions, or unreadable
+};
+
+class FFT_Matcher {
+  public:
+    // frame: as many cells as a template has bands; rows: twice the live frames, for FFT_MATCH_DTW
+    FFT_Matcher ( FFT_Template_Store & store, int8_t * frame, uint32_t * rows = NULL );
+    // window: how many frames the warping may shift a frame by ( at least what the lengths need )
+    void Set_Method ( FFT_Match_Method method, uint8_t window = 8 );
+    // starts over against the live spectrogram, which has to stay as it is until Done ()
+    void Begin ( const FFT_Spectrogram & live );
+    // template after template until done, or budget_us is up ( 0: no limit ); true when done
+    bool Run ( unsigned long budget_us = 0 );
+    bool Done ();
+    const FFT_Match_Result & Best ();
+    // Begin and Run, all at once
+    const FFT_Match_Result & Match ( const FFT_Spectrogram & live );
+
+  private:
+    // 1 compared, with the score; 0 abandoned; -1 skipped
+    int8_t _NCC ( const FFT_Template_Info & t, float & score );
+    int8_t _DTW ( const FFT_Template_Info & t, float & score );
+
+    FFT_Template_Store & _store;
+    int8_t * _frame;
+    uint32_t * _rows;
+    FFT_Match_Method _method;
+    uint8_t _window;
+    FFT_Spectrogram _live;
+    int32_t _sum, _sumSq;                 // the live cells'
+    uint8_t _next;
+    FFT_Match_Result _best;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*
+	FFT_Pipeline.cpp - a spectral analysis pipeline in stages
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+*/
+
+#include <FFT_Pipeline.h>
+
+// ******************************************************************************
+// the sources
+
+FFT_Array_Source::FFT_Array_Source ( const int16_t * samples, unsigned long n, bool loop ) {
+  _samples = samples;
+  _n = n;
+  _loop = loop;
+  _next = 0;
+}
+
+uint16_t FFT_Array_Source::Read ( int16_t * x, uint16_t n ) {
+  uint16_t got = 0;
+  while ( got < n ) {
+    if ( _next >= _n ) {
+      if ( ! _loop || ( _n == 0 ) ) break;
+      _next = 0;
+    }
+    x [ got++ ] = _samples [ _next++ ];
+  }
+  return ( got );
+}
+
+void FFT_Array_Source::Rewind () {
+  _next = 0;
+}
+
+FFT_Analog_Source::FFT_Analog_Source ( uint8_t pin, unsigned long period_us, int16_t offset, uint8_t shift ) {
+  _pin = pin;
+  _period_us = period_us ? period_us : 1;
+  _offset = offset;
+  _shift = shift;
+  _next_us = micros ();
+  _late = 0;
+}
+
+uint16_t FFT_Analog_Source::Read ( int16_t * x, uint16_t n ) {
+  uint16_t got = 0;
+  while ( got < n ) {
+    long behind = ( long ) ( micros () - _next_us );
+    if ( behind < 0 ) break;
+    if ( ( unsigned long ) behind > _period_us ) {
+      // the samples missed are gone; keep the ones read on time
+      _late++;
+      _next_us = micros ();
+    }
+    x [ got++ ] = ( int16_t ) ( ( analogRead ( _pin ) - _offset ) << _shift );
+    _next_us += _period_us;
+  }
+  return ( got );
+}
+
+unsigned long FFT_Analog_Source::Late () {
+  return ( _late );
+}
+
+uint16_t FFT_Read ( FFT_Source & source, int16_t * x, uint16_t n ) {
+  return ( source.Read ( x, n ) );
+}
+
+uint16_t FFT_Read ( FFT_Source & source, int32_t * x, uint16_t n ) {
+  int16_t chunk [ 16 ];
+  uint16_t got = 0;
+  while ( got < n ) {
+    uint16_t want = n - got < 16 ? n - got : 16;
+    uint16_t read = source.Read ( chunk, want );
+    for ( uint16_t i = 0; i < read; i++ ) x [ got + i ] = ( int32_t ) chunk [ i ] << 16;
+    got += read;
+    if ( read < want ) break;
+  }
+  return ( got );
+}
+
+// ******************************************************************************
+// the window
+
+void FFT_Window::Make ( int16_t * w, uint16_t n, FFT_Window_Type type ) {
+  for ( uint16_t i = 0; i <= n / 2; i++ ) {
+    float a = 2.0f * ( float ) M_PI * i / n;
+    float v;
+    switch ( type ) {
+      case FFT_WINDOW_HANN:     v = 0.5f - 0.5f * cos ( a );                               break;
+      case FFT_WINDOW_HAMMING:  v = 0.54f - 0.46f * cos ( a );                             break;
+      case FFT_WINDOW_BLACKMAN: v = 0.42f - 0.5f * cos ( a ) + 0.08f * cos ( 2.0f * a );   break;
+      default:                  v = 1.0f;                                                  break;
+    }
+    long q = ( long ) ( v * 32768.0f + 0.5f );
+    w [ i ] = ( int16_t ) ( q > 32767 ? 32767 : ( q < 0 ? 0 : q ) );
+  }
+}
+
+// w [ i ] for i <= n/2, w [ n - i ] above
+void FFT_Window::Apply ( int16_t * x, const int16_t * w, uint16_t n ) {
+  uint16_t half = n / 2;
+  for ( uint16_t i = 0; i <= half; i++ ) x [ i ] = ( int16_t ) ( ( ( int32_t ) x [ i ] * w [ i ] + 0x4000 ) >> 15 );
+  for ( uint16_t i = half + 1; i < n; i++ ) x [ i ] = ( int16_t ) ( ( ( int32_t ) x [ i ] * w [ n - i ] + 0x4000 ) >> 15 );
+}
+
+void FFT_Window::Apply ( int32_t * x, const int16_t * w, uint16_t n ) {
+  uint16_t half = n / 2;
+  for ( uint16_t i = 0; i <= half; i++ ) x [ i ] = ( int32_t ) ( ( ( int64_t ) x [ i ] * w [ i ] + 0x4000 ) >> 15 );
+  for ( uint16_t i = half + 1; i < n; i++ ) x [ i ] = ( int32_t ) ( ( ( int64_t ) x [ i ] * w [ n - i ] + 0x4000 ) >> 15 );
+}
+
+float FFT_Window::Coherent_Gain ( const int16_t * w, uint16_t n ) {
+  float sum = 0.0f;
+  for ( uint16_t i = 0; i < n; i++ ) sum += w [ i <= n / 2 ? i : n - i ];
+  return ( sum / 32768.0f / n );
+}
+
+float FFT_Window::Power_Gain ( const int16_t * w, uint16_t n ) {
+  float sum = 0.0f;
+  for ( uint16_t i = 0; i < n; i++ ) {
+    float v = w [ i <= n / 2 ? i : n - i ] / 32768.0f;
+    sum += v * v;
+  }
+  return ( sum / n );
+}
+
+// ******************************************************************************
+// bands
+
+FFT_Bands::FFT_Bands ( uint16_t * edges, uint8_t nBands ) {
+  _edges = edges;
+  _nBands = nBands;
+}
+
+void FFT_Bands::Set ( const uint16_t * edges ) {
+  for ( uint8_t b = 0; b <= _nBands; b++ ) _edges [ b ] = edges [ b ];
+}
+
+void FFT_Bands::Set_Linear ( uint16_t first, uint16_t last ) {
+  for ( uint8_t b = 0; b <= _nBands; b++ ) {
+    _edges [ b ] = first + ( uint16_t ) ( ( uint32_t ) ( last - first ) * b / _nBands );
+  }
+}
+
+void FFT_Bands::Set_Log ( uint16_t first, uint16_t last ) {
+  if ( first < 1 ) first = 1;
+  float ratio = ( float ) last / first;
+  _edges [ 0 ] = first;
+  for ( uint8_t b = 1; b <= _nBands; b++ ) {
+    uint16_t e = ( uint16_t ) ( first * pow ( ratio, ( float ) b / _nBands ) + 0.5f );
+    // at least one bin a band, and room left for one in each of the rest
+    if ( e <= _edges [ b - 1 ] ) e = _edges [ b - 1 ] + 1;
+    if ( e > last - ( _nBands - b ) ) e = last - ( _nBands - b );
+    _edges [ b ] = e;
+  }
+}
+
+uint8_t FFT_Bands::Bands () {
+  return ( _nBands );
+}
+
+uint16_t FFT_Bands::First ( uint8_t band ) {
+  return ( _edges [ band ] );
+}
+
+uint16_t FFT_Bands::End ( uint8_t band ) {
+  return ( _edges [ band + 1 ] );
+}
+
+void FFT_Bands::Map ( const uint32_t * power, uint32_t * out ) {
+  for ( uint8_t b = 0; b < _nBands; b++ ) {
+    uint32_t sum = 0;
+    for ( uint16_t k = _edges [ b ]; k < _edges [ b + 1 ]; k++ ) {
+      uint32_t s = sum + power [ k ];
+      sum = s < sum ? 0xFFFFFFFFUL : s;
+    }
+    out [ b ] = sum;
+  }
+}
+
+void FFT_Bands::Map ( const uint16_t * mag, uint16_t * out ) {
+  for ( uint8_t b = 0; b < _nBands; b++ ) {
+    uint32_t sum = 0;
+    for ( uint16_t k = _edges [ b ]; k < _edges [ b + 1 ]; k++ ) sum += mag [ k ];
+    out [ b ] = sum > 0xFFFFUL ? 0xFFFF : ( uint16_t ) sum;
+  }
+}
@@ -0,0 +1,284 @@
+/*
+	FFT_Pipeline.h - a spectral analysis pipeline in stages, on buffers the
+	  caller owns: samples in, window, FFT, power or magnitude, bands out
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	FFTsetup () and FFTloop () in FFT.cpp are one analysis, on one ADC pin
+	sampled by Timer 2, into file-scope arrays of fixed sizes. Here each step
+	is a stage of its own, which can be used alone or strung together by an
+	FFT_Pipeline, and any number of them can exist:
+
+	  FFT_Source          where the samples come from, as Q15:
+	    FFT_Array_Source    from an array ( a recording, or the host )
+	    FFT_Analog_Source   analogRead () paced by micros (), on any board
+	    FFT_Timer2_Source   Timer 2 and the ADC of the ATmega328 ( FFT.h )
+	  FFT_Window          Hann, Hamming, or Blackman, as a Q15 table
+	  FFT_Real_T          the transform ( FFT_T.h )
+	  FFT_Power           the power of each bin, as uint32_t
+	  FFT_Magnitude       the magnitude of each bin, as uint16_t, exactly or
+	                      to 1.22% ( FFT_Magnitude_Approx )
+	  FFT_Bins_dB         the power of each bin in dB ( FFT_Kernels.h )
+	  FFT_Bands           sums of bins, over edges you give, or linear or
+	                      logarithmic ones it works out
+	  FFT_STFT            overlapped frames out of a ring of samples, a
+	                      spectrogram, and Welch averaging ( FFT_STFT.h )
+
+	The values come with exponents, as out of FFT_T: power [ k ] * 2 ^ e is
+	the power of bin k in the units of the samples squared. The power and
+	magnitude of bins 0 .. N/2 - 1 are given; the Nyquist bin is left out,
+	so that either can be written over the bins themselves.
+
+	Synopsis
+	  #include <FFT_Pipeline.h>
+	  #define N 256
+	  int16_t frame [ N ];                       // samples, then bins, in place
+	  int16_t hann [ N / 2 + 1 ];
+	  uint32_t power [ N / 2 ];
+	  uint16_t edges [ 17 ];
+	  uint32_t bands [ 16 ];
+
+	  FFT_Analog_Source adc ( A0, 250UL );      // 4 kHz
+	  FFT_Bands octaves ( edges, 16 );
+	  FFT_Pipeline<N> spectrum ( adc, frame, power );
+
+	  setup:  FFT_Window::Make ( hann, N, FFT_WINDOW_HANN );
+	          octaves.Set_Log ( 1, N / 2 );
+	          spectrum.Set_Window ( hann );
+	          spectrum.Set_Bands ( &octaves, bands );
+	  loop:   if ( spectrum.Poll () ) ... bands [ b ] * 2 ^ spectrum.Exponent () ...
+
+	Poll () reads what the source has and returns true when it has filled the
+	frame and processed it. Acquisition waits while a frame is processed, so
+	the source has to hold the samples that arrive meanwhile.
+*/
+
+#ifndef FFT_Pipeline_h
+#define FFT_Pipeline_h
+
+#define FFT_PIPELINE_VERSION "1.001.000"
+// 2026-10-17 1.000.000 created
+// 2026-10-17 1.001.000 FFT_Magnitude by integer square root; FFT_Magnitude_Approx, FFT_Bins_dB
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include <FFT_T.h>
+#include <FFT_Kernels.h>
+
+//******************************************************************************
+// the sources
+//******************************************************************************
+
+class FFT_Source {
+  public:
+    // copies up to n of the samples that are ready, as Q15, into x; returns how many
+    virtual uint16_t Read ( int16_t * x, uint16_t n ) = 0;
+};
+
+class FFT_Array_Source : public FFT_Source {
+  public:
+    // the samples are read once, or over and over
+    FFT_Array_Source ( const int16_t * samples, unsigned long n, bool loop = false );
+    virtual uint16_t Read ( int16_t * x, uint16_t n );
+    void Rewind ();
+
+  private:
+    const int16_t * _samples;
+    unsigned long _n, _next;
+    bool _loop;
+};
+
+class FFT_Analog_Source : public FFT_Source {
+  public:
+    // ( analogRead - offset ) << shift: 512 and 6 make a 10-bit ADC full-scale Q15
+    FFT_Analog_Source ( uint8_t pin, unsigned long period_us, int16_t offset = 512, uint8_t shift = 6 );
+    // reads the samples that are due; more than a period behind, it starts over from now
+    virtual uint16_t Read ( int16_t * x, uint16_t n );
+    unsigned long Late ();
+
+  private:
+    uint8_t _pin, _shift;
+    int16_t _offset;
+    unsigned long _period_us, _next_us, _late;
+};
+
+// a source of int16_t into a frame of int32_t: Q15 to Q31
+uint16_t FFT_Read ( FFT_Source & source, int16_t * x, uint16_t n );
+uint16_t FFT_Read ( FFT_Source & source, int32_t * x, uint16_t n );
+
+//******************************************************************************
+// the window
+//******************************************************************************
+
+enum FFT_Window_Type {
+  FFT_WINDOW_RECTANGULAR,
+  FFT_WINDOW_HANN,
+  FFT_WINDOW_HAMMING,
+  FFT_WINDOW_BLACKMAN
+};
+
+class FFT_Window {
+  public:
+    // the periodic window of n points, which is symmetric, so only w [ 0 .. n/2 ]: n/2 + 1 of Q15
+    static void Make ( int16_t * w, uint16_t n, FFT_Window_Type type );
+    // x [ i ] * w [ i ], in place
+    static void Apply ( int16_t * x, const int16_t * w, uint16_t n );
+    static void Apply ( int32_t * x, const int16_t * w, uint16_t n );
+    // mean w, which scales a tone's amplitude, and mean w^2, which scales noise power
+    static float Coherent_Gain ( const int16_t * w, uint16_t n );
+    static float Power_Gain ( const int16_t * w, uint16_t n );
+};
+
+//******************************************************************************
+// power and magnitude
+//******************************************************************************
+
+// re^2 + im^2: as it is for Q15, and / 2^32 for Q31
+inline uint32_t FFT_Bin_Power ( int16_t re, int16_t im ) {
+  return ( uint32_t ) ( ( int32_t ) re * re ) + ( uint32_t ) ( ( int32_t ) im * im );
+}
+inline uint32_t FFT_Bin_Power ( int32_t re, int32_t im ) {
+  return ( uint32_t ) ( ( ( uint64_t ) ( ( int64_t ) re * re ) + ( uint64_t ) ( ( int64_t ) im * im ) ) >> 32 );
+}
+inline int FFT_Power_Exponent ( int16_t, int exponent ) { return 2 * exponent; }
+inline int FFT_Power_Exponent ( int32_t, int exponent ) { return 2 * exponent + 32; }
+
+// v * 2 ^ e, rounded, and saturated at 2^32 - 1
+inline uint32_t FFT_Scale ( uint32_t v, int e ) {
+  if ( e >= 0 ) {
+    if ( v == 0 ) return ( 0 );
+    if ( ( e >= 32 ) || ( v > ( 0xFFFFFFFFUL >> e ) ) ) return ( 0xFFFFFFFFUL );
+    return ( v << e );
+  }
+  if ( e <= -32 ) return ( 0 );
+  return ( ( uint32_t ) ( ( ( uint64_t ) v + ( ( uint64_t ) 1 << ( -e - 1 ) ) ) >> -e ) );
+}
+
+// the power of bins 0 .. n - 1 out of the FFT with the exponent given; bin 0 is
+// its real part alone. Returns the power's exponent. power may be the bins themselves
+template <typename T>
+int FFT_Power ( const FFT_Complex<T> * bins, uint16_t n, int exponent, uint32_t * power ) {
+  for ( uint16_t k = 0; k < n; k++ ) power [ k ] = FFT_Bin_Power ( bins [ k ].re, k ? bins [ k ].im : ( T ) 0 );
+  return ( FFT_Power_Exponent ( ( T ) 0, exponent ) );
+}
+
+// the square roots of the powers, rounded, as uint16_t; the magnitude's exponent is half the
+// power's. Returns that exponent. mag may be the bins themselves
+template <typename T>
+int FFT_Magnitude ( const FFT_Complex<T> * bins, uint16_t n, int exponent, uint16_t * mag ) {
+  for ( uint16_t k = 0; k < n; k++ ) mag [ k ] = FFT_isqrt ( FFT_Bin_Power ( bins [ k ].re, k ? bins [ k ].im : ( T ) 0 ) );
+  return ( FFT_Power_Exponent ( ( T ) 0, exponent ) / 2 );
+}
+
+// as FFT_Magnitude, to within 1.22%, by FFT_Approx_Magnitude: no squares and no root
+inline uint16_t FFT_Approx_Magnitude16 ( int16_t re, int16_t im ) { return FFT_Approx_Magnitude ( re, im ); }
+inline uint16_t FFT_Approx_Magnitude16 ( int32_t re, int32_t im ) {
+  return ( uint16_t ) ( ( FFT_Approx_Magnitude ( re, im ) + 0x8000UL ) >> 16 );
+}
+template <typename T>
+int FFT_Magnitude_Approx ( const FFT_Complex<T> * bins, uint16_t n, int exponent, uint16_t * mag ) {
+  for ( uint16_t k = 0; k < n; k++ ) mag [ k ] = FFT_Approx_Magnitude16 ( bins [ k ].re, k ? bins [ k ].im : ( T ) 0 );
+  return ( FFT_Power_Exponent ( ( T ) 0, exponent ) / 2 );
+}
+
+// the power of each bin in dB, as FFT_dB_Q4 ( 1/16 dB ), in the units of the samples.
+// dB may be the bins themselves
+template <typename T>
+void FFT_Bins_dB ( const FFT_Complex<T> * bins, uint16_t n, int exponent, int16_t * dB ) {
+  int e = FFT_Power_Exponent ( ( T ) 0, exponent );
+  for ( uint16_t k = 0; k < n; k++ ) dB [ k ] = FFT_dB_Q4 ( FFT_Bin_Power ( bins [ k ].re, k ? bins [ k ].im : ( T ) 0 ), e );
+}
+
+//******************************************************************************
+// bands
+//******************************************************************************
+
+class FFT_Bands {
+  public:
+    // edges: nBands + 1 entries, the caller's; band b is bins edges [ b ] .. edges [ b + 1 ] - 1
+    FFT_Bands ( uint16_t * edges, uint8_t nBands );
+    // copies the caller's edges ( nBands + 1 of them, rising )
+    void Set ( const uint16_t * edges );
+    // bins first .. last - 1, in bands of equal width, or of equal ratio ( each at least one bin )
+    void Set_Linear ( uint16_t first, uint16_t last );
+    void Set_Log ( uint16_t first, uint16_t last );
+    uint8_t Bands ();
+    uint16_t First ( uint8_t band );
+    uint16_t End ( uint8_t band );
+    // the sum of the bins of each band, saturated
+    void Map ( const uint32_t * power, uint32_t * out );
+    void Map ( const uint16_t * mag, uint16_t * out );
+
+  private:
+    uint16_t * _edges;
+    uint8_t _nBands;
+};
+
+//******************************************************************************
+// the pipeline
+//******************************************************************************
+
+template <uint16_t N, typename T = q15_t>
+class FFT_Pipeline {
+  public:
+    typedef FFT_Complex<T> complex_t;
+
+    // frame: N samples, the caller's, and in place the bins; power: N/2, which may be the frame
+    FFT_Pipeline ( FFT_Source & source, T * frame, uint32_t * power ) :
+      _source ( source ), _frame ( frame ), _power ( power ) {
+      _window = NULL;
+      _bands = NULL;
+      _bandPower = NULL;
+      _fill = 0;
+      _exponent = 0;
+    }
+    // N/2 + 1 of FFT_Window::Make, or NULL for none
+    void Set_Window ( const int16_t * window ) { _window = window; }
+    // bandPower: bands->Bands () of them, the caller's; NULL bands for none
+    void Set_Bands ( FFT_Bands * bands, uint32_t * bandPower ) {
+      _bands = bands;
+      _bandPower = bandPower;
+    }
+
+    // reads what the source has into the frame; true when it is full
+    bool Acquire () {
+      if ( _fill < N ) _fill += FFT_Read ( _source, _frame + _fill, N - _fill );
+      return ( _fill >= N );
+    }
+    // window, FFT, power, bands; the frame is then empty. Returns the power's exponent
+    int Process () {
+      if ( _window ) FFT_Window::Apply ( _frame, _window, N );
+      int e = FFT_Real_T<N, T>::forward ( _frame );
+      _exponent = FFT_Power ( Bins (), N / 2, e, _power );
+      if ( _bands ) _bands->Map ( _power, _bandPower );
+      _fill = 0;
+      return ( _exponent );
+    }
+    bool Poll () {
+      if ( ! Acquire () ) return ( false );
+      Process ();
+      return ( true );
+    }
+
+    // until the power is written over them
+    const complex_t * Bins () { return ( ( const complex_t * ) _frame ); }
+    const uint32_t * Power () { return ( _power ); }
+    int Exponent () { return ( _exponent ); }
+    uint16_t Fill () { return ( _fill ); }
+
+  private:
+    FFT_Source & _source;
+    T * _frame;
+    uint32_t * _power;
+    const int16_t * _window;
+    FFT_Bands * _bands;
+    uint32_t * _bandPower;
+    uint16_t _fill;
+    int _exponent;
+};
+
+#endif
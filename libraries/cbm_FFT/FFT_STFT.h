@@ -0,0 +1,305 @@
+/*
+	FFT_STFT.h - streaming short-time Fourier transform: overlapped frames
+	  out of a ring of samples, a rolling spectrogram, and Welch averaging
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	FFTloop captures 64 frames, then stops capturing to filter and correlate
+	them, and whatever is said meanwhile is lost; FFT_Pipeline reads a frame,
+	then processes it, and the source has to hold what arrives meanwhile.
+	Here the samples go into a ring, by Push () from an interrupt or from
+	loop (), or by Feed () from an FFT_Source, and a frame is taken out of the
+	ring every hop samples: while frame k is processed, the samples of frame
+	k + 1 keep going into the ring.
+
+	  hop = N      frames side by side
+	  hop = N / 2  50% overlap, the usual with Hann; hop = N / 4, 75%
+
+	The ring has to hold a frame, plus the samples that arrive while one is
+	processed, plus a hop: ringLen, a power of 2, at least N + hop + those.
+	If loop () falls further behind, the frames whose samples were written
+	over are skipped and counted ( Overruns () ).
+
+	Each frame goes through the stages of FFT_Pipeline.h: the window, the
+	FFT, the power of each bin, and the bands. Then, as set:
+
+	  the spectrogram  a ring of rows, one a frame, of the level of each
+	                   band as uint8_t, in steps of 0.5 dB above floor_dB
+	                   ( in dB re 1 sample unit squared ): 127 dB of range
+	  Welch            the power of each bin, summed over frames, in
+	                   block floating point ( a uint32_t a bin ):
+	                     Welch_PSD ( k, F_sampling )     units^2 / Hz
+	                     Welch_Mean_Square ( first, end )
+	                   the latter the mean square of the signal within bins
+	                   first .. end - 1, e.g. a band's noise floor; over all
+	                   the bins, with the window's power taken out, that is
+	                   the variance of the signal
+
+	Synopsis
+	  #define N 256
+	  volatile int16_t ring [ 512 ];
+	  int16_t frame [ N ], hann [ N / 2 + 1 ];
+	  uint32_t power [ N / 2 ], welch [ N / 2 ], bandPower [ 8 ];
+	  uint16_t edges [ 9 ];
+	  uint8_t cells [ 32 * 8 ];                 // 32 rows of 8 bands
+	  FFT_Bands bands ( edges, 8 );
+	  FFT_STFT<N> stft ( ring, 512, frame, power, N / 2 );
+
+	  setup:  FFT_Window::Make ( hann, N, FFT_WINDOW_HANN );
+	          bands.Set_Log ( 1, N / 2 );
+	          stft.Set_Window ( hann );
+	          stft.Set_Bands ( &bands, bandPower );
+	          stft.Set_Spectrogram ( cells, 32 );
+	          stft.Set_Welch ( welch );
+	  ISR:    stft.Push ( sample );
+	  loop:   while ( stft.Process () ) ... stft.Band_Power ( b ), stft.Row ( 0 ) ...
+	          every so often: stft.Welch_Mean_Square ( bands.First ( b ), bands.End ( b ) ),
+	                          stft.Welch_Reset ()
+
+	Push () is a store and an increment. On the ESP8266, call it from loop ()
+	( after Acquisition, say ) rather than from an interrupt, since it is
+	not in IRAM.
+*/
+
+#ifndef FFT_STFT_h
+#define FFT_STFT_h
+
+#define FFT_STFT_VERSION "1.001.000"
+// 2026-10-17 1.000.000 created
+// 2026-10-17 1.001.000 the spectrogram's levels by FFT_dB_Q4, without log10
+
+#include <FFT_Pipeline.h>
+
+template <uint16_t N, typename T = q15_t>
+class FFT_STFT {
+  public:
+    typedef FFT_Complex<T> complex_t;
+
+    // ring: ringLen samples, a power of 2; frame: N, and power: N/2, which may be the frame
+    FFT_STFT ( volatile int16_t * ring, uint16_t ringLen, T * frame, uint32_t * power, uint16_t hop ) {
+      _ring = ring;
+      _mask = ringLen - 1;
+      _frame = frame;
+      _power = power;
+      _hop = hop ? hop : N;
+      _window = NULL;
+      _windowPower = N;
+      _bands = NULL;
+      _bandPower = NULL;
+      _cells = NULL;
+      _rows = _row = _rowsFilled = 0;
+      _floorQ4 = 0;
+      _welch = NULL;
+      Reset ();
+    }
+    // N/2 + 1 of FFT_Window::Make, or NULL for none
+    void Set_Window ( const int16_t * window ) {
+      _window = window;
+      _windowPower = window ? FFT_Window::Power_Gain ( window, N ) * N : N;
+    }
+    // bandPower: bands->Bands () of them
+    void Set_Bands ( FFT_Bands * bands, uint32_t * bandPower ) {
+      _bands = bands;
+      _bandPower = bandPower;
+    }
+    // rows * bands->Bands () cells, after Set_Bands
+    void Set_Spectrogram ( uint8_t * cells, uint16_t rows, float floor_dB = 0.0f ) {
+      _cells = cells;
+      _rows = rows;
+      _floorQ4 = ( int16_t ) ( floor_dB * 16.0f + ( floor_dB < 0.0f ? -0.5f : 0.5f ) );
+      _row = _rowsFilled = 0;
+    }
+    // N/2 sums
+    void Set_Welch ( uint32_t * accumulator ) {
+      _welch = accumulator;
+      Welch_Reset ();
+    }
+    // forget the samples and the counts
+    void Reset () {
+      _written = 0;
+      _next = 0;
+      _frames = _overruns = 0;
+      _exponent = 0;
+    }
+
+    // ******************************************************************************
+    // acquisition
+
+    void Push ( int16_t x ) {
+      _ring [ _written & _mask ] = x;
+      _written++;
+    }
+    // what the source has; returns how many
+    uint16_t Feed ( FFT_Source & source ) {
+      int16_t chunk [ 16 ];
+      uint16_t total = 0, got;
+      do {
+        got = source.Read ( chunk, 16 );
+        for ( uint16_t i = 0; i < got; i++ ) Push ( chunk [ i ] );
+        total += got;
+      } while ( got == 16 );
+      return ( total );
+    }
+    // the samples of the next frame are all in
+    bool Ready () { return ( _Written () - _next >= N ); }
+
+    // ******************************************************************************
+    // processing
+
+    // the next frame, if it is ready: true if one was done
+    bool Process () {
+      unsigned long written = _Written ();
+      if ( written - _next < N ) return ( false );
+      if ( written - _next > _mask + 1UL ) {
+        _overruns++;
+        _next = written - N;
+      }
+      for ( uint16_t i = 0; i < N; i++ ) _Load ( _frame [ i ], _ring [ ( _next + i ) & _mask ] );
+      // written over while it was copied?
+      written = _Written ();
+      if ( written - _next > _mask + 1UL ) {
+        _overruns++;
+        _next = written - N;
+        return ( false );
+      }
+      _next += _hop;
+
+      if ( _window ) FFT_Window::Apply ( _frame, _window, N );
+      int e = FFT_Real_T<N, T>::forward ( _frame );
+      _exponent = FFT_Power ( ( const complex_t * ) _frame, N / 2, e, _power );
+      if ( _bands ) {
+        _bands->Map ( _power, _bandPower );
+        if ( _cells ) _Row ();
+      }
+      if ( _welch ) _Welch ();
+      _frames++;
+      return ( true );
+    }
+    bool Poll ( FFT_Source * source = NULL ) {
+      if ( source ) Feed ( * source );
+      return ( Process () );
+    }
+
+    // ******************************************************************************
+    // the latest frame
+
+    const uint32_t * Power () { return ( _power ); }
+    int Exponent () { return ( _exponent ); }
+    // in sample units squared
+    float Band_Power ( uint8_t band ) { return ( ldexp ( ( float ) _bandPower [ band ], _exponent ) ); }
+    unsigned long Frames () { return ( _frames ); }
+    unsigned long Overruns () { return ( _overruns ); }
+    // samples in the ring not yet taken into a frame
+    unsigned long Waiting () { return ( _Written () - _next ); }
+
+    // ******************************************************************************
+    // the spectrogram: row 0 the latest frame's; NULL past the rows there are
+
+    uint8_t * Row ( uint16_t age ) {
+      if ( age >= _rowsFilled ) return ( NULL );
+      uint16_t r = ( _row + _rows - 1 - age ) % _rows;
+      return ( _cells + ( uint32_t ) r * _bands->Bands () );
+    }
+    uint16_t Rows () { return ( _rowsFilled ); }
+    // a cell's level in dB
+    float Cell_dB ( uint8_t cell ) { return ( _floorQ4 / 16.0f + 0.5f * cell ); }
+
+    // ******************************************************************************
+    // Welch
+
+    unsigned long Welch_Frames () { return ( _welchFrames ); }
+    void Welch_Reset () {
+      if ( _welch ) for ( uint16_t k = 0; k < N / 2; k++ ) _welch [ k ] = 0;
+      _welchFrames = 0;
+      _welchExponent = 0;
+      _welchMask = 0;
+    }
+    // the mean power of bin k over the frames, in sample units squared, as out of the FFT
+    float Welch_Power ( uint16_t k ) {
+      if ( ! _welchFrames ) return ( 0.0f );
+      return ( ldexp ( ( float ) _welch [ k ], _welchExponent ) / _welchFrames );
+    }
+    // the one-sided power spectral density at bin k, in units^2 / Hz
+    float Welch_PSD ( uint16_t k, float F_sampling ) {
+      return ( ( k ? 2.0f : 1.0f ) * Welch_Power ( k ) / ( F_sampling * _windowPower ) );
+    }
+    // the mean square of the signal within bins first .. end - 1
+    float Welch_Mean_Square ( uint16_t first, uint16_t end ) {
+      float sum = 0.0f;
+      for ( uint16_t k = first; k < end && k < N / 2; k++ ) sum += ( k ? 2.0f : 1.0f ) * Welch_Power ( k );
+      return ( sum / ( ( float ) N * _windowPower ) );
+    }
+
+  private:
+    // more than one byte on the AVR: read until two reads agree ( as in cbmAcquisition.h )
+    unsigned long _Written () {
+      unsigned long a, b;
+      do { a = _written; b = _written; } while ( a != b );
+      return ( a );
+    }
+    static void _Load ( int16_t & x, int16_t q ) { x = q; }
+    static void _Load ( int32_t & x, int16_t q ) { x = ( int32_t ) q << 16; }
+
+    void _Row () {
+      uint8_t nBands = _bands->Bands ();
+      uint8_t * cells = _cells + ( uint32_t ) _row * nBands;
+      for ( uint8_t b = 0; b < nBands; b++ ) {
+        // 10 log10 ( p 2^e ), less the floor, in 1/16 dB, then in half dB
+        int32_t level = _bandPower [ b ] ? ( int32_t ) FFT_dB_Q4 ( _bandPower [ b ], _exponent ) - _floorQ4 : 0;
+        cells [ b ] = level <= 0 ? 0 : ( level >= 255L * 8 ? 255 : ( uint8_t ) ( ( level + 4 ) >> 3 ) );
+      }
+      _row = ( _row + 1 ) % _rows;
+      if ( _rowsFilled < _rows ) _rowsFilled++;
+    }
+
+    // sums in block floating point: the sums and the power added to them are each
+    // kept under 2^30, so that no sum overflows, by shifting both down as need be
+    void _Welch () {
+      uint32_t pmask = 0;
+      for ( uint16_t k = 0; k < N / 2; k++ ) pmask |= _power [ k ];
+      if ( _welchFrames == 0 ) _welchExponent = _exponent;
+      if ( _exponent > _welchExponent ) {
+        uint8_t up = _exponent - _welchExponent;
+        for ( uint16_t k = 0; k < N / 2; k++ ) _welch [ k ] = up >= 32 ? 0 : _welch [ k ] >> up;
+        _welchMask = up >= 32 ? 0 : _welchMask >> up;
+        _welchExponent = _exponent;
+      }
+      int down = _welchExponent - _exponent;
+      uint8_t rescale = 0;
+      while ( ( _welchMask >> 30 ) || ( ( down < 32 ) && ( ( pmask >> down ) >> 30 ) ) ) {
+        _welchMask >>= 1;
+        down++;
+        rescale++;
+      }
+      _welchExponent += rescale;
+      _welchMask = 0;
+      for ( uint16_t k = 0; k < N / 2; k++ ) {
+        uint32_t sum = ( _welch [ k ] >> rescale ) + ( down >= 32 ? 0 : _power [ k ] >> down );
+        _welch [ k ] = sum;
+        _welchMask |= sum;
+      }
+      _welchFrames++;
+    }
+
+    volatile int16_t * _ring;
+    uint16_t _mask, _hop;
+    volatile unsigned long _written;      // by Push
+    unsigned long _next;                  // the first sample of the next frame
+    T * _frame;
+    uint32_t * _power;
+    const int16_t * _window;
+    float _windowPower;                   // the sum of w^2
+    FFT_Bands * _bands;
+    uint32_t * _bandPower;
+    uint8_t * _cells;
+    uint16_t _rows, _row, _rowsFilled;
+    int16_t _floorQ4;                     // in 1/16 dB
+    uint32_t * _welch;
+    uint32_t _welchMask;
+    int _welchExponent;
+    unsigned long _welchFrames;
+    unsigned long _frames, _overruns;
+    int _exponent;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+	FFT_Match v0.1
+	Charles B. Malloch, PhD
+	2026-10-17
+
+	FFTloop's voice capture, matched against as many words as fit on the SD
+	card, rather than the one in EEPROM. Say a word, then:
+	  r   record it, as word0, word1, ...
+	  m   print what the last one matched, and how well
+	  d   dynamic time warping instead of correlation, and back
+	The words stay in WORDS.SPG from one run to the next.
+
+	FFT.h takes 1 KB of RAM for its spectrogram, the copy being matched
+	another 1 KB, and SD 600 bytes or so for its buffer: this wants more
+	than the 2 KB of an Uno ( a Mega, say ).
+	With a fixed vocabulary, FFT_Flash_Store keeps the words in flash instead.
+*/
+
+#define BAUDRATE 115200
+
+#include <SPI.h>
+#include <SD.h>
+#include <FFT.h>
+
+#define pdSDCS 10
+#define MAX_WORDS 32
+
+File words;
+uint32_t offsets [ MAX_WORDS ];
+FFT_File_Store<File> store ( words, offsets, MAX_WORDS );
+int8_t frame [ NBR_FRQ ];
+uint32_t rows [ 2 * TIME_SZ ];
+int8_t matchCells [ TIME_SZ * NBR_FRQ ];          // the capture, as FFTloop matches it
+FFT_Matcher matcher ( store, frame, rows );
+bool warping = false;
+
+void setup () {
+  Serial.begin ( BAUDRATE );
+  if ( ! SD.begin ( pdSDCS ) ) {
+    Serial.println ( F ( "No SD card" ) );
+    while ( 1 ) delay ( 10 );
+  }
+  words = SD.open ( "WORDS.SPG", FILE_WRITE );
+  Serial.print ( store.Begin () );
+  Serial.println ( F ( " words" ) );
+
+  FFT_matcher = &matcher;
+  FFT_match_cells = matchCells;
+  FFTsetup ();
+  Serial.println ( "Arduino ready" );
+}
+
+void loop () {
+  FFTloop ();
+
+  if ( Serial.available () > 0 ) {
+    uint8_t incomingByte = Serial.read ();
+    if ( incomingByte == 'r' ) {
+      char label [ FFT_LABEL_LEN + 1 ];
+      snprintf ( label, sizeof ( label ), "word%u", store.Count () );
+      Serial.print ( store.Add ( label, FFT_spectrogram ) < 0 ? F ( "not recorded: " ) : F ( "recorded " ) );
+      Serial.println ( label );
+    }
+    if ( incomingByte == 'm' ) {
+      Serial.print ( FFT_match.index < 0 ? "-" : FFT_match.label );
+      Serial.print ( "\t" );
+      Serial.print ( FFT_match.score, 3 );
+      Serial.print ( "\t" );
+      Serial.print ( FFT_match.compared );
+      Serial.print ( " compared, " );
+      Serial.print ( FFT_match.abandoned );
+      Serial.println ( " abandoned" );
+    }
+    if ( incomingByte == 'd' ) {
+      warping = ! warping;
+      matcher.Set_Method ( warping ? FFT_MATCH_DTW : FFT_MATCH_NCC, 8 );
+      Serial.println ( warping ? F ( "DTW" ) : F ( "NCC" ) );
+    }
+  }
+}
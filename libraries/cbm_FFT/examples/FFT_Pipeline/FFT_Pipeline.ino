@@ -0,0 +1,47 @@
+/*
+	FFT_Pipeline v0.1
+	Charles B. Malloch, PhD
+	2026-10-17
+
+	Sixteen logarithmic bands of the spectrum on A0, 256 points at 4 kHz with
+	a Hann window, printed as dB. analogRead () paced by micros (): no timers
+	taken, so this runs on the ESP8266 and Teensy as well as the AVR.
+*/
+
+#define BAUDRATE 115200
+
+#include <FFT_Pipeline.h>
+
+#define N 256
+#define N_BANDS 16
+
+int16_t frame [ N ];
+int16_t hann [ N / 2 + 1 ];
+uint32_t power [ N / 2 ];
+uint16_t edges [ N_BANDS + 1 ];
+uint32_t bands [ N_BANDS ];
+
+FFT_Analog_Source adc ( A0, 250UL );
+FFT_Bands octaves ( edges, N_BANDS );
+FFT_Pipeline<N> spectrum ( adc, frame, power );
+
+void setup () {
+  Serial.begin ( BAUDRATE );
+  FFT_Window::Make ( hann, N, FFT_WINDOW_HANN );
+  octaves.Set_Log ( 1, N / 2 );
+  spectrum.Set_Window ( hann );
+  spectrum.Set_Bands ( &octaves, bands );
+  Serial.println ( "Arduino ready" );
+}
+
+void loop () {
+  if ( spectrum.Poll () ) {
+    // dB re 1 count of the ADC, squared
+    float ref = 10.0 * log10 ( 2.0 ) * ( spectrum.Exponent () - 12 );
+    for ( int b = 0; b < N_BANDS; b++ ) {
+      Serial.print ( "\t" );
+      Serial.print ( bands [ b ] ? 10.0 * log10 ( bands [ b ] ) + ref : 0.0, 1 );
+    }
+    Serial.println ();
+  }
+}
@@ -95,6 +95,7 @@ void LSM303DLH::init ( int acc_scale, int SA0_bridge_value_in ) {
 
   // _printer->println ( "init 0" );
   // change to 0x47 for low-power mode output data rate 0.5 Hz
+  _odr_bits = 0x00;  // 50 Hz; see setDataRate
   write ( 0b00100111, REG_BASE_ADDR_ACC, CTRL_REG1_A );  // 0x27 = normal power mode, all accel axes on
   // _printer->println ( "init 1" );
   _acc_scale_bits = 0x00;
@@ -109,6 +110,9 @@ void LSM303DLH::init ( int acc_scale, int SA0_bridge_value_in ) {
       _acc_scale_bits = 0x00;
       break;
   }
+  // BDU: the output registers are not updated until both bytes of each have
+  // been read, so a burst never mixes two samples; FS1-FS0: the full scale
+  write ( 0x80 | ( _acc_scale_bits << 4 ), REG_BASE_ADDR_ACC, CTRL_REG4_A );
     
   write ( 0x00, REG_BASE_ADDR_MAG, CRA_REG_M );  // 0x1c = D02-D00; 0x03 = MS1-MS0
   write ( 0x20, REG_BASE_ADDR_MAG, CRB_REG_M );  // 0x20 = GN2-GN0 -> highest gain
@@ -124,11 +128,72 @@ void LSM303DLH::init ( int acc_scale, int SA0_bridge_value_in ) {
 //************************************************************************************************
 
 
+bool LSM303DLH::getAccelRaw ( int16_t * xyz ) {
+  byte b [ 6 ];
+  // the MSB of the sub-address makes the accelerometer auto-increment
+  if ( ! readBurst ( REG_BASE_ADDR_ACC, OUT_X_L_A | 0x80, b, 6 ) ) {
+    xyz [ X_COORD ] = xyz [ Y_COORD ] = xyz [ Z_COORD ] = 0;
+    return false;
+  }
+  // low byte first
+  xyz [ X_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 1 ] << 8 ) | b [ 0 ] );
+  xyz [ Y_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 3 ] << 8 ) | b [ 2 ] );
+  xyz [ Z_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 5 ] << 8 ) | b [ 4 ] );
+  return true;
+}
+
+bool LSM303DLH::getMagRaw ( int16_t * xyz ) {
+  byte b [ 6 ];
+  // the magnetometer always auto-increments
+  if ( ! readBurst ( REG_BASE_ADDR_MAG, OUT_X_H_M, b, 6 ) ) {
+    xyz [ X_COORD ] = xyz [ Y_COORD ] = xyz [ Z_COORD ] = 0;
+    return false;
+  }
+  // high byte first
+  xyz [ X_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 0 ] << 8 ) | b [ 1 ] );
+  xyz [ Y_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 2 ] << 8 ) | b [ 3 ] );
+  xyz [ Z_COORD ] = ( int16_t ) ( ( ( uint16_t ) b [ 4 ] << 8 ) | b [ 5 ] );
+  return true;
+}
+
+float LSM303DLH::accelScale () {
+  // 2^15 = 1024 * 32
+  return _acc_scales [ _acc_scale_bits ] / 32768.0;
+}
+
+bool LSM303DLH::setDataRate ( int rate_Hz ) {
+  switch ( rate_Hz ) {
+    case   50: _odr_bits = 0x00; break;
+    case  100: _odr_bits = 0x01; break;
+    case  400: _odr_bits = 0x02; break;
+    case 1000: _odr_bits = 0x03; break;
+    default: return false;
+  }
+  // DR1-DR0 are bits 4-3; normal power mode, all axes on as in init
+  write ( 0b00100111 | ( _odr_bits << 3 ), REG_BASE_ADDR_ACC, CTRL_REG1_A );
+  return true;
+}
+
+int LSM303DLH::dataRate () {
+  const int rates [ 4 ] = { 50, 100, 400, 1000 };
+  return rates [ _odr_bits & 0x03 ];
+}
+
+bool LSM303DLH::accelReady ( bool * overrun ) {
+  // ZYXDA: a new X, Y, Z sample; ZYXOR: one was overwritten before it was read
+  byte status = read ( REG_BASE_ADDR_ACC, STATUS_REG_A );
+  if ( overrun ) *overrun = ( status & 0x80 ) != 0;
+  return ( status & 0x08 ) != 0;
+}
+
+void LSM303DLH::setDataReadyInterrupt ( bool enable ) {
+  // I1_CFG1-I1_CFG0 = 10: data ready on INT1, active high, push-pull
+  write ( enable ? 0x02 : 0x00, REG_BASE_ADDR_ACC, CTRL_REG3_A );
+}
+
 void LSM303DLH::getAccel ( float * _acceleration_vector_components_g ) {
   int16_t regs [ 3 ];
-  regs [ 0 ] = ( ( int16_t ) read ( REG_BASE_ADDR_ACC, OUT_X_H_A ) << 8 ) | (read ( REG_BASE_ADDR_ACC, OUT_X_L_A ) );
-  regs [ 1 ] = ( ( int16_t ) read ( REG_BASE_ADDR_ACC, OUT_Y_H_A ) << 8 ) | (read ( REG_BASE_ADDR_ACC, OUT_Y_L_A ) );
-  regs [ 2 ] = ( ( int16_t ) read ( REG_BASE_ADDR_ACC, OUT_Z_H_A ) << 8 ) | (read ( REG_BASE_ADDR_ACC, OUT_Z_L_A ) );
+  getAccelRaw ( regs );
   
   #if LSM303DLH_VERBOSE >= 30
     _printer->print ( "\nAccelerometer vector unmapped: ( " );
@@ -148,8 +213,7 @@ void LSM303DLH::getAccel ( float * _acceleration_vector_components_g ) {
   rawValues [ Y_COORD ] = ( int ) regs [ 1 ];
   rawValues [ Z_COORD ] = ( int ) regs [ 2 ];
   
-  // 2^15 = 1024 * 32
-  float scaler = _acc_scales [ _acc_scale_bits ] / 32768.0;
+  float scaler = accelScale ();
   _acceleration_vector_components_g [ X_COORD ] = rawValues [ X_COORD ] * scaler;
   _acceleration_vector_components_g [ Y_COORD ] = rawValues [ Y_COORD ] * scaler;
   _acceleration_vector_components_g [ Z_COORD ] = rawValues [ Z_COORD ] * scaler;
@@ -241,12 +305,7 @@ void LSM303DLH::getMag ( float * _magnetic_field_components_gauss ) {
   #endif
  
   int16_t regs [ 3 ];
-  regs [ 0 ] = ( ( int16_t ) read ( REG_BASE_ADDR_MAG, OUT_X_H_M ) << 8 ) 
-                         | ( read ( REG_BASE_ADDR_MAG, OUT_X_L_M ) );
-  regs [ 1 ] = ( ( int16_t ) read ( REG_BASE_ADDR_MAG, OUT_Y_H_M ) << 8 ) 
-                         | ( read ( REG_BASE_ADDR_MAG, OUT_Y_L_M ) );
-  regs [ 2 ] = ( ( int16_t ) read ( REG_BASE_ADDR_MAG, OUT_Z_H_M ) << 8 ) 
-                         | ( read ( REG_BASE_ADDR_MAG, OUT_Z_L_M ) );
+  getMagRaw ( regs );
   
   #if LSM303DLH_VERBOSE >= 30
     _printer->print ( "\n                                      Magnetometer vector unmapped: " );
@@ -456,6 +515,16 @@ byte LSM303DLH::read ( int device_address, byte register_address ) {
   return data;
 }
 
+bool LSM303DLH::readBurst ( byte device_address, byte register_address, byte * buf, byte n ) {
+  // one transaction: the sub-address, a repeated start, then n bytes
+  Wire.beginTransmission ( device_address );
+  Wire.write ( register_address );
+  if ( Wire.endTransmission ( false ) != 0 ) return false;
+  if ( Wire.requestFrom ( ( int ) device_address, ( int ) n ) != n ) return false;
+  for ( byte i = 0; i < n; i++ ) buf [ i ] = Wire.read ();
+  return true;
+}
+
 void LSM303DLH::write ( byte data, byte device_address, byte register_address ) {
   #if LSM303DLH_VERBOSE >= 30
     _printer->print ( "W: d " );
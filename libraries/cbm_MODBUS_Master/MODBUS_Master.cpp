@@ -46,6 +46,14 @@
 //################## MODBUS ###################
 
 MODBUS_Master::MODBUS_Master () {
+  #if ! defined(ATtiny85)
+    _VERBOSITY = 0;
+  #endif
+  _bufPtr = 0;
+  _error = 0;
+  _waiting = false;
+  _busQuietSince_us = 0;
+  Set_Baud ( MBM_DEFAULT_BAUD );
 }
 
 MODBUS_Master::MODBUS_Master( 
@@ -69,6 +77,10 @@ void MODBUS_Master::Init  (
   _bufPtr = 0;
 	_error = 0;
   
+  _waiting = false;
+  _busQuietSince_us = micros ();
+  Set_Baud ( MBM_DEFAULT_BAUD );
+  
 }
 
 // ******************************************************************************
@@ -87,316 +99,529 @@ int appendShort ( unsigned char * buffer, int bufPtr, short value );
 int MODBUS_Master::Read_Coils ( unsigned char slave_address, short startCoil, short nCoils, short * values, short lenValues ) {
 
   //   1 0x01 read_coils        < ss 01 aaaa nnnn cccc >             -> < ss 01 bc xx ... cccc >
-
-  //   memcpy ( strBuf485, "\x01\x05\x00\x00\x00\x01\x00\x00", 8 );
-  
-  // length of command will be 1 (slave address) + 1 (command) + 2 (startCoil) + 2 (nCoils) 
-  //                          + (added later) 2 (CRC16)
-  //                   = 8
-  
-  int msgLen = 8;
-  int nBytes = ( nCoils + 7 ) >> 3;
-  int expectedReplyLen = 5 + nBytes;
-  
   // lenValues is in units of shorts, which are 2 bytes each
-  if ( ( msgLen > MODBUS_MASTER_BUF_LEN ) || ( nBytes > ( lenValues << 1 ) ) ) {
-    _error = -1;
-    return ( _error );
-  }
   
-  _bufPtr = 0;
-  
-  // construct message
-  _strBuf [ _bufPtr++ ] = slave_address;
-  _strBuf [ _bufPtr++ ] = 0x01;            // function code: write single coil
-  _bufPtr = appendShort ( _strBuf, _bufPtr, startCoil );
-  _bufPtr = appendShort ( _strBuf, _bufPtr, nCoils );
-  
-  _MODBUS_port.Send ( _strBuf, msgLen - 2 );  // Send expects the length to exclude the CRC, which it places
-  _bufPtr = 0;  
+  MBM_Request r = { slave_address, 0x01, startCoil, nCoils, values, lenValues };
+  return ( _Run ( r ) );
 
-  if ( _VERBOSITY >= 6 ) {
-    _diagnostic_port->print ( F ( "        Read " ) ); 
-    _diagnostic_port->print ( nCoils );
-    _diagnostic_port->print ( F ( " coils, starting with " ) );
-    _diagnostic_port->println ( startCoil );
+}
 
-    // _diagnostic_port->print (F ( "        Sent: " ));
-    _diagnostic_port->print ( '\n' );
-  }
 
-  // actual port writing is asynchronous; at 57600 baud, it will take 1/5760 sec per char, or 1/6 ms per char
-  delay ( 1 + msgLen / 6 );
-  
-  for ( int i = 0; i < msgLen; i++ ) _strBuf [ i ] = 0x77;
-  delay ( 20 );
-      
-  GetReply();
-  
-  if ( ( _receive_status == 0 ) && ( _bufPtr >= expectedReplyLen ) ) {
-  
-    if ( _VERBOSITY >= 7 ) {
-      for ( int i = 0; i < _strBuf [ 2 ]; i++ ) {
-        _diagnostic_port->print ( F ( " 0x" ) ); _diagnostic_port->print ( _strBuf [ i + 3 ], HEX );
-      }
-    }
-    
-    // the reply is in 8-bit bytes, with the first byte representing 
-    //   coils Address+7 - Address in order, the second Address+15 - Address+8, etc.
-    
-    // copy the bytes in order without transposition
-    memcpy ( ( byte * ) values, &_strBuf [ 3 ], nBytes );
-    
-    if ( _VERBOSITY >= 7 ) {
-      _diagnostic_port->print ( F ( " -> " ) );
-      for ( int i = 0; i < 4; i++ ) {
-        _diagnostic_port->print ( F ( " 0x" ) ); 
-        _diagnostic_port->print ( * ( ( byte * ) values + i ), HEX );
-      }
-      _diagnostic_port->println ();
-    }
-    
-  } else {
-    // _receive_status != 0 or reply too short
-    
-  
-    if ( _receive_status != 0 ) {
-      if ( _VERBOSITY >= 2 ) {
-        _diagnostic_port->print ( F ( "Bad reply: discarding and resetting receive status of 0x" ) );
-        _diagnostic_port->println ( _receive_status, HEX);
-      }
-      _error |= 0x01;
-    }
-    if ( _bufPtr < expectedReplyLen ) {
-        // reply too short
-      if ( _VERBOSITY >= 2 ) {
-        _diagnostic_port->print ( F ( "Bad reply: reply len ( " ) );
-        _diagnostic_port->print ( _bufPtr );
-        _diagnostic_port->print ( F ( " ) < required ( " ) );
-        _diagnostic_port->print ( expectedReplyLen );
-        _diagnostic_port->println ( F ( " )" ) );
-      }
-      _error |= 0x02;
-    }
-    
-    _receive_status = 0;
-    _bufPtr = 0;
-  }
-    
-  return ( _error );  
+void MODBUS_Master::Write_Single_Coil ( unsigned char slave_address, short coilNo, short value ) {
+
+  MBM_Request r = { slave_address, 0x05, coilNo, value };
+  _Run ( r );
 
 }
 
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
 
-void MODBUS_Master::Write_Single_Coil ( unsigned char slave_address, short coilNo, short value ) {
+void MODBUS_Master::Write_Regs ( unsigned char slave_address, short startReg, short nRegs, short values[] ) {
+
+  MBM_Request r = { slave_address, 0x10, startReg, nRegs, values, nRegs };
+  _Run ( r );
+
+}
 
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
 
-  //   memcpy ( strBuf485, "\x01\x05\x00\x00\x00\x01\x00\x00", 8 );
+int MODBUS_Master::Read_Reg ( unsigned char slave_address, short startReg, short nRegs, short * values, short lenValues ) {
+
+  // lenValues is in units of register_size, which is 2 bytes
+  // see http://www.simplymodbus.ca/FC04.htm
+
+  // return value of _error:
+  //   -1 -> insufficient buffer length, either send buffer or destination vector (values)
+  //   bit 0 -> failed receipt from slave ( bad CRC, or an exception reply )
+  //   bit 1 -> reply too short, or none at all
+  
+  MBM_Request r = { slave_address, 0x04, startReg, nRegs, values, lenValues };
+  return ( _Run ( r ) );
   
-  // length of command will be 1 (slave address) + 1 (command) + 2 (coilNo) + 2 (nRegs) 
-  //                          + 2 (data) + (added later) 2 (CRC16)
-  //                   = 10
+}
+
+int MODBUS_Master::Read_Write_Regs ( unsigned char slave_address, short readStart, short nRead, short * readValues,
+                                     short writeStart, short nWrite, short writeValues[] ) {
+
+  //  0x17 read_write_regs   < ss 17 rrrr nnnn wwww mmmm bc vvvv ... cccc > -> < ss 17 bc xxxx ... cccc >
+  // the request carries both halves in one array: the values to write, then those read
   
-  int msgLen = 10;  // 8 -> 10 2014-02-21
-  if ( msgLen > MODBUS_MASTER_BUF_LEN ) {
+  short values [ MODBUS_MASTER_BUF_LEN / 2 ];
+  if ( ( nRead < 0 ) || ( nWrite < 0 ) || ( nRead + nWrite > MODBUS_MASTER_BUF_LEN / 2 ) ) {
     _error = -1;
-    return;
+    return ( _error );
   }
+  for ( int i = 0; i < nWrite; i++ ) values [ i ] = writeValues [ i ];
+  MBM_Request r = { slave_address, 0x17, readStart, nRead, values, ( short ) ( nWrite + nRead ) };
+  r.writeStart = writeStart;
+  r.nWrite = nWrite;
+  _Run ( r );
+  if ( _error == 0 ) {
+    for ( int i = 0; i < nRead; i++ ) readValues [ i ] = values [ nWrite + i ];
+  }
+  return ( _error );
   
-  _bufPtr = 0;
-  
-  // construct message
-  _strBuf [ _bufPtr++ ] = slave_address;
-  _strBuf [ _bufPtr++ ] = 0x05;            // function code: write single coil
-  _bufPtr = appendShort ( _strBuf, _bufPtr, coilNo );
-  _bufPtr = appendShort ( _strBuf, _bufPtr, value );
-  
-  _MODBUS_port.Send ( _strBuf, msgLen - 2 );  // Send expects the length to exclude the CRC, which it places
-  
-  // actual port writing is asynchronous; at 57600 baud, it will take 1/5760 sec per char, or 1/6 ms per char
-  delay ( 1 + msgLen / 6 );
-      
-  GetReply();
-
 }
 
 // ******************************************************************************
 // ******************************************************************************
 // ******************************************************************************
 
-void MODBUS_Master::Write_Regs ( unsigned char slave_address, short startReg, short nRegs, short values[] ) {
+// the blocking calls: queue the request behind any others, and poll until it's done
 
+static void blockingDone ( MBM_Request & request ) {
+  // context is the caller's copy of the request, which it is watching
+  * ( MBM_Request * ) request.context = request;
+}
 
-  // memcpy ( strBuf485, "\x01\x10\x00\x00\x00\x02\x04\xff\xff\xff\xff\x00\x00", 13 );
-  
-  // length of command will be 1 (slave address) + 1 (command) + 2 (starting reg) + 2 (nRegs) + 1 (byte count) 
-  //                          + 2 * nRegs (data) + (added later) 2 (CRC16)
-  //                   = 9 + 2 * nRegs
-  
-  int msgLen = 9 + 2 * nRegs;
-  if ( msgLen > MODBUS_MASTER_BUF_LEN ) {
-    _error = -1;
-    return;
+int MODBUS_Master::_Run ( MBM_Request & request ) {
+
+  request.status = _Check ( request );
+  if ( request.status == MBM_PENDING ) {
+    MBM_Request r = request;
+    r.done = blockingDone;
+    r.context = &request;
+    // if the queue is full, let the requests ahead of this one finish
+    while ( ! Queue ( r ) ) { Poll (); yield (); }
+    while ( request.status == MBM_PENDING ) { Poll (); yield (); }
   }
   
-  _bufPtr = 0;
-  
-  // construct message
-  _strBuf [ _bufPtr++ ] = slave_address;
-  _strBuf [ _bufPtr++ ] = 0x10;            // function code: write multiple registers
-  _bufPtr = appendShort ( _strBuf, _bufPtr, startReg );
-  _bufPtr = appendShort ( _strBuf, _bufPtr, nRegs );
-  _strBuf [ _bufPtr++ ] = 2 * nRegs;       // data byte count
-  for ( short i = 0; i < nRegs; i++ ) {
-    _bufPtr = appendShort ( _strBuf, _bufPtr, values [ i ] );
+  switch ( request.status ) {
+    case MBM_OK:
+      _error = 0;
+      break;
+    case MBM_TOO_LONG:
+      _error = -1;
+      break;
+    case MBM_TIMEOUT:
+    case MBM_SHORT:
+      _error = 0x02;
+      break;
+    default:
+      _error = 0x01;
+      break;
   }
+  return ( _error );
   
-  _MODBUS_port.Send ( _strBuf, msgLen - 2 );  // Send expects the length to exclude the CRC, which it places
+}
+
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+// the asynchronous interface
+
+void MODBUS_Master::Set_Baud ( unsigned long baud, unsigned long replyTimeout_us ) {
+  // a character is 11 bits ( start, 8 data, parity or a second stop, stop );
+  // above 19200 baud the standard fixes the gap at 1750 us
+  if ( baud > 19200 || baud == 0 ) {
+    _t35_us = 1750;
+  } else {
+    _t35_us = ( 35UL * 11UL * 100000UL ) / baud;
+  }
+  _replyTimeout_us = replyTimeout_us;
+}
+
+int MODBUS_Master::_Check ( const MBM_Request & request ) {
+
+  // MBM_PENDING if the request and its reply fit, else why not
+  
+  // request: 1 (slave address) + 1 (function) + 2 (start) + 2 (count or value) 
+  //          [ + 1 (byte count) + 2 * nRegs (data) for 0x10 ] + 2 (CRC16)
+  // reply:   1 (slave address) + 1 (function) + 1 (n data bytes) + < the data bytes > + 2 (CRC16)
+  //          for reads; an echo of the first 6 bytes plus the CRC for writes
+  
+  int msgLen = 8, replyLen = 8;
+  if ( ( request.n < 0 ) && ( request.function != 0x41 ) ) return ( MBM_TOO_LONG );
+  switch ( request.function ) {
+    case 0x01:
+      replyLen = 5 + ( ( request.n + 7 ) >> 3 );
+      if ( ( ( request.n + 7 ) >> 3 ) > ( request.lenValues << 1 ) ) return ( MBM_TOO_LONG );
+      break;
+    case 0x03:
+    case 0x04:
+      replyLen = 5 + 2 * request.n;
+      if ( request.n > request.lenValues ) return ( MBM_TOO_LONG );
+      break;
+    case 0x05:
+      break;
+    case 0x10:
+      msgLen = 9 + 2 * request.n;
+      break;
+    case 0x17:
+      msgLen = 13 + 2 * request.nWrite;
+      replyLen = 5 + 2 * request.n;
+      if ( ( request.n < 1 ) || ( request.nWrite < 1 ) ) return ( MBM_TOO_LONG );
+      if ( request.nWrite + request.n > request.lenValues ) return ( MBM_TOO_LONG );
+      break;
+    case 0x2B:
+      // n is the category; the reply is as long as the slave makes it, up to the buffer
+      msgLen = 7;
+      if ( ( request.n < 1 ) || ( request.n > 4 ) ) return ( MBM_BAD_REPLY );
+      break;
+    case 0x41:
+      // n is a sequence number; the reply is as long as the slave makes it, up to the buffer
+      if ( ( request.start < 0 ) || ( request.start >= request.lenValues ) ) return ( MBM_TOO_LONG );
+      break;
+    default:
+      // not one we know how to ask for
+      return ( MBM_BAD_REPLY );
+  }
+  if ( ( msgLen > MODBUS_MASTER_BUF_LEN ) || ( replyLen > MODBUS_MASTER_BUF_LEN ) ) return ( MBM_TOO_LONG );
+  return ( MBM_PENDING );
   
-  if ( _VERBOSITY >= 7 ) {
-    _diagnostic_port->println (F ( "        Values: " ));
-    for ( int i = 0; i < nRegs; i++ ) {
-      _diagnostic_port->print ( F ( "          " ) ); _diagnostic_port->print ( values [ i ] );
-    }
-    _diagnostic_port->print ( '\n' );
+}
 
-    _diagnostic_port->print (F ( "        Sent: " ));
-    for ( int i = 0; i < msgLen; i++ ) {
-      _diagnostic_port->print ( F ( " 0x" ) ); _diagnostic_port->print ( _strBuf [ i ], HEX );
+bool MODBUS_Master::Queue ( const MBM_Request & request ) {
+  if ( _Check ( request ) != MBM_PENDING ) return ( false );
+  MBM_Request r = request;
+  r.status = MBM_PENDING;
+  r.exception = 0;
+  r.latency_us = 0;
+  return ( _queue.push ( r ) );
+}
+
+bool MODBUS_Master::Queue_Read_Regs ( unsigned char slave_address, short startReg, short nRegs, 
+                                      short * values, short lenValues,
+                                      MBM_Callback done, void * context, 
+                                      unsigned char function ) {
+  MBM_Request r = { slave_address, function, startReg, nRegs, values, lenValues, done, context };
+  return ( Queue ( r ) );
+}
+
+bool MODBUS_Master::Queue_Read_Changes ( unsigned char slave_address, short startReg, unsigned short since,
+                                         short * values, short lenValues,
+                                         MBM_Callback done, void * context ) {
+  //  0x41 read_changes      < ss 41 aaaa SSSS cccc >     -> < ss 41 bc QQQQ NNNN { rrrr nn dddd ... } ... cccc >
+  MBM_Request r = { slave_address, 0x41, startReg, ( short ) since, values, lenValues, done, context };
+  return ( Queue ( r ) );
+}
+
+bool MODBUS_Master::Queue_Read_Write_Regs ( unsigned char slave_address, short readStart, short nRead,
+                                            short writeStart, short nWrite, short * values, short lenValues,
+                                            MBM_Callback done, void * context ) {
+  MBM_Request r = { slave_address, 0x17, readStart, nRead, values, lenValues, done, context };
+  r.writeStart = writeStart;
+  r.nWrite = nWrite;
+  return ( Queue ( r ) );
+}
+
+bool MODBUS_Master::Queue_Read_Device_Id ( unsigned char slave_address, unsigned char category, unsigned char objectId,
+                                           short * values, short lenValues,
+                                           MBM_Callback done, void * context ) {
+  //  0x2B read_device_id    < ss 2B 0E dd oo cccc >     -> < ss 2B 0E dd LL mm nn kk { oo ll xx ... } ... cccc >
+  MBM_Request r = { slave_address, 0x2B, objectId, category, values, lenValues, done, context };
+  return ( Queue ( r ) );
+}
+
+int MODBUS_Master::Device_Id_Object ( const MBM_Request & request, unsigned char objectId, char * value, int lenValue ) {
+  // values holds LL mm nn kk, then kk objects of oo ll and ll bytes
+  const unsigned char * bytes = ( const unsigned char * ) request.values;
+  int end = 2 * request.lenValues;
+  int k = 4;
+  for ( int i = 0; ( i < request.n ) && ( k + 2 <= end ); i++ ) {
+    int length = bytes [ k + 1 ];
+    if ( bytes [ k ] == objectId ) {
+      int n = length < lenValue - 1 ? length : lenValue - 1;
+      if ( k + 2 + n > end ) n = end - k - 2;
+      memcpy ( value, &bytes [ k + 2 ], n );
+      value [ n ] = '\0';
+      return ( length );
     }
-    _diagnostic_port->print ( '\n' );
+    k += 2 + length;
   }
+  return ( -1 );
+}
 
-  // actual port writing is asynchronous; at 57600 baud, it will take 1/5760 sec per char, or 1/6 ms per char
-  delay ( 1 + msgLen / 6 );
-      
-  GetReply();
+bool MODBUS_Master::Queue_Read_Coils ( unsigned char slave_address, short startCoil, short nCoils, 
+                                       short * values, short lenValues,
+                                       MBM_Callback done, void * context ) {
+  MBM_Request r = { slave_address, 0x01, startCoil, nCoils, values, lenValues, done, context };
+  return ( Queue ( r ) );
+}
 
+bool MODBUS_Master::Queue_Write_Regs ( unsigned char slave_address, short startReg, short nRegs, short values[],
+                                       MBM_Callback done, void * context ) {
+  MBM_Request r = { slave_address, 0x10, startReg, nRegs, values, nRegs, done, context };
+  return ( Queue ( r ) );
 }
 
-// ******************************************************************************
-// ******************************************************************************
-// ******************************************************************************
+bool MODBUS_Master::Queue_Write_Single_Coil ( unsigned char slave_address, short coilNo, short value,
+                                              MBM_Callback done, void * context ) {
+  // n carries the coil's new state
+  MBM_Request r = { slave_address, 0x05, coilNo, value, NULL, 0, done, context };
+  return ( Queue ( r ) );
+}
 
-int MODBUS_Master::Read_Reg ( unsigned char slave_address, short startReg, short nRegs, short * values, short lenValues ) {
+int MODBUS_Master::Pending () {
+  return ( _queue.size () + ( _waiting ? 1 : 0 ) );
+}
 
-  // standard Arduino shorts are 1 byte; ints are 2 bytes; standard floats are 4 bytes.
-  // lenValues is in units of register_size, which is 2 bytes
-  
-  // memcpy ( strBuf485, "\x01\x10\x00\x00\x00\x02\x04\xff\xff\xff\xff\x00\x00", 13 );
-  
-  // length of command will be 1 (slave address) + 1 (command) + 2 (reg) + 2 (nRegs)
-  //                          + (added later) 2 (CRC16)
-  //                   = 8
+void MODBUS_Master::Poll () {
+
+  int c;
+  
+  if ( _waiting ) {
+    // the time before looking, so that finding nothing means quiet until then
+    unsigned long now = micros ();
+    bool any = false;
+    // take whatever has arrived, without waiting for more
+    while ( ( c = _MODBUS_port._RS485.read () ) >= 0 ) {
+      any = true;
+      _lastByteAt_us = micros ();
+      if ( _bufPtr >= MODBUS_MASTER_BUF_LEN ) {
+        _Finish ( MBM_TOO_LONG );
+        return;
+      }
+      _strBuf [ _bufPtr++ ] = c;
+      // high order bit of command code in reply indicates an exception: 
+      // slave, function | 0x80, exception code, CRC
+      if ( ( _bufPtr == 2 ) && ( _strBuf [ 1 ] & 0x80 ) ) _expectedLen = 5;
+      // the length of a reply to 0x41 is in its byte count
+      if ( ( _bufPtr == 3 ) && ( _strBuf [ 1 ] == 0x41 ) ) _expectedLen = 5 + _strBuf [ 2 ];
+      // and of one to 0x2B in its objects' lengths, known once the last has begun
+      if ( ( _bufPtr >= 8 ) && ( _strBuf [ 1 ] == 0x2B ) ) _expectedLen = _Device_Id_Length ();
+      if ( _bufPtr >= _expectedLen ) {
+        _Complete ();
+        return;
+      }
+    }
+    if ( any ) return;
+    if ( _bufPtr == 0 ) {
+      if ( ( now - _sentAt_us ) > _replyTimeout_us ) _Finish ( MBM_TIMEOUT );
+    } else if ( ( now - _lastByteAt_us ) > _t35_us ) {
+      // 3.5 characters of silence end a frame, complete or not
+      _Finish ( MBM_SHORT );
+    }
+    return;
+  }
   
-  // length of response will be 1 (slave address) + 1 (command) + 1 (n data bytes) 
-  //                          + < the data bytes > + 2 (CRC16)
-  //                   = 5 + nBytes
+  // idle: anything arriving now belongs to no one, and restarts the 3.5-character gap
+  // that must precede the next request
+  while ( _MODBUS_port._RS485.read () >= 0 ) _busQuietSince_us = micros ();
+  if ( _queue.size () == 0 ) return;
+  if ( ( micros () - _busQuietSince_us ) < _t35_us ) return;
+  _queue.shift ( _current );
+  _Send ();
   
-  // see http://www.simplymodbus.ca/FC04.htm
+}
 
-  // return value of _error:
-  //   -1 -> insufficient buffer length, either send buffer or destination vector (values)
-  //   bit 0 -> failed receipt from slave with status in _receive_status
-  //   bit 1 -> reply too short 
-  
-  int msgLen, expectedReplyLen;
-  msgLen = 8;
-  expectedReplyLen = 5 + 2 * nRegs;
+void MODBUS_Master::_Send () {
+
+  MBM_Request & r = _current;
   
-  _error = 0;
+  // construct message
+  _bufPtr = 0;
+  _strBuf [ _bufPtr++ ] = r.slave;
+  _strBuf [ _bufPtr++ ] = r.function;
+  _bufPtr = appendShort ( _strBuf, _bufPtr, r.start );
+  switch ( r.function ) {
+    case 0x05:
+      // the standard's on is 0xFF00; our slaves take anything but 0
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n ? ( short ) 0xFF00 : 0x0000 );
+      _expectedLen = 8;
+      break;
+    case 0x10:
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n );
+      _strBuf [ _bufPtr++ ] = 2 * r.n;       // data byte count
+      for ( short i = 0; i < r.n; i++ ) {
+        _bufPtr = appendShort ( _strBuf, _bufPtr, r.values [ i ] );
+      }
+      _expectedLen = 8;
+      break;
+    case 0x01:
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n );
+      _expectedLen = 5 + ( ( r.n + 7 ) >> 3 );
+      break;
+    case 0x17:
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n );
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.writeStart );
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.nWrite );
+      _strBuf [ _bufPtr++ ] = 2 * r.nWrite;  // data byte count
+      for ( short i = 0; i < r.nWrite; i++ ) {
+        _bufPtr = appendShort ( _strBuf, _bufPtr, r.values [ i ] );
+      }
+      _expectedLen = 5 + 2 * r.n;
+      break;
+    case 0x2B:
+      // MEI type, category, object id, in place of the start appended above
+      _bufPtr = 2;
+      _strBuf [ _bufPtr++ ] = 0x0E;
+      _strBuf [ _bufPtr++ ] = r.n;
+      _strBuf [ _bufPtr++ ] = r.start;
+      _expectedLen = MODBUS_MASTER_BUF_LEN;
+      break;
+    case 0x41:
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n );
+      _expectedLen = MODBUS_MASTER_BUF_LEN;
+      break;
+    default:  // 0x03, 0x04
+      _bufPtr = appendShort ( _strBuf, _bufPtr, r.n );
+      _expectedLen = 5 + 2 * r.n;
+      break;
+  }
   
-  // lenValues is in units of shorts, which are 2 bytes each
-  if ( ( msgLen > MODBUS_MASTER_BUF_LEN ) || ( nRegs > ( lenValues << 1 ) ) ) {
-    _error = -1;
-    return ( _error );
+  _MODBUS_port.Send ( _strBuf, _bufPtr );  // Send appends the CRC
+  _sentAt_us = _lastByteAt_us = micros ();
+
+  if ( _VERBOSITY >= 6 ) {
+    _diagnostic_port->print ( F ( "        Sent function 0x" ) ); 
+    _diagnostic_port->print ( r.function, HEX );
+    _diagnostic_port->print ( F ( " to slave " ) );
+    _diagnostic_port->print ( r.slave );
+    _diagnostic_port->print ( F ( ": " ) );
+    _diagnostic_port->print ( r.n );
+    _diagnostic_port->print ( F ( " starting with " ) );
+    _diagnostic_port->println ( r.start );
   }
   
   _bufPtr = 0;
+  if ( r.slave == 0 ) {
+    // broadcast: no one replies
+    _Finish ( MBM_OK );
+    return;
+  }
+  _waiting = true;
   
-  // construct message
-  _strBuf [ _bufPtr++ ] = slave_address;
-  _strBuf [ _bufPtr++ ] = 0x04;            // function code: read register
-  _bufPtr = appendShort ( _strBuf, _bufPtr, startReg );
-  _bufPtr = appendShort ( _strBuf, _bufPtr, nRegs  );  // register count
-  
-  _MODBUS_port.Send ( _strBuf, msgLen - 2 );  // Send expects the length to exclude the CRC, which it places
-  _bufPtr = 0;  
+}
 
-  if ( _VERBOSITY >= 6 ) {
-    _diagnostic_port->print ( F ( "        Read " ) ); 
-    _diagnostic_port->print ( nRegs );
-    _diagnostic_port->print ( F ( " regs, starting with " ));
-    _diagnostic_port->println ( startReg );
+void MODBUS_Master::_Complete () {
 
-    // _diagnostic_port->print (F ( "        Sent: " ));
-    _diagnostic_port->print ( '\n' );
-  }
-
-  // actual port writing is asynchronous; at 57600 baud, it will take 1/5760 sec per char, or 1/6 ms per char
-  delay ( 1 + msgLen / 6 );
-  
-  for ( int i = 0; i < msgLen; i++ ) _strBuf [ i ] = 0x77;
-  delay ( 20 );
-      
-  GetReply();
+  MBM_Request & r = _current;
   
-  if ( ( _receive_status == 0 ) && ( _bufPtr >= expectedReplyLen ) ) {
+  // check CRC
+  unsigned short msg_CRC = ( ( _strBuf [ _bufPtr - 1 ] << 8 ) | _strBuf [ _bufPtr - 2 ] );
+  CRC CheckSum;
+  if ( CheckSum.CRC16 ( _strBuf, _bufPtr - 2 ) != msg_CRC ) {
+    _Finish ( MBM_CRC );
+    return;
+  }
+  if ( ( _strBuf [ 0 ] != r.slave ) || ( ( _strBuf [ 1 ] & 0x7f ) != r.function ) ) {
+    _Finish ( MBM_BAD_REPLY );
+    return;
+  }
+  if ( _strBuf [ 1 ] & 0x80 ) {
+    r.exception = _strBuf [ 2 ];
+    _Finish ( MBM_EXCEPTION );
+    return;
+  }
   
-    if ( _VERBOSITY >= 7 ) {
-      for ( int i = 0; i < _strBuf [ 2 ]; i++ ) {
-        _diagnostic_port->print ( F ( " 0x" ) ); _diagnostic_port->print ( _strBuf [ i + 3 ], HEX );
+  switch ( r.function ) {
+    case 0x01:
+    case 0x03:
+    case 0x04:
+    case 0x17:
+      if ( _strBuf [ 2 ] != _expectedLen - 5 ) {
+        _Finish ( MBM_BAD_REPLY );
+        return;
       }
-    }
-    
-    // memcpy ( values, &_strBuf [ 3 ], _strBuf [ 2 ] );  NO NO NO
-    
-    // note that the byte endian-ness has been switched for MODBUS, so we have to gyrate it back
-    for ( int k = 0; k < nRegs; k++ ) {
-      memcpy ( ( byte * ) values + 0 + 2 * k, &_strBuf [ 3 + 1 ] + 2 * k, 1 );
-      memcpy ( ( byte * ) values + 1 + 2 * k, &_strBuf [ 3 + 0 ] + 2 * k, 1 );
-    }
-    
-    if ( _VERBOSITY >= 7 ) {
-      _diagnostic_port->print ( F ( " -> " ) );
-      for ( int i = 0; i < 4; i++ ) {
-        _diagnostic_port->print ( F ( " 0x" ) ); 
-        _diagnostic_port->print ( * ( ( byte * ) values + i ), HEX );
+      if ( r.function == 0x01 ) {
+        // the reply is in 8-bit bytes, with the first byte representing 
+        //   coils Address+7 - Address in order, the second Address+15 - Address+8, etc.
+        // copy the bytes in order without transposition
+        memcpy ( ( byte * ) r.values, &_strBuf [ 3 ], _strBuf [ 2 ] );
+      } else {
+        // MODBUS registers are big-endian; for 0x17 they follow the values written
+        short * values = r.values + ( r.function == 0x17 ? r.nWrite : 0 );
+        for ( int k = 0; k < r.n; k++ ) {
+          values [ k ] = ( _strBuf [ 3 + 2 * k ] << 8 ) | _strBuf [ 4 + 2 * k ];
+        }
       }
-      _diagnostic_port->println ();
-    }
-    
-  } else {
-    // _receive_status != 0 or reply too short
-    
-  
-    if ( _receive_status != 0 ) {
-      if ( _VERBOSITY >= 2 ) {
-        _diagnostic_port->print ( F ( "Bad reply: discarding and resetting receive status of 0x" ) );
-        _diagnostic_port->println ( _receive_status, HEX);
+      break;
+    case 0x2B:
+      {
+        // 0E dd LL mm nn kk, and the objects, whose lengths _Device_Id_Length has checked
+        int length = _bufPtr - 2 - 4;
+        if ( ( _strBuf [ 2 ] != 0x0E ) || ( _expectedLen != _bufPtr ) || ( length > 2 * r.lenValues ) ) {
+          _Finish ( MBM_BAD_REPLY );
+          return;
+        }
+        memcpy ( ( byte * ) r.values, &_strBuf [ 4 ], length );
+        r.n = _strBuf [ 7 ];
+        r.start = _strBuf [ 5 ] ? _strBuf [ 6 ] : -1;
       }
-      _error |= 0x01;
-    }
-    if ( _bufPtr < expectedReplyLen ) {
-        // reply too short
-      if ( _VERBOSITY >= 2 ) {
-        _diagnostic_port->print ( F ( "Bad reply: reply len ( " ) );
-        _diagnostic_port->print ( _bufPtr );
-        _diagnostic_port->print ( F ( " ) < required ( " ) );
-        _diagnostic_port->print ( expectedReplyLen );
-        _diagnostic_port->println ( F ( " )" ) );
+      break;
+    case 0x41:
+      {
+        // QQQQ NNNN, then runs of rrrr nn and nn values, each into the image at its register
+        int end = _bufPtr - 2;
+        if ( ( _strBuf [ 2 ] != _expectedLen - 5 ) || ( end < 7 ) ) {
+          _Finish ( MBM_BAD_REPLY );
+          return;
+        }
+        for ( int k = 7; k < end; ) {
+          if ( k + 3 > end ) {
+            _Finish ( MBM_BAD_REPLY );
+            return;
+          }
+          int reg = ( _strBuf [ k ] << 8 ) | _strBuf [ k + 1 ];
+          int count = _strBuf [ k + 2 ];
+          k += 3;
+          if ( ( k + 2 * count > end ) || ( reg + count > r.lenValues ) ) {
+            _Finish ( MBM_BAD_REPLY );
+            return;
+          }
+          for ( int j = 0; j < count; j++, k += 2 ) {
+            r.values [ reg + j ] = ( _strBuf [ k ] << 8 ) | _strBuf [ k + 1 ];
+          }
+        }
+        r.n = ( _strBuf [ 3 ] << 8 ) | _strBuf [ 4 ];
+        r.start = ( _strBuf [ 5 ] << 8 ) | _strBuf [ 6 ];
       }
-      _error |= 0x02;
+      break;
+    default:
+      // writes are echoed; the CRC has vouched for the echo
+      break;
+  }
+  
+  _Finish ( MBM_OK );
+  
+}
+
+void MODBUS_Master::_Finish ( int status ) {
+
+  unsigned long now = micros ();
+  
+  if ( _VERBOSITY >= 8 ) {
+    _diagnostic_port->print (F ( "        Received: " ));
+    for ( int i = 0; i < _bufPtr; i++ ) {
+      _diagnostic_port->print ( F ( " 0x" ) ); _diagnostic_port->print ( _strBuf [ i ], HEX );
     }
-    
-    _receive_status = 0;
-    _bufPtr = 0;
+    _diagnostic_port->println ();
   }
-    
-  return ( _error );
+  if ( ( status != MBM_OK ) && ( _VERBOSITY >= 2 ) ) {
+    _diagnostic_port->print ( F ( "Bad reply from slave " ) );
+    _diagnostic_port->print ( _current.slave );
+    _diagnostic_port->print ( F ( ": status " ) );
+    _diagnostic_port->print ( status );
+    _diagnostic_port->print ( F ( " after " ) );
+    _diagnostic_port->print ( _bufPtr );
+    _diagnostic_port->println ( F ( " bytes" ) );
+  }
+  
+  _current.status = status;
+  _current.latency_us = now - _sentAt_us;
+  _waiting = false;
+  _busQuietSince_us = now;
+  _bufPtr = 0;
+  if ( _current.done ) _current.done ( _current );
   
 }
 
+int MODBUS_Master::_Device_Id_Length () {
+  // the whole reply's length, once the header of each object has arrived; until then the buffer's
+  int k = 8;
+  for ( int i = 0; i < _strBuf [ 7 ]; i++ ) {
+    if ( k + 2 > _bufPtr ) return ( MODBUS_MASTER_BUF_LEN );
+    k += 2 + _strBuf [ k + 1 ];
+  }
+  return ( k + 2 );
+}
+
 // ******************************************************************************
 // ******************************************************************************
 // ******************************************************************************
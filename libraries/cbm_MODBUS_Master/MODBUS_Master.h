@@ -15,20 +15,134 @@
   
   Written by Charles B. Malloch, PhD  2013-02-21
   
+  Asynchronous use
+  
+    Each of Read_Reg, Read_Coils, Write_Regs, and Write_Single_Coil sends its
+    request and waits for the reply before it returns, so a poll of N slaves
+    costs N round trips of CPU time. Instead, queue the requests and call
+    Poll () from loop (); each call does what can be done without waiting and
+    returns, and each request's callback is called when it completes:
+    
+      short temps [ 8 ] [ 2 ];
+      void gotTemp ( MBM_Request & r ) {
+        if ( r.status != MBM_OK ) return;     // MBM_TIMEOUT, MBM_CRC, ...
+        ... temps [ r.slave - 1 ] is fresh ...   // r.values points to it
+      }
+      
+      master.Set_Baud ( 57600 );
+      for ( int i = 0; i < 8; i++ ) {
+        master.Queue_Read_Regs ( i + 1, REGTEMP, 2, temps [ i ], 2, gotTemp );
+      }
+      
+      loop:  master.Poll ();
+             ... the display, the sensors ...
+    
+    Requests go out one at a time, in order, each as soon as the bus has been
+    quiet for 3.5 character times after the last one, as MODBUS RTU requires;
+    a reply is complete as soon as its last byte arrives, and has timed out if
+    it hasn't begun replyTimeout_us after the request was sent. The values
+    array of a request must stay in place until its callback has been called.
+    Queueing returns false if the queue ( MBM_QUEUE_LEN requests ) is full or
+    the request or its reply wouldn't fit in the buffer.
+    
+    The blocking calls above now queue their request, and call Poll () until
+    it is done.
+    
+  Reading only what has changed
+  
+    A MODBUS_Slave tracking changes ( see MODBUS_Slave.h ) answers function
+    0x41 with only the registers changed since a sequence number. Keep an image
+    of the slave's registers, and the sequence of the last complete update:
+    
+      short image [ nRegs ];
+      unsigned short seen = 0, seenNext;        // 0: everything
+      void gotChanges ( MBM_Request & r ) {
+        if ( r.status != MBM_OK ) return;
+        // image has been updated; r.n is the slave's sequence now, and r.start
+        // where to go on from if the changes didn't all fit in one reply, else -1
+        if ( r.context == NULL ) seenNext = r.n;  // the first reply of a series
+        if ( r.start >= 0 ) master.Queue_Read_Changes ( 1, r.start, seen, image, nRegs, gotChanges, image );
+        else seen = seenNext;
+      }
+      master.Queue_Read_Changes ( 1, 0, seen, image, nRegs, gotChanges );
+  
+  Writing and reading at once
+  
+    Function 0x17 writes registers and then reads registers in one round
+    trip. values holds the nWrite values to write followed by room for the
+    nRead read:
+    
+      short sp [ 3 ];                               // setpoint; temperature, as two registers
+      sp [ 0 ] = setpoint;
+      master.Queue_Read_Write_Regs ( 1, REGTEMP, 2, REGSETPOINT, 1, sp, 3, gotTemp );
+    
+    The blocking Read_Write_Regs takes the two arrays separately.
+  
+  Device identification
+  
+    Queue_Read_Device_Id asks a slave for its identification objects ( see
+    MODBUS_Slave.h ): category 1 ( basic ), 2 ( regular ), or 3 ( extended )
+    from an object on, or 4 for one object alone. values gets the reply from
+    its conformity level byte on, as bytes; r.n is how many objects came, and
+    r.start the object to ask from for the rest, or -1. Device_Id_Object
+    finds one:
+    
+      char vendor [ 20 ];
+      if ( MODBUS_Master::Device_Id_Object ( r, 0, vendor, sizeof ( vendor ) ) >= 0 ) ...
+    
+    It NUL-terminates what it copies, so it serves for the strings; extended
+    object 0x80 of a MODBUS_Slave is binary ( nCoils, nRegs, function codes ).
+  
 */
 
 #ifndef MODBUS_Master_h
 #define MODBUS_Master_h
 
-#define MODBUS_Master_version 1.0.0
+#define MODBUS_Master_version 1.3.0
+// 2026-10-17 1.1.0 request queue advanced by Poll (); frame timing from the baud rate
+// 2026-10-17 1.2.0 Queue_Read_Changes, function 0x41
+// 2026-10-17 1.3.0 Read_Write_Regs and Queue_Read_Write_Regs ( 0x17 ), Queue_Read_Device_Id ( 0x2B / 0x0E )
 
 #include <Stream.h>
 #include <RS485.h>
 #include <MODBUS.h>
 #include <CRC16.h>
+#include <cbmCircularBuffer.h>
 
 #define MBM_TIME_TO_WAIT_FOR_REPLY_us 20000LU
 #define MBM_MESSAGE_TTL_ms 5
+#define MBM_DEFAULT_BAUD 57600LU
+
+#define MBM_QUEUE_LEN 8
+
+// MBM_Request.status
+#define MBM_PENDING     1
+#define MBM_OK          0
+#define MBM_TIMEOUT    -1   // no reply began in time
+#define MBM_SHORT      -2   // the reply stopped before it was complete
+#define MBM_CRC        -3
+#define MBM_EXCEPTION  -4   // the slave replied with an exception code, in .exception
+#define MBM_BAD_REPLY  -5   // from the wrong slave, or the wrong function or byte count
+#define MBM_TOO_LONG   -6   // the request or its reply won't fit the buffer or values
+
+struct MBM_Request;
+typedef void ( * MBM_Callback ) ( MBM_Request & request );
+
+struct MBM_Request {
+  unsigned char slave;          // 0 is a broadcast, which gets no reply
+  unsigned char function;       // 0x01, 0x03, 0x04, 0x05, 0x10, 0x17, 0x2B, or 0x41
+  short start;                  // first coil or register ( for 0x2B, object id )
+  short n;                      // how many ( for 0x41, the sequence number; for 0x2B, the category )
+  short * values;               // read into or written from
+  short lenValues;              // in shorts
+  MBM_Callback done;            // may be NULL
+  void * context;               // for the callback
+  int status;                   // MBM_PENDING until done
+  unsigned char exception;      // with MBM_EXCEPTION
+  unsigned long latency_us;     // from sending to completion
+  short writeStart;             // for 0x17, the registers written, from the front of values
+  short nWrite;
+};
 
 class MODBUS_Master {
 	public:
@@ -47,9 +161,46 @@ class MODBUS_Master {
     void Write_Regs ( unsigned char slave_address, short startReg, short nRegs, short values[] );
     // lenValues is in units of MODBUS registers of 2 bytes each
     int Read_Reg ( unsigned char slave_address, short theReg, short nRegs, short * value, short lenValues );
+    // function 0x17: writes nWrite registers, then reads nRead
+    int Read_Write_Regs ( unsigned char slave_address, short readStart, short nRead, short * readValues,
+                          short writeStart, short nWrite, short writeValues[] );
 
     void GetReply ( unsigned long timeToWaitForReply_us = MBM_TIME_TO_WAIT_FOR_REPLY_us );
     
+    // asynchronous interface; see above
+    // the inter-frame gap is 3.5 character times, or 1750 us above 19200 baud
+    void Set_Baud ( unsigned long baud, unsigned long replyTimeout_us = MBM_TIME_TO_WAIT_FOR_REPLY_us );
+    // function 0x03 reads holding registers, 0x04 ( default ) input registers
+    bool Queue_Read_Regs ( unsigned char slave_address, short startReg, short nRegs, 
+                           short * values, short lenValues,
+                           MBM_Callback done = NULL, void * context = NULL, 
+                           unsigned char function = 0x04 );
+    bool Queue_Read_Coils ( unsigned char slave_address, short startCoil, short nCoils, 
+                            short * values, short lenValues,
+                            MBM_Callback done = NULL, void * context = NULL );
+    bool Queue_Write_Regs ( unsigned char slave_address, short startReg, short nRegs, short values[],
+                            MBM_Callback done = NULL, void * context = NULL );
+    bool Queue_Write_Single_Coil ( unsigned char slave_address, short coilNo, short value,
+                                   MBM_Callback done = NULL, void * context = NULL );
+    // values is an image of all the slave's registers, from register 0, lenValues long
+    bool Queue_Read_Changes ( unsigned char slave_address, short startReg, unsigned short since,
+                              short * values, short lenValues,
+                              MBM_Callback done = NULL, void * context = NULL );
+    // values: the nWrite values to write, then room for the nRead read
+    bool Queue_Read_Write_Regs ( unsigned char slave_address, short readStart, short nRead,
+                                 short writeStart, short nWrite, short * values, short lenValues,
+                                 MBM_Callback done = NULL, void * context = NULL );
+    // category 1 - 4; values gets the bytes of the reply from its conformity level on
+    bool Queue_Read_Device_Id ( unsigned char slave_address, unsigned char category, unsigned char objectId,
+                                short * values, short lenValues,
+                                MBM_Callback done = NULL, void * context = NULL );
+    // the object's length, and up to lenValue - 1 bytes of it in value, NUL-terminated; -1 if it isn't there
+    static int Device_Id_Object ( const MBM_Request & request, unsigned char objectId, char * value, int lenValue );
+    bool Queue ( const MBM_Request & request );
+    void Poll ();
+    // requests queued or in flight
+    int Pending ();
+    
     
     // Receive returns the number of characters received
     // receive_timeout_ms is how long after the most recent character receipt we should 
@@ -69,8 +220,23 @@ class MODBUS_Master {
     RS485 _RS485;
     
   private:
+    int _Check ( const MBM_Request & request );
+    int _Run ( MBM_Request & request );
+    void _Send ();
+    void _Complete ();
+    void _Finish ( int status );
+    int _Device_Id_Length ();
+    
     MODBUS _MODBUS_port;
     
+    CircularBuffer<MBM_Request, MBM_QUEUE_LEN> _queue;
+    MBM_Request _current;
+    bool _waiting;                    // for the reply to _current
+    unsigned long _t35_us;            // 3.5 character times
+    unsigned long _replyTimeout_us;
+    unsigned long _sentAt_us, _lastByteAt_us, _busQuietSince_us;
+    int _expectedLen;
+    
     #if ! defined(ATtiny85)
     Stream * _diagnostic_port;
     int _VERBOSITY;
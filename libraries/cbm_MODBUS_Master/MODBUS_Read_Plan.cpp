@@ -0,0 +1,224 @@
+/*
+	MODBUS_Read_Plan is a library for the Arduino System.  It gathers the program variables
+  to be read from MODBUS RTU slaves into as few requests as will carry them, and decodes
+  the replies straight into the variables.
+
+	Copyright (c) 2026 Charles B. Malloch
+	Arduino MODBUS_Read_Plan is free software: you can redistribute it and/or modify it under the terms of the
+	GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+	or (at your option) any later version.
+
+	Arduino MODBUS_Read_Plan is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+	without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the GNU General Public License for more details.
+
+	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
+
+  Written by Charles B. Malloch, PhD  2026-10-17
+
+  Values of two registers are laid out as MODBUS_var_access's setRegValue
+  stores them on the AVR: the low 16 bits in the first register.
+*/
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include <MODBUS_Read_Plan.h>
+
+MODBUS_Read_Plan::MODBUS_Read_Plan ( MODBUS_Master & master ) : _master ( master ) {
+  Clear ();
+}
+
+void MODBUS_Read_Plan::Clear () {
+  _nItems = 0;
+  _nReads = 0;
+  _planned = false;
+  _next = -1;
+  _failed = 0;
+  _done = NULL;
+}
+
+bool MODBUS_Read_Plan::Add ( unsigned char slave, short reg, short * dest, unsigned char function ) {
+  return ( _Add ( slave, function, reg, MBP_INT16, dest ) );
+}
+
+bool MODBUS_Read_Plan::Add ( unsigned char slave, short reg, unsigned short * dest, unsigned char function ) {
+  return ( _Add ( slave, function, reg, MBP_UINT16, dest ) );
+}
+
+bool MODBUS_Read_Plan::Add ( unsigned char slave, short reg, unsigned long * dest, unsigned char function ) {
+  return ( _Add ( slave, function, reg, MBP_UINT32, dest ) );
+}
+
+bool MODBUS_Read_Plan::Add ( unsigned char slave, short reg, float * dest, unsigned char function ) {
+  return ( _Add ( slave, function, reg, MBP_FLOAT, dest ) );
+}
+
+bool MODBUS_Read_Plan::Add_Coil ( unsigned char slave, short coil, bool * dest ) {
+  return ( _Add ( slave, 0x01, coil, MBP_COIL, dest ) );
+}
+
+bool MODBUS_Read_Plan::_Add ( unsigned char slave, unsigned char function, short reg,
+                              unsigned char type, void * dest ) {
+  if ( ( _nItems >= MBP_MAX_ITEMS ) || ( reg < 0 ) || ( _next >= 0 ) ) return ( false );
+  MBP_Item & item = _items [ _nItems++ ];
+  item.slave = slave;
+  item.function = function;
+  item.reg = reg;
+  item.type = type;
+  item.dest = dest;
+  _planned = false;
+  return ( true );
+}
+
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+bool MODBUS_Read_Plan::Plan () {
+
+  // sort by slave, function, and register; insertion sort, since there are few
+  #define MBP_KEY(i) ( ( ( unsigned long ) _items [ i ].slave << 24 ) \
+                     | ( ( unsigned long ) _items [ i ].function << 16 ) \
+                     | ( unsigned short ) _items [ i ].reg )
+  for ( int i = 0; i < _nItems; i++ ) {
+    unsigned char k = i;
+    int j = i;
+    while ( ( j > 0 ) && ( MBP_KEY ( _order [ j - 1 ] ) > MBP_KEY ( k ) ) ) {
+      _order [ j ] = _order [ j - 1 ];
+      j--;
+    }
+    _order [ j ] = k;
+  }
+  #undef MBP_KEY
+
+  // then read each run of items together while the gaps are short and the span fits
+  _nReads = 0;
+  _planned = true;
+  for ( int i = 0; i < _nItems; i++ ) {
+    MBP_Item & item = _items [ _order [ i ] ];
+    bool coil = ( item.type == MBP_COIL );
+    short width = ( ( item.type == MBP_UINT32 ) || ( item.type == MBP_FLOAT ) ) ? 2 : 1;
+    if ( _nReads > 0 ) {
+      MBP_Read & r = _reads [ _nReads - 1 ];
+      short end = r.start + r.n;
+      short newEnd = ( item.reg + width > end ) ? item.reg + width : end;
+      if ( ( r.slave == item.slave ) && ( r.function == item.function )
+           && ( item.reg - end <= ( coil ? MBP_MAX_COIL_GAP : MBP_MAX_GAP ) )
+           && ( newEnd - r.start <= ( coil ? MBP_MAX_COIL_SPAN : MBP_MAX_SPAN ) ) ) {
+        r.n = newEnd - r.start;
+        r.last = i;
+        continue;
+      }
+    }
+    if ( _nReads >= MBP_MAX_READS ) return ( false );
+    MBP_Read & r = _reads [ _nReads++ ];
+    r.slave = item.slave;
+    r.function = item.function;
+    r.start = item.reg;
+    r.n = width;
+    r.first = r.last = i;
+  }
+  return ( true );
+
+}
+
+int MODBUS_Read_Plan::Reads () {
+  if ( ! _planned ) Plan ();
+  return ( _nReads );
+}
+
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+bool MODBUS_Read_Plan::Start ( MBP_Callback done ) {
+  if ( _next >= 0 ) return ( false );
+  if ( ! _planned ) Plan ();
+  if ( _nReads == 0 ) return ( false );
+  _failed = 0;
+  _done = done;
+  _next = 0;
+  if ( ! _Queue () ) {
+    _next = -1;
+    return ( false );
+  }
+  return ( true );
+}
+
+bool MODBUS_Read_Plan::Busy () {
+  return ( _next >= 0 );
+}
+
+int MODBUS_Read_Plan::Read () {
+  if ( ! Start () ) return ( -1 );
+  while ( _next >= 0 ) { _master.Poll (); yield (); }
+  return ( _failed );
+}
+
+int MODBUS_Read_Plan::Failed () {
+  return ( _failed );
+}
+
+bool MODBUS_Read_Plan::_Queue () {
+  MBP_Read & r = _reads [ _next ];
+  MBM_Request request = { r.slave, r.function, r.start, r.n, _buf, MBP_MAX_SPAN, _Done, this };
+  return ( _master.Queue ( request ) );
+}
+
+void MODBUS_Read_Plan::_Done ( MBM_Request & request ) {
+
+  MODBUS_Read_Plan & plan = * ( MODBUS_Read_Plan * ) request.context;
+  if ( request.status == MBM_OK ) {
+    plan._Decode ( plan._reads [ plan._next ] );
+  } else {
+    plan._failed++;
+  }
+
+  // the next read, queued from here so that it goes out as soon as the bus allows
+  while ( ++plan._next < plan._nReads ) {
+    if ( plan._Queue () ) return;
+    plan._failed++;
+  }
+  plan._next = -1;
+  if ( plan._done ) plan._done ( plan );
+
+}
+
+void MODBUS_Read_Plan::_Decode ( MBP_Read & read ) {
+
+  for ( int i = read.first; i <= read.last; i++ ) {
+    MBP_Item & item = _items [ _order [ i ] ];
+    int k = item.reg - read.start;
+    if ( item.type == MBP_COIL ) {
+      // the reply's bytes as they came: the first coil in bit 0 of the first byte
+      unsigned char * bytes = ( unsigned char * ) _buf;
+      * ( bool * ) item.dest = ( bytes [ k >> 3 ] >> ( k & 0x07 ) ) & 0x01;
+      continue;
+    }
+    unsigned long both = ( unsigned short ) _buf [ k ];
+    switch ( item.type ) {
+      case MBP_INT16:
+        * ( short * ) item.dest = _buf [ k ];
+        break;
+      case MBP_UINT16:
+        * ( unsigned short * ) item.dest = _buf [ k ];
+        break;
+      case MBP_UINT32:
+        both |= ( unsigned long ) ( unsigned short ) _buf [ k + 1 ] << 16;
+        * ( unsigned long * ) item.dest = both;
+        break;
+      case MBP_FLOAT:
+        {
+          both |= ( unsigned long ) ( unsigned short ) _buf [ k + 1 ] << 16;
+          uint32_t bits = both;
+          memcpy ( item.dest, &bits, 4 );
+        }
+        break;
+    }
+  }
+
+}
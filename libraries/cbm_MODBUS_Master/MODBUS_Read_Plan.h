@@ -0,0 +1,141 @@
+/*
+	MODBUS_Read_Plan is a library for the Arduino System.  It gathers the program variables
+  to be read from MODBUS RTU slaves into as few requests as will carry them, and decodes
+  the replies straight into the variables.
+
+	Copyright (c) 2026 Charles B. Malloch
+	Arduino MODBUS_Read_Plan is free software: you can redistribute it and/or modify it under the terms of the
+	GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+	or (at your option) any later version.
+
+	Arduino MODBUS_Read_Plan is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+	without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the GNU General Public License for more details.
+
+	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
+
+  Written by Charles B. Malloch, PhD  2026-10-17
+
+  Reading a dozen variables with a Read_Reg and an intRegValue or floatRegValue
+  each costs a dozen round trips on the bus. Instead, say what is wanted once:
+
+    MODBUS_Read_Plan plan ( master );
+    short tubTemp, heaterState;
+    float flowRate;
+    unsigned long runTime_s;
+    bool pumpOn;
+
+    setup:  plan.Add ( 1, 0, &tubTemp );          // input registers ( 0x04 ) unless told 0x03
+            plan.Add ( 1, 1, &heaterState );
+            plan.Add ( 1, 4, &flowRate );         // two registers, as setRegValue stores a float
+            plan.Add ( 1, 6, &runTime_s );        // two registers, as setRegValue stores an unsigned long
+            plan.Add_Coil ( 1, 3, &pumpOn );
+    loop:   if ( ! plan.Busy () ) plan.Start ();  // or int failed = plan.Read (), which waits
+            master.Poll ();
+
+  Variables on the same slave and function are sorted by register and read
+  together, from the first through the last, as long as the span fits one
+  request ( MBP_MAX_SPAN registers: 125 by the standard, fewer if
+  MODBUS_MASTER_BUF_LEN says so ) and no gap between them is longer than
+  MBP_MAX_GAP registers, which cost less to read and discard than another
+  request's header, CRC, turnaround, and 3.5-character silence. Coils are
+  planned the same way, in bits.
+
+  The requests go through the master's queue one at a time, into one buffer,
+  each queued from the reply to the one before; a plan costs the master one
+  queue slot. When the last is done, Start's callback is called. A request
+  that fails leaves its variables as they were, and is counted in Failed ().
+  Adding a variable after a plan has been made makes a new one at the next
+  Start. Plan () returns false if the variables need more than MBP_MAX_READS
+  requests; those that don't fit are left out.
+*/
+
+#ifndef MODBUS_Read_Plan_h
+#define MODBUS_Read_Plan_h
+
+#define MODBUS_Read_Plan_version 1.0.1
+// 2026-10-17 1.0.0 created
+// 2026-10-18 1.0.1 Read () yields while it waits, as MODBUS_Master's blocking calls do
+
+#include <MODBUS_Master.h>
+
+#define MBP_MAX_ITEMS 24
+#define MBP_MAX_READS 12
+#define MBP_MAX_GAP 8
+#define MBP_MAX_COIL_GAP 64
+
+// registers in one read: what the standard allows, and what fits the master's buffer
+#define MBP_MAX_SPAN ( ( MODBUS_MASTER_BUF_LEN - 5 ) / 2 < 125 ? ( MODBUS_MASTER_BUF_LEN - 5 ) / 2 : 125 )
+#define MBP_MAX_COIL_SPAN ( 16 * MBP_MAX_SPAN < 2000 ? 16 * MBP_MAX_SPAN : 2000 )
+
+// MBP_Item.type
+#define MBP_INT16   0
+#define MBP_UINT16  1
+#define MBP_UINT32  2
+#define MBP_FLOAT   3
+#define MBP_COIL    4
+
+class MODBUS_Read_Plan;
+typedef void ( * MBP_Callback ) ( MODBUS_Read_Plan & plan );
+
+struct MBP_Item {
+  unsigned char slave;
+  unsigned char function;       // 0x01, 0x03, or 0x04
+  short reg;                    // first register, or the coil
+  unsigned char type;
+  void * dest;
+};
+
+struct MBP_Read {
+  unsigned char slave;
+  unsigned char function;
+  short start, n;
+  unsigned char first, last;    // the items it carries, as indices into the sorted order
+};
+
+class MODBUS_Read_Plan {
+	public:
+    MODBUS_Read_Plan ( MODBUS_Master & master );
+
+    // each returns false if there's no room for another item
+    bool Add ( unsigned char slave, short reg, short * dest, unsigned char function = 0x04 );
+    bool Add ( unsigned char slave, short reg, unsigned short * dest, unsigned char function = 0x04 );
+    bool Add ( unsigned char slave, short reg, unsigned long * dest, unsigned char function = 0x04 );
+    bool Add ( unsigned char slave, short reg, float * dest, unsigned char function = 0x04 );
+    bool Add_Coil ( unsigned char slave, short coil, bool * dest );
+    void Clear ();
+
+    // sorts and merges the items into reads; Start does it if need be. False if they
+    // need more than MBP_MAX_READS reads, in which case the rest aren't read
+    bool Plan ();
+    int Reads ();
+
+    // false if a cycle is already under way, or the master's queue is full
+    bool Start ( MBP_Callback done = NULL );
+    bool Busy ();
+    // Start, and Poll the master until the cycle is done; returns Failed ()
+    int Read ();
+    // reads of the last cycle that failed
+    int Failed ();
+
+  private:
+    static void _Done ( MBM_Request & request );
+    bool _Add ( unsigned char slave, unsigned char function, short reg, unsigned char type, void * dest );
+    bool _Queue ();
+    void _Decode ( MBP_Read & read );
+
+    MODBUS_Master & _master;
+    MBP_Item _items [ MBP_MAX_ITEMS ];
+    unsigned char _order [ MBP_MAX_ITEMS ];
+    int _nItems;
+    MBP_Read _reads [ MBP_MAX_READS ];
+    int _nReads;
+    bool _planned;
+
+    int _next;                    // the read under way, or -1
+    int _failed;
+    MBP_Callback _done;
+    short _buf [ MBP_MAX_SPAN ];
+};
+
+#endif
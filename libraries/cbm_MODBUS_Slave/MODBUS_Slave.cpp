@@ -44,10 +44,6 @@
 // #define TESTMODE 1
 #undef TESTMODE
 
-// a character time at 57600 baud = 5760 cps is 1/5.76 ms = 0.17 ms
-// at 9600 baud = 960 cps it's 1/.96 = 1 ms
-#define MODBUS_RECEIVE_TIMEOUT_ms 2
-
 char hexBuf [ 8 ];
 
 //################## MODBUS_Slave ###################
@@ -84,6 +80,10 @@ void MODBUS_Slave::Init(
 	_coilArray = coilArray;
   _nRegs = nRegs;
   _regArray = regArray;
+  _shadow = NULL;
+  _changedAt = NULL;
+  _sequence = 0;
+  for ( int i = 0; i < 7; i++ ) _identification [ i ] = NULL;
   
   _MODBUS_port = MODBUS_port;
   
@@ -103,7 +103,7 @@ void MODBUS_Slave::Init(
 //           1 if frame complete and valid
 // Effect:  Checks completeness, validity, and appropriateness of frame
 
-int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len ) {
+int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len, bool crcChecked ) {
 
   if ( msg_len < 4 ) {
     // valid frame has address (1), function code (1), and CRC (2)
@@ -134,7 +134,7 @@ int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len )
   }
   
   char function_code = msg_buffer[1];
-  char required_len;
+  short required_len;
   // check completeness by function code
   switch (function_code) {
     case 0x01:  // read MODBUS coils
@@ -143,6 +143,7 @@ int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len )
     case 0x04:  // read input reg
     case 0x05:  // write one coil
     case 0x06:  // write one register
+    case 0x41:  // read changed registers
       required_len = 6;
       break;
     case 0x07:   // read exception
@@ -156,6 +157,15 @@ int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len )
       }
       required_len = 7 + msg_buffer[6];  // length in bytes of data segment...
       break;
+    case 0x17: // read and write multiple registers
+      if ( msg_len < 11 ) {
+        return ( -1 );
+      }
+      required_len = 11 + msg_buffer[10];
+      break;
+    case 0x2b: // encapsulated interface; 0x0E is device identification
+      required_len = 5;
+      break;
     default: // unimplemented function code
       #if ! defined(ATtiny85)
         if ( _VERBOSITY >= 5 ) {
@@ -173,6 +183,8 @@ int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len )
     return (-1);
   }
   
+  if ( crcChecked ) return (1);
+
   // check CRC
   unsigned short msg_CRC = ( ( msg_buffer [ msg_len - 1 ] << 8 ) | msg_buffer [ msg_len - 2 ] );
   // my calculated CRC
@@ -207,9 +219,9 @@ int MODBUS_Slave::Check_Data_Frame ( unsigned char * msg_buffer, char msg_len )
 // Returns: Nothing
 // Effect:  Accepts and parses data
 
-void MODBUS_Slave::Process_Data ( unsigned char * msg_buffer, char msg_len ) {
+void MODBUS_Slave::Process_Data ( unsigned char * msg_buffer, char msg_len, bool crcChecked ) {
 
-  int frame_valid = Check_Data_Frame ( msg_buffer, msg_len );
+  int frame_valid = Check_Data_Frame ( msg_buffer, msg_len, crcChecked );
   switch ( frame_valid ) {
     case -1:  // short frame
       return;
@@ -244,6 +256,15 @@ void MODBUS_Slave::Process_Data ( unsigned char * msg_buffer, char msg_len ) {
     case 0x10:
       Write_Regs ( msg_buffer );
       break;
+    case 0x17:
+      Read_Write_Regs ( msg_buffer );
+      break;
+    case 0x2b:
+      Read_Device_Id ( msg_buffer );
+      break;
+    case 0x41:
+      Read_Changes ( msg_buffer );
+      break;
     default:
       #if ! defined(ATtiny85)
         if ( _VERBOSITY >= 5 ) {
@@ -344,6 +365,11 @@ void MODBUS_Slave::Read_Coils( unsigned char *buf ) {
 		_error = 2;
 		return;
 	}
+  if ( 5 + ( ( Bit_Count + 7 ) >> 3 ) > RS485_FRAME_LEN ) {
+    // the reply is built in the request's buffer
+		_error = 2;
+		return;
+  }
   
   short Item = 3;
   Working_Byte = 0;
@@ -540,6 +566,51 @@ void MODBUS_Slave::Write_Regs ( unsigned char *buf ) {
   Send_Response ( buf, Read_Byte ) ;
 }
 
+//################## Read_Write_Regs ###################
+// Takes:   In Data Buffer: read address and count, write address and count, number of following data bytes
+// Returns: Nothing
+// Effect:  Writes the registers, then replies with those read, as function 3 would
+
+void MODBUS_Slave::Read_Write_Regs ( unsigned char *buf ) {
+
+  unsigned short Read_Address = ( buf [ 2 ] << 8 ) | buf [ 3 ];
+  unsigned short Read_Count = ( buf [ 4 ] << 8 ) | buf [ 5 ];
+  unsigned short Write_Address = ( buf [ 6 ] << 8 ) | buf [ 7 ];
+  unsigned short Write_Count = ( buf [ 8 ] << 8 ) | buf [ 9 ];
+  unsigned char Byte_Count = buf [ 10 ];
+  
+  if ( ( Read_Count < 1 ) || ( Write_Count < 1 ) || ( Byte_Count != 2 * Write_Count ) ) {
+		_error = 3;
+		return;
+  }
+  if ( ( ( Read_Address + Read_Count ) > _nRegs ) || ( ( Write_Address + Write_Count ) > _nRegs ) ) {
+		_error = 2;
+		return;
+	}
+  if ( 5 + 2 * Read_Count > RS485_FRAME_LEN ) {
+    // the reply is built in the request's buffer
+		_error = 2;
+		return;
+  }
+  
+  // the write first, as the standard has it; the data start behind where the reply will end
+  short Read_Byte = 11;
+  for ( unsigned short i = 0; i < Write_Count; i++ ) {
+    _regArray [ Write_Address + i ] = ( buf [ Read_Byte ] << 8 ) + buf [ Read_Byte + 1 ];
+    Read_Byte += 2;
+  }
+  
+  short Item = 3;
+  for ( unsigned short i = 0; i < Read_Count; i++ ) {
+    buf [ Item     ] = ( _regArray [ Read_Address + i ] & 0xff00 ) >> 8;
+    buf [ Item + 1 ] =   _regArray [ Read_Address + i ] & 0x00ff;
+    Item += 2;
+  }
+  buf [ 2 ] = 2 * Read_Count;
+  Send_Response ( buf, Item );
+  
+}
+
 
 
 // ******************************************************************************
@@ -571,6 +642,11 @@ void MODBUS_Slave::Read_Reg ( unsigned char *buf ) {
 		_error = 2;
 		return;
 	}
+  if ( 5 + 2 * Count > RS485_FRAME_LEN ) {
+    // the reply is built in the request's buffer
+		_error = 2;
+		return;
+  }
   short Item = 3;
   for ( int i = 0; i < Count; i++ ) {
     buf [ Item     ] = ( _regArray [ Address ] & 0xff00 ) >> 8;
@@ -583,6 +659,229 @@ void MODBUS_Slave::Read_Reg ( unsigned char *buf ) {
 
 
 
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+//################## Track Changes ###################
+// Takes:   two arrays of _nRegs: a copy of the registers, and the sequence number of each one's last change
+// Returns: Nothing
+// Effect:  Starts change tracking; everything has changed at sequence 1
+
+void MODBUS_Slave::Track_Changes ( short * shadow, unsigned short * changedAt ) {
+  _shadow = shadow;
+  _changedAt = changedAt;
+  _sequence = 1;
+  for ( int i = 0; i < _nRegs; i++ ) {
+    _shadow [ i ] = _regArray [ i ];
+    _changedAt [ i ] = _sequence;
+  }
+}
+
+unsigned short MODBUS_Slave::Sequence () {
+  if ( _shadow ) Scan_Changes ();
+  return ( _sequence );
+}
+
+//################## Scan Changes ###################
+// Takes:   Nothing
+// Returns: Nothing
+// Effect:  Compares the registers with their copy; any that differ are stamped with a new sequence number
+
+void MODBUS_Slave::Scan_Changes () {
+  bool any = false;
+  for ( int i = 0; i < _nRegs; i++ ) {
+    if ( _regArray [ i ] == _shadow [ i ] ) continue;
+    if ( ! any ) {
+      // one new sequence number for everything found in this scan; 0 is reserved for "everything"
+      if ( ++_sequence == 0 ) _sequence = 1;
+      any = true;
+    }
+    _shadow [ i ] = _regArray [ i ];
+    _changedAt [ i ] = _sequence;
+  }
+}
+
+//################## Read Changes ###################
+// Takes:   In Data Buffer: first register, sequence number
+// Returns: Nothing
+// Effect:  Replies with the runs of registers changed since the sequence number, as many as fit
+
+void MODBUS_Slave::Read_Changes ( unsigned char *buf ) {
+
+  if ( ! _shadow ) {
+    _error = 1;
+    return;
+  }
+  
+  unsigned short Address = ( buf [ 2 ] << 8 ) | buf [ 3 ];
+  unsigned short Since = ( buf [ 4 ] << 8 ) | buf [ 5 ];
+  
+  Scan_Changes ();
+  
+  // changed after Since, allowing for the wrap of the sequence numbers
+  #define CHANGED(i) ( ( Since == 0 ) || ( ( short ) ( _changedAt [ i ] - Since ) > 0 ) )
+  
+  // the reply is built in the request's buffer, behind where the request has been read
+  short Room = ( MBS_CHANGES_REPLY_LEN < RS485_FRAME_LEN ? MBS_CHANGES_REPLY_LEN : RS485_FRAME_LEN ) - 2;
+  short Item = 7;
+  unsigned short Next = 0xFFFF;
+  unsigned short Reg = Address;
+  while ( Reg < _nRegs ) {
+    if ( ! CHANGED ( Reg ) ) {
+      Reg++;
+      continue;
+    }
+    // the run goes on through single unchanged registers, which cost less than a new run's header
+    unsigned short End = Reg + 1;
+    while ( ( End < _nRegs ) && ( CHANGED ( End ) || ( ( End + 1 < _nRegs ) && CHANGED ( End + 1 ) ) ) ) End++;
+    short Fits = ( Room - Item - 3 ) / 2;
+    if ( Fits > 255 ) Fits = 255;
+    if ( Fits < 1 ) {
+      Next = Reg;
+      break;
+    }
+    unsigned short Count = End - Reg;
+    if ( Count > Fits ) Count = Fits;
+    buf [ Item++ ] = Reg >> 8;
+    buf [ Item++ ] = Reg & 0xff;
+    buf [ Item++ ] = Count;
+    for ( unsigned short i = 0; i < Count; i++ ) {
+      buf [ Item++ ] = ( _regArray [ Reg + i ] & 0xff00 ) >> 8;
+      buf [ Item++ ] =   _regArray [ Reg + i ] & 0x00ff;
+    }
+    if ( Reg + Count < End ) {
+      Next = Reg + Count;
+      break;
+    }
+    Reg = End;
+  }
+  #undef CHANGED
+  
+  buf [ 2 ] = Item - 3;
+  buf [ 3 ] = _sequence >> 8;
+  buf [ 4 ] = _sequence & 0xff;
+  buf [ 5 ] = Next >> 8;
+  buf [ 6 ] = Next & 0xff;
+  Send_Response ( buf, Item );
+  
+}
+
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+//################## Set Identification ###################
+// Takes:   the strings of objects 0 - 6; the first three are required
+// Returns: Nothing
+// Effect:  Enables function 0x2B / 0x0E
+
+void MODBUS_Slave::Set_Identification ( const char * vendorName, const char * productCode, const char * revision,
+                                        const char * vendorURL, const char * productName,
+                                        const char * modelName, const char * userApplicationName ) {
+  _identification [ 0 ] = vendorName;
+  _identification [ 1 ] = productCode;
+  _identification [ 2 ] = revision;
+  _identification [ 3 ] = vendorURL;
+  _identification [ 4 ] = productName;
+  _identification [ 5 ] = modelName;
+  _identification [ 6 ] = userApplicationName;
+}
+
+bool MODBUS_Slave::Has_Object ( unsigned char id ) {
+  if ( id < 7 ) return ( _identification [ id ] != NULL );
+  return ( id == 0x80 );
+}
+
+//################## Put Object ###################
+// Takes:   reply buffer, where the object goes, object id, bytes available for the reply
+// Returns: where the next object goes, or 0 if this one doesn't fit
+// Effect:  Appends the object's id, length, and value; alone in a reply, a long one is cut short
+
+short MODBUS_Slave::Put_Object ( unsigned char * buf, short Item, unsigned char id, short Room ) {
+
+  short Length;
+  if ( id == 0x80 ) {
+    static const unsigned char Functions [] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x0f, 0x10, 0x17, 0x2b, 0x41 };
+    short nFunctions = sizeof ( Functions ) - ( _shadow ? 0 : 1 );
+    Length = 4 + nFunctions;
+    if ( Item + 2 + Length > Room ) return ( 0 );
+    buf [ Item + 2 ] = _nCoils >> 8;
+    buf [ Item + 3 ] = _nCoils & 0xff;
+    buf [ Item + 4 ] = _nRegs >> 8;
+    buf [ Item + 5 ] = _nRegs & 0xff;
+    memcpy ( &buf [ Item + 6 ], Functions, nFunctions );
+  } else {
+    Length = strlen ( _identification [ id ] );
+    if ( Item + 2 + Length > Room ) {
+      if ( Item > 8 ) return ( 0 );
+      Length = Room - Item - 2;
+    }
+    memcpy ( &buf [ Item + 2 ], _identification [ id ], Length );
+  }
+  buf [ Item ] = id;
+  buf [ Item + 1 ] = Length;
+  return ( Item + 2 + Length );
+  
+}
+
+//################## Read Device Id ###################
+// Takes:   In Data Buffer: MEI type 0x0E, read device id code, first object id
+// Returns: Nothing
+// Effect:  Replies with the objects of the category from the first one on, as many as fit, or the one asked for
+
+void MODBUS_Slave::Read_Device_Id ( unsigned char *buf ) {
+
+  unsigned char Code = buf [ 3 ];
+  unsigned char Id = buf [ 4 ];
+  
+  if ( ( buf [ 2 ] != 0x0E ) || ( _identification [ 0 ] == NULL ) ) {
+    _error = 1;
+    return;
+  }
+  if ( ( Code < 1 ) || ( Code > 4 ) ) {
+    _error = 3;
+    return;
+  }
+  
+  // the last object of the category; a stream from an object not in it starts over at 0
+  unsigned char Last = ( Code == 1 ) ? 2 : ( Code == 2 ) ? 6 : 0x80;
+  if ( Code == 4 ) {
+    if ( ! Has_Object ( Id ) ) {
+      _error = 2;
+      return;
+    }
+  } else if ( ( Id > Last ) || ( ( Id > 6 ) && ( Id < 0x80 ) ) ) {
+    Id = 0;
+  }
+  
+  // the reply is built in the request's buffer, once the request has been read
+  short Room = ( MBS_DEVICE_ID_REPLY_LEN < RS485_FRAME_LEN ? MBS_DEVICE_ID_REPLY_LEN : RS485_FRAME_LEN ) - 2;
+  short Item = 8;
+  unsigned char Count = 0, More = 0, Next = 0;
+  while ( true ) {
+    if ( Has_Object ( Id ) ) {
+      short Next_Item = Put_Object ( buf, Item, Id, Room );
+      if ( Next_Item == 0 ) {
+        More = 0xFF;
+        Next = Id;
+        break;
+      }
+      Item = Next_Item;
+      Count++;
+    }
+    if ( ( Code == 4 ) || ( Id == Last ) ) break;
+    Id = ( Id == 6 ) ? 0x80 : Id + 1;
+  }
+  
+  buf [ 4 ] = 0x83;       // conformity: extended identification, streams and single objects
+  buf [ 5 ] = More;
+  buf [ 6 ] = Next;
+  buf [ 7 ] = Count;
+  Send_Response ( buf, Item );
+  
+}
+
 // ******************************************************************************
 // ******************************************************************************
 // ******************************************************************************
@@ -593,18 +892,17 @@ void MODBUS_Slave::Read_Reg ( unsigned char *buf ) {
 
 int MODBUS_Slave::Execute ( ) {
 
-  unsigned long lastMsgReceivedAt_ms;
   unsigned char somethingChanged = 0;
   int status = 0;
   
-  #define bufLen 80
-  static unsigned char strBuf [ bufLen + 1 ];
-  static int bufPtr;
-  
-  bufPtr = _MODBUS_port.Receive ( strBuf, bufLen, MODBUS_RECEIVE_TIMEOUT_ms );
+  // the port assembles frames without waiting, ends each after 3.5 character times
+  // of quiet, and passes on only those whose CRC checks; the reply is built in place
+  RS485 & port = _MODBUS_port._RS485;
+  port.Poll ();
+  int bufPtr = port.Frame_Available ();
+  unsigned char * strBuf = port.Frame ();
   
   if ( bufPtr ) {
-    lastMsgReceivedAt_ms = millis();
     #if ! defined(ATtiny85)
       if ( _VERBOSITY >= 1 ) {
         
@@ -619,39 +917,28 @@ int MODBUS_Slave::Execute ( ) {
     #endif
   }
 
-  if ( ( ( millis() - lastMsgReceivedAt_ms ) > MESSAGE_TTL_ms ) && bufPtr != 0 ) {
-    // kill old messages to keep from blocking up with a bad message piece
-    #if ! defined(ATtiny85)
-      if ( _VERBOSITY >= 1 ) {
-        _diagnostic_port->println ( F ( "timeout" ) );
-      }
-    #endif
-    status = -81;  // timeout
-    bufPtr = 0;
-  }
-    
   // bufPtr points to (vacant) char *after* the character string in strBuf,
   // and so it is the number of chars currently in the buffer
-  switch ( Check_Data_Frame ( strBuf, bufPtr ) ) {
-    case -1 : // incomplete message; keep looking
-      break;
-    case 0 : // not for me; discard it
-      bufPtr = 0;
-      break;
-    case 1 : // process it
-      digitalWrite ( pdLED, ! digitalRead ( pdLED ) );
-      // Process_Data sends the response
-      Process_Data ( strBuf, bufPtr );
-      digitalWrite ( pdLED, ! digitalRead ( pdLED ) );
-      somethingChanged = 1;
-      bufPtr = 0;
-      break;
+  if ( bufPtr ) {
+    switch ( Check_Data_Frame ( strBuf, bufPtr, true ) ) {
+      case -1 : // incomplete message
+        break;
+      case 0 : // not for me; discard it
+        break;
+      case 1 : // process it
+        digitalWrite ( pdLED, ! digitalRead ( pdLED ) );
+        // Process_Data sends the response
+        Process_Data ( strBuf, bufPtr, true );
+        digitalWrite ( pdLED, ! digitalRead ( pdLED ) );
+        somethingChanged = 1;
+        break;
+    }
+    port.Release_Frame ();
   }
   
   // _error is normally 0, so status normally returns 0 ( nothing changed ) or 1 ( something did change )
   if ( _error ) {
     status = - _error;
-    bufPtr = 0;
     _error = 0;
   }
   
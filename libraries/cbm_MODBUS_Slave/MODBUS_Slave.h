@@ -20,12 +20,73 @@
   Note that in main program, one should define coilArray thus:
     unsigned short coils[ ( nCoils + 15 ) >> 4 ];
 
+  Change tracking
+  
+    A master polling slowly varying values ( temperatures, light levels ) reads
+    the same numbers over and over. Given two more arrays of nRegs each, the
+    slave keeps a copy of the registers and the sequence number at which each
+    last changed, and answers function 0x41 with only the registers that have
+    changed since a sequence number the master gives:
+    
+      short regs [ nRegs ], shadow [ nRegs ];
+      unsigned short changedAt [ nRegs ];
+      mb.Init ( ... );
+      mb.Track_Changes ( shadow, changedAt );
+    
+    The sketch goes on writing regs as before; changes are found by comparing
+    with the copy when a master asks ( and writes by masters are found the same
+    way ), so nothing else need be called.
+    
+    request   < ss 41 aaaa SSSS cccc >     from register aaaa, changed since sequence SSSS
+    reply     < ss 41 bc QQQQ NNNN { rrrr nn dddd ... } ... cccc >
+    
+    QQQQ is the sequence now, and NNNN the register to continue from if the
+    changes didn't all fit, else 0xFFFF; then each run of changed registers is
+    its first register, its count, and its values. A run may include an
+    unchanged register between two changed ones, since that is cheaper than
+    starting another. Since sequence 0 means everything. A master keeps the
+    QQQQ of the first reply of a series to ask with next time; sequences are
+    16 bits and wrap, so one that hasn't asked in 32767 changes should ask
+    since 0. Without Track_Changes, 0x41 is an illegal function.
+
+  Read/write multiple registers ( 0x17 )
+  
+    A control loop that writes a setpoint and reads back a temperature can do
+    both in one round trip: the slave writes first, then reads, so a read of
+    registers just written returns the new values.
+    
+    request   < ss 17 rrrr nnnn wwww mmmm bc vvvv ... cccc >
+    reply     < ss 17 bc xxxx ... cccc >
+    
+  Device identification ( 0x2B / 0x0E )
+  
+    A master can learn what a slave is, and what it can do, in one query:
+    
+      mb.Set_Identification ( "cbm", "HOTTUB", "1.5.0" );
+    
+    request   < ss 2B 0E dd oo cccc >     dd: 1 basic, 2 regular, 3 extended stream; 4 object oo alone
+    reply     < ss 2B 0E dd 83 mm nn kk { oo ll chars ... } ... cccc >
+    
+    Objects 0, 1, and 2 ( vendor name, product code, revision ) are the
+    basic ones; 3 to 6 ( vendor URL, product name, model name, application
+    name ) are sent if given. Extended object 0x80 is the slave's map and
+    what it answers: nCoils and nRegs, two bytes each, then one byte for each
+    function code. What doesn't fit in a reply ( MBS_DEVICE_ID_REPLY_LEN ) is
+    left for another request, from object nn, with mm 0xFF. Without
+    Set_Identification, 0x2B is an illegal function. The strings must stay
+    in place; they aren't copied.
+
 */
 
 #ifndef MODBUS_Slave_h
 #define MODBUS_Slave_h
 
-#define MODBUS_Slave_version 1.2.3
+#define MODBUS_Slave_version 1.5.1
+// 2026-10-17 1.3.0 Execute takes frames from the RS485 assembler and never waits
+// 2026-10-17 1.4.0 change tracking; function 0x41 reads the registers changed since a sequence number
+// 2026-10-17 1.5.0 function 0x17 reads and writes registers at once; 0x2B / 0x0E identifies the device
+// 2026-10-18 1.5.1 frames from the RS485 assembler, whose CRC it has checked, are not checked again;
+//                  replies of up to RS485_FRAME_LEN ( 80 ) bytes, 37 registers, as before 1.3.0
 
 #include <Stream.h>
 #include <CRC16.h>
@@ -43,6 +104,11 @@
 // so timeout could be 1 ms
 #define MESSAGE_TTL_ms 5
 
+// the longest reply to 0x41, with its CRC: what fits MODBUS_Master's buffer
+#define MBS_CHANGES_REPLY_LEN 60
+// and the longest to 0x2B
+#define MBS_DEVICE_ID_REPLY_LEN 60
+
 /*
   Trying to strip it down to run on an ATtiny85 or ATtiny84. In order to do that, I want to 
   remove all extra code from the class. In particular, the VERBOSITY code should be disabled 
@@ -85,9 +151,19 @@ class MODBUS_Slave {
                 MODBUS MODBUS_port
              );
 
+    // see Change tracking, above; both arrays nRegs long
+    void Track_Changes ( short * shadow, unsigned short * changedAt );
+    unsigned short Sequence ();
+    
+    // see Device identification, above; the last four may be NULL
+    void Set_Identification ( const char * vendorName, const char * productCode, const char * revision,
+                              const char * vendorURL = NULL, const char * productName = NULL,
+                              const char * modelName = NULL, const char * userApplicationName = NULL );
+    
     int Execute ();
-    int Check_Data_Frame ( unsigned char * msg_buffer, char msg_len );
-		void Process_Data    ( unsigned char * msg_buffer, char msg_len );
+    // crcChecked: the RS485 assembler has checked the CRC already
+    int Check_Data_Frame ( unsigned char * msg_buffer, char msg_len, bool crcChecked = false );
+		void Process_Data    ( unsigned char * msg_buffer, char msg_len, bool crcChecked = false );
     
     void Set_Verbose ( Stream * diagnostic_port, int VERBOSITY );
     
@@ -103,12 +179,24 @@ class MODBUS_Slave {
     void Read_Reg ( unsigned char * Data_In );          // Function code 3 (holding reg), 4 (input reg)
     void Write_Single_Reg ( unsigned char * Data_In );  // Function code 6
     void Write_Regs ( unsigned char * Data_In );        // Function code 16
+    void Read_Write_Regs ( unsigned char * Data_In );   // Function code 0x17
+    
+    void Read_Changes ( unsigned char * Data_In );      // Function code 0x41
+    void Scan_Changes ();
+    
+    void Read_Device_Id ( unsigned char * Data_In );    // Function code 0x2B / 0x0E
+    bool Has_Object ( unsigned char id );
+    short Put_Object ( unsigned char * buf, short Item, unsigned char id, short Room );
     
 		char _address;
 		short _nCoils;
 		unsigned short * _coilArray;
     short _nRegs;
     short * _regArray;
+    short * _shadow;
+    unsigned short * _changedAt;
+    unsigned short _sequence;
+    const char * _identification [ 7 ];
     
     MODBUS _MODBUS_port;
     #if ! defined(ATtiny85)
@@ -0,0 +1,480 @@
+/*
+	MODBUS_TCP_Gateway.cpp is a library for the ESP8266.  It serves MODBUS/TCP to any number of
+  SCADA tools and HMIs on the network, and carries their requests to the slaves on an RS485
+  MODBUS RTU bus through a MODBUS_Master.
+
+	Copyright (c) 2026 Charles B. Malloch
+	Arduino MODBUS_TCP_Gateway is free software: you can redistribute it and/or modify it under the terms of the
+	GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+	or (at your option) any later version.
+
+	Arduino MODBUS_TCP_Gateway is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+	without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the GNU General Public License for more details.
+
+	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
+
+  Written by Charles B. Malloch, PhD  2026-10-17
+
+  MBAP header ( big-endian ):
+    transaction identifier   2 bytes   copied into the response
+    protocol identifier      2 bytes   0 for MODBUS
+    length                   2 bytes   of what follows: the unit and the PDU
+    unit identifier          1 byte    the RTU slave address
+  followed by the PDU, which is the RTU frame without its address and CRC.
+*/
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include <MODBUS_TCP_Gateway.h>
+
+#define MBAP_LEN 7
+
+MODBUS_TCP_Gateway::MODBUS_TCP_Gateway ( MODBUS_Master & master, unsigned short port )
+  : _master ( master ), _server ( port ) {
+  _ttl_ms = MBTCP_CACHE_TTL_ms;
+  for ( int i = 0; i < MBTCP_MAX_CLIENTS; i++ ) {
+    _len [ i ] = 0;
+    _generation [ i ] = 0;
+  }
+  for ( int i = 0; i < MBM_QUEUE_LEN + 1; i++ ) {
+    _transactions [ i ].busy = false;
+    _transactions [ i ].gateway = this;
+  }
+  for ( int i = 0; i < MBTCP_MAX_WAITING; i++ ) _waiting [ i ].busy = false;
+  for ( int i = 0; i < MBTCP_CACHE_LEN; i++ ) _cache [ i ].valid = false;
+  _requests = _busTransactions = _cacheHits = _joined = _exceptions = 0;
+  _diagnostic_port = NULL;
+  _VERBOSITY = 0;
+}
+
+void MODBUS_TCP_Gateway::Init () {
+  _server.begin ();
+  // replies are whole frames, written at once; don't hold them back for more
+  _server.setNoDelay ( true );
+}
+
+void MODBUS_TCP_Gateway::Set_Cache_TTL ( unsigned long ttl_ms ) {
+  _ttl_ms = ttl_ms;
+  if ( ttl_ms == 0 ) {
+    for ( int i = 0; i < MBTCP_CACHE_LEN; i++ ) _cache [ i ].valid = false;
+  }
+}
+
+int MODBUS_TCP_Gateway::Clients () {
+  int n = 0;
+  for ( int i = 0; i < MBTCP_MAX_CLIENTS; i++ ) if ( _clients [ i ] ) n++;
+  return ( n );
+}
+
+unsigned long MODBUS_TCP_Gateway::Requests () { return ( _requests ); }
+unsigned long MODBUS_TCP_Gateway::Bus_Transactions () { return ( _busTransactions ); }
+unsigned long MODBUS_TCP_Gateway::Cache_Hits () { return ( _cacheHits ); }
+unsigned long MODBUS_TCP_Gateway::Joined () { return ( _joined ); }
+unsigned long MODBUS_TCP_Gateway::Exceptions () { return ( _exceptions ); }
+
+void MODBUS_TCP_Gateway::Set_Verbose ( Stream * diagnostic_port, int VERBOSITY ) {
+  _diagnostic_port = diagnostic_port;
+  _VERBOSITY = VERBOSITY;
+}
+
+void MODBUS_TCP_Gateway::Poll () {
+
+  _Accept ();
+
+  for ( int c = 0; c < MBTCP_MAX_CLIENTS; c++ ) {
+    if ( ! _clients [ c ] ) continue;
+    if ( ! _clients [ c ].connected () ) {
+      // any replies still owed it will find a new generation in the slot, and be dropped
+      _clients [ c ].stop ();
+      _generation [ c ]++;
+      _len [ c ] = 0;
+      if ( _VERBOSITY >= 4 ) {
+        _diagnostic_port->print ( F ( "MODBUS/TCP client " ) );
+        _diagnostic_port->print ( c );
+        _diagnostic_port->println ( F ( " gone" ) );
+      }
+      continue;
+    }
+    _Receive ( c );
+  }
+
+  _master.Poll ();
+
+}
+
+void MODBUS_TCP_Gateway::_Accept () {
+  WiFiClient client = _server.available ();
+  while ( client ) {
+    int c;
+    for ( c = 0; c < MBTCP_MAX_CLIENTS; c++ ) {
+      if ( ! _clients [ c ] ) break;
+    }
+    if ( c < MBTCP_MAX_CLIENTS ) {
+      _clients [ c ] = client;
+      _len [ c ] = 0;
+      _generation [ c ]++;
+      if ( _VERBOSITY >= 4 ) {
+        _diagnostic_port->print ( F ( "MODBUS/TCP client " ) );
+        _diagnostic_port->print ( c );
+        _diagnostic_port->println ( F ( " connected" ) );
+      }
+    } else {
+      // no room; better that it find out now than wait on a timeout
+      client.stop ();
+    }
+    client = _server.available ();
+  }
+}
+
+void MODBUS_TCP_Gateway::_Receive ( int c ) {
+
+  WiFiClient & client = _clients [ c ];
+  unsigned char * buf = _buf [ c ];
+
+  while ( client.available () > 0 ) {
+    // read the header, then exactly the rest of the frame, so that what's left
+    // in the client is the beginning of the next one
+    int want = MBAP_LEN;
+    if ( _len [ c ] >= MBAP_LEN ) want = 6 + ( ( buf [ 4 ] << 8 ) | buf [ 5 ] );
+    int got = client.read ( &buf [ _len [ c ] ], want - _len [ c ] );
+    if ( got <= 0 ) return;
+    _len [ c ] += got;
+    if ( _len [ c ] < MBAP_LEN ) continue;
+
+    unsigned short protocol = ( buf [ 2 ] << 8 ) | buf [ 3 ];
+    unsigned short length = ( buf [ 4 ] << 8 ) | buf [ 5 ];
+    if ( ( protocol != 0 ) || ( length < 2 ) || ( length > MBTCP_FRAME_LEN - 6 ) ) {
+      // not MODBUS, or not a frame we can trust the length of: there's no resynchronizing
+      if ( _VERBOSITY >= 2 ) {
+        _diagnostic_port->print ( F ( "MODBUS/TCP client " ) );
+        _diagnostic_port->print ( c );
+        _diagnostic_port->println ( F ( ": bad MBAP header; dropped" ) );
+      }
+      client.stop ();
+      _generation [ c ]++;
+      _len [ c ] = 0;
+      return;
+    }
+    if ( _len [ c ] < 6 + length ) continue;
+
+    _len [ c ] = 0;
+    _requests++;
+    _Request ( c, ( buf [ 0 ] << 8 ) | buf [ 1 ], buf [ 6 ], &buf [ MBAP_LEN ], length - 1 );
+  }
+
+}
+
+void MODBUS_TCP_Gateway::_Request ( int c, unsigned short tid, unsigned char unit,
+                                    unsigned char * pdu, int len ) {
+
+  unsigned char function = pdu [ 0 ];
+  if ( len < 5 ) {
+    _Exception ( c, tid, unit, function, 0x03 );
+    return;
+  }
+  unsigned short start = ( pdu [ 1 ] << 8 ) | pdu [ 2 ];
+  unsigned short n = ( pdu [ 3 ] << 8 ) | pdu [ 4 ];
+
+  switch ( function ) {
+    case 0x01:
+    case 0x03:
+    case 0x04:
+      _Read ( c, tid, unit, function, start, n );
+      break;
+    case 0x05:
+    case 0x06:
+      _Write ( c, tid, unit, function, start, n, NULL );
+      break;
+    case 0x10:
+      //   < 10 aaaa nnnn bc dddd ... >
+      if ( ( len < 6 ) || ( pdu [ 5 ] != 2 * n ) || ( len != 6 + 2 * n ) ) {
+        _Exception ( c, tid, unit, function, 0x03 );
+        return;
+      }
+      _Write ( c, tid, unit, function, start, n, &pdu [ 6 ] );
+      break;
+    default:
+      _Exception ( c, tid, unit, function, 0x01 );
+      break;
+  }
+
+}
+
+void MODBUS_TCP_Gateway::_Read ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                                 unsigned short start, unsigned short n ) {
+
+  bool coils = ( function == 0x01 );
+  if ( ( n < 1 ) || ( n > ( coils ? MBTCP_MAX_READ_COILS : MBTCP_MAX_READ_REGS ) ) ) {
+    _Exception ( c, tid, unit, function, 0x03 );
+    return;
+  }
+  if ( unit == 0 ) {
+    // a broadcast gets no reply, so there's nothing to read
+    _Exception ( c, tid, unit, function, 0x0A );
+    return;
+  }
+
+  // coils are packed 8 to a byte from the first one, so only the same read will do
+  #define MBTCP_COVERS(x) ( ( x.unit == unit ) && ( x.function == function ) \
+                            && ( coils ? ( ( x.start == start ) && ( x.n == n ) ) \
+                                       : ( ( x.start <= start ) && ( start + n <= x.start + x.n ) ) ) )
+
+  unsigned long now = millis ();
+  for ( int i = 0; i < MBTCP_CACHE_LEN; i++ ) {
+    MBTCP_CacheEntry & e = _cache [ i ];
+    if ( ! e.valid ) continue;
+    if ( ( now - e.at_ms ) >= _ttl_ms ) {
+      e.valid = false;
+      continue;
+    }
+    if ( MBTCP_COVERS ( e ) ) {
+      _cacheHits++;
+      _Reply_Read ( c, tid, unit, function, n, &e.values [ start - e.start ] );
+      return;
+    }
+  }
+
+  int w = _Free_Waiting ();
+  if ( w < 0 ) {
+    _Exception ( c, tid, unit, function, 0x06 );
+    return;
+  }
+  int t;
+  for ( t = 0; t < MBM_QUEUE_LEN + 1; t++ ) {
+    MBTCP_Transaction & x = _transactions [ t ];
+    if ( x.busy && x.joinable && MBTCP_COVERS ( x ) ) break;
+  }
+  #undef MBTCP_COVERS
+  if ( t < MBM_QUEUE_LEN + 1 ) {
+    _joined++;
+  } else {
+    t = _New_Transaction ( unit, function, start, n, NULL );
+    if ( t < 0 ) {
+      _Exception ( c, tid, unit, function, 0x06 );
+      return;
+    }
+  }
+
+  MBTCP_Waiting & x = _waiting [ w ];
+  x.busy = true;
+  x.client = c;
+  x.generation = _generation [ c ];
+  x.tid = tid;
+  x.unit = unit;
+  x.function = function;
+  x.start = start;
+  x.n = n;
+  x.transaction = t;
+
+}
+
+void MODBUS_TCP_Gateway::_Write ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                                  unsigned short start, unsigned short n, unsigned char * data ) {
+
+  // n is the coil's new state for 0x05, the register's new value for 0x06, and the count for 0x10
+  short values [ MBTCP_MAX_WRITE_REGS ];
+  unsigned char busFunction = function;
+  unsigned short busN = n;
+  switch ( function ) {
+    case 0x05:
+      if ( ( n != 0xFF00 ) && ( n != 0x0000 ) ) {
+        _Exception ( c, tid, unit, function, 0x03 );
+        return;
+      }
+      busN = n ? 1 : 0;
+      break;
+    case 0x06:
+      // the master writes registers only with 0x10; one register is the same thing
+      busFunction = 0x10;
+      busN = 1;
+      values [ 0 ] = n;
+      break;
+    default:  // 0x10
+      if ( ( n < 1 ) || ( n > MBTCP_MAX_WRITE_REGS ) ) {
+        _Exception ( c, tid, unit, function, 0x03 );
+        return;
+      }
+      for ( int i = 0; i < n; i++ ) values [ i ] = ( data [ 2 * i ] << 8 ) | data [ 2 * i + 1 ];
+      break;
+  }
+
+  int w = _Free_Waiting ();
+  int t = ( w < 0 ) ? -1 : _New_Transaction ( unit, busFunction, start, busN, values );
+  if ( t < 0 ) {
+    _Exception ( c, tid, unit, function, 0x06 );
+    return;
+  }
+  _Forget ( unit );
+
+  MBTCP_Waiting & x = _waiting [ w ];
+  x.busy = true;
+  x.client = c;
+  x.generation = _generation [ c ];
+  x.tid = tid;
+  x.unit = unit;
+  x.function = function;
+  x.start = start;
+  x.n = n;
+  x.transaction = t;
+
+}
+
+int MODBUS_TCP_Gateway::_Free_Waiting () {
+  for ( int i = 0; i < MBTCP_MAX_WAITING; i++ ) if ( ! _waiting [ i ].busy ) return ( i );
+  return ( -1 );
+}
+
+int MODBUS_TCP_Gateway::_New_Transaction ( unsigned char unit, unsigned char function,
+                                           unsigned short start, unsigned short n, short * values ) {
+
+  // the index of a transaction queued to the master, or -1 if there's no room for one
+  int t;
+  for ( t = 0; t < MBM_QUEUE_LEN + 1; t++ ) if ( ! _transactions [ t ].busy ) break;
+  if ( t >= MBM_QUEUE_LEN + 1 ) return ( -1 );
+
+  MBTCP_Transaction & x = _transactions [ t ];
+  x.unit = unit;
+  x.function = function;
+  x.start = start;
+  x.n = n;
+  x.joinable = ( function != 0x05 ) && ( function != 0x10 );
+  if ( values ) {
+    for ( int i = 0; i < n; i++ ) x.values [ i ] = values [ i ];
+  }
+
+  MBM_Request r = { unit, function, ( short ) start, ( short ) n,
+                    x.values, MBTCP_MAX_READ_REGS, _Done, &x };
+  if ( ! _master.Queue ( r ) ) return ( -1 );
+  x.busy = true;
+  _busTransactions++;
+  return ( t );
+
+}
+
+void MODBUS_TCP_Gateway::_Done ( MBM_Request & request ) {
+  MBTCP_Transaction * t = ( MBTCP_Transaction * ) request.context;
+  t->gateway->_Finish ( *t, request );
+}
+
+void MODBUS_TCP_Gateway::_Finish ( MBTCP_Transaction & t, MBM_Request & request ) {
+
+  int ti = &t - _transactions;
+
+  for ( int i = 0; i < MBTCP_MAX_WAITING; i++ ) {
+    MBTCP_Waiting & w = _waiting [ i ];
+    if ( ! w.busy || ( w.transaction != ti ) ) continue;
+    w.busy = false;
+    // the client may have gone, and another taken its place, since it asked
+    if ( ( w.generation != _generation [ w.client ] ) || ! _clients [ w.client ] ) continue;
+
+    if ( request.status != MBM_OK ) {
+      _Exception ( w.client, w.tid, w.unit, w.function,
+                   request.status == MBM_EXCEPTION ? request.exception : 0x0B );
+      continue;
+    }
+    if ( ( w.function == 0x01 ) || ( w.function == 0x03 ) || ( w.function == 0x04 ) ) {
+      _Reply_Read ( w.client, w.tid, w.unit, w.function, w.n, &t.values [ w.start - t.start ] );
+      continue;
+    }
+    // writes are answered with an echo of their address and value or count
+    unsigned char pdu [ 5 ] = { w.function, ( unsigned char ) ( w.start >> 8 ), ( unsigned char ) w.start,
+                                ( unsigned char ) ( w.n >> 8 ), ( unsigned char ) w.n };
+    _Reply ( w.client, w.tid, w.unit, pdu, sizeof ( pdu ) );
+  }
+
+  if ( ( request.status == MBM_OK ) && t.joinable && ( _ttl_ms > 0 ) ) _Cache ( t );
+  t.busy = false;
+
+}
+
+void MODBUS_TCP_Gateway::_Cache ( MBTCP_Transaction & t ) {
+
+  // into a free entry, or the one that would expire first
+  unsigned long now = millis ();
+  int oldest = 0;
+  for ( int i = 0; i < MBTCP_CACHE_LEN; i++ ) {
+    MBTCP_CacheEntry & e = _cache [ i ];
+    if ( ! e.valid || ( ( now - e.at_ms ) >= _ttl_ms ) ) {
+      oldest = i;
+      break;
+    }
+    if ( ( now - e.at_ms ) > ( now - _cache [ oldest ].at_ms ) ) oldest = i;
+  }
+  MBTCP_CacheEntry & e = _cache [ oldest ];
+  e.valid = true;
+  e.unit = t.unit;
+  e.function = t.function;
+  e.start = t.start;
+  e.n = t.n;
+  e.at_ms = now;
+  memcpy ( e.values, t.values, sizeof ( e.values ) );
+
+}
+
+void MODBUS_TCP_Gateway::_Forget ( unsigned char unit ) {
+  // a broadcast writes to everyone
+  for ( int i = 0; i < MBTCP_CACHE_LEN; i++ ) {
+    if ( ( unit == 0 ) || ( _cache [ i ].unit == unit ) ) _cache [ i ].valid = false;
+  }
+  for ( int i = 0; i < MBM_QUEUE_LEN + 1; i++ ) {
+    if ( ( unit == 0 ) || ( _transactions [ i ].unit == unit ) ) _transactions [ i ].joinable = false;
+  }
+}
+
+void MODBUS_TCP_Gateway::_Reply_Read ( int c, unsigned short tid, unsigned char unit,
+                                       unsigned char function, unsigned short n, short * values ) {
+
+  //   < 03 bc dddd ... >, or for coils < 01 bc cc ... > with the first coil in bit 0
+  unsigned char pdu [ 2 + 2 * MBTCP_MAX_READ_REGS ];
+  int len = 0;
+  pdu [ len++ ] = function;
+  if ( function == 0x01 ) {
+    int nBytes = ( n + 7 ) >> 3;
+    pdu [ len++ ] = nBytes;
+    memcpy ( &pdu [ len ], values, nBytes );
+    len += nBytes;
+  } else {
+    pdu [ len++ ] = 2 * n;
+    for ( int i = 0; i < n; i++ ) {
+      pdu [ len++ ] = values [ i ] >> 8;
+      pdu [ len++ ] = values [ i ];
+    }
+  }
+  _Reply ( c, tid, unit, pdu, len );
+
+}
+
+void MODBUS_TCP_Gateway::_Exception ( int c, unsigned short tid, unsigned char unit,
+                                      unsigned char function, unsigned char code ) {
+  _exceptions++;
+  if ( _VERBOSITY >= 4 ) {
+    _diagnostic_port->print ( F ( "MODBUS/TCP exception 0x" ) );
+    _diagnostic_port->print ( code, HEX );
+    _diagnostic_port->print ( F ( " to function 0x" ) );
+    _diagnostic_port->print ( function, HEX );
+    _diagnostic_port->print ( F ( " for unit " ) );
+    _diagnostic_port->println ( unit );
+  }
+  unsigned char pdu [ 2 ] = { ( unsigned char ) ( function | 0x80 ), code };
+  _Reply ( c, tid, unit, pdu, sizeof ( pdu ) );
+}
+
+void MODBUS_TCP_Gateway::_Reply ( int c, unsigned short tid, unsigned char unit,
+                                  unsigned char * pdu, int len ) {
+  // one write, so that the frame goes out in one segment
+  unsigned char frame [ MBTCP_FRAME_LEN ];
+  frame [ 0 ] = tid >> 8;
+  frame [ 1 ] = tid;
+  frame [ 2 ] = 0;
+  frame [ 3 ] = 0;
+  frame [ 4 ] = ( len + 1 ) >> 8;
+  frame [ 5 ] = len + 1;
+  frame [ 6 ] = unit;
+  memcpy ( &frame [ MBAP_LEN ], pdu, len );
+  _clients [ c ].write ( frame, MBAP_LEN + len );
+}
@@ -0,0 +1,167 @@
+/*
+	MODBUS_TCP_Gateway.h is a library for the ESP8266.  It serves MODBUS/TCP to any number of
+  SCADA tools and HMIs on the network, and carries their requests to the slaves on an RS485
+  MODBUS RTU bus through a MODBUS_Master.
+
+	Copyright (c) 2026 Charles B. Malloch
+	Arduino MODBUS_TCP_Gateway is free software: you can redistribute it and/or modify it under the terms of the
+	GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+	or (at your option) any later version.
+
+	Arduino MODBUS_TCP_Gateway is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+	without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the GNU General Public License for more details.
+
+	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
+
+  Written by Charles B. Malloch, PhD  2026-10-17
+
+  Synopsis
+
+    MODBUS MODBUS_port ( &Serial, pdRS485_TX_ENABLE );
+    MODBUS_Master master ( MODBUS_port );
+    MODBUS_TCP_Gateway gateway ( master );          // port 502
+
+    setup:  ... WiFi up ...
+            master.Set_Baud ( 57600 );
+            gateway.Init ();
+    loop:   gateway.Poll ();                        // and master.Poll (), which it calls
+
+  A MODBUS/TCP request is an MBAP header ( transaction, protocol 0, length,
+  unit ) and a PDU; the unit is the RTU slave address. Up to MBTCP_MAX_CLIENTS
+  clients may be connected at once, each with as many requests outstanding
+  as it likes, up to MBTCP_MAX_WAITING in all. Requests go to the bus through
+  the master's queue; the replies come back with the client's transaction
+  number, in whatever order the bus finishes them.
+
+  Function codes: 0x01, 0x03, 0x04 ( reads ), 0x05, 0x06, 0x10 ( writes; 0x06
+  goes to the bus as a 0x10 of one register ). Anything else gets exception
+  0x01. A read or write too long for the master's buffer ( MBTCP_MAX_READ_REGS
+  and MBTCP_MAX_WRITE_REGS registers ) gets 0x03. A slave that doesn't
+  answer, or answers badly, gets the client 0x0B; one that replies with an
+  exception has it passed on.
+
+  Several HMIs polling the same registers would multiply the bus traffic; so
+    a read identical to, or within, one already on its way to the bus waits
+      for that one's reply instead of going to the bus itself;
+    the replies to reads are kept for Set_Cache_TTL ms ( MBTCP_CACHE_TTL_ms
+      by default ) in MBTCP_CACHE_LEN entries, and a read within one of them
+      is answered from it at once.
+  A write to a unit forgets everything cached from it, and keeps reads
+  already on their way from being joined or cached, since their data may
+  predate the write. For coils, only identical reads are shared.
+*/
+
+#ifndef MODBUS_TCP_Gateway_h
+#define MODBUS_TCP_Gateway_h
+
+#define MODBUS_TCP_Gateway_version 1.0.0
+// 2026-10-17 1.0.0 created
+
+#include <ESP8266WiFi.h>
+#include <MODBUS_Master.h>
+
+#define MBTCP_PORT 502
+#define MBTCP_MAX_CLIENTS 4
+#define MBTCP_MAX_WAITING 16
+#define MBTCP_CACHE_LEN 8
+#define MBTCP_CACHE_TTL_ms 250UL
+
+// MBAP header of 7 bytes plus a PDU of up to 253
+#define MBTCP_FRAME_LEN 260
+
+// what fits in the master's buffer: a reply of 5 + 2n, a request of 9 + 2n
+#define MBTCP_MAX_READ_REGS ( ( MODBUS_MASTER_BUF_LEN - 5 ) / 2 )
+#define MBTCP_MAX_WRITE_REGS ( ( MODBUS_MASTER_BUF_LEN - 9 ) / 2 )
+#define MBTCP_MAX_READ_COILS ( 8 * 2 * MBTCP_MAX_READ_REGS )
+
+class MODBUS_TCP_Gateway;
+
+// one request on its way to the bus, which any number of clients may be waiting on
+struct MBTCP_Transaction {
+  bool busy;
+  bool joinable;                  // no write to the unit since it was queued
+  unsigned char unit, function;
+  unsigned short start, n;
+  short values [ MBTCP_MAX_READ_REGS ];
+  MODBUS_TCP_Gateway * gateway;
+};
+
+// a client's request, waiting on a transaction
+struct MBTCP_Waiting {
+  bool busy;
+  unsigned char client;
+  unsigned long generation;       // of the connection in that client slot
+  unsigned short tid;             // the client's transaction identifier
+  unsigned char unit, function;   // as the client asked
+  unsigned short start, n;        // for a write, n is the value or count echoed
+  unsigned char transaction;
+};
+
+struct MBTCP_CacheEntry {
+  bool valid;
+  unsigned char unit, function;
+  unsigned short start, n;
+  unsigned long at_ms;
+  short values [ MBTCP_MAX_READ_REGS ];
+};
+
+class MODBUS_TCP_Gateway {
+	public:
+    MODBUS_TCP_Gateway ( MODBUS_Master & master, unsigned short port = MBTCP_PORT );
+
+    void Init ();
+    void Poll ();
+    void Set_Cache_TTL ( unsigned long ttl_ms );
+
+    int Clients ();                     // connected now
+    unsigned long Requests ();          // from clients
+    unsigned long Bus_Transactions ();  // queued to the master
+    unsigned long Cache_Hits ();
+    unsigned long Joined ();            // reads that waited on another's transaction
+    unsigned long Exceptions ();        // sent to clients
+
+    void Set_Verbose ( Stream * diagnostic_port, int VERBOSITY );
+
+  private:
+    static void _Done ( MBM_Request & request );
+
+    void _Accept ();
+    void _Receive ( int c );
+    void _Request ( int c, unsigned short tid, unsigned char unit, unsigned char * pdu, int len );
+    void _Read ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                 unsigned short start, unsigned short n );
+    void _Write ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                  unsigned short start, unsigned short n, unsigned char * data );
+    int _Free_Waiting ();
+    int _New_Transaction ( unsigned char unit, unsigned char function,
+                           unsigned short start, unsigned short n, short * values );
+    void _Finish ( MBTCP_Transaction & t, MBM_Request & request );
+    void _Cache ( MBTCP_Transaction & t );
+    void _Forget ( unsigned char unit );
+    void _Reply_Read ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                       unsigned short n, short * values );
+    void _Reply ( int c, unsigned short tid, unsigned char unit, unsigned char * pdu, int len );
+    void _Exception ( int c, unsigned short tid, unsigned char unit, unsigned char function,
+                      unsigned char code );
+
+    MODBUS_Master & _master;
+    WiFiServer _server;
+    unsigned long _ttl_ms;
+
+    WiFiClient _clients [ MBTCP_MAX_CLIENTS ];
+    unsigned char _buf [ MBTCP_MAX_CLIENTS ] [ MBTCP_FRAME_LEN ];
+    int _len [ MBTCP_MAX_CLIENTS ];
+    unsigned long _generation [ MBTCP_MAX_CLIENTS ];
+
+    MBTCP_Transaction _transactions [ MBM_QUEUE_LEN + 1 ];
+    MBTCP_Waiting _waiting [ MBTCP_MAX_WAITING ];
+    MBTCP_CacheEntry _cache [ MBTCP_CACHE_LEN ];
+
+    unsigned long _requests, _busTransactions, _cacheHits, _joined, _exceptions;
+
+    Stream * _diagnostic_port;
+    int _VERBOSITY;
+};
+
+#endif
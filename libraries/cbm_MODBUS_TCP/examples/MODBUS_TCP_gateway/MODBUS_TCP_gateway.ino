@@ -0,0 +1,87 @@
+#define VERSION "1.0.0"
+#define VERDATE "2026-10-17"
+#define PROGMONIKER "MBTCP"
+
+/*
+  MODBUS/TCP gateway on an ESP8266, to the MODBUS RTU slaves on a MAX485 network.
+  
+  SCADA tools and HMIs connect to port 502 and address the slaves by unit
+  identifier. Identical or overlapping reads from several of them share one
+  trip on the bus, and what has been read is reused for MBTCP_CACHE_TTL_ms.
+  
+  The MAX485 is on the UART ( Serial, GPIO1 TX and GPIO3 RX ), with its driver
+  enable on GPIO4; diagnostics go out on Serial1 ( GPIO2, transmit only ).
+  
+  To try it from a *nix system, e.g. with mbpoll:
+    mbpoll -m tcp -a 1 -r 1 -c 4 -t 3 172.16.5.20
+*/
+
+#define VERBOSE 2
+#define BAUDRATE 115200
+#define BAUDRATE485 57600
+// need to use CBMDDWRT3 or CBMDATACOL for my own network access
+#define WIFI_LOCALE CBMDATACOL
+
+#define pdRS485_TX_ENABLE 4
+
+#include <ESP8266WiFi.h>
+#include <cbmNetworkInfo.h>
+cbmNetworkInfo Network;
+
+// wah... indirectly used, but have to include for compiler
+#include <RS485.h>
+#include <CRC16.h>
+
+#include <MODBUS.h>
+MODBUS MODBUS_port ( ( Stream * ) &Serial, pdRS485_TX_ENABLE );
+#include <MODBUS_Master.h>
+MODBUS_Master master ( MODBUS_port );
+#include <MODBUS_TCP_Gateway.h>
+MODBUS_TCP_Gateway gateway ( master );
+
+void setup () {
+
+  Serial.begin ( BAUDRATE485 );
+  Serial1.begin ( BAUDRATE );
+  
+  if ( VERBOSE >= 5 ) {
+    master.Set_Verbose ( ( Stream * ) &Serial1, 4 );
+    gateway.Set_Verbose ( ( Stream * ) &Serial1, 4 );
+  }
+  
+  Network.init ( WIFI_LOCALE );
+  Serial1.print ( "\nConnecting to '" ); Serial1.print ( Network.ssid ); Serial1.println ( "'" );
+  WiFi.config ( Network.ip, Network.gw, Network.mask, Network.dns );
+  WiFi.mode ( WIFI_STA );
+  WiFi.begin ( Network.ssid, Network.password );
+  while ( WiFi.status () != WL_CONNECTED ) {
+    Serial1.print ( "." );
+    delay ( 500 );
+  }
+  Serial1.println ();
+  Serial1.print ( "WiFi connected as " ); Serial1.println ( WiFi.localIP () );
+  
+  master.Set_Baud ( BAUDRATE485 );
+  gateway.Init ();
+  
+  Serial1.print ( F ( "[" PROGMONIKER ": MODBUS/TCP gateway v" VERSION " " VERDATE "]\n" ) );
+
+}
+
+void loop () {
+
+  static unsigned long lastReportAt_ms = 0;
+  
+  gateway.Poll ();
+  
+  if ( ( VERBOSE >= 2 ) && ( millis () - lastReportAt_ms > 60000UL ) ) {
+    Serial1.print ( gateway.Clients () ); Serial1.print ( F ( " clients; " ) );
+    Serial1.print ( gateway.Requests () ); Serial1.print ( F ( " requests, " ) );
+    Serial1.print ( gateway.Bus_Transactions () ); Serial1.print ( F ( " on the bus, " ) );
+    Serial1.print ( gateway.Cache_Hits () ); Serial1.print ( F ( " from the cache, " ) );
+    Serial1.print ( gateway.Joined () ); Serial1.print ( F ( " joined, " ) );
+    Serial1.print ( gateway.Exceptions () ); Serial1.println ( F ( " exceptions" ) );
+    lastReportAt_ms = millis ();
+  }
+  
+}
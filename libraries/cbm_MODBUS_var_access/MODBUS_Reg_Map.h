@@ -0,0 +1,192 @@
+/*
+	MODBUS_Reg_Map describes the layout of a MODBUS RTU slave's coils and registers once, at
+  compile time, for the slave and its masters to share, with inline accessors for each field.
+
+	Copyright (c) 2026 Charles B. Malloch
+	Arduino MODBUS_Reg_Map is free software: you can redistribute it and/or modify it under the terms of the
+	GNU General Public License as published by the Free Software Foundation, either version 3 of the License,
+	or (at your option) any later version.
+
+	Arduino MODBUS_Reg_Map is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+	without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+	See the GNU General Public License for more details.
+
+	To get a copy of the GNU General Public License see <http://www.gnu.org/licenses/>.
+
+  Written by Charles B. Malloch, PhD  2026-10-17
+
+  setRegValue, floatRegValue, coilValue and the rest take the register or coil
+  number at run time, check it against the array's size, and copy through
+  memcpy on every call. With the layout known at compile time, none of that is
+  needed. Describe it once, in a header both the slave's and the masters'
+  sketches include:
+
+    struct HotTub {
+      typedef MB_Reg<float,    0> hotTubTemp;       // registers 0 and 1
+      typedef MB_Reg<float,    2> ambientTemp;
+      typedef MB_Reg<int16_t,  4> time;
+      typedef MB_Reg<int16_t,  6> ambientLight;
+      typedef MB_Reg<uint16_t, 8> ledBrightness;
+      typedef MB_Coil<0> heater;
+      typedef MB_Coil<3> pump;
+      typedef MB_Map<10, 4, hotTubTemp, ambientTemp, time, ambientLight, ledBrightness,
+                     heater, pump> map;
+    };
+
+    short regs [ HotTub::map::nRegs ];
+    unsigned short coils [ HotTub::map::nCoilWords ];
+
+    HotTub::hotTubTemp::set ( regs, tHotTub_degF );
+    displayTemperature ( HotTub::hotTubTemp::get ( regs ) );
+    if ( HotTub::pump::get ( coils ) ) ...
+
+  Each get and set is an inline load or store at a fixed place: no call, no
+  bounds check. Using the map ( as in sizing the arrays from it ) checks it:
+  a field that runs past nRegs or nCoils, or two fields that share a register
+  or coil, is a compile-time error.
+
+  Layout, as setRegValue and MODBUS_Read_Plan have it: a 32-bit value ( int32_t,
+  uint32_t, float ) takes two registers, low 16 bits in the first; give
+  MB_HIGH_WORD_FIRST as the third parameter for a device that puts the high
+  half first. Coils are packed 16 to an unsigned short, coil 0 in bit 0 of
+  the first. On the wire each register is big-endian; MB_To_Wire and
+  MB_From_Wire convert a block of them at once, for a transport that doesn't
+  go through MODBUS_Slave or MODBUS_Master, which do it themselves.
+
+  Use the fixed-size types: an int is 16 bits on the AVR but 32 on the ESP8266.
+*/
+
+#ifndef MODBUS_Reg_Map_h
+#define MODBUS_Reg_Map_h
+
+#define MODBUS_Reg_Map_version 1.0.0
+// 2026-10-17 1.0.0 created
+
+#include <stdint.h>
+#include <string.h>
+
+#define MB_LOW_WORD_FIRST  0
+#define MB_HIGH_WORD_FIRST 1
+
+#define MB_KIND_REG  0
+#define MB_KIND_COIL 1
+
+// the register-level work for fields of one and two registers
+template <int WIDTH, int FIRST, int ORDER> struct MB_Words;
+
+template <int FIRST, int ORDER> struct MB_Words<1, FIRST, ORDER> {
+  template <typename T> static inline T get ( const short * regs ) {
+    T value;
+    uint16_t word = regs [ FIRST ];
+    memcpy ( &value, &word, 2 );
+    return ( value );
+  }
+  template <typename T> static inline void set ( short * regs, T value ) {
+    uint16_t word;
+    memcpy ( &word, &value, 2 );
+    regs [ FIRST ] = word;
+  }
+};
+
+template <int FIRST, int ORDER> struct MB_Words<2, FIRST, ORDER> {
+  static const int lo = ( ORDER == MB_HIGH_WORD_FIRST ) ? FIRST + 1 : FIRST;
+  static const int hi = ( ORDER == MB_HIGH_WORD_FIRST ) ? FIRST : FIRST + 1;
+  template <typename T> static inline T get ( const short * regs ) {
+    uint32_t bits = ( uint32_t ) ( uint16_t ) regs [ lo ] | ( ( uint32_t ) ( uint16_t ) regs [ hi ] << 16 );
+    T value;
+    memcpy ( &value, &bits, 4 );
+    return ( value );
+  }
+  template <typename T> static inline void set ( short * regs, T value ) {
+    uint32_t bits;
+    memcpy ( &bits, &value, 4 );
+    regs [ lo ] = ( uint16_t ) bits;
+    regs [ hi ] = ( uint16_t ) ( bits >> 16 );
+  }
+};
+
+// a value of type T in the register REG ( and REG + 1, for 32 bits )
+template <typename T, int REG, int ORDER = MB_LOW_WORD_FIRST>
+struct MB_Reg {
+  static_assert ( ( sizeof ( T ) == 2 ) || ( sizeof ( T ) == 4 ), "a register field is 16 or 32 bits" );
+  typedef T type;
+  static const int kind = MB_KIND_REG;
+  static const int first = REG;
+  static const int width = sizeof ( T ) / 2;
+  static inline T get ( const short * regs ) {
+    return ( MB_Words<width, REG, ORDER>::template get<T> ( regs ) );
+  }
+  static inline void set ( short * regs, T value ) {
+    MB_Words<width, REG, ORDER>::template set<T> ( regs, value );
+  }
+};
+
+// coil COIL, bit COIL & 15 of word COIL >> 4
+template <int COIL>
+struct MB_Coil {
+  static const int kind = MB_KIND_COIL;
+  static const int first = COIL;
+  static const int width = 1;
+  static const int word = COIL >> 4;
+  static const unsigned short mask = 1U << ( COIL & 0x0f );
+  static inline bool get ( const unsigned short * coils ) {
+    return ( ( coils [ word ] & mask ) != 0 );
+  }
+  static inline void set ( unsigned short * coils, bool value ) {
+    if ( value ) coils [ word ] |= mask;
+    else coils [ word ] &= ( unsigned short ) ~ mask;
+  }
+};
+
+// ******************************************************************************
+// the compile-time checks
+
+template <typename A, typename B> struct MB_Overlap {
+  static const bool value = ( A::kind == B::kind )
+                            && ( A::first < B::first + B::width ) && ( B::first < A::first + A::width );
+};
+
+// F overlaps one of Rest
+template <typename F, typename... Rest> struct MB_Overlaps_Any {
+  static const bool value = false;
+};
+template <typename F, typename G, typename... Rest> struct MB_Overlaps_Any<F, G, Rest...> {
+  static const bool value = MB_Overlap<F, G>::value || MB_Overlaps_Any<F, Rest...>::value;
+};
+
+template <int NREGS, int NCOILS, typename... Fields> struct MB_Check {
+  static const bool fits = true;
+  static const bool disjoint = true;
+};
+template <int NREGS, int NCOILS, typename F, typename... Rest> struct MB_Check<NREGS, NCOILS, F, Rest...> {
+  static const bool fits = ( F::first >= 0 )
+                           && ( F::first + F::width <= ( F::kind == MB_KIND_COIL ? NCOILS : NREGS ) )
+                           && MB_Check<NREGS, NCOILS, Rest...>::fits;
+  static const bool disjoint = ! MB_Overlaps_Any<F, Rest...>::value
+                               && MB_Check<NREGS, NCOILS, Rest...>::disjoint;
+};
+
+template <int NREGS, int NCOILS, typename... Fields>
+struct MB_Map {
+  static_assert ( MB_Check<NREGS, NCOILS, Fields...>::fits, "a field of the MODBUS map lies outside it" );
+  static_assert ( MB_Check<NREGS, NCOILS, Fields...>::disjoint, "two fields of the MODBUS map overlap" );
+  static const int nRegs = NREGS;
+  static const int nCoils = NCOILS;
+  static const int nCoilWords = ( NCOILS + 15 ) >> 4;
+};
+
+// ******************************************************************************
+// registers to and from the wire's big-endian bytes, a block at a time
+
+inline void MB_To_Wire ( const short * regs, int n, unsigned char * bytes ) {
+  for ( int i = 0; i < n; i++ ) {
+    *bytes++ = ( uint16_t ) regs [ i ] >> 8;
+    *bytes++ = regs [ i ] & 0xff;
+  }
+}
+
+inline void MB_From_Wire ( const unsigned char * bytes, int n, short * regs ) {
+  for ( int i = 0; i < n; i++, bytes += 2 ) regs [ i ] = ( bytes [ 0 ] << 8 ) | bytes [ 1 ];
+}
+
+#endif
@@ -17,7 +17,11 @@
   
   By standard, a MODBUS coil is one bit, and a MODBUS register is 16 bits, big-endian.
   
-  By my own standard, the coil array is packed into 8-bit shorts.
+  By my own standard, the coil array is packed 16 coils to an unsigned short, coil 0 in bit 0
+  of the first.
+  
+  Where the layout is fixed when the sketch is written, MODBUS_Reg_Map.h describes it once
+  at compile time, for the slave and master to share, with inline accessors in place of these.
 
 */
 
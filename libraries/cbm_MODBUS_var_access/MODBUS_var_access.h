@@ -17,14 +17,19 @@
   
   By standard, a MODBUS coil is one bit, and a MODBUS register is 16 bits, big-endian.
   
-  By my own standard, the coil array is packed into 8-bit shorts.
+  By my own standard, the coil array is packed 16 coils to an unsigned short, coil 0 in bit 0
+  of the first.
+  
+  Where the layout is fixed when the sketch is written, MODBUS_Reg_Map.h describes it once
+  at compile time, for the slave and master to share, with inline accessors in place of these.
 
 */
 
 #ifndef MODBUS_var_access_h
 #define MODBUS_var_access_h
 
-#define MODBUS_var_access_version 0.1.0
+#define MODBUS_var_access_version 0.1.1
+// 2026-10-17 0.1.1 coil packing comment corrected; see MODBUS_Reg_Map.h
 
 int coilValue ( unsigned short * coils, int num_coils, int coilNo );
 int setCoilValue ( unsigned short * coils, int num_coils, int coilNo, int newValue );
@@ -31,6 +31,13 @@
 
 
 RS485::RS485() {
+  _port = NULL;
+  _pdTalkEnable = -1;
+  _handler = NULL;
+  _context = NULL;
+  _frames = _crcErrors = _gapErrors = _overflows = 0;
+  _Reset_Frame ();
+  Set_Baud ( 19200 );
 }
 
 RS485::RS485(
@@ -48,6 +55,12 @@ void RS485::Init(
   _port = port;
   // what pin do we use to enable the RS485 send? -1 means don't use any pin
   _pdTalkEnable = pdTalkEnable;
+  
+  _handler = NULL;
+  _context = NULL;
+  _frames = _crcErrors = _gapErrors = _overflows = 0;
+  _Reset_Frame ();
+  Set_Baud ( 19200 );
   /*
     // How long should an unprocessed message live ?
   _message_TTL = 10;
@@ -65,11 +78,19 @@ void RS485::Send ( unsigned char * buf, short nChars ) {
   return;
 }
 
+int RS485::available () {
+  return ( _port->available() );
+}
+
+int RS485::read () {
+  return ( _port->read() );
+}
+
 int RS485::Receive ( unsigned char * buf, unsigned int bufLen, long receive_timeout_ms ) {
 
   // returns the number of characters received
 
-  static unsigned long lastCharReceivedAt_ms;
+  unsigned long lastCharReceivedAt_ms;
   unsigned int bufPtr = 0;
   
   errorFlag = 0;
@@ -105,3 +126,107 @@ int RS485::Receive ( unsigned char * buf, unsigned int bufLen, long receive_time
 
   return ( bufPtr );
 }
+
+// ******************************************************************************
+// ******************************************************************************
+// ******************************************************************************
+
+// RTU frame assembly
+
+void RS485::Set_Baud ( unsigned long baud ) {
+  // a character is 11 bits; above 19200 baud the standard fixes the gaps
+  if ( baud > 19200 || baud == 0 ) {
+    _t15_us = 750;
+    _t35_us = 1750;
+  } else {
+    _t15_us = ( 15UL * 11UL * 100000UL ) / baud;
+    _t35_us = ( 35UL * 11UL * 100000UL ) / baud;
+  }
+}
+
+void RS485::Set_Frame_Handler ( RS485_FrameHandler handler, void * context ) {
+  _handler = handler;
+  _context = context;
+}
+
+void RS485::Poll () {
+
+  // the serial buffer holds whatever follows a frame that hasn't been read
+  if ( _frameReady ) return;
+  
+  // the time before looking, so that an empty buffer means quiet until then
+  unsigned long now = micros ();
+  if ( _port != NULL && _port->available () ) {
+    while ( _port->available () ) Feed ( _port->read () );
+    return;
+  }
+  
+  // the line has been quiet at least since the last character
+  if ( _frameLen == 0 ) return;
+  unsigned long quiet_us = now - _lastCharAt_us;
+  if ( quiet_us >= _t35_us ) {
+    _End_Frame ();
+  } else if ( quiet_us > _t15_us ) {
+    _gapSeen = true;
+  }
+  
+}
+
+void RS485::Feed ( unsigned char c ) {
+  // nowhere to put it while a frame waits to be read
+  if ( _frameReady ) return;
+  if ( _gapSeen ) _frameBad = true;
+  // the CRC is kept as the characters come; over a whole good frame it ends at 0
+  _crc = CRC::Update ( _crc, c );
+  if ( _frameLen < RS485_FRAME_LEN ) {
+    _frame [ _frameLen++ ] = c;
+  } else {
+    _overflow = true;
+  }
+  _lastCharAt_us = micros ();
+}
+
+void RS485::_End_Frame () {
+
+  if ( _overflow ) {
+    _overflows++;
+  } else if ( _frameBad ) {
+    _gapErrors++;
+  } else {
+    if ( ( _frameLen < 4 ) || ( _crc != 0 ) ) {
+      _crcErrors++;
+    } else {
+      _frames++;
+      if ( _handler == NULL ) {
+        _frameReady = true;
+        return;
+      }
+      _handler ( _frame, _frameLen, _context );
+    }
+  }
+  _Reset_Frame ();
+  
+}
+
+void RS485::_Reset_Frame () {
+  _frameLen = 0;
+  _frameReady = _gapSeen = _frameBad = _overflow = false;
+  _crc = CRC16_INIT;
+}
+
+int RS485::Frame_Available () {
+  return ( _frameReady ? _frameLen : 0 );
+}
+
+unsigned char * RS485::Frame () {
+  return ( _frame );
+}
+
+void RS485::Release_Frame () {
+  _Reset_Frame ();
+}
+
+unsigned long RS485::Frames () { return ( _frames ); }
+unsigned long RS485::CRC_Errors () { return ( _crcErrors ); }
+unsigned long RS485::Gap_Errors () { return ( _gapErrors ); }
+unsigned long RS485::Overflows () { return ( _overflows ); }
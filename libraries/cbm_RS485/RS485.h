@@ -16,14 +16,58 @@
   
   Written by Charles B. Malloch, PhD  2013-02-20
   
+  MODBUS RTU frames
+  
+    Receive waits a fixed number of milliseconds after the last character,
+    which at 57600 baud is a dozen character times. Instead, call Poll ()
+    from loop (): it takes whatever characters have arrived, without waiting,
+    and ends a frame when the line has been quiet for 3.5 character times.
+    Frames whose CRC checks go to the handler, if one is set:
+    
+      void gotFrame ( unsigned char * frame, int len, void * context ) { ... }
+      port.Set_Frame_Handler ( gotFrame );
+      
+    or else wait, one at a time, to be read:
+    
+      port.Poll ();
+      int len = port.Frame_Available ();
+      if ( len ) {
+        ... port.Frame () [ 0 .. len - 1 ] ...
+        port.Release_Frame ();
+      }
+    
+    While a frame waits, Poll () leaves the characters after it in the
+    serial buffer. A frame in which the line went quiet for more than 1.5
+    character times, or that overflows RS485_FRAME_LEN, is discarded, as are
+    those that fail the CRC; each has its counter. All of this state is in
+    the instance, so two ports can assemble frames side by side.
+    
+    The timing is measured in micros () from when Poll () finds the serial
+    buffer empty, which never shortens a gap, so frames are never cut short;
+    but Poll () must be called at least every 3.5 character times for back
+    to back frames to be told apart. Set_Baud sets the gaps; the default
+    suits 19200 baud and above.
+  
 */
 
 #ifndef RS485_h
 #define RS485_h
 
-#define RS485_h_version 0.1.0
+#define RS485_h_version 0.3.2
+// 2026-10-17 0.2.0 available () and read (), which don't wait
+// 2026-10-17 0.3.0 RTU frame assembly timed in microseconds: Poll (), Feed ()
+// 2026-10-17 0.3.1 the frame's CRC kept as its characters arrive
+// 2026-10-18 0.3.2 RS485_FRAME_LEN 80, as the receive buffer was before 0.3.0
 
 #include <Stream.h>
+#include <CRC16.h>
+
+// 80 as MODBUS_Slave's buffer always was: a reply of 37 registers is built in it
+#ifndef RS485_FRAME_LEN
+  #define RS485_FRAME_LEN 80
+#endif
+
+typedef void ( * RS485_FrameHandler ) ( unsigned char * frame, int len, void * context );
 
 class RS485 {
 	public:
@@ -50,13 +94,49 @@ class RS485 {
                   unsigned int bufLen, 
                   long receive_timeout_ms = 2
                  );
+    
+    // without waiting: characters received and not yet read, and the next one ( -1 if none )
+    int available ();
+    int read ();
+    
+    // RTU frame assembly; see above
+    // t1.5 and t3.5 are 750 and 1750 us above 19200 baud, else 1.5 and 3.5 character times
+    void Set_Baud ( unsigned long baud );
+    void Set_Frame_Handler ( RS485_FrameHandler handler, void * context = NULL );
+    void Poll ();
+    // one character from somewhere other than the port, just now; dropped while a frame waits
+    void Feed ( unsigned char c );
+    // the length of the complete frame waiting to be read, or 0
+    int Frame_Available ();
+    unsigned char * Frame ();
+    void Release_Frame ();
+    unsigned long Frames ();        // delivered
+    unsigned long CRC_Errors ();
+    unsigned long Gap_Errors ();    // quiet for more than t1.5 within a frame
+    unsigned long Overflows ();     // longer than RS485_FRAME_LEN
                  
     // errorFlag: 0 -> OK; 1 -> buffer overrun on receive
     short errorFlag;
 
 	private:
+    void _Reset_Frame ();
+    void _End_Frame ();
+    
     Stream * _port;
     short _pdTalkEnable;
+    
+    unsigned char _frame [ RS485_FRAME_LEN ];
+    int _frameLen;
+    bool _frameReady;               // complete and waiting to be read
+    bool _gapSeen;                  // quiet for more than t1.5 since the last character
+    bool _frameBad;                 // a character came after such a gap
+    bool _overflow;
+    unsigned short _crc;            // of the characters so far
+    unsigned long _lastCharAt_us;
+    unsigned long _t15_us, _t35_us;
+    RS485_FrameHandler _handler;
+    void * _context;
+    unsigned long _frames, _crcErrors, _gapErrors, _overflows;
 };
 
 #endif
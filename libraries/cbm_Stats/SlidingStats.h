@@ -0,0 +1,152 @@
+/*
+	SlidingStats.h - mean, variance, minimum, and maximum of the last N samples
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	Stats accumulates without end; SlidingStats<T, N> forgets everything but
+	the last N samples, which it keeps in a CircularBuffer<T, N> ( see
+	cbmCircularBuffer.h ), so there is no heap allocation. Each store is O(1):
+
+	  mean, variance: a sliding form of Welford's update. When a new x replaces
+	    the oldest x0 in a full window,
+	      mean' = mean + ( x - x0 ) / N
+	      M2'   = M2 + ( x - x0 ) * ( x - mean' + x0 - mean )
+	    Rounding errors in that update never age out of the window, so once
+	    every N stores the sums are recomputed from the buffer. That is O(N)
+	    once per N stores, so still O(1) amortized, and the sums never drift.
+	  minimum, maximum: monotonic deques of the sequence numbers of candidates,
+	    themselves CircularBuffer<unsigned long, N>s. A new
+	    sample removes from the back of the max deque every candidate it beats,
+	    since none of them can be the maximum again while it is in the window,
+	    and the front drops off when it leaves the window. Each sample enters
+	    and leaves each deque once, so amortized O(1); reading the answer is
+	    the front of the deque.
+
+	Sequence numbers are count (), an unsigned long, which wraps: after 2^32
+	stores on the AVR and the ESP8266, 124 days at 400 Hz. So they are only
+	ever compared by their distance, seq - front >= N, which wraps with
+	them, and whether the window is full is a flag of its own rather than
+	count () < N. reset ( count ) starts the numbering somewhere else.
+
+	RAM: the buffer, N * sizeof ( T ), plus two deques of N unsigned longs.
+	The deques hold sequence numbers, not values; the values stay in the
+	buffer. A power-of-two N makes the index arithmetic a mask.
+
+	Synopsis
+	  #include <SlidingStats.h>
+	  SlidingStats<float, 32> lta;            // long-term average, 32 samples
+	  lta.store ( energy );
+	  if ( energy > 4.0 * lta.mean () ) ...   // STA/LTA trigger
+	  float peak = lta.maximum ();            // peak hold over the window
+
+	See the note in cbmCircularBuffer.h on why a template lives entirely in
+	its header file.
+*/
+
+#ifndef SlidingStats_h
+#define SlidingStats_h
+
+#define SlidingStats_VERSION "1.001.000"
+// 2026-10-17 1.000.000 created
+// 2026-10-18 1.001.000 survives the wrap of the sequence numbers; reset ( count )
+
+#include <math.h>
+#include <cbmCircularBuffer.h>
+#include "Stats.h"   // BASIS_SAMPLE, BASIS_POPULATION
+
+template <typename T, size_t N>
+class SlidingStats
+{
+  public:
+    SlidingStats () { _bias = BASIS_SAMPLE; reset (); }
+    void setBasis ( int bias ) {
+      if ( bias == BASIS_SAMPLE || bias == BASIS_POPULATION ) _bias = bias;
+    }
+    // count: the sequence number of the first sample to come
+    void reset ( unsigned long count = 0UL ) {
+      _buf.reset ( count );
+      _filled = false;
+      _sinceResync = 0;
+      _mean = _M2 = 0.0;
+      _maxSeq.reset ();
+      _minSeq.reset ();
+    }
+
+    // returns the total number of samples stored, as CircularBuffer::store
+    unsigned long store ( T x ) {
+      unsigned long seq = _buf.count ();   // this sample's sequence number
+      double xd = x;
+      if ( ! _filled ) {
+        // filling: the ordinary Welford update
+        double delta = xd - _mean;
+        _mean += delta / ( _buf.size () + 1 );
+        _M2 += delta * ( xd - _mean );
+      } else {
+        double x0 = _buf [ 0 ];
+        double oldMean = _mean;
+        _mean += ( xd - x0 ) / N;
+        _M2 += ( xd - x0 ) * ( xd - _mean + x0 - oldMean );
+        if ( _M2 < 0.0 ) _M2 = 0.0;
+      }
+      bool wasFilled = _filled;
+      _buf.store ( x );
+      if ( _buf.size () >= N ) _filled = true;
+
+      unsigned long s;
+      // max deque: drop stale candidates at the front, N or more behind, beaten ones at the back
+      while ( _maxSeq.size () > 0 && ( unsigned long ) ( seq - _maxSeq.peek () ) >= N ) _maxSeq.shift ( s );
+      while ( _maxSeq.size () > 0 && valueAt ( _maxSeq.peekLast () ) <= x ) _maxSeq.pop ( s );
+      _maxSeq.push ( seq );
+      // and likewise for the min deque
+      while ( _minSeq.size () > 0 && ( unsigned long ) ( seq - _minSeq.peek () ) >= N ) _minSeq.shift ( s );
+      while ( _minSeq.size () > 0 && valueAt ( _minSeq.peekLast () ) >= x ) _minSeq.pop ( s );
+      _minSeq.push ( seq );
+
+      // recompute the sums from the buffer once per N stores
+      if ( wasFilled && ++_sinceResync >= N ) {
+        _sinceResync = 0;
+        _resync ();
+      }
+      return _buf.count ();
+    }
+
+    unsigned long count () { return _buf.count (); }
+    // number of samples in the window, up to N
+    size_t size () { return _buf.size (); }
+    double mean () { return _mean; }
+    double variance () {
+      long d = ( long ) size () + _bias;
+      return d > 0 ? _M2 / d : 0.0;
+    }
+    double stDev () { return sqrt ( variance () ); }
+    T minimum () { return _minSeq.size () > 0 ? valueAt ( _minSeq.peek () ) : 0; }
+    T maximum () { return _maxSeq.size () > 0 ? valueAt ( _maxSeq.peek () ) : 0; }
+    // the value stored as sample number seq, which must still be in the window
+    T valueAt ( unsigned long seq ) { return _buf [ seq - _buf.firstIndex () ]; }
+    // the samples themselves, e.g. for entries ()
+    CircularBuffer<T, N> & buffer () { return _buf; }
+
+  private:
+    void _resync () {
+      size_t n = size ();
+      double sum = 0.0;
+      for ( size_t i = 0; i < n; i++ ) sum += _buf [ i ];
+      _mean = sum / n;
+      double M2 = 0.0;
+      for ( size_t i = 0; i < n; i++ ) {
+        double d = _buf [ i ] - _mean;
+        M2 += d * d;
+      }
+      _M2 = M2;
+    }
+
+    CircularBuffer<T, N> _buf;
+    bool _filled;                         // N stored since reset (), once and for all
+    size_t _sinceResync;
+    int _bias;
+    double _mean, _M2;
+    // monotonic deques of sequence numbers
+    CircularBuffer<unsigned long, N> _maxSeq, _minSeq;
+};
+
+#endif
@@ -2,6 +2,10 @@
 	Stats.cpp - library for doing simple statistics
 	Created by Charles B. Malloch, PhD, April 3, 2009
 	Released into the public domain
+
+	Welford's update and the pairwise combination are from
+	  https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+	( "Higher-order statistics" and "Parallel algorithm" )
 */
 
 #include <Math.h>
@@ -14,6 +18,11 @@
 
 //    NOTE: the use of this-> is optional
 
+// the recordInt block: with | x - k | < 4096, ( x - k )^4 < 2^48, so 2^14
+// of them fit in s4
+#define STATS_INT_MAX_DEVIATION  4095L
+#define STATS_INT_MAX_BLOCK      16384U
+
 Stats::Stats() {
   // for *sample* stats, use basis of n-1; for *population* stats, use n
   // the bias, which will be added to n, must be thus either 0 or -1
@@ -24,10 +33,11 @@ Stats::Stats() {
 void Stats::setBasis ( int bias ) {
   if ( bias == BASIS_SAMPLE ) this->bias = BASIS_SAMPLE;
   if ( bias == BASIS_POPULATION ) this->bias = BASIS_POPULATION;
+  this->calculated = false;
 }
 
 const char *Stats::version() {
-	return "1.002.000";
+	return "1.003.000";
 }
 
 void Stats::reset() {
@@ -36,8 +46,14 @@ void Stats::reset() {
 
 void Stats::load ( unsigned long n, double xSum, double x2Sum ) {
 	this->n     = n;
-	this->xSum  = xSum;
-	this->x2Sum = x2Sum;
+	this->mu    = n > 0 ? xSum / n : 0.0;
+	this->M2    = n > 0 ? x2Sum - xSum * this->mu : 0.0;
+	if ( this->M2 < 0.0 ) this->M2 = 0.0;
+	this->M3    = 0.0;
+	this->M4    = 0.0;
+	this->xMin  = this->mu;
+	this->xMax  = this->mu;
+	this->nb    = 0;
 	this->calculated = false;    // force calculation of results
 	this->m = -655.30;
 	this->v = -655.30;
@@ -45,33 +61,121 @@ void Stats::load ( unsigned long n, double xSum, double x2Sum ) {
 }
 
 void Stats::record ( double x ) {
+  unsigned long n1 = this->n;
   this->n++;
-	this->xSum  += x;
-	this->x2Sum += x * x;
+  if ( n1 == 0 ) {
+    this->xMin = this->xMax = x;
+  } else {
+    if ( x < this->xMin ) this->xMin = x;
+    if ( x > this->xMax ) this->xMax = x;
+  }
+  double N = this->n;
+  double delta = x - this->mu;
+  double delta_n = delta / N;
+  double delta_n2 = delta_n * delta_n;
+  double term1 = delta * delta_n * n1;
+  this->mu += delta_n;
+  this->M4 += term1 * delta_n2 * ( N * N - 3.0 * N + 3.0 )
+            + 6.0 * delta_n2 * this->M2 - 4.0 * delta_n * this->M3;
+  this->M3 += term1 * delta_n * ( N - 2.0 ) - 3.0 * delta_n * this->M2;
+  this->M2 += term1;
 	this->calculated = false;    // force calculation of results
 }
 
+void Stats::recordInt ( long x ) {
+  if ( this->nb == 0 ) {
+    this->k = x;
+    this->s1 = this->s2 = this->s3 = this->s4 = 0;
+    this->bMin = this->bMax = x;
+  }
+  long d = x - this->k;
+  if ( d > STATS_INT_MAX_DEVIATION || d < -STATS_INT_MAX_DEVIATION ) {
+    record ( ( double ) x );
+    return;
+  }
+  if ( x < this->bMin ) this->bMin = x;
+  if ( x > this->bMax ) this->bMax = x;
+  // d^2 < 2^24 fits in a long
+  long d2 = d * d;
+  this->s1 += d;
+  this->s2 += d2;
+  this->s3 += ( int64_t ) d2 * d;
+  this->s4 += ( int64_t ) d2 * d2;
+  this->nb++;
+	this->calculated = false;    // force calculation of results
+  if ( this->nb >= STATS_INT_MAX_BLOCK ) _flush ();
+}
+
+void Stats::_flush () {
+  // central moments of the recordInt block, from its power sums
+  if ( this->nb == 0 ) return;
+  double nb = this->nb;
+  double delta = ( double ) this->s1 / nb;
+  double S2 = ( double ) this->s2, S3 = ( double ) this->s3, S4 = ( double ) this->s4;
+  double delta2 = delta * delta;
+  double M2b = S2 - delta * ( double ) this->s1;
+  double M3b = S3 - 3.0 * delta * S2 + 2.0 * nb * delta2 * delta;
+  double M4b = S4 - 4.0 * delta * S3 + 6.0 * delta2 * S2 - 3.0 * nb * delta2 * delta2;
+  if ( M2b < 0.0 ) M2b = 0.0;
+  this->nb = 0;
+  _combine ( ( unsigned long ) nb, this->k + delta, M2b, M3b, M4b, this->bMin, this->bMax );
+}
+
+void Stats::_combine ( unsigned long nOther, double mub, double M2b, double M3b, double M4b,
+                       double minb, double maxb ) {
+  // Chan et al.'s pairwise combination; b is the other set
+  if ( nOther == 0 ) return;
+  if ( this->n == 0 ) {
+    this->n = nOther;
+    this->mu = mub; this->M2 = M2b; this->M3 = M3b; this->M4 = M4b;
+    this->xMin = minb; this->xMax = maxb;
+    this->calculated = false;
+    return;
+  }
+  double na = this->n;
+  double nB = nOther;
+  double n = na + nB;
+  double delta = mub - this->mu;
+  double delta2 = delta * delta;
+  double M2a = this->M2, M3a = this->M3, M4a = this->M4;
+  this->mu += delta * nB / n;
+  this->M2 = M2a + M2b + delta2 * na * nB / n;
+  this->M3 = M3a + M3b + delta2 * delta * na * nB * ( na - nB ) / ( n * n )
+           + 3.0 * delta * ( na * M2b - nB * M2a ) / n;
+  this->M4 = M4a + M4b
+           + delta2 * delta2 * na * nB * ( na * na - na * nB + nB * nB ) / ( n * n * n )
+           + 6.0 * delta2 * ( na * na * M2b + nB * nB * M2a ) / ( n * n )
+           + 4.0 * delta * ( na * M3b - nB * M3a ) / n;
+  this->n += nOther;
+  if ( minb < this->xMin ) this->xMin = minb;
+  if ( maxb > this->xMax ) this->xMax = maxb;
+  this->calculated = false;
+}
+
+void Stats::merge ( const Stats & other ) {
+  Stats o = other;
+  o._flush ();
+  _combine ( o.n, o.mu, o.M2, o.M3, o.M4, o.xMin, o.xMax );
+}
+
 double *Stats::_internals() {
 	static double ret[3];
+	_flush ();
 	ret[0] = this->n;
-	ret[1] = this->xSum;
-	ret[2] = this->x2Sum;
+	ret[1] = this->mu * this->n;
+	ret[2] = this->M2 + this->mu * this->mu * this->n;
 	return ret;
 }
 
 void Stats::_calculate() {
 	if ( ! this->calculated ) {
 		// recalculate statistics; otherwise they're already done...
+		_flush ();
 		if ( this->n > 0 ) {
-			this->m = this->xSum / this->n;
+			this->m = this->mu;
 			if ( this->n > 1 ) {
-				// from WikiPedia; checks with Excel
-        if ( this->x2Sum  > ( this->xSum * this->xSum ) / this->n ) {
-          this->v = ( this->x2Sum  - (this->xSum * this->xSum ) / this->n ) / ( this->n + this->bias );
-          this->s = sqrt( this->v );
-        } else {
-          this->s = 0.0;
-        }
+				this->v = this->M2 / ( this->n + this->bias );
+				this->s = sqrt( this->v );
 			}
 		}
 		this->calculated = true;
@@ -100,16 +204,38 @@ double Stats::stDev () {
 
 double Stats::rms () {
 	if ( ! this->calculated ) this->_calculate();
-  return sqrt ( this->x2Sum / this->n );
+  return sqrt ( this->M2 / this->n + this->mu * this->mu );
 }
 
 double Stats::zScore ( double v ) {
-  if ( this->n < 4 ) return ( -1e16 );
 	if ( ! this->calculated ) this->_calculate();
+  if ( this->n < 4 ) return ( -1e16 );
 	if ( this->s < 1e-16 ) return ( -2e16 );
   return ( ( v - this->m ) / this->s );
 }
 
+double Stats::minimum () {
+	if ( ! this->calculated ) this->_calculate();
+  return this->xMin;
+}
+
+double Stats::maximum () {
+	if ( ! this->calculated ) this->_calculate();
+  return this->xMax;
+}
+
+double Stats::skewness () {
+	if ( ! this->calculated ) this->_calculate();
+  if ( this->n < 2 || this->M2 <= 0.0 ) return 0.0;
+  return ( sqrt ( ( double ) this->n ) * this->M3 / pow ( this->M2, 1.5 ) );
+}
+
+double Stats::kurtosis () {
+	if ( ! this->calculated ) this->_calculate();
+  if ( this->n < 2 || this->M2 <= 0.0 ) return 0.0;
+  return ( ( double ) this->n * this->M4 / ( this->M2 * this->M2 ) - 3.0 );
+}
+
 
 double *Stats::results() {
 	/*
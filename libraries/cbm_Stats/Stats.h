@@ -2,19 +2,48 @@
 	Stats.h - library for doing simple statistics
 	Created by Charles B. Malloch, PhD, April 3, 2009
 	Released into the public domain
-  
+
   #include <Stats.h>
   Stats theStats;
-  
+
   ...
   theStats.record ( (double) value );
   ...
   Serial.print ( theStats.mean () );
+
+  Since 1.003.000 the accumulation is Welford's: a running mean and the sums
+  of the 2nd, 3rd, and 4th powers of the deviations from it, so the variance
+  no longer comes from the difference of two large sums and stays accurate
+  over long runs. minimum, maximum, skewness, and kurtosis come along with it.
+
+  Rollups: keep one Stats per reporting interval and merge them,
+    Stats hour, interval;
+    ...
+    hour.merge ( interval );
+    interval.reset ();
+  which gives exactly what recording all the samples into hour would have.
+
+  Integer samples ( ADC counts, loop times in ms ) can use
+    theStats.recordInt ( counts );
+  which accumulates exact integer power sums of the deviations from the first
+  sample of a block, and folds the block into the Welford sums only when a
+  result is asked for ( or the block fills up ). Per sample that is integer
+  arithmetic only, where record does a divide and a dozen floating point
+  multiplies. Samples more than 4095 away from the block's first sample go
+  through record instead.
+
+  skewness is g1 = sqrt ( n ) M3 / M2^1.5; kurtosis is the excess kurtosis,
+  g2 = n M4 / M2^2 - 3, which is 0 for a normal distribution. Neither depends
+  on setBasis. After load, which knows only n and the sums, minimum, maximum,
+  skewness, and kurtosis are not meaningful. ( Not min and max: those are
+  macros in Arduino.h. )
 */
 
 #ifndef Stats_h
 #define Stats_h
 
+#include <stdint.h>
+
 #define BASIS_SAMPLE     -1
 #define BASIS_POPULATION  0
 
@@ -27,6 +56,8 @@ public:
   void reset();
   void load ( unsigned long n, double xSum, double x2Sum );
   void record ( double x );
+  void recordInt ( long x );
+  void merge ( const Stats & other );
 	double *results();
   unsigned long num();
   double mean();
@@ -34,6 +65,10 @@ public:
   double stDev();
   double rms ();
   double zScore ( double v );
+  double minimum ();
+  double maximum ();
+  double skewness ();
+  double kurtosis ();
 //	char *resultString();
 	double *_internals();
 
@@ -43,16 +78,26 @@ protected:
 	//    friend functions and classes
 	//    inheritors
 	// this-> reportedly not needed
-	
+
 private:
   // for *sample* stats, use basis of n-1; for *population* stats, use n
   // the bias, which will be added to n, must be thus either 0 or -1
   // set using setBasis with BASIS_SAMPLE or BASIS_POPULATION
   int bias;
-  double xSum, x2Sum;
 	unsigned long n;
+	// Welford: mean and sums of powers of deviations from it
+	double mu, M2, M3, M4;
+	double xMin, xMax;
+	// recordInt block: sums of powers of ( x - k ), exact
+	unsigned int nb;
+	long k;
+	int64_t s1, s2, s3, s4;
+	long bMin, bMax;
 	bool calculated;
 	double m, v, s;
+	void _combine ( unsigned long nOther, double mub, double M2b, double M3b, double M4b,
+	                double minb, double maxb );
+	void _flush ();
 	void _calculate();
 };
 
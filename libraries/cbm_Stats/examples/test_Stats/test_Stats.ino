@@ -39,6 +39,22 @@ void setup()
   Serial.print(int(banana.results()[0] * 100));       // 49950
   Serial.print("  ");
   Serial.println(int(banana.results()[1] * 100));     //          28881
+
+  // the same 1000 values in two halves, merged; integer input
+  Stats firstHalf, secondHalf;
+  for (i = 0; i < 1000; i++) {
+    if (i < 500) firstHalf.recordInt(i); else secondHalf.recordInt(i);
+  }
+  firstHalf.merge(secondHalf);
+  Serial.print(long(firstHalf.mean() * 100));          // 49950
+  Serial.print("  ");
+  Serial.println(long(firstHalf.stDev() * 100));       //          28881
+  Serial.print(long(firstHalf.minimum()));             // 0
+  Serial.print("  ");
+  Serial.println(long(firstHalf.maximum()));           //   999
+  Serial.print(long(firstHalf.skewness() * 1000));     // 0
+  Serial.print("  ");
+  Serial.println(long(firstHalf.kurtosis() * 1000));   //   -1200
 }
 
 void loop()
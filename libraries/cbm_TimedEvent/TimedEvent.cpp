@@ -39,7 +39,8 @@ void TimedEvent::stop() {
 void TimedEvent::tick() {
 	if (this->armed != 0) {
 		unsigned long now = millis();
-		if (now >= (this->msStart + this->interval)) {
+		// the difference, unlike the sum, survives millis () wrapping after 49.7 days
+		if (now - this->msStart >= this->interval) {
 			this->msStart = now;
 			this->armed = 0;
 			this->callback(this->name);
@@ -0,0 +1,213 @@
+/*
+	TimedScheduler.cpp - cooperative scheduler of periodic tasks
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+*/
+
+#include <stdio.h>
+#include <TimedScheduler.h>
+
+#if defined(__AVR__)
+	#include <avr/sleep.h>
+#endif
+
+TimedScheduler::TimedScheduler () {
+	_nTasks = _heapLen = 0;
+	_idle = NULL;
+	_idle_us = 0;
+}
+
+int TimedScheduler::Add ( TS_Callback callback, unsigned long period_us, unsigned long phase_us,
+                          unsigned long deadline_us, void * context ) {
+	if ( _nTasks >= TS_MAX_TASKS ) return ( -1 );
+	int task = _nTasks++;
+	TS_Task & t = _tasks [ task ];
+	t.callback = callback;
+	t.context = context;
+	t.period_us = period_us ? period_us : 1;
+	t.deadline_us = deadline_us ? deadline_us : t.period_us;
+	t.active = false;
+	t.runs = t.late = t.skipped = 0;
+	t.maxLateness_us = t.totalLateness_us = t.maxRun_us = 0;
+	Start ( task, phase_us );
+	return ( task );
+}
+
+void TimedScheduler::Start ( int task, unsigned long phase_us ) {
+	if ( ( task < 0 ) || ( task >= _nTasks ) ) return;
+	if ( _tasks [ task ].active ) _Remove ( task );
+	TS_Task & t = _tasks [ task ];
+	t.release_us = micros () + phase_us;
+	t.active = true;
+	_Push ( task );
+}
+
+void TimedScheduler::Stop ( int task ) {
+	if ( ( task < 0 ) || ( task >= _nTasks ) || ! _tasks [ task ].active ) return;
+	_Remove ( task );
+	_tasks [ task ].active = false;
+}
+
+void TimedScheduler::Set_Period ( int task, unsigned long period_us ) {
+	if ( ( task < 0 ) || ( task >= _nTasks ) ) return;
+	TS_Task & t = _tasks [ task ];
+	// a deadline that was the period stays the period
+	if ( t.deadline_us == t.period_us ) t.deadline_us = period_us ? period_us : 1;
+	t.period_us = period_us ? period_us : 1;
+}
+
+void TimedScheduler::Set_Idle ( void ( * idle ) () ) {
+	_idle = idle;
+}
+
+// ******************************************************************************
+// the heap, on release times compared across the wrap of micros ()
+
+bool TimedScheduler::_Before ( unsigned char a, unsigned char b ) {
+	return ( ( long ) ( _tasks [ a ].release_us - _tasks [ b ].release_us ) < 0 );
+}
+
+void TimedScheduler::_Sift_Up ( int i ) {
+	while ( i > 0 ) {
+		int parent = ( i - 1 ) >> 1;
+		if ( ! _Before ( _heap [ i ], _heap [ parent ] ) ) break;
+		unsigned char x = _heap [ i ]; _heap [ i ] = _heap [ parent ]; _heap [ parent ] = x;
+		i = parent;
+	}
+}
+
+void TimedScheduler::_Sift_Down ( int i ) {
+	while ( true ) {
+		int least = i, l = 2 * i + 1, r = l + 1;
+		if ( ( l < _heapLen ) && _Before ( _heap [ l ], _heap [ least ] ) ) least = l;
+		if ( ( r < _heapLen ) && _Before ( _heap [ r ], _heap [ least ] ) ) least = r;
+		if ( least == i ) break;
+		unsigned char x = _heap [ i ]; _heap [ i ] = _heap [ least ]; _heap [ least ] = x;
+		i = least;
+	}
+}
+
+void TimedScheduler::_Push ( unsigned char task ) {
+	_heap [ _heapLen ] = task;
+	_Sift_Up ( _heapLen++ );
+}
+
+void TimedScheduler::_Remove ( unsigned char task ) {
+	for ( int i = 0; i < _heapLen; i++ ) {
+		if ( _heap [ i ] != task ) continue;
+		_heap [ i ] = _heap [ --_heapLen ];
+		if ( i < _heapLen ) {
+			_Sift_Down ( i );
+			_Sift_Up ( i );
+		}
+		return;
+	}
+}
+
+// ******************************************************************************
+
+long TimedScheduler::Poll () {
+
+	while ( _heapLen > 0 ) {
+		unsigned char task = _heap [ 0 ];
+		TS_Task & t = _tasks [ task ];
+		unsigned long start = micros ();
+		long wait = ( long ) ( t.release_us - start );
+		if ( wait > 0 ) return ( wait );
+
+		unsigned long released = t.release_us;
+		unsigned long lateness = start - released;
+		t.callback ( t.context );
+		unsigned long end = micros ();
+
+		t.runs++;
+		t.totalLateness_us += lateness;
+		if ( lateness > t.maxLateness_us ) t.maxLateness_us = lateness;
+		if ( end - start > t.maxRun_us ) t.maxRun_us = end - start;
+		if ( ( long ) ( end - ( released + t.deadline_us ) ) > 0 ) t.late++;
+
+		// the callback may have stopped or restarted its task, which took care of the heap
+		if ( ! t.active || ( t.release_us != released ) ) continue;
+		// the next release on the grid; any that have gone by while this ran are skipped
+		t.release_us += t.period_us;
+		long behind = ( long ) ( end - t.release_us );
+		if ( behind > 0 ) {
+			unsigned long missed = behind / t.period_us + 1;
+			t.skipped += missed;
+			t.release_us += missed * t.period_us;
+		}
+		// still on top, unless the callback added a task
+		if ( _heap [ 0 ] == task ) {
+			_Sift_Down ( 0 );
+		} else {
+			_Remove ( task );
+			_Push ( task );
+		}
+	}
+	return ( -1 );
+
+}
+
+void TimedScheduler::Run ( unsigned long maxWait_us ) {
+	long wait = Poll ();
+	if ( wait <= 0 ) return;
+	_Wait_Until ( micros () + ( ( unsigned long ) wait > maxWait_us ? maxWait_us : wait ) );
+}
+
+void TimedScheduler::_Wait_Until ( unsigned long t_us ) {
+	unsigned long started = micros ();
+	long left;
+	while ( ( left = ( long ) ( t_us - micros () ) ) > 0 ) {
+		if ( _idle ) {
+			_idle ();
+			continue;
+		}
+		#if defined(__AVR__)
+			if ( ( unsigned long ) left > TS_SLEEP_MARGIN_us ) {
+				set_sleep_mode ( SLEEP_MODE_IDLE );
+				sleep_mode ();
+				continue;
+			}
+		#else
+			if ( left >= 2000L ) {
+				delay ( left / 1000L - 1 );
+				continue;
+			}
+		#endif
+		// the last stretch is spun, for precision
+	}
+	_idle_us += micros () - started;
+}
+
+// ******************************************************************************
+
+const TS_Task & TimedScheduler::Task ( int task ) {
+	return ( _tasks [ ( task >= 0 ) && ( task < _nTasks ) ? task : 0 ] );
+}
+
+unsigned long TimedScheduler::Idle_us () {
+	return ( _idle_us );
+}
+
+void TimedScheduler::Reset_Counts () {
+	for ( int i = 0; i < _nTasks; i++ ) {
+		TS_Task & t = _tasks [ i ];
+		t.runs = t.late = t.skipped = 0;
+		t.maxLateness_us = t.totalLateness_us = t.maxRun_us = 0;
+	}
+	_idle_us = 0;
+}
+
+void TimedScheduler::Report ( Print & out ) {
+	out.println ( F ( "task  period_us     runs  late  skipped  mean_late_us  max_late_us  max_run_us" ) );
+	char line [ 88 ];
+	for ( int i = 0; i < _nTasks; i++ ) {
+		TS_Task & t = _tasks [ i ];
+		snprintf ( line, sizeof ( line ), "%4d %10lu %8lu %5lu %8lu %13lu %12lu %11lu",
+		           i, t.period_us, t.runs, t.late, t.skipped,
+		           t.runs ? t.totalLateness_us / t.runs : 0UL, t.maxLateness_us, t.maxRun_us );
+		out.println ( line );
+	}
+	out.print ( F ( "idle us: " ) );
+	out.println ( _idle_us );
+}
@@ -0,0 +1,115 @@
+/*
+	TimedScheduler.h - cooperative scheduler of periodic tasks
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	TimedEvent runs one callback once per interval, and has to be tick ()ed;
+	a sketch with a dozen periodic jobs ends up with a dozen
+	"static unsigned long last...At_ms" checks and a delay () to keep loop ()
+	from spinning, and each job is late by however long the delay and the
+	other jobs took. Instead, give the scheduler the jobs, and call Run ():
+
+	  TimedScheduler scheduler;
+	  void sendStatus ( void * context ) { ... }
+
+	  setup:  scheduler.Add ( sendStatus, 2000000UL );                  // every 2 s
+	          scheduler.Add ( readSensor, 5000UL, 1000UL, 500UL );     // every 5 ms, from 1 ms, within 0.5 ms
+	  loop:   ... what must be done every time through ( WiFi, MODBUS Poll () ) ...
+	          scheduler.Run ( 10000UL );
+
+	Run () calls each task whose release time has come, earliest first, and
+	then waits until the next release, or for the longest wait given, instead
+	of a fixed delay. The tasks are kept in a min-heap on their release times,
+	so finding the next one costs nothing as the number of tasks grows.
+
+	Each task has a period; a phase, the delay to its first release; and a
+	deadline, how long after its release it must have finished ( by default,
+	its period ). Releases stay on the grid of phase + k * period, however late
+	a run starts; if a run ends after the next release has passed, the
+	releases missed are skipped and counted, rather than run back to back.
+
+	Overrun accounting, per task: runs, runs that missed their deadline,
+	releases skipped, the largest and the total lateness ( start - release ),
+	and the longest run. Idle_us () is the time spent waiting. Report ()
+	prints all of it.
+
+	The wait: with an idle function ( Set_Idle ), it is called over and over
+	until the release, for work that must not wait. Otherwise, on the AVR the
+	processor sleeps in idle mode, to be woken by timer 0 every 1.024 ms, and
+	spins the last stretch; elsewhere delay () takes the whole milliseconds,
+	so that the ESP8266's WiFi runs meanwhile, and the rest is spun.
+
+	Times are micros (), so periods up to 35 minutes.
+*/
+
+#ifndef TimedScheduler_h
+#define TimedScheduler_h
+
+#define TIMED_SCHEDULER_VERSION "1.000.000"
+// 2026-10-17 1.000.000 created
+
+#if defined(ARDUINO) && ARDUINO >= 100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#ifndef TS_MAX_TASKS
+	#define TS_MAX_TASKS 8
+#endif
+
+// on the AVR, sleep only when the release is at least this far off; timer 0 wakes it within 1024 us
+#define TS_SLEEP_MARGIN_us 1200UL
+
+typedef void ( * TS_Callback ) ( void * context );
+
+struct TS_Task {
+	TS_Callback callback;
+	void * context;
+	unsigned long period_us, deadline_us;
+	unsigned long release_us;                   // the next
+	bool active;
+	// the accounting
+	unsigned long runs, late, skipped;
+	unsigned long maxLateness_us, totalLateness_us, maxRun_us;
+};
+
+class TimedScheduler {
+	public:
+		TimedScheduler ();
+
+		// the task's number, or -1 if there are TS_MAX_TASKS already; deadline 0 is the period
+		int Add ( TS_Callback callback, unsigned long period_us, unsigned long phase_us = 0UL,
+		          unsigned long deadline_us = 0UL, void * context = NULL );
+		// Start releases the task after phase_us; Stop leaves its counts
+		void Start ( int task, unsigned long phase_us = 0UL );
+		void Stop ( int task );
+		void Set_Period ( int task, unsigned long period_us );
+
+		// runs the tasks that are due; the microseconds to the next release, 0 if one is due, -1 if none
+		long Poll ();
+		// Poll, then wait for the next release, but no more than maxWait_us; with no task started, returns
+		void Run ( unsigned long maxWait_us = 0x7FFFFFFFUL );
+		void Set_Idle ( void ( * idle ) () );
+
+		const TS_Task & Task ( int task );
+		unsigned long Idle_us ();
+		void Reset_Counts ();
+		void Report ( Print & out );
+
+	private:
+		bool _Before ( unsigned char a, unsigned char b );
+		void _Push ( unsigned char task );
+		void _Remove ( unsigned char task );
+		void _Sift_Down ( int i );
+		void _Sift_Up ( int i );
+		void _Wait_Until ( unsigned long t_us );
+
+		TS_Task _tasks [ TS_MAX_TASKS ];
+		unsigned char _heap [ TS_MAX_TASKS ];     // task numbers, the earliest release on top
+		unsigned char _nTasks, _heapLen;
+		void ( * _idle ) ();
+		unsigned long _idle_us;
+};
+
+#endif
@@ -0,0 +1,37 @@
+// test for TimedScheduler: test_Timed_Event's blink and message, without tick () or delay ()
+
+#include <TimedScheduler.h>
+
+#define LEDPin 13
+byte LEDStatus = 0;
+
+TimedScheduler scheduler;
+
+void setup() {
+	Serial.begin(115200);
+	pinMode(LEDPin, OUTPUT);
+
+	scheduler.Add(cb, 2500000UL, 2500000UL, 0UL, (void *) "grape");
+	scheduler.Add(LEDToggle, 500000UL);
+	scheduler.Add(report, 10000000UL, 10000000UL);
+}
+
+void loop() {
+	// the due callbacks, then sleep until the next one
+	scheduler.Run();
+}
+
+void cb(void *context) {
+	Serial.print(millis());
+	Serial.print("   ");
+	Serial.println((const char *) context);
+}
+
+void LEDToggle(void *context) {
+	LEDStatus = 1 - LEDStatus;
+	digitalWrite(LEDPin, LEDStatus ? HIGH : LOW);
+}
+
+void report(void *context) {
+	scheduler.Report(Serial);
+}
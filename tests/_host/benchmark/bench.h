@@ -0,0 +1,62 @@
+/*
+	bench.h - tiny timing harness for the host benchmarks
+	Released into the public domain
+
+	Synopsis
+	  double ns = benchTime_ns ( [&] ( unsigned long i ) { x.record ( i ); }, 1000000UL );
+	  benchReport ( "EWMA::record", ns, sizeof ( EWMA ) );
+
+	benchTime_ns runs the body nOps times, repeats that nRuns times, and returns
+	the best ( smallest ) time per call in nanoseconds; best-of-n is the most
+	repeatable figure on a host that is also doing other things.
+	The body receives the iteration index so it can vary its input.
+
+	benchReport prints one line: ns per op, millions of ops per second,
+	bytes of RAM per instance, and ( if bytesPerOp is given ) MB/s.
+*/
+
+#ifndef bench_h
+#define bench_h
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+
+extern volatile double benchSink;
+
+inline unsigned long long benchNow_ns () {
+  struct timespec ts;
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  return ( unsigned long long ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+template <typename Body>
+double benchTime_ns ( Body body, unsigned long nOps, int nRuns = 5 ) {
+  double best = 1e30;
+  for ( int run = 0; run < nRuns; run++ ) {
+    unsigned long long startedAt_ns = benchNow_ns ();
+    for ( unsigned long i = 0; i < nOps; i++ ) {
+      body ( i );
+    }
+    double took = ( double ) ( benchNow_ns () - startedAt_ns ) / nOps;
+    if ( took < best ) best = took;
+  }
+  return best;
+}
+
+inline void benchSection ( const char * name ) {
+  printf ( "\n%s\n", name );
+  printf ( "  %-36s %12s %10s %10s %10s\n", "", "ns/op", "Mop/s", "RAM B", "MB/s" );
+}
+
+inline void benchReport ( const char * name, double ns_per_op, size_t ramBytes,
+                          double bytesPerOp = 0.0 ) {
+  printf ( "  %-36s %12.2f %10.3f %10lu", name, ns_per_op, 1e3 / ns_per_op,
+           ( unsigned long ) ramBytes );
+  if ( bytesPerOp > 0.0 ) {
+    printf ( " %10.2f", bytesPerOp * 1e3 / ns_per_op );
+  }
+  printf ( "\n" );
+}
+
+#endif
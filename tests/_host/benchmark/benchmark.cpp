@@ -0,0 +1,2326 @@
+/*
+	benchmark.cpp - per-call cost of the hot paths of the cbm_* libraries,
+	  measured on the host
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	Host numbers are not board numbers, but they are repeatable, and the
+	ratios between implementations carry over well enough to catch regressions
+	and to decide which change is worth trying on the hardware.
+
+	Usage: make bench   ( or build/benchmark [ scale ] )
+	  scale multiplies the iteration counts; default 1
+*/
+
+#include <Arduino.h>
+
+#include <EWMA.h>
+#include <EWMA_T.h>
+#include <Biquad.h>
+#include <Stats.h>
+#include <SlidingStats.h>
+#include <cbmCircularBuffer.h>
+#include <cbmSPSCRing.h>
+#include <cbmAcquisition.h>
+#include <LSM303DLH.h>
+#include <CRC16.h>
+#include <MODBUS.h>
+#include <MODBUS_Master.h>
+#include <MODBUS_Read_Plan.h>
+#include <MODBUS_var_access.h>
+#include <MODBUS_Reg_Map.h>
+#include <MODBUS_Slave.h>
+#include <MODBUS_TCP_Gateway.h>
+#include <FFT.h>
+#include <FFT_T.h>
+#include <FFT_Pipeline.h>
+#include <FFT_STFT.h>
+#include <FFT_Kernels.h>
+#include <FFT_Match.h>
+#include <FormatFloat.h>
+#include <PrintHex.h>
+#include <TimedScheduler.h>
+
+#include <pthread.h>
+#include <algorithm>
+#include <climits>
+#include <sched.h>
+
+#include "bench.h"
+
+// not in FFT.h, but not static either
+void fix_fftr ( CMPLX * fr, int16_t fft_n );
+extern CMPLX FFT_array_freq [ FFT_SIZE ];
+extern int8_t spectrogram_array [ NBR_FRQ ][ TIME_SZ ];
+extern volatile int8_t FFT_array_time [ FFT_SIZE ];
+extern uint8_t spectro;
+extern "C" void TIMER2_OVF_vect ( void );
+
+volatile double benchSink;
+
+static const unsigned long nSamples = 4096;
+static double samples [ nSamples ];
+static unsigned char frame [ 256 ];
+
+static void initializeInputs () {
+  srand ( 12345 );
+  for ( unsigned long i = 0; i < nSamples; i++ ) {
+    // a slow sinusoid plus noise, roughly what the seismometer sees
+    samples [ i ] = 100.0 + 10.0 * sin ( i * 0.01 ) + ( rand () % 1000 ) / 100.0;
+  }
+  for ( unsigned int i = 0; i < sizeof ( frame ); i++ ) {
+    frame [ i ] = rand () & 0xff;
+  }
+}
+
+static void benchStats ( unsigned long n ) {
+  benchSection ( "cbm_Stats" );
+  Stats s;
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    s.record ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = s.mean ();
+  benchReport ( "Stats::record", ns, sizeof ( Stats ) );
+
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    s.record ( samples [ i & ( nSamples - 1 ) ] );
+    benchSink = s.stDev ();
+  }, n );
+  benchReport ( "Stats::record + stDev", ns, sizeof ( Stats ) );
+
+  static long counts [ nSamples ];
+  for ( unsigned long i = 0; i < nSamples; i++ ) counts [ i ] = ( long ) ( samples [ i ] * 10.0 );
+  s.reset ();
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    s.recordInt ( counts [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = s.mean ();
+  benchReport ( "Stats::recordInt", ns, sizeof ( Stats ) );
+
+  // accuracy on a long run with a large offset, against a two-pass reference
+  const double offset = 1e9;
+  const unsigned long nLong = 4 * nSamples;
+  double refMean = 0.0, refM2 = 0.0, refM3 = 0.0, refM4 = 0.0;
+  for ( unsigned long i = 0; i < nLong; i++ ) refMean += samples [ i & ( nSamples - 1 ) ];
+  refMean /= nLong;
+  for ( unsigned long i = 0; i < nLong; i++ ) {
+    double d = samples [ i & ( nSamples - 1 ) ] - refMean;
+    refM2 += d * d; refM3 += d * d * d; refM4 += d * d * d * d;
+  }
+  double refStDev = sqrt ( refM2 / ( nLong - 1 ) );
+  double refSkew = sqrt ( ( double ) nLong ) * refM3 / pow ( refM2, 1.5 );
+  double refKurt = nLong * refM4 / ( refM2 * refM2 ) - 3.0;
+  // one accumulator against four merged quarters
+  Stats whole, quarter [ 4 ], merged;
+  double xSum = 0.0, x2Sum = 0.0;
+  for ( unsigned long i = 0; i < nLong; i++ ) {
+    double x = offset + samples [ i & ( nSamples - 1 ) ];
+    whole.record ( x );
+    quarter [ i * 4 / nLong ].record ( x );
+    xSum += x; x2Sum += x * x;
+  }
+  for ( int q = 0; q < 4; q++ ) merged.merge ( quarter [ q ] );
+  double sumsStDev = sqrt ( fabs ( x2Sum - xSum * xSum / nLong ) / ( nLong - 1 ) );
+  printf ( "  offset %.0e, stDev %.6f: sums-of-squares error %.3g, Welford %.3g, merged %.3g\n",
+           offset, refStDev, fabs ( sumsStDev - refStDev ), fabs ( whole.stDev () - refStDev ),
+           fabs ( merged.stDev () - refStDev ) );
+  printf ( "  skewness %.6f, kurtosis %.6f: Welford errors %.3g, %.3g\n", refSkew, refKurt,
+           fabs ( whole.skewness () - refSkew ), fabs ( whole.kurtosis () - refKurt ) );
+
+  // recordInt against record on the same integers
+  Stats viaInt, viaDouble;
+  for ( unsigned long i = 0; i < nLong; i++ ) {
+    long c = counts [ i & ( nSamples - 1 ) ] + ( ( i & 1 ) ? 5000 : 0 );
+    viaInt.recordInt ( c );
+    viaDouble.record ( ( double ) c );
+  }
+  printf ( "  recordInt vs record: mean %.3g, stDev %.3g, skewness %.3g, kurtosis %.3g, max %.3g\n",
+           fabs ( viaInt.mean () - viaDouble.mean () ), fabs ( viaInt.stDev () - viaDouble.stDev () ),
+           fabs ( viaInt.skewness () - viaDouble.skewness () ),
+           fabs ( viaInt.kurtosis () - viaDouble.kurtosis () ),
+           fabs ( viaInt.maximum () - viaDouble.maximum () ) );
+}
+
+static const size_t blockLen = 64;
+
+// a block record must reproduce single records exactly
+template <typename F, typename T>
+static void checkBlock ( const char * name, F scalar, F block, const T * in, size_t len ) {
+  T out [ blockLen ];
+  unsigned long mismatches = 0;
+  for ( size_t k = 0; k + blockLen <= len; k += blockLen ) {
+    block.record ( in + k, out, blockLen );
+    for ( size_t j = 0; j < blockLen; j++ ) {
+      scalar.record ( in [ k + j ] );
+      if ( scalar.value () != out [ j ] ) mismatches++;
+    }
+  }
+  if ( scalar.count () != block.count () ) mismatches++;
+  printf ( "  %-36s block vs single records: %lu mismatches\n", name, mismatches );
+}
+
+static void checkSlidingStats ( unsigned long first, const char * note );
+
+static void benchSlidingStats ( unsigned long n ) {
+  benchSection ( "cbm_Stats SlidingStats" );
+  const size_t window = 64;
+  SlidingStats<float, window> ss;
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    ss.store ( samples [ i & ( nSamples - 1 ) ] );
+    benchSink = ss.maximum ();
+  }, n );
+  benchReport ( "SlidingStats<float, 64>::store + max", ns,
+                sizeof ( ss ) + window * sizeof ( float ) );
+
+  // what it replaces: copy the window out and rescan it
+  CircularBuffer<float> cb ( window );
+  float w [ window ];
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    cb.store ( samples [ i & ( nSamples - 1 ) ] );
+    cb.entries ( w );
+    float mx = w [ 0 ];
+    for ( size_t k = 1; k < window; k++ ) if ( w [ k ] > mx ) mx = w [ k ];
+    benchSink = mx;
+  }, n / 16 );
+  benchReport ( "CircularBuffer + entries + rescan", ns,
+                sizeof ( cb ) + window * sizeof ( float ) );
+
+  checkSlidingStats ( 0UL, "" );
+  // sequence numbers that wrap a few windows in
+  checkSlidingStats ( ULONG_MAX - 3 * window, ", from ULONG_MAX - 192" );
+}
+
+// against a brute-force rescan, over several windows' worth, the sequence numbers from first
+static void checkSlidingStats ( unsigned long first, const char * note ) {
+  const size_t window = 64;
+  SlidingStats<float, window> chk;
+  chk.reset ( first );
+  double maxErrMean = 0.0, maxErrStDev = 0.0;
+  unsigned long extremaMismatches = 0;
+  for ( unsigned long i = 0; i < 8 * nSamples; i++ ) {
+    // an offset and a slow ramp, to give the drift something to work on
+    chk.store ( 1000.0 + samples [ i & ( nSamples - 1 ) ] + i * 1e-3 );
+    size_t m = chk.size ();
+    double sum = 0.0, M2 = 0.0;
+    float mn = chk.valueAt ( chk.count () - m ), mx = mn;
+    for ( size_t k = 0; k < m; k++ ) {
+      float v = chk.buffer () [ k ];
+      sum += v;
+      if ( v < mn ) mn = v;
+      if ( v > mx ) mx = v;
+    }
+    double mean = sum / m;
+    for ( size_t k = 0; k < m; k++ ) M2 += ( chk.buffer () [ k ] - mean ) * ( chk.buffer () [ k ] - mean );
+    double stDev = m > 1 ? sqrt ( M2 / ( m - 1 ) ) : 0.0;
+    if ( fabs ( chk.mean () - mean ) > maxErrMean ) maxErrMean = fabs ( chk.mean () - mean );
+    if ( fabs ( chk.stDev () - stDev ) > maxErrStDev ) maxErrStDev = fabs ( chk.stDev () - stDev );
+    if ( chk.minimum () != mn || chk.maximum () != mx ) extremaMismatches++;
+  }
+  printf ( "  vs rescan%s: max error mean %.3g, stDev %.3g; min/max mismatches %lu; %s\n",
+           note, maxErrMean, maxErrStDev, extremaMismatches,
+           maxErrMean < 1e-3 && maxErrStDev < 1e-3 && extremaMismatches == 0 ? "correct" : "WRONG" );
+}
+
+static void benchEWMA ( unsigned long n ) {
+  benchSection ( "cbm_EWMA" );
+  EWMA e ( e.alpha ( 200 ) );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = e.record ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchReport ( "EWMA::record", ns, sizeof ( EWMA ) );
+
+  LPF lpf ( 40.0, 62.0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    lpf.record ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = lpf.value ();
+  benchReport ( "LPF::record", ns, sizeof ( LPF ) );
+
+  HPF hpf ( 0.01, 62.0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    hpf.record ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = hpf.value ();
+  benchReport ( "HPF::record", ns, sizeof ( HPF ) );
+
+  BPF bpf ( 0.01, 40.0, 62.0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    bpf.record ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = bpf.value ();
+  benchReport ( "BPF::record", ns, sizeof ( BPF ) );
+
+  static double out [ blockLen ];
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    e.record ( &samples [ ( i * blockLen ) & ( nSamples - 1 ) ], out, blockLen );
+  }, n / blockLen );
+  benchSink = out [ 0 ];
+  benchReport ( "EWMA::record ( block, per sample )", ns / blockLen, sizeof ( EWMA ) );
+
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    bpf.record ( &samples [ ( i * blockLen ) & ( nSamples - 1 ) ], out, blockLen );
+  }, n / blockLen );
+  benchSink = out [ 0 ];
+  benchReport ( "BPF::record ( block, per sample )", ns / blockLen, sizeof ( BPF ) );
+
+  checkBlock ( "EWMA", EWMA ( e.alpha ( 200 ) ), EWMA ( e.alpha ( 200 ) ), samples, nSamples );
+  checkBlock ( "HPF", HPF ( 0.5, 62.0 ), HPF ( 0.5, 62.0 ), samples, nSamples );
+  checkBlock ( "BPF", BPF ( 0.01, 40.0, 62.0 ), BPF ( 0.01, 40.0, 62.0 ), samples, nSamples );
+}
+
+template <typename T>
+static void benchEWMA_T ( const char * typeName, unsigned long n, double scale ) {
+  char name [ 48 ];
+  static T in [ nSamples ];
+  for ( unsigned long i = 0; i < nSamples; i++ ) in [ i ] = ( T ) ( samples [ i ] * scale );
+
+  EWMA_T<T> e ( EWMA_T<T>::alpha ( 200 ) );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = e.record ( in [ i & ( nSamples - 1 ) ] );
+  }, n );
+  snprintf ( name, sizeof ( name ), "EWMA_T<%s>::record", typeName );
+  benchReport ( name, ns, sizeof ( e ) );
+
+  BPF_T<T> bpf ( 0.01, 40.0, 62.0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    bpf.record ( in [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = bpf.value ();
+  snprintf ( name, sizeof ( name ), "BPF_T<%s>::record", typeName );
+  benchReport ( name, ns, sizeof ( bpf ) );
+
+  static T out [ blockLen ];
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    bpf.record ( &in [ ( i * blockLen ) & ( nSamples - 1 ) ], out, blockLen );
+  }, n / blockLen );
+  benchSink = out [ 0 ];
+  snprintf ( name, sizeof ( name ), "BPF_T<%s>::record ( block )", typeName );
+  benchReport ( name, ns / blockLen, sizeof ( bpf ) );
+  checkBlock ( name, BPF_T<T> ( 0.01, 40.0, 62.0 ), BPF_T<T> ( 0.01, 40.0, 62.0 ), in, nSamples );
+
+  // agreement with the double-precision filters, in units of T
+  EWMA ref ( EWMA_T<T>::alpha ( 200 ) );
+  LPF refLPF ( 5.0, 62.0 );
+  e.init ( EWMA_T<T>::alpha ( 200 ) );
+  LPF_T<T> lpf ( 5.0, 62.0 );
+  double maxErr = 0.0, maxErrLPF = 0.0;
+  for ( unsigned long i = 0; i < 4 * nSamples; i++ ) {
+    T x = in [ i & ( nSamples - 1 ) ];
+    double err = fabs ( ( double ) e.record ( x ) - ref.record ( x ) );
+    if ( err > maxErr ) maxErr = err;
+    lpf.record ( x );
+    refLPF.record ( x );
+    err = fabs ( ( double ) lpf.value () - refLPF.value () );
+    if ( err > maxErrLPF ) maxErrLPF = err;
+  }
+  printf ( "  %-36s max |error| vs double: EWMA %.3g, LPF %.3g\n", "", maxErr, maxErrLPF );
+}
+
+// steady-state gain of a filter at frequency f, by running a sine through it
+template <typename F>
+static double measuredGain ( F & filter, double f, double F_sampling, double amplitude ) {
+  typedef __typeof__ ( filter.value () ) T;
+  const unsigned long settle = 20000, measure = 20000;
+  double sumIn2 = 0.0, sumOut2 = 0.0;
+  filter.reset ();
+  for ( unsigned long i = 0; i < settle + measure; i++ ) {
+    double x = amplitude * sin ( 2.0 * M_PI * f * i / F_sampling );
+    filter.record ( ( T ) x );
+    if ( i >= settle ) {
+      double y = filter.value ();
+      sumIn2 += x * x;
+      sumOut2 += y * y;
+    }
+  }
+  return sqrt ( sumOut2 / sumIn2 );
+}
+
+template <typename T>
+static void benchBiquad_T ( const char * typeName, unsigned long n, double scale ) {
+  char name [ 48 ];
+  static T in [ nSamples ], out [ blockLen ];
+  for ( unsigned long i = 0; i < nSamples; i++ ) in [ i ] = ( T ) ( ( samples [ i ] - 100.0 ) * scale );
+
+  Biquad<T, 4> bq;
+  bq.bandpass ( 2, 0.5, 10.0, 62.0 );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = bq.record ( in [ i & ( nSamples - 1 ) ] );
+  }, n );
+  snprintf ( name, sizeof ( name ), "Biquad<%s>, 2 sections", typeName );
+  benchReport ( name, ns, sizeof ( bq ) );
+
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    bq.record ( &in [ ( i * blockLen ) & ( nSamples - 1 ) ], out, blockLen );
+  }, n / blockLen );
+  benchSink = out [ 0 ];
+  snprintf ( name, sizeof ( name ), "Biquad<%s>, 2 sections ( block )", typeName );
+  benchReport ( name, ns / blockLen, sizeof ( bq ) );
+  checkBlock ( name, bq, bq, in, nSamples );
+}
+
+static void benchBiquad ( unsigned long n ) {
+  benchSection ( "cbm_EWMA Biquad" );
+  benchBiquad_T<int16_t> ( "int16_t", n, 1000.0 );
+  benchBiquad_T<int32_t> ( "int32_t", n, 1e6 );
+  benchBiquad_T<float> ( "float", n, 1.0 );
+
+  // roll-off of a 0.5 - 10 Hz band at 62 Hz: EWMA BPF against order-2 Butterworth
+  const double Fs = 62.0, low = 0.5, high = 10.0;
+  BiquadCoefs sos [ 4 ];
+  int nSections = biquadBandpass ( sos, 2, low, high, Fs );
+  BPF ewmaBand ( low, high, Fs );
+  Biquad<double, 4> bqD ( sos, nSections );
+  Biquad<float, 4> bqF ( sos, nSections );
+  Biquad<int16_t, 4> bq16 ( sos, nSections );
+  Biquad<int32_t, 4> bq32 ( sos, nSections );
+  const double freqs [] = { 0.05, 0.25, 0.5, 2.0, 10.0, 20.0, 30.0 };
+  printf ( "\n  gain, dB     %8s %8s %8s %8s %8s %8s\n",
+           "Hz", "EWMA BPF", "design", "double", "int16", "int32" );
+  for ( unsigned int k = 0; k < sizeof ( freqs ) / sizeof ( freqs [ 0 ] ); k++ ) {
+    double f = freqs [ k ];
+    printf ( "               %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", f,
+             20.0 * log10 ( measuredGain ( ewmaBand, f, Fs, 1.0 ) ),
+             20.0 * log10 ( biquadGain ( sos, nSections, f, Fs ) ),
+             20.0 * log10 ( measuredGain ( bqD, f, Fs, 1.0 ) ),
+             20.0 * log10 ( measuredGain ( bq16, f, Fs, 10000.0 ) ),
+             20.0 * log10 ( measuredGain ( bq32, f, Fs, 1e8 ) ) );
+  }
+  ( void ) bqF;
+
+  // an odd order takes as many sections as its order, so Biquad<T, 1> is still a band
+  Biquad<float, 1> bq1;
+  Biquad<float, 3> bq3;
+  int n1 = bq1.bandpass ( 4, low, high, Fs ), n3 = bq3.bandpass ( 3, low, high, Fs );
+  BiquadCoefs apart [ 4 ];
+  int nApart = biquadHighpass ( apart, 3, low, Fs );
+  nApart += biquadLowpass ( &apart [ nApart ], 3, high, Fs );
+  int nJoined = biquadBandpass ( sos, 3, low, high, Fs );
+  double worst = 0.0;
+  for ( unsigned int k = 0; k < sizeof ( freqs ) / sizeof ( freqs [ 0 ] ); k++ ) {
+    double d = fabs ( 20.0 * log10 ( biquadGain ( sos, nJoined, freqs [ k ], Fs )
+                                      / biquadGain ( apart, nApart, freqs [ k ], Fs ) ) );
+    if ( d > worst ) worst = d;
+  }
+  double pass1 = measuredGain ( bq1, 2.0, Fs, 1.0 ), stop1 = measuredGain ( bq1, 30.0, Fs, 1.0 );
+  printf ( "  Biquad<float, 1>::bandpass: %d section, %.2f dB at 2 Hz, %.2f dB at 30 Hz; "
+           "order 3 in %d sections, %.1g dB from 4 apart; %s\n",
+           n1, 20.0 * log10 ( pass1 ), 20.0 * log10 ( stop1 ), n3, worst,
+           n1 == 1 && n3 == 3 && nJoined == 3 && pass1 > 0.8 && stop1 < 0.5 && worst < 1e-9 ? "correct" : "WRONG" );
+}
+
+// random deque operations on a CircularBuffer and on a plain array
+template <typename B>
+static unsigned long checkDeque ( B & buf, int capacity ) {
+  int model [ 64 ], mHead = 28, mLen = 0;
+  unsigned long mismatches = 0;
+  srand ( 1 );
+  for ( unsigned long i = 0; i < 100000; i++ ) {
+    int v = rand (), x = 0;
+    bool ok;
+    switch ( rand () % 5 ) {
+      case 0:   // store, overwriting
+        buf.store ( v );
+        if ( mLen == capacity ) { mHead++; mLen--; }
+        model [ mHead + mLen++ ] = v;
+        break;
+      case 1:
+        ok = mLen < capacity;
+        if ( buf.push ( v ) != ok ) mismatches++;
+        if ( ok ) model [ mHead + mLen++ ] = v;
+        break;
+      case 2:
+        ok = mLen > 0;
+        if ( buf.pop ( x ) != ok ) mismatches++;
+        if ( ok && x != model [ mHead + --mLen ] ) mismatches++;
+        break;
+      case 3:
+        ok = mLen < capacity;
+        if ( buf.unshift ( v ) != ok ) mismatches++;
+        if ( ok ) { model [ --mHead ] = v; mLen++; }
+        break;
+      case 4:
+        ok = mLen > 0;
+        if ( buf.shift ( x ) != ok ) mismatches++;
+        if ( ok && x != model [ mHead++ ] ) mismatches++;
+        if ( ok ) mLen--;
+        break;
+    }
+    // keep the model's window away from the ends of its array
+    if ( mHead < 12 || mHead > 40 ) {
+      for ( int k = 0; k < mLen; k++ ) model [ 28 + k ] = model [ mHead + k ];
+      mHead = 28;
+    }
+    if ( ( int ) buf.size () != mLen ) mismatches++;
+    for ( int k = 0; k < mLen; k++ ) if ( buf [ k ] != model [ mHead + k ] ) mismatches++;
+    if ( mLen > 0 && ( buf.peek () != model [ mHead ] || buf.peekLast () != model [ mHead + mLen - 1 ] ) ) mismatches++;
+    int * p;
+    int k = 0;
+    size_t n1 = buf.firstSpan ( p );
+    for ( size_t j = 0; j < n1; j++ ) if ( p [ j ] != model [ mHead + k++ ] ) mismatches++;
+    size_t n2 = buf.secondSpan ( p );
+    for ( size_t j = 0; j < n2; j++ ) if ( p [ j ] != model [ mHead + k++ ] ) mismatches++;
+    if ( k != mLen ) mismatches++;
+  }
+  return mismatches;
+}
+
+static void benchCircularBuffer ( unsigned long n ) {
+  benchSection ( "cbm_CircularBuffer" );
+  const size_t bufSize = 20;
+  CircularBuffer<float> cb ( bufSize );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    cb.store ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = cb.count ();
+  benchReport ( "CircularBuffer<float>(20)::store", ns,
+                sizeof ( cb ) + bufSize * sizeof ( float ) );
+
+  float out [ bufSize ];
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    cb.entries ( out );
+    benchSink = out [ i % bufSize ];
+  }, n / 16 );
+  benchReport ( "CircularBuffer<float>(20)::entries", ns,
+                sizeof ( cb ) + bufSize * sizeof ( float ) );
+
+  CircularBuffer<float, bufSize> cbs;
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    cbs.store ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = cbs.count ();
+  benchReport ( "CircularBuffer<float, 20>::store", ns, sizeof ( cbs ) );
+
+  CircularBuffer<float, 32> cb32;
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    cb32.store ( samples [ i & ( nSamples - 1 ) ] );
+  }, n );
+  benchSink = cb32.count ();
+  benchReport ( "CircularBuffer<float, 32>::store", ns, sizeof ( cb32 ) );
+
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    float * p;
+    float sum = 0.0;
+    size_t m = cbs.firstSpan ( p );
+    for ( size_t k = 0; k < m; k++ ) sum += p [ k ];
+    m = cbs.secondSpan ( p );
+    for ( size_t k = 0; k < m; k++ ) sum += p [ k ];
+    benchSink = sum;
+  }, n / 16 );
+  benchReport ( "CircularBuffer<float, 20> spans, summed", ns, sizeof ( cbs ) );
+
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    float x;
+    cb32.push ( ( float ) i );
+    cb32.shift ( x );
+    benchSink = x;
+  }, n );
+  benchReport ( "CircularBuffer<float, 32> push + shift", ns, sizeof ( cb32 ) );
+
+  // the two flavors, power of two or not, against a plain model
+  CircularBuffer<int> dyn ( 7 );
+  CircularBuffer<int, 7> odd;
+  CircularBuffer<int, 8> pow2;
+  unsigned long mismatches = checkDeque ( dyn, 7 ) + checkDeque ( odd, 7 ) + checkDeque ( pow2, 8 );
+  printf ( "  deque operations vs model: %lu mismatches\n", mismatches );
+}
+
+// a producer thread standing in for the timer ISR
+static SPSCRing<uint32_t, 64> spsc;
+static const uint32_t spscCount = 4000000UL;
+
+static void * spscProducer ( void * ) {
+  for ( uint32_t i = 0; i < spscCount; i++ ) {
+    spsc.push ( i );
+    // now and then, faster than the consumer for a while; on one CPU, give
+    // the consumer its turn as a timer ISR would give loop () its turn
+    if ( ( i & 0x3ff ) < 0x3c0 ) for ( volatile int k = 0; k < 20; k++ ) ;
+    if ( ( i & 0x3f ) == 0x3f ) sched_yield ();
+  }
+  return NULL;
+}
+
+static void benchSPSCRing ( unsigned long n ) {
+  benchSection ( "cbm_CircularBuffer SPSCRing" );
+  SPSCRing<int16_t, 64> ring;
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    int16_t x = 0;
+    ring.push ( ( int16_t ) i );
+    ring.pop ( x );
+    benchSink = x;
+  }, n );
+  benchReport ( "SPSCRing<int16_t, 64> push + pop", ns, sizeof ( ring ) );
+
+  // every value arrives once, in order; the only gaps are counted overruns
+  pthread_t producer;
+  pthread_create ( &producer, NULL, spscProducer, NULL );
+  uint32_t expected = 0, x, buf [ 16 ];
+  unsigned long received = 0, skipped = 0, disorder = 0;
+  while ( expected < spscCount ) {
+    size_t m = spsc.pop ( buf, 16 );
+    for ( size_t k = 0; k < m; k++ ) {
+      x = buf [ k ];
+      if ( x < expected ) disorder++;
+      else skipped += x - expected;
+      expected = x + 1;
+      received++;
+    }
+    if ( m == 0 && spsc.overruns () + received >= spscCount ) break;
+    if ( m == 0 ) sched_yield ();
+  }
+  pthread_join ( producer, NULL );
+  while ( spsc.pop ( x ) ) { skipped += x - expected; expected = x + 1; received++; }
+  skipped += spscCount - expected;
+  printf ( "  two threads: %lu received, %lu overruns, %lu skipped, %lu out of order, high water %lu\n",
+           received, spsc.overruns (), skipped, disorder, ( unsigned long ) spsc.highWater () );
+}
+
+static unsigned long acqReads = 0;
+static bool acqReader ( float & v ) {
+  // every 100th read fails, as an I2C NAK would
+  acqReads++;
+  v = ( float ) acqReads;
+  return ( acqReads % 100 ) != 0;
+}
+
+static void benchAcquisition ( unsigned long n ) {
+  benchSection ( "cbm_Acquisition" );
+  static Acquisition<float, 64> acq;
+  AcquisitionSample<float> block [ 16 ];
+  acq.begin ( 1e6, acqReader, ACQUISITION_EXTERNAL );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    acq.tick ();
+    if ( ( i & 15 ) == 15 ) benchSink = acq.read ( block, 16 );
+  }, n );
+  benchReport ( "Acquisition<float, 64>::tick", ns, sizeof ( acq ) );
+  printf ( "  no timer on the host: begin ( ACQUISITION_TIMER ) %s\n",
+           acq.begin ( 1000.0, acqReader ) ? "started" : "refused" );
+
+  // paced at 10 kHz: one tick held back three periods, then loop () stalls
+  // for 100 ticks, which the ring of 64 can't absorb
+  const unsigned long ticks = 2000;
+  acqReads = 0;
+  acq.begin ( 10000.0, acqReader, ACQUISITION_EXTERNAL );
+  unsigned long next = micros (), received = 0, misordered = 0, lastT = 0;
+  for ( unsigned long i = 0; i < ticks; i++ ) {
+    next += acq.period_us () * ( i == 500 ? 3 : 1 );
+    while ( ( long ) ( micros () - next ) < 0 ) ;
+    acq.tick ();
+    if ( i >= 1000 && i < 1100 ) continue;
+    size_t m;
+    while ( ( m = acq.read ( block, 16 ) ) > 0 ) {
+      for ( size_t k = 0; k < m; k++ ) {
+        if ( received > 0 && block [ k ].t_us < lastT ) misordered++;
+        lastT = block [ k ].t_us;
+        received++;
+      }
+    }
+  }
+  printf ( "  %lu ticks: %lu received, %lu read failures, %lu overruns, %lu late, "
+           "max jitter %lu us, high water %lu, %lu out of order\n",
+           acq.samples (), received, acq.readFailures (), acq.overruns (), acq.late (),
+           acq.maxJitter_us (), ( unsigned long ) acq.highWater (), misordered );
+  acq.end ();
+}
+
+// the old one-register-at-a-time read, for comparison
+class LSM303DLH_probe : public LSM303DLH {
+  public:
+    void getAccelBytewise ( int16_t * xyz ) {
+      const int a = 0x18;
+      xyz [ 0 ] = ( ( int16_t ) read ( a, 0x29 ) << 8 ) | read ( a, 0x28 );
+      xyz [ 1 ] = ( ( int16_t ) read ( a, 0x2B ) << 8 ) | read ( a, 0x2A );
+      xyz [ 2 ] = ( ( int16_t ) read ( a, 0x2D ) << 8 ) | read ( a, 0x2C );
+    }
+};
+
+static void benchLSM303DLH ( unsigned long n ) {
+  benchSection ( "cbm_LSM303DLH ( simulated bus )" );
+  static uint8_t acc [ 128 ], mag [ 128 ];
+  Wire.attachDevice ( 0x18, acc, WIRE_INCREMENT_ON_MSB );
+  Wire.attachDevice ( 0x1E, mag, WIRE_INCREMENT_ALWAYS );
+  LSM303DLH_probe compass;
+  compass.init ( 2, 0 );
+  // X = -2, Y = 1000, Z = 16384, low byte first; the magnetometer high first
+  const uint8_t out [ 6 ] = { 0xfe, 0xff, 0xe8, 0x03, 0x00, 0x40 };
+  memcpy ( &acc [ 0x28 ], out, 6 );
+  const uint8_t outM [ 6 ] = { 0xff, 0xfe, 0x03, 0xe8, 0x40, 0x00 };
+  memcpy ( &mag [ 0x03 ], outM, 6 );
+  int16_t raw [ 3 ], old [ 3 ], rawM [ 3 ];
+  bool ok = compass.getAccelRaw ( raw );
+  compass.getAccelBytewise ( old );
+  compass.getMagRaw ( rawM );
+  compass.setDataRate ( 400 );
+  printf ( "  accel %d %d %d ( bytewise %d %d %d ), mag %d %d %d, %s; CTRL_REG1_A %02x, CTRL_REG4_A %02x\n",
+           raw [ 0 ], raw [ 1 ], raw [ 2 ], old [ 0 ], old [ 1 ], old [ 2 ],
+           rawM [ 0 ], rawM [ 1 ], rawM [ 2 ], ok ? "ok" : "FAILED", acc [ 0x20 ], acc [ 0x23 ] );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    compass.getAccelRaw ( raw );
+    benchSink = raw [ 0 ];
+  }, n / 10 );
+  benchReport ( "LSM303DLH::getAccelRaw ( host CPU )", ns, sizeof ( compass ) );
+
+  // what the hardware would spend on the bus per sample
+  Wire.resetCounts ();
+  compass.getAccelBytewise ( old );
+  unsigned long bitsOld = Wire.busBits (), transOld = Wire.transactions ();
+  Wire.resetCounts ();
+  compass.getAccelRaw ( raw );
+  unsigned long bitsNew = Wire.busBits (), transNew = Wire.transactions ();
+  printf ( "  bus per sample: bytewise %lu bits in %lu transactions ( %.0f us at 100 kHz ), "
+           "burst %lu bits in %lu ( %.0f us at 100 kHz, %.0f us at 400 kHz )\n",
+           bitsOld, transOld, bitsOld * 10.0, bitsNew, transNew, bitsNew * 10.0, bitsNew * 2.5 );
+
+  // a dead bus fails cleanly instead of hanging
+  LSM303DLH_probe absent;
+  absent.init ( 2, 1 );   // SA0 high: 0x19, where nothing answers
+  printf ( "  no device: getAccelRaw %s\n", absent.getAccelRaw ( raw ) ? "succeeded?" : "returned false" );
+}
+
+// the MODBUS CRC a bit at a time, to check the others against
+static unsigned short crcBitwise ( const unsigned char * p, unsigned short len ) {
+  unsigned short crc = 0xffff;
+  while ( len-- ) {
+    crc ^= *p++;
+    for ( int k = 0; k < 8; k++ ) crc = ( crc & 1 ) ? ( crc >> 1 ) ^ 0xa001 : crc >> 1;
+  }
+  return crc;
+}
+
+static unsigned short crcByUpdate ( unsigned char * p, unsigned short len ) {
+  unsigned short crc = CRC16_INIT;
+  while ( len-- ) crc = CRC::Update ( crc, *p++ );
+  return crc;
+}
+
+static void benchCRC ( unsigned long n ) {
+  benchSection ( "cbm_CRC16 ( RAM B here; table RAM on the AVR after AVR )" );
+  struct {
+    const char * name;
+    unsigned short ( * f ) ( unsigned char *, unsigned short );
+    const char * ramAVR;
+    size_t ram;
+  } methods [] = {
+    { "CRC16_TwoTable",  CRC::CRC16_TwoTable,  "512",  512 },
+    { "CRC16_Table",     CRC::CRC16_Table,     "0",    512 },
+    { "CRC16_Nibble",    CRC::CRC16_Nibble,    "32",   32 },
+    { "CRC16_Slice4",    CRC::CRC16_Slice4,    "-",    4 * 512 },
+    { "CRC16_Slice8",    CRC::CRC16_Slice8,    "-",    8 * 512 },
+    { "Update",          crcByUpdate,         "0",    512 }
+  };
+  const int nMethods = sizeof ( methods ) / sizeof ( methods [ 0 ] );
+
+  // all agree with the bitwise CRC, at every length and alignment
+  int disagreements = 0;
+  for ( int m = 0; m < nMethods; m++ ) {
+    for ( unsigned short len = 0; len < 40; len++ ) {
+      for ( int offset = 0; offset < 4; offset++ ) {
+        if ( methods [ m ].f ( frame + offset, len ) != crcBitwise ( frame + offset, len ) ) disagreements++;
+      }
+    }
+  }
+  // and a frame with its CRC appended leaves 0
+  unsigned char msg [ 10 ];
+  memcpy ( msg, frame, 8 );
+  unsigned short c = CRC::CRC16 ( msg, 8 );
+  msg [ 8 ] = c & 0xff;
+  msg [ 9 ] = c >> 8;
+  printf ( "  %d disagreements with the bitwise CRC; frame plus CRC leaves 0x%04x\n",
+           disagreements, crcByUpdate ( msg, 10 ) );
+
+  const unsigned short lens [] = { 8, 64, 256 };
+  char label [ 64 ];
+  for ( int L = 0; L < 3; L++ ) {
+    for ( int m = 0; m < nMethods; m++ ) {
+      unsigned short len = lens [ L ];
+      double ns = benchTime_ns ( [&] ( unsigned long i ) {
+        frame [ 0 ] = i;
+        benchSink = methods [ m ].f ( frame, len );
+      }, n / ( len / 4 ) );
+      snprintf ( label, sizeof ( label ), "%-16s %3d B   AVR %s", methods [ m ].name, len, methods [ m ].ramAVR );
+      benchReport ( label, ns, methods [ m ].ram, len );
+    }
+  }
+}
+
+static void benchMODBUS ( unsigned long n ) {
+  benchSection ( "cbm_MODBUS" );
+  NullStream bus;
+  MODBUS port ( &bus );
+  unsigned char msg [ 16 ] = { 0x01, 0x04, 0x00, 0x00, 0x00, 0x0a };
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    msg [ 3 ] = i;
+    port.Send ( msg, 6 );
+  }, n / 4 );
+  benchReport ( "MODBUS::Send ( read request )", ns, sizeof ( MODBUS ), 8 );
+}
+
+/*
+  SlaveBus is an RS485 bus with slaves 1 .. nSlaves on it, as the master's
+  UART sees it. A request goes out when RS485::Send flushes, which takes its
+  characters' time as on the board; the addressed slave's reply then arrives
+  one character per character time after a turnaround. Register r of slave
+  s reads s * 100 + r, and coil c is on when c is odd; writes are echoed.
+  Addresses of 1000 and up get exception 0x02, and slaves beyond nSlaves
+  don't answer at all.
+*/
+class SlaveBus : public Stream {
+  public:
+    SlaveBus ( unsigned long baud, unsigned long turnaround_us, int nSlaves ) {
+      _char_us = 11000000UL / baud;
+      _turnaround_us = turnaround_us;
+      _nSlaves = nSlaves;
+      _reqLen = _repLen = _repPos = 0;
+      _replyAt_us = 0;
+      _requests = 0;
+    }
+    size_t write ( uint8_t c ) {
+      if ( _reqLen < sizeof ( _req ) ) _req [ _reqLen++ ] = c;
+      return 1;
+    }
+    using Print::write;
+    void flush () {
+      unsigned long startedAt_us = micros ();
+      while ( micros () - startedAt_us < _reqLen * _char_us ) ;
+      _answer ();
+      _reqLen = 0;
+    }
+    int available () { return _arrived () - _repPos; }
+    int read () { return available () > 0 ? _rep [ _repPos++ ] : -1; }
+    int peek () { return available () > 0 ? _rep [ _repPos ] : -1; }
+    unsigned long char_us () { return _char_us; }
+    unsigned long requests () { return _requests; }
+
+  private:
+    int _arrived () {
+      long since = ( long ) ( micros () - _replyAt_us );
+      if ( since < 0 ) return 0;
+      int n = since / _char_us;
+      return n < _repLen ? n : _repLen;
+    }
+    void _answer () {
+      CRC crc;
+      _repLen = _repPos = 0;
+      _requests++;
+      if ( _reqLen < 8 ) return;
+      if ( crc.CRC16 ( _req, _reqLen - 2 ) != ( _req [ _reqLen - 2 ] | ( _req [ _reqLen - 1 ] << 8 ) ) ) return;
+      int slave = _req [ 0 ], fn = _req [ 1 ];
+      if ( slave < 1 || slave > _nSlaves ) return;
+      int start = ( _req [ 2 ] << 8 ) | _req [ 3 ];
+      int n = ( _req [ 4 ] << 8 ) | _req [ 5 ];
+      _rep [ _repLen++ ] = slave;
+      if ( start >= 1000 ) {
+        _rep [ _repLen++ ] = fn | 0x80;
+        _rep [ _repLen++ ] = 0x02;              // illegal data address
+      } else if ( fn == 0x03 || fn == 0x04 ) {
+        _rep [ _repLen++ ] = fn;
+        _rep [ _repLen++ ] = 2 * n;
+        for ( int k = 0; k < n; k++ ) {
+          int v = slave * 100 + start + k;
+          _rep [ _repLen++ ] = v >> 8;
+          _rep [ _repLen++ ] = v & 0xff;
+        }
+      } else if ( fn == 0x01 ) {
+        _rep [ _repLen++ ] = fn;
+        int nBytes = ( n + 7 ) >> 3;
+        _rep [ _repLen++ ] = nBytes;
+        for ( int b = 0; b < nBytes; b++ ) {
+          uint8_t bits = 0;
+          for ( int i = 0; i < 8 && 8 * b + i < n; i++ ) {
+            if ( ( start + 8 * b + i ) & 1 ) bits |= 1 << i;
+          }
+          _rep [ _repLen++ ] = bits;
+        }
+      } else {
+        for ( int i = 1; i < 6; i++ ) _rep [ _repLen++ ] = _req [ i ];
+      }
+      unsigned short c = crc.CRC16 ( _rep, _repLen );
+      _rep [ _repLen++ ] = c & 0xff;
+      _rep [ _repLen++ ] = c >> 8;
+      _replyAt_us = micros () + _turnaround_us;
+    }
+
+    unsigned long _char_us, _turnaround_us;
+    int _nSlaves;
+    uint8_t _req [ 64 ], _rep [ 64 ];
+    size_t _reqLen;
+    int _repLen, _repPos;
+    unsigned long _replyAt_us;
+    unsigned long _requests;
+};
+
+static int mbmDone, mbmGood;
+static void mbmCheck ( MBM_Request & r ) {
+  mbmDone++;
+  if ( r.status == MBM_OK && r.values [ 0 ] == r.slave * 100 + r.start
+                          && r.values [ r.n - 1 ] == r.slave * 100 + r.start + r.n - 1 ) mbmGood++;
+}
+
+static MBM_Request mbmRecorded [ 2 ];
+static int mbmNRecorded;
+static void mbmRecord ( MBM_Request & r ) {
+  if ( mbmNRecorded < 2 ) mbmRecorded [ mbmNRecorded++ ] = r;
+}
+
+static void benchMODBUS_Master () {
+  benchSection ( "cbm_MODBUS_Master" );
+  const unsigned long baud = 57600;
+  const int nSlaves = MBM_QUEUE_LEN;
+  const short nRegs = 4;
+  SlaveBus bus ( baud, 500, nSlaves );
+  MODBUS port ( &bus );
+  MODBUS_Master master ( port );
+  master.Set_Baud ( baud );
+  static short regs [ nSlaves ] [ nRegs ];
+
+  // one round: every slave's registers, queued at once and advanced by Poll ()
+  const int nRounds = 20;
+  unsigned long long wall_ns = 0, inPoll_ns = 0, longest_ns = 0;
+  unsigned long polls = 0;
+  mbmDone = mbmGood = 0;
+  for ( int round = 0; round < nRounds; round++ ) {
+    for ( int s = 0; s < nSlaves; s++ ) {
+      master.Queue_Read_Regs ( s + 1, 10 * round, nRegs, regs [ s ], nRegs, mbmCheck );
+    }
+    unsigned long long startedAt_ns = benchNow_ns ();
+    while ( master.Pending () > 0 ) {
+      unsigned long long t0 = benchNow_ns ();
+      master.Poll ();
+      unsigned long long dt = benchNow_ns () - t0;
+      inPoll_ns += dt;
+      if ( dt > longest_ns ) longest_ns = dt;
+      polls++;
+    }
+    wall_ns += benchNow_ns () - startedAt_ns;
+  }
+  // request 8 characters, turnaround, reply 5 + 2 * nRegs, then the 3.5-character gap
+  double floor_ms = nSlaves * ( ( 8 + 5 + 2 * nRegs ) * bus.char_us () + 500 + 1750 ) / 1000.0;
+  printf ( "  round of %d slaves x %d registers at %lu baud: %.2f ms ( bus floor %.2f ms; "
+           "the blocking calls waited >= %d ms )\n",
+           nSlaves, nRegs, baud, wall_ns / 1e6 / nRounds, floor_ms, nSlaves * 22 );
+  printf ( "  %d of %d replies complete and correct; %lu polls, %.1f us average, %.1f us longest "
+           "( sending: the UART flush )\n",
+           mbmGood, mbmDone, polls, inPoll_ns / 1e3 / polls, longest_ns / 1e3 );
+  // and with loop () busy with other things between polls
+  unsigned long others = 0;
+  unsigned long long startedAt_ns = benchNow_ns ();
+  for ( int s = 0; s < nSlaves; s++ ) {
+    master.Queue_Read_Regs ( s + 1, 0, nRegs, regs [ s ], nRegs, mbmCheck );
+  }
+  while ( master.Pending () > 0 ) {
+    master.Poll ();
+    unsigned long long t0 = benchNow_ns ();
+    while ( benchNow_ns () - t0 < 250000ULL ) ;    // 250 us of display and sensors
+    others++;
+  }
+  printf ( "  with 250 us of other work between polls: round %.2f ms, %lu times round loop ()\n",
+           ( benchNow_ns () - startedAt_ns ) / 1e6, others );
+
+  // the blocking calls, and the failures
+  short value [ 2 ] = { 0, 0 };
+  unsigned long startedAt_us = micros ();
+  int error = master.Read_Reg ( 3, 5, 2, value, 2 );
+  unsigned long took_us = micros () - startedAt_us;
+  printf ( "  Read_Reg ( 3, 5, 2 ): error %d, values %d %d, in %lu us\n", error, value [ 0 ], value [ 1 ], took_us );
+  short coils = 0;
+  error = master.Read_Coils ( 2, 0, 8, &coils, 1 );
+  printf ( "  Read_Coils ( 2, 0, 8 ): error %d, 0x%02x\n", error, coils & 0xff );
+  printf ( "  Read_Reg ( 3, 5, 40 ): error %d ( too long )\n", master.Read_Reg ( 3, 5, 40, value, 40 ) );
+  MBM_Request r = { 1, 0x04, 1000, 1, value, 2, mbmRecord };
+  master.Queue ( r );
+  r.slave = nSlaves + 1;
+  r.start = 0;
+  master.Queue ( r );
+  mbmNRecorded = 0;
+  while ( master.Pending () > 0 ) master.Poll ();
+  printf ( "  address 1000: status %d, exception %d; absent slave: status %d after %lu us\n",
+           mbmRecorded [ 0 ].status, mbmRecorded [ 0 ].exception,
+           mbmRecorded [ 1 ].status, mbmRecorded [ 1 ].latency_us );
+}
+
+/*
+  MODBUS/TCP clients on the loopback interface, through the gateway, to a
+  SlaveBus. tcpAsk sends a request; tcpAnswer polls the gateway until the
+  client has a whole response, and returns its length.
+*/
+static void tcpAsk ( WiFiClient & client, unsigned short tid, uint8_t unit, const uint8_t * pdu, int len ) {
+  uint8_t frame [ 7 + 32 ] = { ( uint8_t ) ( tid >> 8 ), ( uint8_t ) tid, 0, 0,
+                               ( uint8_t ) ( ( len + 1 ) >> 8 ), ( uint8_t ) ( len + 1 ), unit };
+  memcpy ( &frame [ 7 ], pdu, len );
+  client.write ( frame, 7 + len );
+}
+
+static int tcpAnswer ( MODBUS_TCP_Gateway & gateway, WiFiClient & client, uint8_t * reply ) {
+  int len = 0;
+  unsigned long startedAt_us = micros ();
+  while ( micros () - startedAt_us < 200000UL ) {
+    gateway.Poll ();
+    int want = len < 7 ? 7 : 6 + ( ( reply [ 4 ] << 8 ) | reply [ 5 ] );
+    int got = client.read ( &reply [ len ], want - len );
+    if ( got > 0 ) len += got;
+    if ( len >= 7 && len == 6 + ( ( reply [ 4 ] << 8 ) | reply [ 5 ] ) ) return len;
+  }
+  return -1;
+}
+
+static void benchMODBUS_TCP () {
+  benchSection ( "cbm_MODBUS_TCP gateway" );
+  const unsigned long baud = 57600;
+  SlaveBus bus ( baud, 500, 4 );
+  MODBUS port ( &bus );
+  MODBUS_Master master ( port );
+  master.Set_Baud ( baud );
+  MODBUS_TCP_Gateway gateway ( master, 15020 );
+  gateway.Init ();
+
+  const int nClients = 3;
+  WiFiClient clients [ nClients ];
+  for ( int i = 0; i < nClients; i++ ) clients [ i ].connect ( "127.0.0.1", 15020 );
+  unsigned long startedAt_us = micros ();
+  while ( gateway.Clients () < nClients && micros () - startedAt_us < 200000UL ) gateway.Poll ();
+  if ( gateway.Clients () < nClients ) {
+    printf ( "  only %d of %d clients connected; skipped\n", gateway.Clients (), nClients );
+    return;
+  }
+
+  uint8_t reply [ MBTCP_FRAME_LEN ];
+  const uint8_t read10 [ 5 ] = { 0x03, 0x00, 0x00, 0x00, 0x0a };    // registers 0 .. 9
+  const uint8_t read4 [ 5 ] = { 0x03, 0x00, 0x03, 0x00, 0x04 };     //           3 .. 6
+
+  // every client polling the same registers at once: one trip on the bus for all of them
+  unsigned long bus0 = bus.requests ();
+  unsigned long long t0 = benchNow_ns ();
+  for ( int i = 0; i < nClients; i++ ) tcpAsk ( clients [ i ], 100 + i, 2, read10, 5 );
+  int good = 0;
+  for ( int i = 0; i < nClients; i++ ) {
+    int len = tcpAnswer ( gateway, clients [ i ], reply );
+    if ( len == 7 + 2 + 20 && ( ( reply [ 0 ] << 8 ) | reply [ 1 ] ) == 100 + i
+         && reply [ 7 ] == 0x03 && ( ( reply [ 9 ] << 8 ) | reply [ 10 ] ) == 200
+         && ( ( reply [ 27 ] << 8 ) | reply [ 28 ] ) == 209 ) good++;
+  }
+  double joined_ms = ( benchNow_ns () - t0 ) / 1e6;
+  printf ( "  %d clients read 10 registers of unit 2 at once: %d correct, %lu bus transaction(s), %.2f ms\n",
+           nClients, good, bus.requests () - bus0, joined_ms );
+
+  // within what was just read: from the cache, without the bus
+  bus0 = bus.requests ();
+  t0 = benchNow_ns ();
+  tcpAsk ( clients [ 1 ], 200, 2, read4, 5 );
+  int len = tcpAnswer ( gateway, clients [ 1 ], reply );
+  double cached_us = ( benchNow_ns () - t0 ) / 1e3;
+  printf ( "  registers 3 .. 6 just after: %s, %lu bus transaction(s), %.0f us "
+           "( round trip over loopback )\n",
+           len == 7 + 2 + 8 && ( ( reply [ 9 ] << 8 ) | reply [ 10 ] ) == 203 ? "correct" : "WRONG",
+           bus.requests () - bus0, cached_us );
+
+  // a write forgets the unit's cache; the next read goes to the bus
+  const uint8_t write6 [ 5 ] = { 0x06, 0x00, 0x04, 0x12, 0x34 };
+  bus0 = bus.requests ();
+  tcpAsk ( clients [ 0 ], 300, 2, write6, 5 );
+  len = tcpAnswer ( gateway, clients [ 0 ], reply );
+  bool echoed = len == 12 && memcmp ( &reply [ 7 ], write6, 5 ) == 0;
+  unsigned long writes = bus.requests () - bus0;
+  bus0 = bus.requests ();
+  tcpAsk ( clients [ 2 ], 301, 2, read4, 5 );
+  tcpAnswer ( gateway, clients [ 2 ], reply );
+  printf ( "  0x06 write: %s, %lu bus transaction(s); the read after it: %lu\n",
+           echoed ? "echoed" : "NOT ECHOED", writes, bus.requests () - bus0 );
+
+  // and after the TTL
+  delay ( MBTCP_CACHE_TTL_ms + 10 );
+  bus0 = bus.requests ();
+  tcpAsk ( clients [ 0 ], 400, 2, read4, 5 );
+  tcpAnswer ( gateway, clients [ 0 ], reply );
+  printf ( "  the same read %lu ms later: %lu bus transaction(s)\n",
+           MBTCP_CACHE_TTL_ms + 10, bus.requests () - bus0 );
+
+  // failures come back as exceptions
+  const uint8_t read1000 [ 5 ] = { 0x03, 0x03, 0xe8, 0x00, 0x01 };
+  tcpAsk ( clients [ 0 ], 500, 2, read1000, 5 );
+  tcpAnswer ( gateway, clients [ 0 ], reply );
+  uint8_t slaveException = reply [ 8 ];
+  tcpAsk ( clients [ 0 ], 501, 9, read4, 5 );
+  tcpAnswer ( gateway, clients [ 0 ], reply );
+  uint8_t absentException = reply [ 8 ];
+  const uint8_t fn07 [ 5 ] = { 0x07, 0, 0, 0, 0 };
+  tcpAsk ( clients [ 0 ], 502, 2, fn07, 5 );
+  tcpAnswer ( gateway, clients [ 0 ], reply );
+  printf ( "  exceptions: address 1000 0x%02x, absent unit 0x%02x, function 0x07 0x%02x\n",
+           slaveException, absentException, reply [ 8 ] );
+  printf ( "  %lu requests: %lu bus transactions, %lu cache hits, %lu joined, %lu exceptions\n",
+           gateway.Requests (), gateway.Bus_Transactions (), gateway.Cache_Hits (),
+           gateway.Joined (), gateway.Exceptions () );
+
+  for ( int i = 0; i < nClients; i++ ) clients [ i ].stop ();
+  gateway.Poll ();
+}
+
+// hot_tub_monitor's registers and coils, as a map
+struct HotTub {
+  typedef MB_Reg<float,    0> hotTubTemp;
+  typedef MB_Reg<float,    2> ambientTemp;
+  typedef MB_Reg<int16_t,  4> time;
+  typedef MB_Reg<int16_t,  6> ambientLight;
+  typedef MB_Reg<uint16_t, 8> ledBrightness;
+  typedef MB_Coil<0> heater;
+  typedef MB_Coil<3> pump;
+  typedef MB_Map<10, 4, hotTubTemp, ambientTemp, time, ambientLight, ledBrightness, heater, pump> map;
+};
+
+static void benchRegMap ( unsigned long n ) {
+  benchSection ( "cbm_MODBUS_var_access register map" );
+  static short regs [ HotTub::map::nRegs ];
+  static unsigned short coils [ HotTub::map::nCoilWords ];
+
+  // the same layout as setRegValue and coilValue
+  HotTub::hotTubTemp::set ( regs, 101.5f );
+  HotTub::time::set ( regs, 1234 );
+  HotTub::pump::set ( coils, true );
+  setRegValue ( regs, HotTub::map::nRegs, 2, ( float ) -40.25 );
+  bool same = floatRegValue ( regs, HotTub::map::nRegs, 0 ) == 101.5f
+              && intRegValue ( regs, HotTub::map::nRegs, 4 ) == 1234
+              && HotTub::ambientTemp::get ( regs ) == -40.25f
+              && coilValue ( coils, HotTub::map::nCoils, 3 ) == 1 && ! HotTub::heater::get ( coils );
+  short wire [ 2 ];
+  MB_Reg<uint32_t, 0, MB_HIGH_WORD_FIRST>::set ( wire, 0x12345678UL );
+  unsigned char bytes [ 4 ];
+  MB_To_Wire ( wire, 2, bytes );
+  bool order = ( uint16_t ) wire [ 0 ] == 0x1234 && bytes [ 0 ] == 0x12 && bytes [ 3 ] == 0x78
+               && MB_Reg<uint32_t, 0, MB_HIGH_WORD_FIRST>::get ( wire ) == 0x12345678UL;
+  printf ( "  layout as setRegValue and coilValue have it: %s; high word first: %s\n",
+           same ? "yes" : "NO", order ? "right" : "WRONG" );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    setRegValue ( regs, HotTub::map::nRegs, 0, ( float ) i );
+    benchSink = floatRegValue ( regs, HotTub::map::nRegs, 0 );
+  }, n );
+  benchReport ( "setRegValue + floatRegValue", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    HotTub::hotTubTemp::set ( regs, ( float ) i );
+    benchSink = HotTub::hotTubTemp::get ( regs );
+  }, n );
+  benchReport ( "MB_Reg<float>::set + get", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    setCoilValue ( coils, HotTub::map::nCoils, 3, i & 1 );
+    benchSink = coilValue ( coils, HotTub::map::nCoils, 3 );
+  }, n );
+  benchReport ( "setCoilValue + coilValue", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    HotTub::pump::set ( coils, i & 1 );
+    benchSink = HotTub::pump::get ( coils );
+  }, n );
+  benchReport ( "MB_Coil::set + get", ns, 0 );
+}
+
+static unsigned long planYields;
+static void planYielded () { planYields++; }
+
+static void benchMODBUS_Read_Plan () {
+  benchSection ( "cbm_MODBUS_Master read planner" );
+  const unsigned long baud = 57600;
+  SlaveBus bus ( baud, 500, 4 );
+  MODBUS port ( &bus );
+  MODBUS_Master master ( port );
+  master.Set_Baud ( baud );
+
+  // a dozen variables on two slaves, as a sketch would have them
+  short t1, t2, t3, s2a, s2b, s2far;
+  unsigned long runTime;
+  float flow, level;
+  bool pump, heater, valve;
+  struct { unsigned char slave; short reg; } wanted [ 12 ] = {
+    { 1, 0 }, { 1, 1 }, { 1, 3 }, { 1, 5 }, { 1, 8 },   // t1, t2, t3, flow, runTime
+    { 2, 10 }, { 2, 12 }, { 2, 40 }, { 2, 14 },         // s2a, s2b, s2far, level
+    { 1, 0 }, { 1, 3 }, { 1, 9 }                        // coils pump, heater, valve
+  };
+  MODBUS_Read_Plan plan ( master );
+  plan.Add ( 1, 0, &t1 );
+  plan.Add ( 1, 1, &t2 );
+  plan.Add ( 1, 3, &t3 );
+  plan.Add ( 1, 5, &flow );
+  plan.Add ( 1, 8, &runTime );
+  plan.Add ( 2, 10, &s2a );
+  plan.Add ( 2, 12, &s2b );
+  plan.Add ( 2, 40, &s2far );
+  plan.Add ( 2, 14, &level );
+  plan.Add_Coil ( 1, 0, &pump );
+  plan.Add_Coil ( 1, 3, &heater );
+  plan.Add_Coil ( 1, 9, &valve );
+
+  // one at a time, as with Read_Reg and intRegValue
+  unsigned long bus0 = bus.requests ();
+  unsigned long startedAt_us = micros ();
+  short value [ 2 ];
+  for ( int i = 0; i < 12; i++ ) {
+    if ( i < 9 ) master.Read_Reg ( wanted [ i ].slave, wanted [ i ].reg, 2, value, 2 );
+    else master.Read_Coils ( wanted [ i ].slave, wanted [ i ].reg, 1, value, 1 );
+  }
+  unsigned long single_us = micros () - startedAt_us;
+  unsigned long singleTransactions = bus.requests () - bus0;
+
+  bus0 = bus.requests ();
+  startedAt_us = micros ();
+  planYields = 0;
+  setYieldHook ( planYielded );
+  int failed = plan.Read ();
+  setYieldHook ( NULL );
+  unsigned long planned_us = micros () - startedAt_us;
+
+  // SlaveBus: register r of slave s reads s * 100 + r; coil c is on when c is odd
+  #define TWO(s,r) ( ( unsigned long ) ( s * 100 + r ) | ( ( unsigned long ) ( s * 100 + r + 1 ) << 16 ) )
+  uint32_t flowBits = TWO ( 1, 5 ), levelBits = TWO ( 2, 14 );
+  float flowWant, levelWant;
+  memcpy ( &flowWant, &flowBits, 4 );
+  memcpy ( &levelWant, &levelBits, 4 );
+  bool right = t1 == 100 && t2 == 101 && t3 == 103 && runTime == TWO ( 1, 8 )
+               && s2a == 210 && s2b == 212 && s2far == 240
+               && memcmp ( &flow, &flowWant, 4 ) == 0 && memcmp ( &level, &levelWant, 4 ) == 0
+               && ! pump && heater && valve;
+  #undef TWO
+  printf ( "  12 variables on 2 slaves, one at a time: %lu transactions, %.2f ms\n",
+           singleTransactions, single_us / 1e3 );
+  printf ( "  planned: %d reads, %lu transactions, %.2f ms; %d failed; %lu yields; values %s\n",
+           plan.Reads (), bus.requests () - bus0, planned_us / 1e3, failed, planYields,
+           right && planYields > 0 ? "correct" : "WRONG" );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    (void) i;
+    benchSink = plan.Plan ();
+  }, 10000 );
+  benchReport ( "MODBUS_Read_Plan::Plan ( 12 items )", ns, sizeof ( MODBUS_Read_Plan ) );
+}
+
+/*
+  TimedLine is one direction of a serial line: characters put on it with
+  arrival times become available () as micros () reaches them. What is
+  written to it is kept, for sent ().
+*/
+class TimedLine : public Stream {
+  public:
+    TimedLine () { _head = _tail = 0; _sentLen = 0; }
+    // len characters, one per char_us, the first complete at at_us; returns when the last is
+    unsigned long arrive ( const uint8_t * buf, int len, unsigned long at_us, unsigned long char_us ) {
+      for ( int i = 0; i < len; i++ ) {
+        _t [ _head & ( _n - 1 ) ] = at_us + i * char_us;
+        _c [ _head & ( _n - 1 ) ] = buf [ i ];
+        _head++;
+      }
+      return at_us + ( len - 1 ) * char_us;
+    }
+    int available () {
+      unsigned long now = micros ();
+      int n = 0;
+      for ( unsigned long i = _tail; i != _head && ( long ) ( now - _t [ i & ( _n - 1 ) ] ) >= 0; i++ ) n++;
+      return n;
+    }
+    int read () { return available () > 0 ? _c [ _tail++ & ( _n - 1 ) ] : -1; }
+    int peek () { return available () > 0 ? _c [ _tail & ( _n - 1 ) ] : -1; }
+    bool drained () { return _tail == _head; }
+    size_t write ( uint8_t c ) {
+      if ( _sentLen < sizeof ( _sent ) ) _sent [ _sentLen++ ] = c;
+      return 1;
+    }
+    using Print::write;
+    int sent () { return _sentLen; }
+    const uint8_t * sentData () { return _sent; }
+    void clearSent () { _sentLen = 0; }
+
+  private:
+    static const unsigned long _n = 512;
+    unsigned long _t [ _n ];
+    uint8_t _c [ _n ];
+    unsigned long _head, _tail;
+    uint8_t _sent [ 256 ];
+    size_t _sentLen;
+};
+
+// body plus its CRC, low byte first
+static int rtuFrame ( uint8_t * out, const uint8_t * body, int len ) {
+  CRC crc;
+  memcpy ( out, body, len );
+  unsigned short c = crc.CRC16 ( out, len );
+  out [ len++ ] = c & 0xff;
+  out [ len++ ] = c >> 8;
+  return len;
+}
+
+static unsigned long rtuLastCharAt_us [ 8 ];
+static int rtuNext;
+static double rtuLatency_us, rtuLatencyMax_us;
+static int rtuDelivered;
+static void rtuGotFrame ( unsigned char * frame, int len, void * context ) {
+  (void) frame; (void) len; (void) context;
+  double latency = micros () - rtuLastCharAt_us [ rtuNext++ ];
+  rtuLatency_us += latency;
+  if ( latency > rtuLatencyMax_us ) rtuLatencyMax_us = latency;
+  rtuDelivered++;
+}
+
+static void benchRS485Frames ( unsigned long n ) {
+  benchSection ( "cbm_RS485 frame assembly" );
+  const unsigned long char_us = 11000000UL / 57600;
+  uint8_t body [ 6 ] = { 0x01, 0x04, 0x00, 0x10, 0x00, 0x02 };
+  uint8_t good [ 8 ], bad [ 8 ];
+  rtuFrame ( good, body, 6 );
+  memcpy ( bad, good, 8 );
+  bad [ 7 ] ^= 0x55;
+
+  // two ports side by side: A with a handler, B read as a queue
+  TimedLine lineA, lineB;
+  RS485 A ( &lineA ), B ( &lineB );
+  A.Set_Baud ( 57600 );
+  B.Set_Baud ( 57600 );
+  A.Set_Frame_Handler ( rtuGotFrame );
+  rtuNext = rtuDelivered = 0;
+  rtuLatency_us = rtuLatencyMax_us = 0.0;
+
+  unsigned long t = micros () + 1000, tB = t + 500;
+  int nGood = 0;
+  // good, then good after a 2 ms gap
+  rtuLastCharAt_us [ nGood++ ] = t = lineA.arrive ( good, 8, t, char_us );
+  rtuLastCharAt_us [ nGood++ ] = t = lineA.arrive ( good, 8, t + 2000, char_us );
+  // a 1 ms pause after the third character: more than t1.5, less than t3.5
+  t = lineA.arrive ( good, 3, t + 2000, char_us );
+  t = lineA.arrive ( good + 3, 5, t + 1000, char_us );
+  // a bad CRC, then good
+  t = lineA.arrive ( bad, 8, t + 2000, char_us );
+  rtuLastCharAt_us [ nGood++ ] = t = lineA.arrive ( good, 8, t + 2000, char_us );
+  for ( int i = 0; i < 3; i++ ) tB = lineB.arrive ( good, 8, tB + 3000, char_us );
+
+  int nB = 0;
+  while ( ! lineA.drained () || ! lineB.drained () || micros () - t < 5000 ) {
+    A.Poll ();
+    B.Poll ();
+    if ( B.Frame_Available () == 8 && memcmp ( B.Frame (), good, 8 ) == 0 ) nB++;
+    if ( B.Frame_Available () ) B.Release_Frame ();
+  }
+  printf ( "  port A: %lu frames ( of %d ), %lu CRC errors, %lu gap errors; "
+           "delivered %.0f us after the last character on average, %.0f us at most ( t3.5 1750 us )\n",
+           A.Frames (), nGood, A.CRC_Errors (), A.Gap_Errors (),
+           rtuDelivered ? rtuLatency_us / rtuDelivered : 0.0, rtuLatencyMax_us );
+  printf ( "  port B, alongside: %d frames read\n", nB );
+
+  // the old way, for comparison: Receive waits out its timeout, in milliseconds
+  TimedLine lineC;
+  RS485 C ( &lineC );
+  unsigned char buf [ 16 ];
+  unsigned long startedAt_us = micros ();
+  unsigned long last_us = lineC.arrive ( good, 8, startedAt_us + 100, char_us );
+  int got = C.Receive ( buf, sizeof ( buf ), 2 );
+  unsigned long returnedAt_us = micros ();
+  printf ( "  RS485::Receive ( 2 ms ): %d characters, returned %lu us after the last, "
+           "having blocked for %lu us\n", got, returnedAt_us - last_us, returnedAt_us - startedAt_us );
+
+  // the cost of polling an idle port
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    (void) i;
+    B.Poll ();
+  }, n / 4 );
+  benchReport ( "RS485::Poll ( idle )", ns, sizeof ( RS485 ) );
+
+  // a slave answering from Execute (), which no longer waits
+  TimedLine lineS;
+  MODBUS portS ( &lineS );
+  short regs [ 32 ];
+  unsigned short coils [ 2 ] = { 0, 0 };
+  for ( int i = 0; i < 32; i++ ) regs [ i ] = 1000 + i;
+  MODBUS_Slave slave ( 1, 32, coils, 32, regs, portS );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    (void) i;
+    benchSink = slave.Execute ();
+  }, n / 4 );
+  benchReport ( "MODBUS_Slave::Execute ( idle )", ns, sizeof ( MODBUS_Slave ) );
+  startedAt_us = micros ();
+  last_us = lineS.arrive ( good, 8, startedAt_us + 100, char_us );
+  while ( lineS.sent () == 0 && micros () - startedAt_us < 20000 ) slave.Execute ();
+  printf ( "  slave: %d-character reply %lu us after the request's last character\n",
+           lineS.sent (), micros () - last_us );
+
+  // the longest read that fits the frame: 37 registers, 79 characters, as before the assembler
+  TimedLine lineL;
+  MODBUS portL ( &lineL );
+  static short regsL [ 40 ];
+  for ( int i = 0; i < 40; i++ ) regsL [ i ] = 500 + i;
+  MODBUS_Slave slaveL ( 1, 32, coils, 40, regsL, portL );
+  uint8_t read37 [ 6 ] = { 0x01, 0x03, 0x00, 0x00, 0x00, 37 }, request [ 8 ];
+  rtuFrame ( request, read37, 6 );
+  startedAt_us = micros ();
+  lineL.arrive ( request, 8, startedAt_us + 100, char_us );
+  while ( lineL.sent () == 0 && micros () - startedAt_us < 20000 ) slaveL.Execute ();
+  const uint8_t * r = lineL.sentData ();
+  bool longRight = lineL.sent () == 5 + 2 * 37 && r [ 2 ] == 2 * 37 && ( ( r [ 75 ] << 8 ) | r [ 76 ] ) == 536;
+  printf ( "  slave: 37 registers in a %d-character reply; %s\n", lineL.sent (), longRight ? "correct" : "WRONG" );
+}
+
+/*
+  A master and a slave on one bus: what each sends arrives at the other one
+  character time later, a character per character time.
+*/
+static unsigned long shuttle ( TimedLine & from, TimedLine & to, unsigned long char_us ) {
+  int len = from.sent ();
+  if ( len == 0 ) return 0;
+  to.arrive ( from.sentData (), len, micros () + char_us, char_us );
+  from.clearSent ();
+  return len;
+}
+
+static MBM_Request mbcLast;
+static void mbcDone ( MBM_Request & r ) { mbcLast = r; }
+
+static void benchMODBUS_Changes () {
+  benchSection ( "cbm_MODBUS_Slave change tracking ( function 0x41 )" );
+  const unsigned long char_us = 11000000UL / 57600;
+  const int nRegs = 32;
+  TimedLine toMaster, toSlave;
+  MODBUS portM ( &toMaster ), portS ( &toSlave );
+  MODBUS_Master master ( portM );
+  master.Set_Baud ( 57600 );
+  static short regs [ nRegs ], shadow [ nRegs ], image [ nRegs ];
+  static unsigned short changedAt [ nRegs ];
+  unsigned short coils [ 1 ] = { 0 };
+  for ( int i = 0; i < nRegs; i++ ) regs [ i ] = 2000 + 10 * i;
+  MODBUS_Slave slave ( 1, 16, coils, nRegs, regs, portS );
+  slave.Track_Changes ( shadow, changedAt );
+
+  // run what's queued to completion; the characters on the bus, and the time
+  unsigned long busChars, took_us;
+  auto run = [&] () {
+    busChars = 0;
+    unsigned long startedAt_us = micros ();
+    while ( master.Pending () > 0 && micros () - startedAt_us < 200000UL ) {
+      master.Poll ();
+      slave.Execute ();
+      busChars += shuttle ( toSlave, toMaster, char_us );
+      busChars += shuttle ( toMaster, toSlave, char_us );
+    }
+    took_us = micros () - startedAt_us;
+  };
+  // every change since seen, following NNNN until the series is done
+  unsigned short seen = 0;
+  int replies;
+  auto update = [&] () {
+    unsigned long chars = 0, us = 0;
+    unsigned short seenNext = 0;
+    short from = 0;
+    replies = 0;
+    do {
+      master.Queue_Read_Changes ( 1, from, seen, image, nRegs, mbcDone );
+      run ();
+      chars += busChars;
+      us += took_us;
+      if ( mbcLast.status != MBM_OK ) break;
+      if ( replies++ == 0 ) seenNext = mbcLast.n;
+      from = mbcLast.start;
+    } while ( from >= 0 );
+    seen = seenNext;
+    busChars = chars;
+    took_us = us;
+  };
+  auto same = [&] () { return memcmp ( image, regs, sizeof ( regs ) ) == 0; };
+
+  // the usual poll: all of them, in two reads of 16 ( 32 won't fit the master's buffer )
+  master.Queue_Read_Regs ( 1, 0, 16, image, 16, mbcDone, NULL, 0x03 );
+  master.Queue_Read_Regs ( 1, 16, 16, image + 16, 16, mbcDone, NULL, 0x03 );
+  run ();
+  unsigned long fullChars = busChars;
+  printf ( "  reading all %d registers: %lu characters on the bus, %.2f ms\n",
+           nRegs, busChars, took_us / 1e3 );
+
+  memset ( image, 0, sizeof ( image ) );
+  update ();
+  printf ( "  changes since 0 ( everything ): %d replies, %lu characters, image %s\n",
+           replies, busChars, same () ? "correct" : "WRONG" );
+  update ();
+  printf ( "  nothing changed: %lu characters ( %.0f%% of reading all ), %.2f ms, image %s\n",
+           busChars, 100.0 * busChars / fullChars, took_us / 1e3, same () ? "correct" : "WRONG" );
+  regs [ 5 ]++;
+  regs [ 20 ]--;
+  update ();
+  printf ( "  registers 5 and 20 changed: %lu characters ( %.0f%% ), image %s\n",
+           busChars, 100.0 * busChars / fullChars, same () ? "correct" : "WRONG" );
+  regs [ 10 ]++;
+  regs [ 12 ]++;
+  update ();
+  printf ( "  registers 10 and 12 changed: %lu characters ( one run, through 11 ), image %s\n",
+           busChars, same () ? "correct" : "WRONG" );
+  // what a master wrote counts as a change, to other masters
+  unsigned short before = seen;
+  short v [ 1 ] = { 1234 };
+  master.Queue_Write_Regs ( 1, 30, 1, v, mbcDone );
+  run ();
+  seen = before;
+  update ();
+  printf ( "  register 30 written by a master: image %s\n", same () && image [ 30 ] == 1234 ? "correct" : "WRONG" );
+}
+
+/*
+  Function 0x17 against a write and a read, on the same pair of lines; and
+  0x2B / 0x0E device identification. A blocking call runs the slave and the
+  lines from yield ().
+*/
+static MODBUS_Slave * mbfSlave;
+static TimedLine * mbfToMaster, * mbfToSlave;
+static void mbfStep () {
+  mbfSlave->Execute ();
+  shuttle ( *mbfToSlave, *mbfToMaster, 11000000UL / 57600 );
+  shuttle ( *mbfToMaster, *mbfToSlave, 11000000UL / 57600 );
+}
+
+static void benchMODBUS_Functions () {
+  benchSection ( "cbm_MODBUS read/write multiple ( 0x17 ), device identification ( 0x2B )" );
+  const unsigned long char_us = 11000000UL / 57600;
+  const int nRegs = 16;
+  TimedLine toMaster, toSlave;
+  MODBUS portM ( &toMaster ), portS ( &toSlave );
+  MODBUS_Master master ( portM );
+  master.Set_Baud ( 57600 );
+  static short regs [ nRegs ];
+  unsigned short coils [ 1 ] = { 0 };
+  for ( int i = 0; i < nRegs; i++ ) regs [ i ] = 2000 + 10 * i;
+  MODBUS_Slave slave ( 1, 16, coils, nRegs, regs, portS );
+  slave.Set_Identification ( "cbm", "HOTTUB", "1.5.0", NULL, "hot tub controller" );
+
+  unsigned long busChars, took_us;
+  int transactions;
+  auto run = [&] () {
+    busChars = 0;
+    transactions = 0;
+    unsigned long startedAt_us = micros ();
+    while ( master.Pending () > 0 && micros () - startedAt_us < 200000UL ) {
+      master.Poll ();
+      if ( slave.Execute () != 0 ) transactions++;
+      busChars += shuttle ( toSlave, toMaster, char_us );
+      busChars += shuttle ( toMaster, toSlave, char_us );
+    }
+    took_us = micros () - startedAt_us;
+  };
+
+  // a control loop's step: write the setpoint ( register 8 ), read the two temperature registers ( 0, 1 )
+  const int cycles = 10;
+  short setpoint [ 1 ], temps [ 2 ], both [ 3 ];
+  bool right = true;
+  unsigned long chars2 = 0, us2 = 0, chars1 = 0, us1 = 0;
+  int n2 = 0, n1 = 0;
+  for ( int c = 0; c < cycles; c++ ) {
+    setpoint [ 0 ] = 1000 + c;
+    master.Queue_Write_Regs ( 1, 8, 1, setpoint, mbcDone );
+    master.Queue_Read_Regs ( 1, 0, 2, temps, 2, mbcDone, NULL, 0x03 );
+    run ();
+    chars2 += busChars; us2 += took_us; n2 += transactions;
+    right &= ( regs [ 8 ] == 1000 + c ) && ( temps [ 1 ] == regs [ 1 ] );
+  }
+  for ( int c = 0; c < cycles; c++ ) {
+    both [ 0 ] = 2000 + c;
+    regs [ 1 ] = 3000 + c;
+    master.Queue_Read_Write_Regs ( 1, 0, 2, 8, 1, both, 3, mbcDone );
+    run ();
+    chars1 += busChars; us1 += took_us; n1 += transactions;
+    right &= ( mbcLast.status == MBM_OK ) && ( regs [ 8 ] == 2000 + c ) && ( both [ 0 ] == 2000 + c )
+             && ( both [ 1 ] == regs [ 0 ] ) && ( both [ 2 ] == 3000 + c );
+  }
+  printf ( "  write setpoint, read temperature, 0x10 + 0x03: %d transactions, %lu characters, %.2f ms a step\n",
+           n2 / cycles, chars2 / cycles, us2 / 1e3 / cycles );
+  printf ( "  the same with 0x17:                         %d transaction,  %lu characters, %.2f ms a step; values %s\n",
+           n1 / cycles, chars1 / cycles, us1 / 1e3 / cycles, right ? "correct" : "WRONG" );
+  // the write comes first, so reading what was just written returns it
+  short blocking [ 1 ], written [ 1 ] = { 4321 };
+  mbfSlave = &slave;
+  mbfToMaster = &toMaster;
+  mbfToSlave = &toSlave;
+  setYieldHook ( mbfStep );
+  int error = master.Read_Write_Regs ( 1, 3, 1, blocking, 3, 1, written );
+  setYieldHook ( NULL );
+  printf ( "  blocking Read_Write_Regs of the register it writes: %s\n",
+           error == 0 && blocking [ 0 ] == 4321 ? "correct" : "WRONG" );
+
+  // everything about the slave in one query, but for the map, which is left for a second
+  short id [ 30 ];
+  char vendor [ 16 ], product [ 16 ], revision [ 16 ], name [ 24 ], map [ 24 ];
+  master.Queue_Read_Device_Id ( 1, 3, 0, id, 30, mbcDone );
+  run ();
+  bool idRight = ( mbcLast.status == MBM_OK ) && ( mbcLast.n == 4 ) && ( mbcLast.start == 0x80 )
+                 && ( MODBUS_Master::Device_Id_Object ( mbcLast, 0, vendor, sizeof ( vendor ) ) == 3 )
+                 && ( MODBUS_Master::Device_Id_Object ( mbcLast, 1, product, sizeof ( product ) ) == 6 )
+                 && ( MODBUS_Master::Device_Id_Object ( mbcLast, 2, revision, sizeof ( revision ) ) == 5 )
+                 && ( MODBUS_Master::Device_Id_Object ( mbcLast, 4, name, sizeof ( name ) ) == 18 )
+                 && ( MODBUS_Master::Device_Id_Object ( mbcLast, 3, name, sizeof ( name ) ) == -1 )
+                 && ! strcmp ( vendor, "cbm" ) && ! strcmp ( product, "HOTTUB" ) && ! strcmp ( revision, "1.5.0" );
+  unsigned long idChars = busChars, id_us = took_us;
+  master.Queue_Read_Device_Id ( 1, 3, mbcLast.start, id, 30, mbcDone );
+  run ();
+  int mapLen = MODBUS_Master::Device_Id_Object ( mbcLast, 0x80, map, sizeof ( map ) );
+  int mapRegs = ( uint8_t ) map [ 2 ] << 8 | ( uint8_t ) map [ 3 ];
+  idRight &= ( mbcLast.status == MBM_OK ) && ( mbcLast.n == 1 ) && ( mbcLast.start == -1 )
+             && ( mapLen == 4 + 11 ) && ( mapRegs == nRegs );
+  printf ( "  device id, extended stream: 5 objects in 2 replies, %lu characters, %.2f ms ( %s %s %s, %d registers ); %s\n",
+           idChars + busChars, ( id_us + took_us ) / 1e3, vendor, product, revision, mapRegs,
+           idRight ? "correct" : "WRONG" );
+  master.Queue_Read_Device_Id ( 1, 4, 4, id, 30, mbcDone );
+  run ();
+  printf ( "  device id, object 4 alone: %s\n",
+           mbcLast.status == MBM_OK && mbcLast.n == 1
+           && MODBUS_Master::Device_Id_Object ( mbcLast, 4, name, sizeof ( name ) ) == 18
+           && ! strcmp ( name, "hot tub controller" ) ? "correct" : "WRONG" );
+}
+
+/*
+  A 5 ms job, with a 20 ms and a 100 ms one beside it, run as the sketches
+  do it ( a millis () check for each, and delay ( 10 ) ) and by TimedScheduler;
+  how far the 5 ms job's start-to-start intervals stray from 5 ms.
+*/
+static unsigned long tsStarts [ 512 ];
+static int tsNStarts;
+static void tsWork ( unsigned long us ) {
+  unsigned long t0 = micros ();
+  while ( micros () - t0 < us ) ;
+}
+static void tsJobA ( void * ) {
+  if ( tsNStarts < 512 ) tsStarts [ tsNStarts++ ] = micros ();
+  tsWork ( 200 );
+}
+static void tsJobB ( void * ) { tsWork ( 1000 ); }
+static void tsJobC ( void * ) { tsWork ( 3000 ); }
+static void tsNothing ( void * ) { }
+
+static void tsReport ( const char * how, unsigned long took_us ) {
+  static unsigned long dev [ 512 ];
+  int nDev = 0;
+  for ( int i = 1; i < tsNStarts; i++ ) {
+    long d = ( long ) ( tsStarts [ i ] - tsStarts [ i - 1 ] ) - 5000L;
+    dev [ nDev++ ] = d < 0 ? -d : d;
+  }
+  std::sort ( dev, dev + nDev );
+  printf ( "  %-36s %3d runs of the 5 ms job in %lu ms; interval error p50 %lu us, p99 %lu us, max %lu us\n",
+           how, tsNStarts, took_us / 1000, dev [ nDev / 2 ], dev [ nDev * 99 / 100 ], dev [ nDev - 1 ] );
+}
+
+static void benchTimedScheduler ( unsigned long n ) {
+  benchSection ( "cbm_TimedEvent TimedScheduler" );
+
+  // the cost of looking, with 8 tasks and none due
+  TimedScheduler idle;
+  for ( int i = 0; i < TS_MAX_TASKS; i++ ) idle.Add ( tsNothing, 1000000UL, 1000000UL + 1000UL * i );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) { benchSink = idle.Poll (); }, n / 10 );
+  benchReport ( "Poll ( 8 tasks, none due )", ns, sizeof ( TimedScheduler ) );
+
+  const unsigned long run_us = 500000UL;
+  // the sketches' way
+  tsNStarts = 0;
+  unsigned long t0 = micros ();
+  unsigned long lastA = millis (), lastB = lastA, lastC = lastA;
+  while ( micros () - t0 < run_us ) {
+    if ( millis () - lastA >= 5 ) { tsJobA ( NULL ); lastA = millis (); }
+    if ( millis () - lastB >= 20 ) { tsJobB ( NULL ); lastB = millis (); }
+    if ( millis () - lastC >= 100 ) { tsJobC ( NULL ); lastC = millis (); }
+    delay ( 10 );
+  }
+  tsReport ( "millis () checks and delay ( 10 ):", micros () - t0 );
+  // the same without the delay, spinning
+  tsNStarts = 0;
+  t0 = micros ();
+  lastA = lastB = lastC = millis ();
+  while ( micros () - t0 < run_us ) {
+    if ( millis () - lastA >= 5 ) { tsJobA ( NULL ); lastA = millis (); }
+    if ( millis () - lastB >= 20 ) { tsJobB ( NULL ); lastB = millis (); }
+    if ( millis () - lastC >= 100 ) { tsJobC ( NULL ); lastC = millis (); }
+  }
+  tsReport ( "millis () checks, spinning:", micros () - t0 );
+
+  // the scheduler, the 5 ms job first in line and the others out of its way
+  TimedScheduler scheduler;
+  int a = scheduler.Add ( tsJobA, 5000UL, 0UL, 500UL );
+  scheduler.Add ( tsJobB, 20000UL, 2500UL );
+  scheduler.Add ( tsJobC, 100000UL, 1000UL );
+  tsNStarts = 0;
+  t0 = micros ();
+  scheduler.Start ( a );
+  while ( micros () - t0 < run_us ) scheduler.Run ();
+  unsigned long took_us = micros () - t0;
+  tsReport ( "TimedScheduler.Run ():", took_us );
+  const TS_Task & ta = scheduler.Task ( a );
+  printf ( "  TimedScheduler: 5 ms job mean lateness %lu us, max %lu us, %lu late, %lu skipped; idle %.0f%%\n",
+           ta.runs ? ta.totalLateness_us / ta.runs : 0UL, ta.maxLateness_us, ta.late, ta.skipped,
+           100.0 * scheduler.Idle_us () / took_us );
+}
+
+static void benchFFT ( unsigned long n ) {
+  benchSection ( "cbm_FFT" );
+  CMPLX fr [ FFT_SIZE ];
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    for ( int k = 0; k < FFT_SIZE; k++ ) {
+      fr [ k ].hb [ 0 ] = 0;
+      fr [ k ].hb [ 1 ] = ( int8_t ) ( samples [ ( i + k ) & ( nSamples - 1 ) ] - 100.0 );
+    }
+    fix_fftr ( fr, FFT_SIZE );
+    benchSink = fr [ 1 ].hb [ 1 ];
+  }, n / 256 );
+  benchReport ( "fix_fftr ( 64-point, per transform )", ns, sizeof ( fr ) );
+  benchReport ( "fix_fftr ( 64-point, per sample )", ns / FFT_SIZE, sizeof ( fr ) );
+}
+
+// the signal-to-noise ratio of a spectrum, in dB, against the double-precision DFT of x;
+// get ( k, re, im ) gives bin k of the spectrum under test, 0 <= k <= n / 2
+template <typename Get>
+static double fftSNR_dB ( const double * x, int n, Get get ) {
+  double signal = 0.0, noise = 0.0;
+  for ( int k = 0; k <= n / 2; k++ ) {
+    double re = 0.0, im = 0.0;
+    for ( int j = 0; j < n; j++ ) {
+      double a = -2.0 * M_PI * ( ( ( long ) k * j ) % n ) / n;
+      re += x [ j ] * cos ( a );
+      im += x [ j ] * sin ( a );
+    }
+    double yr, yi;
+    get ( k, yr, yi );
+    signal += re * re + im * im;
+    noise += ( re - yr ) * ( re - yr ) + ( im - yi ) * ( im - yi );
+  }
+  return 10.0 * log10 ( signal / noise );
+}
+
+// the seismometer's signal, less its offset, scaled to the amplitude given
+static void fftInput ( double * x, int n, double amplitude ) {
+  for ( int j = 0; j < n; j++ ) x [ j ] = lround ( ( samples [ j ] - 105.0 ) * amplitude / 16.0 );
+}
+
+template <uint16_t N, typename T>
+static double benchFFT_Real_T ( const char * name, unsigned long n, double amplitude ) {
+  static double x [ N ];
+  static T data [ N ];
+  fftInput ( x, N, amplitude );
+  for ( int j = 0; j < N; j++ ) data [ j ] = ( T ) x [ j ];
+  int e = FFT_Real_T<N, T>::forward ( data );
+  const FFT_Complex<T> * bins = ( const FFT_Complex<T> * ) data;
+  double snr = fftSNR_dB ( x, N, [&] ( int k, double & re, double & im ) {
+    re = ldexp ( k == N / 2 ? bins [ 0 ].im : bins [ k ].re, e );
+    im = ( k == 0 ) || ( k == N / 2 ) ? 0.0 : ldexp ( bins [ k ].im, e );
+  } );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    for ( int j = 0; j < N; j++ ) data [ j ] = ( T ) x [ ( i + j ) & ( N - 1 ) ];
+    benchSink = FFT_Real_T<N, T>::forward ( data ) + data [ 2 ];
+  }, n / N / 4 );
+  char line [ 64 ];
+  snprintf ( line, sizeof ( line ), "%s ( per transform )", name );
+  benchReport ( line, ns, sizeof ( data ) );
+  printf ( "  %-36s SNR %5.1f dB\n", "", snr );
+  return snr;
+}
+
+static void benchFFT_T ( unsigned long n ) {
+  benchSection ( "cbm_FFT: FFT_T.h" );
+
+  // the old 64 points of int8_t against FFT_Real_T's, on the same samples
+  static double x [ 64 ];
+  fftInput ( x, 64, 127.0 );
+  CMPLX fr [ 64 ];
+  for ( int j = 0; j < 64; j++ ) {
+    fr [ j ].hb [ 0 ] = 0;
+    fr [ j ].hb [ 1 ] = ( int8_t ) x [ j ];
+  }
+  fix_fftr ( fr, 64 );
+  // its twiddles turn the other way, so that it gives the conjugate, and it halves every stage
+  double oldSNR = fftSNR_dB ( x, 64, [&] ( int k, double & re, double & im ) {
+    re = fr [ k ].hb [ 1 ] * 64.0;
+    im = fr [ k ].hb [ 0 ] * -64.0;
+  } );
+  printf ( "  fix_fftr, 64 points of int8_t: SNR %.1f dB\n", oldSNR );
+  double newSNR = benchFFT_Real_T<64, q15_t> ( "FFT_Real_T<64, q15_t>", n, 127.0 );
+
+  double snr256 = benchFFT_Real_T<256, q15_t> ( "FFT_Real_T<256, q15_t>", n, 32767.0 );
+  double snr1024 = benchFFT_Real_T<1024, q15_t> ( "FFT_Real_T<1024, q15_t>", n, 32767.0 );
+  double snr1024q31 = benchFFT_Real_T<1024, q31_t> ( "FFT_Real_T<1024, q31_t>", n, 2147483647.0 );
+  // a quiet signal: block floating point scales it up rather than losing it
+  double snrQuiet = benchFFT_Real_T<1024, q15_t> ( "FFT_Real_T<1024, q15_t> quiet", n, 64.0 );
+
+  // complex, and back
+  static FFT_Complex<q15_t> z [ 1024 ], z0 [ 1024 ];
+  for ( int j = 0; j < 1024; j++ ) {
+    z0 [ j ].re = ( q15_t ) lround ( ( samples [ j ] - 105.0 ) * 2048.0 );
+    z0 [ j ].im = ( q15_t ) lround ( ( samples [ j + 1024 ] - 105.0 ) * 2048.0 );
+  }
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    memcpy ( z, z0, sizeof ( z ) );
+    benchSink = FFT_T<1024, q15_t>::forward ( z ) + z [ 1 ].re;
+  }, n / 1024 / 4 );
+  benchReport ( "FFT_T<1024, q15_t> ( complex )", ns, sizeof ( z ) );
+  memcpy ( z, z0, sizeof ( z ) );
+  int e = FFT_T<1024, q15_t>::forward ( z );
+  e += FFT_T<1024, q15_t>::inverse ( z );
+  double signal = 0.0, noise = 0.0;
+  for ( int j = 0; j < 1024; j++ ) {
+    double dr = ldexp ( z [ j ].re, e ) - z0 [ j ].re, di = ldexp ( z [ j ].im, e ) - z0 [ j ].im;
+    signal += ( double ) z0 [ j ].re * z0 [ j ].re + ( double ) z0 [ j ].im * z0 [ j ].im;
+    noise += dr * dr + di * di;
+  }
+  double roundTrip = 10.0 * log10 ( signal / noise );
+
+  printf ( "  64 points: %.1f dB against fix_fftr's %.1f; %s\n", newSNR, oldSNR,
+           newSNR > oldSNR + 20.0 ? "better" : "WRONG" );
+  printf ( "  Q15 real 256 / 1024 / quiet: %.1f / %.1f / %.1f dB; Q31 1024: %.1f dB; %s\n",
+           snr256, snr1024, snrQuiet, snr1024q31,
+           snr256 > 55.0 && snr1024 > 55.0 && snrQuiet > 55.0 && snr1024q31 > 140.0 ? "correct" : "WRONG" );
+  printf ( "  Q15 complex 1024 forward and inverse: %.1f dB; %s\n", roundTrip, roundTrip > 40.0 ? "correct" : "WRONG" );
+}
+
+// the power of bin k, relative to the largest, in dB
+static double pipelineLevel_dB ( const uint32_t * power, int n, int k ) {
+  uint32_t peak = 1;
+  for ( int j = 1; j < n; j++ ) if ( power [ j ] > peak ) peak = power [ j ];
+  return 10.0 * log10 ( ( power [ k ] + 0.5 ) / peak );
+}
+
+static void benchFFT_Pipeline ( unsigned long n ) {
+  benchSection ( "cbm_FFT: FFT_Pipeline.h" );
+
+  // a tone between bins 40 and 41 of 256, and a weaker one at bin 90
+  const int N = 256;
+  static int16_t tone [ 4 * N ];
+  for ( int j = 0; j < 4 * N; j++ ) {
+    tone [ j ] = ( int16_t ) lround ( 20000.0 * sin ( 2.0 * M_PI * 40.5 * j / N ) + 2000.0 * sin ( 2.0 * M_PI * 90.0 * j / N ) );
+  }
+  static int16_t frame [ N ], hann [ N / 2 + 1 ];
+  static uint32_t power [ N / 2 ], bandPower [ 16 ];
+  static uint16_t edges [ 17 ];
+  FFT_Window::Make ( hann, N, FFT_WINDOW_HANN );
+  FFT_Bands bands ( edges, 16 );
+  bands.Set_Log ( 1, N / 2 );
+
+  // leakage far from the tone, without and with the window
+  FFT_Array_Source source ( tone, 4 * N, true );
+  FFT_Pipeline<N> spectrum ( source, frame, power );
+  spectrum.Poll ();
+  double rectangular_dB = pipelineLevel_dB ( power, N / 2, 70 );
+  spectrum.Set_Window ( hann );
+  spectrum.Set_Bands ( &bands, bandPower );
+  spectrum.Poll ();
+  double hann_dB = pipelineLevel_dB ( power, N / 2, 70 );
+  double second_dB = pipelineLevel_dB ( power, N / 2, 90 );
+  int peakBand = 0;
+  for ( int b = 1; b < 16; b++ ) if ( bandPower [ b ] > bandPower [ peakBand ] ) peakBand = b;
+  // the tone's power in bins 40 and 41: each ( 20000 * N / 2 * coherent gain )^2, less the
+  // window's response half a bin off, 0.8488^2 for Hann
+  double tonePower = ldexp ( ( double ) power [ 40 ] + power [ 41 ], spectrum.Exponent () );
+  double expected = 2.0 * pow ( 20000.0 * N / 2 * FFT_Window::Coherent_Gain ( hann, N ) * 0.8488, 2 );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    spectrum.Poll ();
+    benchSink = bandPower [ 7 ];
+  }, n / N / 4 );
+  benchReport ( "FFT_Pipeline<256>: Hann, 16 log bands", ns, sizeof ( frame ) + sizeof ( hann ) + sizeof ( power ) );
+  printf ( "  bands: %u", edges [ 0 ] );
+  for ( int b = 1; b <= 16; b++ ) printf ( " %u", edges [ b ] );
+  printf ( "\n  leakage at bin 70: %.1f dB rectangular, %.1f dB Hann; %s\n", rectangular_dB, hann_dB,
+           rectangular_dB > -60.0 && hann_dB < rectangular_dB - 20.0 ? "correct" : "WRONG" );
+  printf ( "  bin 90 %.1f dB ( -20 ), tone in band %d ( bins %u - %u ), power %.3g of %.3g; %s\n",
+           second_dB, peakBand, bands.First ( peakBand ), bands.End ( peakBand ) - 1, tonePower, expected,
+           fabs ( second_dB + 20.0 ) < 3.0 && bands.First ( peakBand ) <= 40 && bands.End ( peakBand ) > 41
+           && fabs ( tonePower / expected - 1.0 ) < 0.1 ? "correct" : "WRONG" );
+
+  // the same in Q31
+  static int32_t frame31 [ N ];
+  static uint32_t power31 [ N / 2 ];
+  source.Rewind ();
+  FFT_Pipeline<N, q31_t> spectrum31 ( source, frame31, power31 );
+  spectrum31.Set_Window ( hann );
+  spectrum31.Poll ();
+  // in Q31 units, 2^16 times those of Q15
+  double tonePower31 = ldexp ( ( double ) power31 [ 40 ] + power31 [ 41 ], spectrum31.Exponent () - 32 );
+  printf ( "  Q31: power %.4g, %.3f of Q15's; %s\n", tonePower31, tonePower31 / tonePower,
+           fabs ( tonePower31 / tonePower - 1.0 ) < 0.001 ? "correct" : "WRONG" );
+
+  // FFTsetup and FFTloop, on the same stages: Timer2's interrupt fired by hand, a tone at bin 20 of 64
+  TIMSK0 = 0x01;
+  FFTsetup ();
+  bool timersLeft = TIMSK0 == 0x01;
+  int fed = 0;
+  for ( int j = 0; j < FFT_SIZE + 40 && ! spectrogram_array [ 12 ][ 0 ]; j++ ) {
+    int adc = 512 + ( int ) lround ( 200.0 * sin ( 2.0 * M_PI * 20.0 * j / FFT_SIZE ) );
+    ADCL = adc & 0xff;
+    ADCH = adc >> 8;
+    ADCSRA |= 0x10;
+    TIMER2_OVF_vect ();
+    fed++;
+    if ( ( j & 7 ) == 7 ) FFTloop ();
+  }
+  int peak = 1;
+  for ( int k = 2; k < FFT_SIZE / 2; k++ ) if ( FFT_array_freq [ k ].hb [ 1 ] > FFT_array_freq [ peak ].hb [ 1 ] ) peak = k;
+  // 100 counts of int8_t: 100 * 64 / 2 / 64
+  printf ( "  FFTloop: bin %d at %d ( 50 ), band 12 at %d, after %d samples; timer 0 %s; %s\n",
+           peak, FFT_array_freq [ peak ].hb [ 1 ], spectrogram_array [ 12 ][ 0 ], fed,
+           timersLeft ? "left alone" : "STOPPED",
+           timersLeft && peak == 20 && abs ( FFT_array_freq [ 20 ].hb [ 1 ] - 50 ) <= 1
+           && spectrogram_array [ 12 ][ 0 ] >= 50 ? "correct" : "WRONG" );
+
+  // a stall of 100 samples, longer than the ring, in the middle of a frame: a ramp, 76 .. 125 over
+  // and over, so that any gap shows; the frame has to start over after it rather than splice
+  unsigned long ramp = 0, overruns0 = FFT_timer2.Overruns ();
+  auto feed = [&] ( int n, bool loop ) {
+    for ( int j = 0; j < n; j++ ) {
+      int adc = 512 + 2 * ( 76 + ( int ) ( ramp++ % 50 ) );
+      ADCL = adc & 0xff;
+      ADCH = adc >> 8;
+      ADCSRA |= 0x10;
+      TIMER2_OVF_vect ();
+      if ( loop && ( j & 7 ) == 7 ) FFTloop ();
+    }
+  };
+  uint8_t s0 = spectro;
+  for ( int j = 0; j < 8 * FFT_SIZE && spectro == s0; j += 8 ) feed ( 8, true );
+  feed ( 8, true );
+  feed ( 100, false );
+  FFTloop ();
+  s0 = spectro;
+  for ( int j = 0; j < 8 * FFT_SIZE && spectro == s0; j += 8 ) feed ( 8, true );
+  int gaps = 0;
+  for ( int i = 1; i < FFT_SIZE; i++ ) if ( ( FFT_array_time [ i ] - FFT_array_time [ i - 1 ] + 50 ) % 50 != 1 ) gaps++;
+  unsigned long dropped = FFT_timer2.Overruns () - overruns0;
+  printf ( "  FFTloop after a stall of 100 samples: %lu dropped, %d gaps in the frame; %s\n",
+           dropped, gaps, dropped == 100 - FFT_SIZE && spectro != s0 && gaps == 0 ? "correct" : "WRONG" );
+  FFT_timer2.End ();
+}
+
+static void benchFFT_Kernels ( unsigned long n ) {
+  benchSection ( "cbm_FFT: FFT_Kernels.h" );
+
+  // the square root, exactly, at the ends and at random
+  unsigned long seed = 1;
+  int rootsWrong = 0;
+  for ( unsigned long j = 0; j < 200000UL; j++ ) {
+    seed = seed * 1103515245UL + 12345UL;
+    uint32_t x = j < 70000UL ? ( uint32_t ) j : ( j < 70100UL ? 0xFFFFFFFFUL - ( j - 70000UL ) : ( uint32_t ) seed );
+    double root = floor ( sqrt ( ( double ) x ) + 0.5 );
+    if ( root > 65535.0 ) root = 65535.0;
+    if ( FFT_isqrt ( x ) != ( uint16_t ) root ) rootsWrong++;
+  }
+
+  // the magnitude, around the circle at several radii: the bound alone where a count is
+  // nothing, and the bound and the rounding at all of them
+  double magLow = 0.0, magHigh = 0.0;
+  bool magCounts = true;
+  for ( int r = 0; r < 4; r++ ) {
+    double radius = r == 0 ? 300.0 : ( r == 1 ? 3000.0 : ( r == 2 ? 30000.0 : 46340.0 ) );
+    for ( int a = 0; a < 3600; a++ ) {
+      double re = radius * cos ( a * M_PI / 1800.0 ), im = radius * sin ( a * M_PI / 1800.0 );
+      if ( fabs ( re ) > 32767.0 || fabs ( im ) > 32767.0 ) continue;
+      int16_t qre = ( int16_t ) lround ( re ), qim = ( int16_t ) lround ( im );
+      double exact = sqrt ( ( double ) qre * qre + ( double ) qim * qim );
+      double e16 = FFT_Approx_Magnitude ( qre, qim ) / exact - 1.0;
+      double e32 = FFT_Approx_Magnitude ( ( int32_t ) qre << 16, ( int32_t ) qim << 16 ) / ( exact * 65536.0 ) - 1.0;
+      if ( radius > 10000.0 ) {
+        magLow = fmin ( magLow, fmin ( e16, e32 ) );
+        magHigh = fmax ( magHigh, fmax ( e16, e32 ) );
+      }
+      if ( fabs ( e16 ) * exact > 0.0122 * exact + 0.5 ) magCounts = false;
+    }
+  }
+  bool extremes = FFT_Approx_Magnitude ( ( int16_t ) -32768, ( int16_t ) -32768 ) > 45000
+                  && FFT_Approx_Magnitude ( ( int16_t ) -32768, ( int16_t ) 0 ) == 32768;
+
+  // log2 and dB, against double precision
+  double log2Error = 0.0, dBError = 0.0;
+  for ( unsigned long j = 0; j < 100000UL; j++ ) {
+    seed = seed * 1103515245UL + 12345UL;
+    uint32_t x = j < 1000UL ? ( uint32_t ) j + 1 : seed >> ( j % 32 );
+    if ( x == 0 ) x = 1;
+    log2Error = fmax ( log2Error, fabs ( FFT_log2_Q8 ( x ) / 256.0 - log2 ( ( double ) x ) ) * 256.0 );
+    int e = ( int ) ( j % 41 ) - 20;
+    dBError = fmax ( dBError, fabs ( FFT_dB_Q4 ( x, e ) / 16.0 - 10.0 * log10 ( ldexp ( ( double ) x, e ) ) ) );
+  }
+  bool zeros = FFT_log2_Q8 ( 0 ) == FFT_LOG_ZERO && FFT_dB_Q4 ( 0, 10 ) == FFT_LOG_ZERO;
+
+  printf ( "  FFT_isqrt: %d of 200000 wrong; %s\n", rootsWrong, rootsWrong == 0 ? "correct" : "WRONG" );
+  printf ( "  FFT_Approx_Magnitude: %+.2f%% to %+.2f%% ( +-1.22%% ), and within half a count at 300; %s\n", 100.0 * magLow, 100.0 * magHigh,
+           magLow > -0.0125 && magHigh < 0.0125 && magCounts && extremes ? "correct" : "WRONG" );
+  printf ( "  FFT_log2_Q8: within %.2f of the last place; FFT_dB_Q4: within %.3f dB; %s\n", log2Error, dBError,
+           log2Error < 0.8 && dBError < 0.05 && zeros ? "correct" : "WRONG" );
+
+  // the block versions, on the bins of a spectrum, against the floating-point ones
+  const int N = 256;
+  static int16_t frame [ N ], bins [ N ];
+  static uint16_t mag [ N / 2 ], approx [ N / 2 ];
+  static int16_t dB [ N / 2 ];
+  for ( int j = 0; j < N; j++ ) {
+    frame [ j ] = ( int16_t ) lround ( 20000.0 * sin ( 2.0 * M_PI * 40.5 * j / N ) + 50.0 * ( ( j * 7919 ) % 101 - 50 ) );
+  }
+  memcpy ( bins, frame, sizeof ( bins ) );
+  int e = FFT_Real_T<N, q15_t>::forward ( bins );
+  const FFT_Complex<int16_t> * b = ( const FFT_Complex<int16_t> * ) bins;
+  FFT_Magnitude ( b, N / 2, e, mag );
+  FFT_Magnitude_Approx ( b, N / 2, e, approx );
+  FFT_Bins_dB ( b, N / 2, e, dB );
+  double blockMag = 0.0, blockdB = 0.0;
+  for ( int k = 1; k < N / 2; k++ ) {
+    double p = ( double ) b [ k ].re * b [ k ].re + ( double ) b [ k ].im * b [ k ].im;
+    if ( mag [ k ] >= 64 ) blockMag = fmax ( blockMag, fabs ( ( double ) approx [ k ] / mag [ k ] - 1.0 ) );
+    if ( p > 0.0 ) blockdB = fmax ( blockdB, fabs ( dB [ k ] / 16.0 - 10.0 * log10 ( ldexp ( p, 2 * e ) ) ) );
+  }
+  printf ( "  FFT_Magnitude_Approx against FFT_Magnitude: within %.2f%%; FFT_Bins_dB: within %.3f dB; %s\n",
+           100.0 * blockMag, blockdB, blockMag < 0.0125 + 1.0 / 64 && blockdB < 0.05 ? "correct" : "WRONG" );
+
+  // the cost a bin, against the float it replaces
+  static uint32_t power [ N / 2 ];
+  FFT_Power ( b, N / 2, e, power );
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = ( uint16_t ) ( sqrt ( ( float ) power [ i & ( N / 2 - 1 ) ] ) + 0.5f );
+  }, n );
+  benchReport ( "sqrt ( float ) + 0.5", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = FFT_isqrt ( power [ i & ( N / 2 - 1 ) ] );
+  }, n );
+  benchReport ( "FFT_isqrt", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = FFT_Approx_Magnitude ( b [ i & ( N / 2 - 1 ) ].re, b [ i & ( N / 2 - 1 ) ].im );
+  }, n );
+  benchReport ( "FFT_Approx_Magnitude", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = ( int16_t ) ( 160.0f * log10 ( ( float ) power [ i & ( N / 2 - 1 ) ] + 1.0f ) );
+  }, n );
+  benchReport ( "10 log10 ( float )", ns, 0 );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = FFT_dB_Q4 ( power [ i & ( N / 2 - 1 ) ], e );
+  }, n );
+  benchReport ( "FFT_dB_Q4", ns, 0 );
+}
+
+static void benchFFT_STFT ( unsigned long n ) {
+  benchSection ( "cbm_FFT: FFT_STFT.h" );
+
+  const int N = 256, HOP = N / 2, RING = 1024;
+  static volatile int16_t ring [ RING ];
+  static int16_t frame [ N ], hann [ N / 2 + 1 ];
+  static uint32_t power [ N / 2 ], welch [ N / 2 ], bandPower [ 8 ];
+  static uint16_t edges [ 9 ];
+  static uint8_t cells [ 16 * 8 ];
+  FFT_Window::Make ( hann, N, FFT_WINDOW_HANN );
+  FFT_Bands bands ( edges, 8 );
+  bands.Set_Log ( 1, N / 2 );
+  FFT_STFT<N> stft ( ring, RING, frame, power, HOP );
+  stft.Set_Window ( hann );
+  stft.Set_Bands ( &bands, bandPower );
+  stft.Set_Spectrogram ( cells, 16 );
+  stft.Set_Welch ( welch );
+  int toneBand = 0;
+  while ( bands.End ( toneBand ) <= 40 ) toneBand++;
+
+  // silence, then a tone from sample 1000 on, pushed 37 at a time between frames:
+  // frame j holds samples j * HOP .. j * HOP + N - 1, so frame 6 is the first with the tone
+  const int START = 1000, TOTAL = 4000;
+  int first = -1, frames = 0;
+  for ( int j = 0; j < TOTAL; ) {
+    for ( int i = 0; i < 37 && j < TOTAL; i++, j++ ) {
+      stft.Push ( j < START ? 0 : ( int16_t ) lround ( 20000.0 * sin ( 2.0 * M_PI * 40.5 * j / N ) ) );
+    }
+    while ( stft.Process () ) {
+      if ( first < 0 && bandPower [ toneBand ] ) first = frames;
+      frames++;
+    }
+  }
+  int expectedFrames = ( TOTAL - N ) / HOP + 1;
+  printf ( "  %d frames of %d samples, hop %d, from %d samples ( %d ); the tone from frame %d ( 6 ); %lu overruns; %s\n",
+           frames, N, HOP, TOTAL, expectedFrames, first, stft.Overruns (),
+           frames == expectedFrames && first == 6 && stft.Overruns () == 0 ? "correct" : "WRONG" );
+
+  // the latest row of the spectrogram against the band's power
+  uint8_t * row = stft.Row ( 0 );
+  double level_dB = 10.0 * log10 ( stft.Band_Power ( toneBand ) );
+  int quiet = 0;
+  for ( int b = 0; b < 8; b++ ) if ( b != toneBand && row [ b ] < row [ toneBand ] ) quiet++;
+  printf ( "  spectrogram: %u rows, tone band %d at %.1f dB ( %.1f ), %d of 7 others below it; %s\n",
+           stft.Rows (), toneBand, stft.Cell_dB ( row [ toneBand ] ), level_dB, quiet,
+           stft.Rows () == 16 && fabs ( stft.Cell_dB ( row [ toneBand ] ) - level_dB ) <= 0.25 && quiet == 7
+           && stft.Row ( 16 ) == NULL ? "correct" : "WRONG" );
+
+  // falling behind: more than the ring before a frame is taken
+  for ( int j = 0; j < 3 * RING; j++ ) stft.Push ( 0 );
+  bool one = stft.Process ();
+  unsigned long overruns = stft.Overruns ();
+  int after = 0;
+  while ( stft.Process () ) after++;
+  printf ( "  %d samples unread: %lu overrun, then %d frame and %lu waiting; %s\n", 3 * RING, overruns,
+           one + after, stft.Waiting (), one && overruns == 1 && after == 0 && stft.Waiting () == N - HOP ? "correct" : "WRONG" );
+
+  // Welch: white noise, uniform over +-8000, has a variance of 8000^2 / 3, and a one-sided
+  // density of twice that over the sampling frequency
+  stft.Reset ();
+  stft.Welch_Reset ();
+  const double fs = 400.0, variance = 8000.0 * 8000.0 / 3.0;
+  unsigned long seed = 12345;
+  for ( int j = 0; j < 200 * HOP + N; j++ ) {
+    seed = seed * 1103515245UL + 12345UL;
+    stft.Push ( ( int16_t ) ( ( long ) ( ( seed >> 8 ) % 16001 ) - 8000 ) );
+    stft.Process ();
+  }
+  double psd = 0.0;
+  for ( int k = 1; k < N / 2; k++ ) psd += stft.Welch_PSD ( k, fs );
+  psd /= N / 2 - 1;
+  double meanSquare = stft.Welch_Mean_Square ( 0, N / 2 );
+  printf ( "  Welch over %lu frames: density %.4g ( %.4g ), mean square %.4g ( %.4g ); %s\n",
+           stft.Welch_Frames (), psd, 2.0 * variance / fs, meanSquare, variance,
+           stft.Welch_Frames () == 201 && fabs ( psd / ( 2.0 * variance / fs ) - 1.0 ) < 0.03
+           && fabs ( meanSquare / variance - 1.0 ) < 0.03 ? "correct" : "WRONG" );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    for ( int j = 0; j < HOP; j++ ) stft.Push ( ( int16_t ) ( 100.0 * ( samples [ ( i * HOP + j ) & ( nSamples - 1 ) ] - 105.0 ) ) );
+    stft.Process ();
+    benchSink = bandPower [ 3 ];
+  }, n / N / 2 );
+  benchReport ( "FFT_STFT<256>: hop 128, Hann, 8 bands, spectrogram, Welch", ns,
+               sizeof ( ring ) + sizeof ( frame ) + sizeof ( hann ) + sizeof ( power ) + sizeof ( welch ) + sizeof ( cells ) );
+}
+
+// a file in memory, with the calls of SD's File that FFT_File_Store makes
+struct MemFile {
+  uint8_t data [ 32768 ];
+  uint32_t length, at;
+  MemFile () : length ( 0 ), at ( 0 ) { }
+  uint32_t size () { return length; }
+  bool seek ( uint32_t p ) { if ( p > length ) return false; at = p; return true; }
+  int read ( uint8_t * buf, uint16_t n ) {
+    if ( at + n > length ) n = length - at;
+    memcpy ( buf, data + at, n );
+    at += n;
+    return n;
+  }
+  size_t write ( const uint8_t * buf, size_t n ) {
+    if ( at + n > sizeof ( data ) ) n = sizeof ( data ) - at;
+    memcpy ( data + at, buf, n );
+    at += n;
+    if ( at > length ) length = at;
+    return n;
+  }
+  void flush () { }
+};
+
+// 12 words of 64 frames by 16 bands: random levels every 8 frames, joined by straight lines
+static const int MATCH_WORDS = 12, MATCH_FRAMES = 64, MATCH_BANDS = 16;
+static int8_t matchCells [ MATCH_WORDS ][ MATCH_FRAMES * MATCH_BANDS ];
+static char matchLabels [ MATCH_WORDS ][ 9 ];
+static FFT_Flash_Template matchTable [ MATCH_WORDS ];
+static double matchKey ( int word, int key, int band ) {
+  unsigned long seed = ( ( unsigned long ) word * 131UL + key ) * 37UL + band;
+  for ( int j = 0; j < 3; j++ ) seed = seed * 1103515245UL + 12345UL;
+  return ( double ) ( ( seed >> 12 ) % 121 ) - 40.0;
+}
+static double matchWord ( int word, double frame, int band ) {
+  if ( frame < 0.0 ) frame = 0.0;
+  if ( frame > MATCH_FRAMES - 1 ) frame = MATCH_FRAMES - 1;
+  int key = ( int ) ( frame / 8.0 );
+  double f = frame / 8.0 - key;
+  return ( 1.0 - f ) * matchKey ( word, key, band ) + f * matchKey ( word, key + 1, band );
+}
+
+// each template alone, in a store of one, so that nothing is abandoned
+static void matchEach ( FFT_Match_Method method, const FFT_Spectrogram & live, int8_t * frame, uint32_t * rows,
+                        int & best, float & bestScore ) {
+  best = -1;
+  for ( int w = 0; w < MATCH_WORDS; w++ ) {
+    FFT_Flash_Store one ( matchTable + w, 1 );
+    FFT_Matcher matcher ( one, frame, rows );
+    matcher.Set_Method ( method, 8 );
+    float score = matcher.Match ( live ).score;
+    if ( best < 0 || ( method == FFT_MATCH_NCC ? score > bestScore : score < bestScore ) ) {
+      best = w;
+      bestScore = score;
+    }
+  }
+}
+
+static void benchFFT_Match ( unsigned long n ) {
+  benchSection ( "cbm_FFT: FFT_Match.h" );
+
+  for ( int w = 0; w < MATCH_WORDS; w++ ) {
+    for ( int f = 0; f < MATCH_FRAMES; f++ ) {
+      for ( int b = 0; b < MATCH_BANDS; b++ ) matchCells [ w ][ f * MATCH_BANDS + b ] = ( int8_t ) lround ( matchWord ( w, f, b ) );
+    }
+    snprintf ( matchLabels [ w ], sizeof ( matchLabels [ w ] ), "word%02d", w );
+    matchTable [ w ].label = matchLabels [ w ];
+    matchTable [ w ].cells = matchCells [ w ];
+    matchTable [ w ].frames = MATCH_FRAMES;
+    matchTable [ w ].bands = MATCH_BANDS;
+  }
+  // word 7 said again: up to 6 frames early or late, and noisy; band by frame, as FFTloop's
+  static int8_t live [ MATCH_BANDS ][ MATCH_FRAMES ];
+  unsigned long seed = 99;
+  for ( int f = 0; f < MATCH_FRAMES; f++ ) {
+    double warped = f + 6.0 * sin ( M_PI * f / ( MATCH_FRAMES - 1 ) );
+    for ( int b = 0; b < MATCH_BANDS; b++ ) {
+      seed = seed * 1103515245UL + 12345UL;
+      live [ b ][ f ] = ( int8_t ) lround ( matchWord ( 7, warped, b ) + ( double ) ( ( seed >> 16 ) % 21 ) - 10.0 );
+    }
+  }
+  FFT_Spectrogram spoken ( &live [ 0 ][ 0 ], MATCH_FRAMES, MATCH_BANDS, 1, MATCH_FRAMES );
+
+  static int8_t frame [ MATCH_BANDS ];
+  static uint32_t rows [ 2 * MATCH_FRAMES ];
+  FFT_Flash_Store words ( matchTable, MATCH_WORDS );
+  FFT_Matcher matcher ( words, frame, rows );
+
+  // against each alone: the same best, and the same score
+  int each;
+  float eachScore;
+  FFT_Match_Result ncc = matcher.Match ( spoken );
+  matchEach ( FFT_MATCH_NCC, spoken, frame, rows, each, eachScore );
+  printf ( "  NCC: %s at %.3f ( alone %d at %.3f ), %u compared, %u abandoned; %s\n", ncc.label, ncc.score,
+           each, eachScore, ncc.compared, ncc.abandoned,
+           ncc.index == 7 && each == 7 && ncc.score == eachScore && ncc.abandoned > 0
+           && ncc.compared + ncc.abandoned == MATCH_WORDS ? "correct" : "WRONG" );
+  matcher.Set_Method ( FFT_MATCH_DTW, 8 );
+  FFT_Match_Result dtw = matcher.Match ( spoken );
+  matchEach ( FFT_MATCH_DTW, spoken, frame, rows, each, eachScore );
+  printf ( "  DTW: %s at %.2f a cell ( alone %d at %.2f ), %u compared, %u abandoned; %s\n", dtw.label, dtw.score,
+           each, eachScore, dtw.compared, dtw.abandoned,
+           dtw.index == 7 && each == 7 && dtw.score == eachScore && dtw.abandoned > 0 ? "correct" : "WRONG" );
+
+  // the same words in a file, and one of 48 frames, which the correlation cannot take
+  static MemFile file;
+  static uint32_t offsets [ 16 ];
+  FFT_File_Store<MemFile> filed ( file, offsets, 16 );
+  int added = 0;
+  for ( int w = 0; w < MATCH_WORDS; w++ ) {
+    added += filed.Add ( matchLabels [ w ], FFT_Spectrogram ( matchCells [ w ], MATCH_FRAMES, MATCH_BANDS, MATCH_BANDS, 1 ) ) == w;
+  }
+  filed.Add ( "short", FFT_Spectrogram ( matchCells [ 3 ], 48, MATCH_BANDS, MATCH_BANDS, 1 ) );
+  FFT_File_Store<MemFile> reopened ( file, offsets, 16 );
+  uint8_t found = reopened.Begin ();
+  FFT_Matcher fileMatcher ( reopened, frame, rows );
+  FFT_Match_Result fileNCC = fileMatcher.Match ( spoken );
+  fileMatcher.Set_Method ( FFT_MATCH_DTW, 8 );
+  // a little at a time, as between frames
+  fileMatcher.Begin ( spoken );
+  int runs = 1;
+  while ( ! fileMatcher.Run ( 1 ) ) runs++;
+  FFT_Match_Result fileDTW = fileMatcher.Best ();
+  printf ( "  file: %d added, %u found, %lu bytes; NCC %s at %.3f, %u skipped; DTW %s at %.2f in %d runs; %s\n",
+           added, found, ( unsigned long ) file.size (), fileNCC.label, fileNCC.score, fileNCC.skipped,
+           fileDTW.label, fileDTW.score, runs,
+           added == MATCH_WORDS && found == MATCH_WORDS + 1 && fileNCC.index == 7 && fileNCC.score == ncc.score
+           && fileNCC.skipped == 1 && fileDTW.index == 7 && fileDTW.score == dtw.score && fileDTW.skipped == 0
+           && runs > 1 ? "correct" : "WRONG" );
+
+  // FFTloop: a tone captured and added to the file, then captured again and matched, a pass at a time
+  static int8_t loopCells [ TIME_SZ * NBR_FRQ ];
+  FFT_Matcher loopMatcher ( reopened, frame, rows );
+  FFT_matcher = &loopMatcher;
+  FFT_match_cells = loopCells;
+  FFTsetup ();
+  int16_t loopIndex [ 2 ];
+  unsigned long loopLongest_us = 0;
+  for ( int capture = 0; capture < 2; capture++ ) {
+    FFT_match.index = -2;
+    for ( int j = 0; j < 3 * FFT_SIZE * TIME_SZ && FFT_match.index == -2; j++ ) {
+      int adc = 512 + ( int ) lround ( 200.0 * sin ( 2.0 * M_PI * 10.0 * j / FFT_SIZE ) );
+      ADCL = adc & 0xff;
+      ADCH = adc >> 8;
+      ADCSRA |= 0x10;
+      TIMER2_OVF_vect ();
+      if ( ( j & 7 ) == 7 ) {
+        unsigned long t0 = micros ();
+        FFTloop ();
+        if ( micros () - t0 > loopLongest_us ) loopLongest_us = micros () - t0;
+      }
+    }
+    loopIndex [ capture ] = FFT_match.index;
+    if ( capture == 0 ) reopened.Add ( "tone", FFT_spectrogram );
+  }
+  FFT_timer2.End ();
+  FFT_matcher = NULL;
+  FFT_match_cells = NULL;
+  printf ( "  FFTloop: first capture matched %d, second %s ( %d ) at %.3f, the longest pass %lu us; %s\n",
+           loopIndex [ 0 ], FFT_match.label, loopIndex [ 1 ], FFT_match.score, loopLongest_us,
+           loopIndex [ 0 ] >= 0 && loopIndex [ 1 ] == MATCH_WORDS + 1 && FFT_match.score > 0.95
+           && loopLongest_us < 16000UL ? "correct" : "WRONG" );
+
+  // 250 templates, DTW, more than a frame's worth all at once: FFTloop's budget a Run, each under
+  // the 16 ms of a frame, and the same best as Match
+  static FFT_Flash_Template manyTable [ 250 ];
+  for ( int t = 0; t < 250; t++ ) manyTable [ t ] = matchTable [ t % MATCH_WORDS ];
+  FFT_Flash_Store many ( manyTable, 250 );
+  FFT_Matcher manyMatcher ( many, frame, rows );
+  manyMatcher.Set_Method ( FFT_MATCH_DTW, 8 );
+  unsigned long t0 = micros ();
+  FFT_Match_Result manyAll = manyMatcher.Match ( spoken );
+  unsigned long all_us = micros () - t0, longest_us = 0;
+  manyMatcher.Begin ( spoken );
+  int manyRuns = 0;
+  bool manyDone = false;
+  while ( ! manyDone ) {
+    t0 = micros ();
+    manyDone = manyMatcher.Run ( FFT_match_budget_us );
+    if ( micros () - t0 > longest_us ) longest_us = micros () - t0;
+    manyRuns++;
+  }
+  printf ( "  Run ( %lu ): 250 templates in %d runs, the longest %lu us ( %lu us all at once ); %s\n",
+           FFT_match_budget_us, manyRuns, longest_us, all_us,
+           manyMatcher.Best ().index == manyAll.index && manyAll.index == 7
+           && longest_us < 16000UL ? "correct" : "WRONG" );
+
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = matcher.Match ( spoken ).score;
+  }, n / 20000 );
+  benchReport ( "FFT_Matcher: DTW, window 8, 12 x 64 x 16, a template", ns / MATCH_WORDS, sizeof ( frame ) + sizeof ( rows ) );
+  matcher.Set_Method ( FFT_MATCH_NCC );
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    benchSink = matcher.Match ( spoken ).score;
+  }, n / 2000 );
+  benchReport ( "FFT_Matcher: NCC, 12 x 64 x 16, a template", ns / MATCH_WORDS, sizeof ( frame ) );
+}
+
+static void benchFormatting ( unsigned long n ) {
+  benchSection ( "cbm_FormatFloat / cbm_PrintHex" );
+  char buf [ 24 ];
+  double ns = benchTime_ns ( [&] ( unsigned long i ) {
+    formatFloat ( buf, 0, samples [ i & ( nSamples - 1 ) ], 2 );
+    benchSink = buf [ 0 ];
+  }, n / 16 );
+  benchReport ( "formatFloat", ns, 0 );
+
+  NullStream null;
+  ns = benchTime_ns ( [&] ( unsigned long i ) {
+    convertHex ( buf, 8, i, 4, null );
+    benchSink = buf [ 0 ];
+  }, n / 4 );
+  benchReport ( "convertHex ( 4 nybbles )", ns, 0 );
+}
+
+int main ( int argc, char ** argv ) {
+  unsigned long scale = argc > 1 ? strtoul ( argv [ 1 ], NULL, 10 ) : 1UL;
+  if ( scale == 0 ) scale = 1;
+  const unsigned long n = 1000000UL * scale;
+
+  initializeInputs ();
+
+  printf ( "cbm_* host benchmark ( %lu iterations per hot call )\n", n );
+
+  benchStats ( n );
+  benchSlidingStats ( n );
+  benchEWMA ( n );
+  benchEWMA_T<int16_t> ( "int16_t", n, 100.0 );
+  benchEWMA_T<int32_t> ( "int32_t", n, 1e6 );
+  benchEWMA_T<float> ( "float", n, 1.0 );
+  benchEWMA_T<double> ( "double", n, 1.0 );
+  benchBiquad ( n );
+  benchCircularBuffer ( n );
+  benchSPSCRing ( n );
+  benchAcquisition ( n );
+  benchLSM303DLH ( n );
+  benchCRC ( n );
+  benchMODBUS ( n );
+  benchMODBUS_Master ();
+  benchMODBUS_Read_Plan ();
+  benchRegMap ( n );
+  benchRS485Frames ( n );
+  benchMODBUS_Changes ();
+  benchMODBUS_Functions ();
+  benchMODBUS_TCP ();
+  benchTimedScheduler ( n );
+  benchFFT ( n );
+  benchFFT_T ( n );
+  benchFFT_Pipeline ( n );
+  benchFFT_Kernels ( n );
+  benchFFT_STFT ( n );
+  benchFFT_Match ( n );
+  benchFormatting ( n );
+
+  return 0;
+}
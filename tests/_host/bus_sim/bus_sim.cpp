@@ -0,0 +1,331 @@
+/*
+	bus_sim - load test of the real MODBUS_Master polling real MODBUS_Slaves
+	  on a simulated RS485 line ( shim/RTUBus.h ), without boards
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	  build/bus_sim [ -b baud ] [ -p propagation_us ] [ -e bit_error_rate ]
+	                [ -n slaves ] [ -r registers ] [ -t seconds ] [ -w reply_timeout_us ]
+	                [ -x seed ] [ -s blocking|queued|changes|all ]
+
+	Slave s ( 1 .. n ) holds registers r = 0 .. registers - 1 of s * 100 + r;
+	the first two also change, by thousands, ten times a second, like a
+	temperature and a light level. Each strategy polls every slave's registers
+	for the given time:
+	  blocking  Read_Reg for each slave in turn; the slaves run from yield ()
+	  queued    Queue_Read_Regs for all of them, then Poll () until done
+	  changes   Queue_Read_Changes ( function 0x41 ) for each, following
+	            continuations, keeping an image of each slave's registers
+	and reports transactions and rounds per second, latency percentiles,
+	failures by kind, how long a slave took to answer correctly again after a
+	failure, and the line's load. Every value that arrives is checked against
+	the pattern above; a bad one in a reply with a good CRC is "wrong data".
+
+	The exit status is 1 if there was wrong data, or a strategy got no good
+	replies at all, so that a polling strategy can be regression-tested.
+*/
+
+#include <Arduino.h>
+#include <RTUBus.h>
+#include <MODBUS.h>
+#include <MODBUS_Master.h>
+#include <MODBUS_Slave.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <algorithm>
+
+struct Options {
+  unsigned long baud, propagation_us, timeout_us, seed;
+  double bitErrorRate, seconds;
+  int nSlaves, nRegs;
+  const char * strategy;
+};
+
+static Options opt = { 57600, 5, MBM_TIME_TO_WAIT_FOR_REPLY_us, 1, 0.0, 1.0, 8, 8, "all" };
+
+#define N_CHANGING 2
+#define N_PHASES 8
+
+// ******************************************************************************
+// the slaves
+
+struct SimSlave {
+  MODBUS * port;
+  MODBUS_Slave * slave;
+  std::vector<short> regs, shadow;
+  std::vector<unsigned short> changedAt;
+  unsigned short coils [ 1 ];
+};
+
+static std::vector<SimSlave> slaves;
+static unsigned long lastChangeAt_ms;
+static int phase;
+
+static bool valid ( int s, int r, short v ) {
+  int d = v - ( s * 100 + r );
+  return ( d % 1000 == 0 ) && ( d >= 0 ) && ( d / 1000 < N_PHASES );
+}
+
+// the slaves' loop (): the process, then Execute; also called from each port's
+// flush (), so a slave that is sending is skipped until it has finished
+static void runSlaves () {
+  static std::vector<bool> busy;
+  busy.resize ( slaves.size () );
+  if ( millis () - lastChangeAt_ms >= 100 ) {
+    lastChangeAt_ms = millis ();
+    phase = ( phase + 1 ) % N_PHASES;
+    for ( int s = 1; s <= opt.nSlaves; s++ ) {
+      for ( int r = 0; r < N_CHANGING && r < opt.nRegs; r++ ) {
+        slaves [ s - 1 ].regs [ r ] = s * 100 + r + 1000 * ( ( phase + s ) % N_PHASES );
+      }
+    }
+  }
+  for ( size_t i = 0; i < slaves.size (); i++ ) {
+    if ( busy [ i ] ) continue;
+    busy [ i ] = true;
+    slaves [ i ].slave->Execute ();
+    busy [ i ] = false;
+  }
+}
+
+// ******************************************************************************
+// what happened
+
+struct Stats {
+  std::vector<unsigned long> latency_us, recovery_us;
+  std::vector<unsigned long> failedAt_us;   // per slave, 0 if its last was good
+  unsigned long transactions, good, wrong, rounds;
+  unsigned long byStatus [ 7 ];             // by - status, MBM_TIMEOUT .. MBM_TOO_LONG
+  unsigned long startedAt_us;
+
+  void reset () {
+    latency_us.clear ();
+    recovery_us.clear ();
+    failedAt_us.assign ( opt.nSlaves + 1, 0 );
+    transactions = good = wrong = rounds = 0;
+    memset ( byStatus, 0, sizeof ( byStatus ) );
+    startedAt_us = micros ();
+  }
+
+  void record ( int slave, int status, unsigned long latency, bool dataGood ) {
+    transactions++;
+    latency_us.push_back ( latency );
+    if ( status != MBM_OK ) {
+      if ( -status >= 1 && -status <= 6 ) byStatus [ -status ]++;
+      if ( failedAt_us [ slave ] == 0 ) failedAt_us [ slave ] = micros () | 1;
+      return;
+    }
+    if ( ! dataGood ) wrong++;
+    good++;
+    if ( failedAt_us [ slave ] ) {
+      recovery_us.push_back ( micros () - failedAt_us [ slave ] );
+      failedAt_us [ slave ] = 0;
+    }
+  }
+};
+
+static Stats stats;
+
+static unsigned long percentile ( std::vector<unsigned long> & v, double p ) {
+  if ( v.empty () ) return 0;
+  size_t k = ( size_t ) ( p * ( v.size () - 1 ) + 0.5 );
+  std::nth_element ( v.begin (), v.begin () + k, v.end () );
+  return v [ k ];
+}
+
+static void report ( const char * name, RTUBus & bus ) {
+  double elapsed_s = ( micros () - stats.startedAt_us ) / 1e6;
+  printf ( "\n%s: %d slaves x %d registers, %lu baud, %lu us propagation, bit error rate %g\n",
+           name, opt.nSlaves, opt.nRegs, opt.baud, opt.propagation_us, opt.bitErrorRate );
+  printf ( "  transactions %lu ( %.1f/s ), rounds %lu ( %.1f/s )\n",
+           stats.transactions, stats.transactions / elapsed_s, stats.rounds, stats.rounds / elapsed_s );
+  printf ( "  latency us: p50 %lu, p90 %lu, p99 %lu, max %lu\n",
+           percentile ( stats.latency_us, 0.50 ), percentile ( stats.latency_us, 0.90 ),
+           percentile ( stats.latency_us, 0.99 ), percentile ( stats.latency_us, 1.0 ) );
+  printf ( "  good %lu; timeout %lu, short %lu, CRC %lu, exception %lu, bad reply %lu; wrong data %lu\n",
+           stats.good, stats.byStatus [ - MBM_TIMEOUT ], stats.byStatus [ - MBM_SHORT ],
+           stats.byStatus [ - MBM_CRC ], stats.byStatus [ - MBM_EXCEPTION ],
+           stats.byStatus [ - MBM_BAD_REPLY ], stats.wrong );
+  if ( ! stats.recovery_us.empty () ) {
+    unsigned long long sum = 0;
+    for ( size_t i = 0; i < stats.recovery_us.size (); i++ ) sum += stats.recovery_us [ i ];
+    printf ( "  recovery after a failure: %lu times, mean %.1f ms, max %.1f ms\n",
+             ( unsigned long ) stats.recovery_us.size (), sum / 1e3 / stats.recovery_us.size (),
+             percentile ( stats.recovery_us, 1.0 ) / 1e3 );
+  }
+  printf ( "  line: %lu characters ( %.1f a round ), %lu corrupted, %lu collisions, busy %.1f%%\n",
+           bus.characters (), stats.rounds ? ( double ) bus.characters () / stats.rounds : 0.0,
+           bus.corrupted (), bus.collisions (), 100.0 * bus.busy_us () / ( elapsed_s * 1e6 ) );
+}
+
+static bool timeIsUp () {
+  return micros () - stats.startedAt_us >= opt.seconds * 1e6;
+}
+
+// ******************************************************************************
+// the strategies
+
+static void pollBlocking ( MODBUS_Master & master ) {
+  std::vector<short> buf ( opt.nRegs );
+  while ( ! timeIsUp () ) {
+    for ( int s = 1; s <= opt.nSlaves; s++ ) {
+      unsigned long t0 = micros ();
+      int error = master.Read_Reg ( s, 0, opt.nRegs, &buf [ 0 ], opt.nRegs );
+      // the blocking call says only whether there was no reply ( 2 ) or a bad one ( 1 )
+      int status = error == 0 ? MBM_OK : error == 0x02 ? MBM_TIMEOUT : MBM_BAD_REPLY;
+      bool dataGood = true;
+      for ( int r = 0; r < opt.nRegs && error == 0; r++ ) dataGood &= valid ( s, r, buf [ r ] );
+      stats.record ( s, status, micros () - t0, dataGood );
+    }
+    stats.rounds++;
+  }
+}
+
+static std::vector< std::vector<short> > replies;
+
+static void gotRegs ( MBM_Request & r ) {
+  bool dataGood = true;
+  for ( int k = 0; k < r.n && r.status == MBM_OK; k++ ) dataGood &= valid ( r.slave, r.start + k, r.values [ k ] );
+  stats.record ( r.slave, r.status, r.latency_us, dataGood );
+}
+
+static void pollQueued ( MODBUS_Master & master ) {
+  replies.assign ( opt.nSlaves + 1, std::vector<short> ( opt.nRegs ) );
+  while ( ! timeIsUp () ) {
+    for ( int s = 1; s <= opt.nSlaves; s++ ) {
+      while ( ! master.Queue_Read_Regs ( s, 0, opt.nRegs, &replies [ s ] [ 0 ], opt.nRegs, gotRegs, NULL, 0x03 ) ) {
+        master.Poll ();
+        runSlaves ();
+      }
+    }
+    while ( master.Pending () > 0 ) {
+      master.Poll ();
+      runSlaves ();
+    }
+    stats.rounds++;
+  }
+}
+
+static std::vector< std::vector<short> > images;
+static std::vector<unsigned short> seen, seenNext;
+static MODBUS_Master * changesMaster;
+
+static void gotChanges ( MBM_Request & r ) {
+  int s = r.slave;
+  bool dataGood = true;
+  for ( int k = 0; k < opt.nRegs && r.status == MBM_OK; k++ ) dataGood &= valid ( s, k, r.values [ k ] );
+  stats.record ( s, r.status, r.latency_us, dataGood );
+  if ( r.status != MBM_OK ) return;                // seen stays, so the next round asks again
+  if ( r.context == NULL ) seenNext [ s ] = r.n;   // the first reply of the series
+  if ( r.start >= 0 ) {
+    changesMaster->Queue_Read_Changes ( s, r.start, seen [ s ], &images [ s ] [ 0 ], opt.nRegs,
+                                        gotChanges, &images [ s ] );
+  } else {
+    seen [ s ] = seenNext [ s ];
+  }
+}
+
+static void pollChanges ( MODBUS_Master & master ) {
+  changesMaster = &master;
+  images.assign ( opt.nSlaves + 1, std::vector<short> ( opt.nRegs ) );
+  seen.assign ( opt.nSlaves + 1, 0 );
+  seenNext.assign ( opt.nSlaves + 1, 0 );
+  // everything once, so that the images start out right
+  for ( int s = 1; s <= opt.nSlaves; s++ ) {
+    for ( int r = 0; r < opt.nRegs; r++ ) images [ s ] [ r ] = s * 100 + r;
+  }
+  while ( ! timeIsUp () ) {
+    for ( int s = 1; s <= opt.nSlaves; s++ ) {
+      while ( ! master.Queue_Read_Changes ( s, 0, seen [ s ], &images [ s ] [ 0 ], opt.nRegs, gotChanges ) ) {
+        master.Poll ();
+        runSlaves ();
+      }
+    }
+    while ( master.Pending () > 0 ) {
+      master.Poll ();
+      runSlaves ();
+    }
+    stats.rounds++;
+  }
+}
+
+// ******************************************************************************
+
+static bool run ( const char * name, void ( * strategy ) ( MODBUS_Master & ) ) {
+
+  RTUBus bus ( opt.baud, opt.propagation_us, opt.bitErrorRate, opt.seed );
+  MODBUS masterPort ( bus.attach () );
+  MODBUS_Master master ( masterPort );
+  master.Set_Baud ( opt.baud, opt.timeout_us );
+
+  slaves.assign ( opt.nSlaves, SimSlave () );
+  for ( int s = 1; s <= opt.nSlaves; s++ ) {
+    SimSlave & x = slaves [ s - 1 ];
+    x.regs.resize ( opt.nRegs );
+    x.shadow.resize ( opt.nRegs );
+    x.changedAt.resize ( opt.nRegs );
+    for ( int r = 0; r < opt.nRegs; r++ ) x.regs [ r ] = s * 100 + r;
+    x.coils [ 0 ] = 0;
+    x.port = new MODBUS ( bus.attach () );
+    x.port->_RS485.Set_Baud ( opt.baud );
+    x.slave = new MODBUS_Slave ( s, 16, x.coils, opt.nRegs, &x.regs [ 0 ], *x.port );
+    x.slave->Track_Changes ( &x.shadow [ 0 ], &x.changedAt [ 0 ] );
+  }
+  lastChangeAt_ms = millis ();
+  phase = 0;
+
+  setYieldHook ( runSlaves );
+  stats.reset ();
+  bus.resetCounts ();
+  strategy ( master );
+  report ( name, bus );
+  setYieldHook ( NULL );
+
+  bool passed = ( stats.wrong == 0 ) && ( stats.good > 0 );
+  for ( size_t i = 0; i < slaves.size (); i++ ) {
+    delete slaves [ i ].slave;
+    delete slaves [ i ].port;
+  }
+  slaves.clear ();
+  return ( passed );
+
+}
+
+int main ( int argc, char ** argv ) {
+
+  int c;
+  while ( ( c = getopt ( argc, argv, "b:p:e:n:r:t:w:x:s:" ) ) != -1 ) {
+    switch ( c ) {
+      case 'b': opt.baud = strtoul ( optarg, NULL, 10 ); break;
+      case 'p': opt.propagation_us = strtoul ( optarg, NULL, 10 ); break;
+      case 'e': opt.bitErrorRate = atof ( optarg ); break;
+      case 'n': opt.nSlaves = atoi ( optarg ); break;
+      case 'r': opt.nRegs = atoi ( optarg ); break;
+      case 't': opt.seconds = atof ( optarg ); break;
+      case 'w': opt.timeout_us = strtoul ( optarg, NULL, 10 ); break;
+      case 'x': opt.seed = strtoul ( optarg, NULL, 10 ); break;
+      case 's': opt.strategy = optarg; break;
+      default:
+        fprintf ( stderr, "usage: %s [ -b baud ] [ -p propagation_us ] [ -e bit_error_rate ] [ -n slaves ]\n"
+                          "         [ -r registers ] [ -t seconds ] [ -w reply_timeout_us ] [ -x seed ]\n"
+                          "         [ -s blocking|queued|changes|all ]\n", argv [ 0 ] );
+        return 2;
+    }
+  }
+  // one port for the master; a read's reply has to fit MODBUS_Master's buffer
+  if ( opt.nSlaves < 1 ) opt.nSlaves = 1;
+  if ( opt.nSlaves > RTUBUS_MAX_PORTS - 1 ) opt.nSlaves = RTUBUS_MAX_PORTS - 1;
+  if ( opt.nRegs < 1 ) opt.nRegs = 1;
+  if ( opt.nRegs > ( MODBUS_MASTER_BUF_LEN - 5 ) / 2 ) opt.nRegs = ( MODBUS_MASTER_BUF_LEN - 5 ) / 2;
+
+  bool all = strcmp ( opt.strategy, "all" ) == 0;
+  bool passed = true;
+  if ( all || strcmp ( opt.strategy, "blocking" ) == 0 ) passed &= run ( "blocking", pollBlocking );
+  if ( all || strcmp ( opt.strategy, "queued" ) == 0 ) passed &= run ( "queued", pollQueued );
+  if ( all || strcmp ( opt.strategy, "changes" ) == 0 ) passed &= run ( "changes", pollChanges );
+  printf ( "\n%s\n", passed ? "passed" : "FAILED" );
+  return ( passed ? 0 : 1 );
+
+}
@@ -0,0 +1,231 @@
+/*
+	Arduino.cpp - host shim of the Arduino core
+	Released into the public domain
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include <Arduino.h>
+
+// AVR registers ( see avr/io.h )
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, ASSR;
+volatile uint8_t TIMSK0, TIMSK1, TIMSK2;
+volatile uint8_t ADCSRA, ADMUX, ADCL, ADCH;
+volatile uint8_t EECR, EEDR;
+volatile uint16_t EEAR;
+
+// cbm_FFT's freeRam () looks at these
+int __heap_start;
+int * __brkval;
+
+HostSerial Serial;
+
+//************************************************************************************************
+// 						                             time
+//************************************************************************************************
+
+static unsigned long long _now_ns () {
+  struct timespec ts;
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+  return ( unsigned long long ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const unsigned long long _startedAt_ns = _now_ns ();
+
+unsigned long millis () {
+  return ( uint32_t ) ( ( _now_ns () - _startedAt_ns ) / 1000000ULL );
+}
+
+unsigned long micros () {
+  return ( uint32_t ) ( ( _now_ns () - _startedAt_ns ) / 1000ULL );
+}
+
+void delay ( unsigned long ms ) {
+  struct timespec ts;
+  ts.tv_sec = ms / 1000UL;
+  ts.tv_nsec = ( ms % 1000UL ) * 1000000UL;
+  nanosleep ( &ts, NULL );
+}
+
+void delayMicroseconds ( unsigned int us ) {
+  unsigned long long until = _now_ns () + us * 1000ULL;
+  while ( _now_ns () < until ) ;
+}
+
+static void ( * _yieldHook ) () = NULL;
+
+void yield () {
+  if ( _yieldHook ) _yieldHook ();
+}
+
+void setYieldHook ( void ( * hook ) () ) {
+  _yieldHook = hook;
+}
+
+//************************************************************************************************
+// 						                             pins ( inert )
+//************************************************************************************************
+
+void pinMode ( uint8_t pin, uint8_t mode ) { (void) pin; (void) mode; }
+void digitalWrite ( uint8_t pin, uint8_t value ) { (void) pin; (void) value; }
+int digitalRead ( uint8_t pin ) { (void) pin; return LOW; }
+int analogRead ( uint8_t pin ) { (void) pin; return 512; }
+
+//************************************************************************************************
+// 						                             misc
+//************************************************************************************************
+
+long random ( long howbig ) {
+  if ( howbig == 0 ) return 0;
+  return rand () % howbig;
+}
+
+long random ( long howsmall, long howbig ) {
+  if ( howsmall >= howbig ) return howsmall;
+  return random ( howbig - howsmall ) + howsmall;
+}
+
+void randomSeed ( unsigned long seed ) {
+  if ( seed != 0 ) srand ( seed );
+}
+
+long map ( long x, long in_min, long in_max, long out_min, long out_max ) {
+  return ( x - in_min ) * ( out_max - out_min ) / ( in_max - in_min ) + out_min;
+}
+
+char * dtostrf ( double val, signed char width, unsigned char prec, char * s ) {
+  sprintf ( s, "%*.*f", width, prec, val );
+  return s;
+}
+
+//************************************************************************************************
+// 						                             Print
+//************************************************************************************************
+
+size_t Print::write ( const uint8_t * buf, size_t len ) {
+  size_t n = 0;
+  while ( len-- ) n += write ( *buf++ );
+  return n;
+}
+
+size_t Print::printNumber ( unsigned long long n, int base ) {
+  char buf [ 8 * sizeof ( n ) + 1 ];
+  char * p = &buf [ sizeof ( buf ) - 1 ];
+  *p = '\0';
+  if ( base < 2 ) base = 10;
+  do {
+    int d = n % base;
+    n /= base;
+    *--p = d < 10 ? '0' + d : 'A' + d - 10;
+  } while ( n );
+  return write ( p );
+}
+
+size_t Print::printSigned ( long long n, int base ) {
+  if ( base == 10 && n < 0 ) {
+    size_t t = print ( '-' );
+    return t + printNumber ( - ( unsigned long long ) n, 10 );
+  }
+  return printNumber ( ( unsigned long long ) n, base );
+}
+
+size_t Print::print ( const __FlashStringHelper * s ) { return write ( ( const char * ) s ); }
+size_t Print::print ( const char * s ) { return write ( s ); }
+size_t Print::print ( char c ) { return write ( ( uint8_t ) c ); }
+size_t Print::print ( unsigned char n, int base ) { return printNumber ( n, base ); }
+size_t Print::print ( int n, int base ) { return base == 10 ? printSigned ( n, base ) : printNumber ( ( unsigned int ) n, base ); }
+size_t Print::print ( unsigned int n, int base ) { return printNumber ( n, base ); }
+size_t Print::print ( long n, int base ) { return base == 10 ? printSigned ( n, base ) : printNumber ( ( unsigned long ) n, base ); }
+size_t Print::print ( unsigned long n, int base ) { return printNumber ( n, base ); }
+size_t Print::print ( long long n, int base ) { return printSigned ( n, base ); }
+size_t Print::print ( unsigned long long n, int base ) { return printNumber ( n, base ); }
+
+size_t Print::print ( double x, int digits ) {
+  char buf [ 48 ];
+  snprintf ( buf, sizeof ( buf ), "%.*f", digits, x );
+  return write ( buf );
+}
+
+size_t Print::println () { return write ( "\r\n" ); }
+size_t Print::println ( const __FlashStringHelper * s ) { size_t n = print ( s ); return n + println (); }
+size_t Print::println ( const char * s ) { size_t n = print ( s ); return n + println (); }
+size_t Print::println ( char c ) { size_t n = print ( c ); return n + println (); }
+size_t Print::println ( unsigned char v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( int v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( unsigned int v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( long v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( unsigned long v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( long long v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( unsigned long long v, int base ) { size_t n = print ( v, base ); return n + println (); }
+size_t Print::println ( double x, int digits ) { size_t n = print ( x, digits ); return n + println (); }
+
+size_t Print::printf ( const char * format, ... ) {
+  char buf [ 256 ];
+  va_list args;
+  va_start ( args, format );
+  int len = vsnprintf ( buf, sizeof ( buf ), format, args );
+  va_end ( args );
+  if ( len < 0 ) return 0;
+  if ( ( size_t ) len >= sizeof ( buf ) ) len = sizeof ( buf ) - 1;
+  return write ( ( const uint8_t * ) buf, len );
+}
+
+//************************************************************************************************
+// 						                             Stream
+//************************************************************************************************
+
+size_t Stream::readBytes ( char * buf, size_t len ) {
+  size_t n = 0;
+  unsigned long startedAt_ms = millis ();
+  while ( n < len && ( millis () - startedAt_ms ) < _timeout_ms ) {
+    int c = read ();
+    if ( c >= 0 ) {
+      buf [ n++ ] = ( char ) c;
+      startedAt_ms = millis ();
+    }
+  }
+  return n;
+}
+
+//************************************************************************************************
+// 						                             HostSerial
+//************************************************************************************************
+
+HostSerial::HostSerial () {
+  _rxHead = _rxTail = 0;
+}
+
+int HostSerial::available () {
+  return ( _rxHead + _rxLen - _rxTail ) % _rxLen;
+}
+
+int HostSerial::read () {
+  if ( _rxHead == _rxTail ) return -1;
+  uint8_t c = _rx [ _rxTail ];
+  _rxTail = ( _rxTail + 1 ) % _rxLen;
+  return c;
+}
+
+int HostSerial::peek () {
+  if ( _rxHead == _rxTail ) return -1;
+  return _rx [ _rxTail ];
+}
+
+void HostSerial::flush () {
+  fflush ( stdout );
+}
+
+size_t HostSerial::write ( uint8_t c ) {
+  return fputc ( c, stdout ) == EOF ? 0 : 1;
+}
+
+void HostSerial::inject ( const uint8_t * buf, size_t len ) {
+  while ( len-- ) {
+    size_t next = ( _rxHead + 1 ) % _rxLen;
+    if ( next == _rxTail ) return;   // full; drop the rest
+    _rx [ _rxHead ] = *buf++;
+    _rxHead = next;
+  }
+}
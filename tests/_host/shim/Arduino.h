@@ -0,0 +1,125 @@
+/*
+	Arduino.h - minimal Arduino core shim for building the cbm_* libraries on a
+	  Linux host, so that they can be benchmarked and exercised without a board
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	Only what the libraries actually use is provided:
+	  millis, micros, delay, delayMicroseconds, yield
+	  pinMode, digitalWrite, digitalRead, analogRead ( inert )
+	  Print, Stream, and a Serial object that writes to stdout
+	  PROGMEM / pgm_read_* ( see avr/pgmspace.h )
+	  the AVR registers touched by cbm_FFT ( see avr/io.h )
+
+	The clock is CLOCK_MONOTONIC, zeroed at program start, so millis() and
+	micros() wrap exactly as they would on the board ( unsigned long is 64 bits
+	on the host, but we truncate to 32 to keep the wraparound arithmetic honest ).
+
+	yield () calls whatever has been set with setYieldHook ( host-only ), so
+	that code waiting in a polling loop can let simulated devices run.
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#define HOST_SHIM_VERSION "1.000.000"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT  8
+#define BIN  2
+
+#ifndef PI
+  #define PI 3.1415926535897932384626433832795
+#endif
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI  6.283185307179586476925286766559
+
+#ifndef _BV
+  #define _BV(bit) ( 1 << ( bit ) )
+#endif
+
+#define lowByte(w)  ( ( uint8_t ) ( ( w ) & 0xff ) )
+#define highByte(w) ( ( uint8_t ) ( ( w ) >> 8 ) )
+
+// see the note in cbm_FFT/FFT.h: the FFT expects this in Arduino.h
+typedef union _CMPLX {
+  int16_t intl;
+  int8_t  hb[2];
+} CMPLX;
+
+unsigned long millis ();
+unsigned long micros ();
+void delay ( unsigned long ms );
+void delayMicroseconds ( unsigned int us );
+void yield ();
+void setYieldHook ( void ( * hook ) () );   // host-only
+
+void pinMode ( uint8_t pin, uint8_t mode );
+void digitalWrite ( uint8_t pin, uint8_t value );
+int digitalRead ( uint8_t pin );
+int analogRead ( uint8_t pin );
+
+long random ( long howbig );
+long random ( long howsmall, long howbig );
+void randomSeed ( unsigned long seed );
+
+long map ( long x, long in_min, long in_max, long out_min, long out_max );
+
+char * dtostrf ( double val, signed char width, unsigned char prec, char * s );
+
+#include <Print.h>
+#include <Stream.h>
+
+/*
+  HostSerial is the stand-in for HardwareSerial: output goes to stdout,
+  input comes from whatever has been queued with inject ()
+*/
+
+class HostSerial : public Stream {
+  public:
+    HostSerial ();
+    void begin ( unsigned long baud ) { (void) baud; }
+    void end () {}
+    operator bool () { return true; }
+
+    int available ();
+    int read ();
+    int peek ();
+    void flush ();
+    size_t write ( uint8_t c );
+    using Print::write;
+
+    // host-only: queue characters to be returned by read ()
+    void inject ( const uint8_t * buf, size_t len );
+
+  private:
+    static const size_t _rxLen = 256;
+    uint8_t _rx [ _rxLen ];
+    size_t _rxHead, _rxTail;
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,120 @@
+/*
+	ESP8266WiFi.cpp - host shim of the ESP8266 core's TCP classes
+	Released into the public domain
+*/
+
+#include <ESP8266WiFi.h>
+
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+int WiFiClient::connect ( const char * host, uint16_t port ) {
+  stop ();
+  int fd = socket ( AF_INET, SOCK_STREAM, 0 );
+  if ( fd < 0 ) return 0;
+  struct sockaddr_in addr;
+  memset ( &addr, 0, sizeof ( addr ) );
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons ( port );
+  if ( inet_pton ( AF_INET, host, &addr.sin_addr ) != 1
+    || ::connect ( fd, ( struct sockaddr * ) &addr, sizeof ( addr ) ) != 0 ) {
+    close ( fd );
+    return 0;
+  }
+  _fd = fd;
+  return 1;
+}
+
+uint8_t WiFiClient::connected () {
+  if ( _fd < 0 ) return 0;
+  uint8_t c;
+  ssize_t n = recv ( _fd, &c, 1, MSG_PEEK | MSG_DONTWAIT );
+  if ( n > 0 ) return 1;
+  if ( n == 0 ) return 0;                          // closed by the peer
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+int WiFiClient::available () {
+  if ( _fd < 0 ) return 0;
+  int n = 0;
+  if ( ioctl ( _fd, FIONREAD, &n ) != 0 ) return 0;
+  return n;
+}
+
+int WiFiClient::read () {
+  uint8_t c;
+  return read ( &c, 1 ) == 1 ? c : -1;
+}
+
+int WiFiClient::read ( uint8_t * buf, size_t len ) {
+  if ( _fd < 0 ) return -1;
+  ssize_t n = recv ( _fd, buf, len, MSG_DONTWAIT );
+  return n > 0 ? ( int ) n : -1;
+}
+
+int WiFiClient::peek () {
+  if ( _fd < 0 ) return -1;
+  uint8_t c;
+  return recv ( _fd, &c, 1, MSG_PEEK | MSG_DONTWAIT ) == 1 ? c : -1;
+}
+
+size_t WiFiClient::write ( const uint8_t * buf, size_t len ) {
+  if ( _fd < 0 ) return 0;
+  size_t sent = 0;
+  while ( sent < len ) {
+    ssize_t n = send ( _fd, buf + sent, len - sent, MSG_NOSIGNAL );
+    if ( n <= 0 ) break;
+    sent += n;
+  }
+  return sent;
+}
+
+void WiFiClient::stop () {
+  if ( _fd >= 0 ) close ( _fd );
+  _fd = -1;
+}
+
+void WiFiClient::setNoDelay ( bool noDelay ) {
+  if ( _fd < 0 ) return;
+  int on = noDelay ? 1 : 0;
+  setsockopt ( _fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+}
+
+void WiFiServer::begin () {
+  stop ();
+  int fd = socket ( AF_INET, SOCK_STREAM, 0 );
+  if ( fd < 0 ) return;
+  int on = 1;
+  setsockopt ( fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+  struct sockaddr_in addr;
+  memset ( &addr, 0, sizeof ( addr ) );
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons ( _port );
+  addr.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+  if ( bind ( fd, ( struct sockaddr * ) &addr, sizeof ( addr ) ) != 0 || listen ( fd, 8 ) != 0 ) {
+    close ( fd );
+    return;
+  }
+  fcntl ( fd, F_SETFL, fcntl ( fd, F_GETFL ) | O_NONBLOCK );
+  _fd = fd;
+}
+
+WiFiClient WiFiServer::available () {
+  if ( _fd < 0 ) return WiFiClient ();
+  int fd = accept ( _fd, NULL, NULL );
+  if ( fd < 0 ) return WiFiClient ();
+  WiFiClient client ( fd );
+  client.setNoDelay ( _noDelay );
+  return client;
+}
+
+void WiFiServer::stop () {
+  if ( _fd >= 0 ) close ( _fd );
+  _fd = -1;
+}
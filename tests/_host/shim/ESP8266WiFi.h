@@ -0,0 +1,64 @@
+/*
+	ESP8266WiFi.h - host shim of the ESP8266 core's TCP classes, over POSIX
+	  sockets on the loopback interface
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	Only what a TCP server needs:
+	  WiFiServer server ( 502 );
+	  server.begin ();                         // listens on 127.0.0.1
+	  WiFiClient c = server.available ();      // the next new connection, if any
+	  if ( c ) ... c.available (), c.read ( buf, n ), c.write ( buf, n ), c.stop ()
+	and, to test one, a client:
+	  WiFiClient client;
+	  client.connect ( "127.0.0.1", 502 );
+
+	As on the ESP8266, copies of a WiFiClient are the same connection; here
+	nothing closes it but stop (). Reads never wait; writes do, until the
+	kernel has taken everything.
+*/
+
+#ifndef ESP8266WiFi_h
+#define ESP8266WiFi_h
+
+#include <Arduino.h>
+
+class WiFiClient : public Stream {
+  public:
+    WiFiClient () { _fd = -1; }
+    explicit WiFiClient ( int fd ) { _fd = fd; }
+
+    int connect ( const char * host, uint16_t port );
+    uint8_t connected ();
+    int available ();
+    int read ();
+    int read ( uint8_t * buf, size_t len );
+    int peek ();
+    size_t write ( uint8_t c ) { return write ( &c, 1 ); }
+    size_t write ( const uint8_t * buf, size_t len );
+    using Print::write;
+    void flush () {}
+    void stop ();
+    void setNoDelay ( bool noDelay );
+    operator bool () { return _fd >= 0; }
+    bool operator == ( const WiFiClient & other ) const { return _fd == other._fd; }
+
+  private:
+    int _fd;
+};
+
+class WiFiServer {
+  public:
+    WiFiServer ( uint16_t port ) { _port = port; _fd = -1; _noDelay = false; }
+    void begin ();
+    WiFiClient available ();
+    void setNoDelay ( bool noDelay ) { _noDelay = noDelay; }
+    void stop ();
+
+  private:
+    uint16_t _port;
+    int _fd;
+    bool _noDelay;
+};
+
+#endif
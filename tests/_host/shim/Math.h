@@ -0,0 +1,6 @@
+/*
+	Math.h - some of the libraries include <Math.h>, which only resolves on
+	  case-insensitive file systems; forward to the real <math.h>
+*/
+
+#include_next <math.h>
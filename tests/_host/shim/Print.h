@@ -0,0 +1,60 @@
+/*
+	Print.h - host shim of the Arduino Print class
+	Released into the public domain
+*/
+
+#ifndef Print_h
+#define Print_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class __FlashStringHelper;
+#define F(string_literal) ( reinterpret_cast<const __FlashStringHelper *> ( string_literal ) )
+
+class Print {
+  public:
+    virtual ~Print () {}
+    virtual size_t write ( uint8_t c ) = 0;
+    virtual size_t write ( const uint8_t * buf, size_t len );
+    size_t write ( const char * str ) {
+      return str ? write ( ( const uint8_t * ) str, strlen ( str ) ) : 0;
+    }
+    size_t write ( const char * buf, size_t len ) { return write ( ( const uint8_t * ) buf, len ); }
+    virtual void flush () {}
+
+    size_t print ( const __FlashStringHelper * s );
+    size_t print ( const char * s );
+    size_t print ( char c );
+    size_t print ( unsigned char n, int base = DEC_BASE );
+    size_t print ( int n, int base = DEC_BASE );
+    size_t print ( unsigned int n, int base = DEC_BASE );
+    size_t print ( long n, int base = DEC_BASE );
+    size_t print ( unsigned long n, int base = DEC_BASE );
+    size_t print ( long long n, int base = DEC_BASE );
+    size_t print ( unsigned long long n, int base = DEC_BASE );
+    size_t print ( double x, int digits = 2 );
+
+    size_t println ();
+    size_t println ( const __FlashStringHelper * s );
+    size_t println ( const char * s );
+    size_t println ( char c );
+    size_t println ( unsigned char n, int base = DEC_BASE );
+    size_t println ( int n, int base = DEC_BASE );
+    size_t println ( unsigned int n, int base = DEC_BASE );
+    size_t println ( long n, int base = DEC_BASE );
+    size_t println ( unsigned long n, int base = DEC_BASE );
+    size_t println ( long long n, int base = DEC_BASE );
+    size_t println ( unsigned long long n, int base = DEC_BASE );
+    size_t println ( double x, int digits = 2 );
+
+    size_t printf ( const char * format, ... ) __attribute__ ( ( format ( printf, 2, 3 ) ) );
+
+  private:
+    static const int DEC_BASE = 10;
+    size_t printNumber ( unsigned long long n, int base );
+    size_t printSigned ( long long n, int base );
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+	RTUBus.cpp - host shim of an RS485 multi-drop line
+	Released into the public domain
+*/
+
+#include <RTUBus.h>
+
+RTUBus::RTUBus ( unsigned long baud, unsigned long propagation_us, double bitErrorRate, unsigned long seed ) {
+  _nPorts = 0;
+  _char_us = 11000000UL / baud;
+  _propagation_us = propagation_us;
+  double p = 1.0 - pow ( 1.0 - bitErrorRate, 11 );
+  _errorThreshold = p >= 1.0 ? 0xffffffffUL : ( uint32_t ) ( p * 4294967296.0 );
+  _state = seed ? seed : 1;
+  _talker = NULL;
+  _freeAt_us = micros ();
+  resetCounts ();
+}
+
+RTUBusPort * RTUBus::attach () {
+  if ( _nPorts >= RTUBUS_MAX_PORTS ) return NULL;
+  RTUBusPort * port = &_ports [ _nPorts++ ];
+  port->_bus = this;
+  port->_txEnd_us = micros ();
+  return port;
+}
+
+// xorshift32
+uint32_t RTUBus::_random () {
+  _state ^= _state << 13;
+  _state ^= _state >> 17;
+  _state ^= _state << 5;
+  return _state;
+}
+
+void RTUBus::_transmit ( RTUBusPort * from, uint8_t c ) {
+  unsigned long now = micros ();
+  // after the port's own last character, or now if it has finished
+  unsigned long start = ( long ) ( from->_txEnd_us - now ) > 0 ? from->_txEnd_us : now;
+  if ( ( _talker != from ) && ( long ) ( _freeAt_us - start ) > 0 ) {
+    _collisions++;
+    c ^= 1 + _random () % 255;
+  } else if ( _random () < _errorThreshold ) {
+    _corrupted++;
+    c ^= 1 << ( _random () & 0x07 );
+  }
+  unsigned long end = start + _char_us;
+  from->_txEnd_us = end;
+  if ( ( long ) ( end - _freeAt_us ) > 0 ) {
+    _freeAt_us = end;
+    _talker = from;
+  }
+  _characters++;
+  _busy_us += _char_us;
+  for ( int i = 0; i < _nPorts; i++ ) {
+    if ( &_ports [ i ] != from ) _ports [ i ]._arrive ( c, end + _propagation_us );
+  }
+}
+
+void RTUBusPort::_arrive ( uint8_t c, unsigned long at_us ) {
+  if ( _head - _tail >= _n ) return;                 // overrun: dropped, as by a UART
+  _at [ _head % _n ] = at_us;
+  _c [ _head % _n ] = c;
+  _head++;
+}
+
+int RTUBusPort::available () {
+  unsigned long now = micros ();
+  int n = 0;
+  for ( unsigned long i = _tail; i != _head && ( long ) ( now - _at [ i % _n ] ) >= 0; i++ ) n++;
+  return n;
+}
+
+int RTUBusPort::read () {
+  if ( _tail == _head || ( long ) ( micros () - _at [ _tail % _n ] ) < 0 ) return -1;
+  return _c [ _tail++ % _n ];
+}
+
+int RTUBusPort::peek () {
+  if ( _tail == _head || ( long ) ( micros () - _at [ _tail % _n ] ) < 0 ) return -1;
+  return _c [ _tail % _n ];
+}
+
+size_t RTUBusPort::write ( uint8_t c ) {
+  _bus->_transmit ( this, c );
+  return 1;
+}
+
+// yield, so that the other nodes ( run from the yield hook ) go on while this one talks
+void RTUBusPort::flush () {
+  while ( ( long ) ( _txEnd_us - micros () ) > 0 ) yield ();
+}
@@ -0,0 +1,90 @@
+/*
+	RTUBus.h - host shim of an RS485 multi-drop line, for running the real
+	  MODBUS_Master, MODBUS_Slave, and RS485 code against each other
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	Each node gets a port, a Stream, to give its RS485 ( or MODBUS ) object:
+	  RTUBus bus ( 57600, 5, 1e-5 );           // baud, propagation us, bit error rate
+	  MODBUS masterPort ( bus.attach () );
+	  MODBUS slavePort ( bus.attach () );
+	What a port writes goes onto the line one character time after the last
+	character it put there ( or now, if the line has gone quiet ), and arrives
+	at every other port propagation_us after its last bit; a node doesn't hear
+	itself, as with the MAX485's receiver disabled while it talks. flush ()
+	waits, as HardwareSerial's does, until the port's last character is out,
+	calling yield () meanwhile: the nodes share one host thread, and each
+	node's receiver has to keep watching the line's gaps while another talks.
+
+	With a bit error rate, each character of 11 bits is hit with probability
+	1 - ( 1 - rate ) ^ 11, and one of its data bits is flipped for everyone
+	who hears it. A port that starts talking while another's characters are
+	still on the line collides: its characters are counted, and garbled.
+	The random numbers come from seed, so that a run can be repeated.
+
+	Counters: characters on the line, how many were corrupted, collisions, and
+	the microseconds the line was busy.
+*/
+
+#ifndef RTUBus_h
+#define RTUBus_h
+
+#include <Arduino.h>
+
+#define RTUBUS_MAX_PORTS 40
+
+class RTUBus;
+
+class RTUBusPort : public Stream {
+  public:
+    RTUBusPort () { _bus = NULL; _head = _tail = 0; _txEnd_us = 0; }
+    int available ();
+    int read ();
+    int peek ();
+    size_t write ( uint8_t c );
+    using Print::write;
+    void flush ();
+
+  private:
+    friend class RTUBus;
+    void _arrive ( uint8_t c, unsigned long at_us );
+
+    static const unsigned long _n = 512;
+    RTUBus * _bus;
+    unsigned long _at [ _n ];
+    uint8_t _c [ _n ];
+    unsigned long _head, _tail;
+    unsigned long _txEnd_us;             // when its last character is out
+};
+
+class RTUBus {
+  public:
+    RTUBus ( unsigned long baud, unsigned long propagation_us = 0,
+             double bitErrorRate = 0.0, unsigned long seed = 1 );
+
+    // a new node's port, or NULL when there are RTUBUS_MAX_PORTS
+    RTUBusPort * attach ();
+    unsigned long char_us () { return _char_us; }
+
+    unsigned long characters () { return _characters; }
+    unsigned long corrupted () { return _corrupted; }
+    unsigned long collisions () { return _collisions; }
+    unsigned long busy_us () { return _busy_us; }
+    void resetCounts () { _characters = _corrupted = _collisions = _busy_us = 0; }
+
+  private:
+    friend class RTUBusPort;
+    void _transmit ( RTUBusPort * from, uint8_t c );
+    uint32_t _random ();
+
+    RTUBusPort _ports [ RTUBUS_MAX_PORTS ];
+    int _nPorts;
+    unsigned long _char_us, _propagation_us;
+    uint32_t _errorThreshold;            // a character is hit when _random () is below it
+    uint32_t _state;
+    RTUBusPort * _talker;                // whose characters are on the line until _freeAt_us
+    unsigned long _freeAt_us;
+    unsigned long _characters, _corrupted, _collisions, _busy_us;
+};
+
+#endif
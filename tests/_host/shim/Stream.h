@@ -0,0 +1,40 @@
+/*
+	Stream.h - host shim of the Arduino Stream class
+	Released into the public domain
+*/
+
+#ifndef Stream_h
+#define Stream_h
+
+#include <Print.h>
+
+class Stream : public Print {
+  public:
+    virtual int available () = 0;
+    virtual int read () = 0;
+    virtual int peek () = 0;
+
+    void setTimeout ( unsigned long timeout_ms ) { _timeout_ms = timeout_ms; }
+    size_t readBytes ( char * buf, size_t len );
+    size_t readBytes ( uint8_t * buf, size_t len ) { return readBytes ( ( char * ) buf, len ); }
+
+  protected:
+    unsigned long _timeout_ms = 1000UL;
+};
+
+/*
+  NullStream swallows output and never has input; useful for timing code
+  that writes to a Stream without timing the terminal
+*/
+
+class NullStream : public Stream {
+  public:
+    int available () { return 0; }
+    int read () { return -1; }
+    int peek () { return -1; }
+    size_t write ( uint8_t c ) { (void) c; return 1; }
+    size_t write ( const uint8_t * buf, size_t len ) { (void) buf; return len; }
+    using Print::write;
+};
+
+#endif
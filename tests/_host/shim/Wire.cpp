@@ -0,0 +1,81 @@
+/*
+	Wire.cpp - host shim of the Arduino I2C library
+	Released into the public domain
+*/
+
+#include <Wire.h>
+
+TwoWire Wire;
+
+TwoWire::TwoWire () {
+  _nDevices = 0;
+  _txLen = _rxLen = _rxPos = 0;
+  _clock = 100000UL;
+  _inTransaction = false;
+  _bits = _transactions = 0;
+}
+
+void TwoWire::attachDevice ( uint8_t address, uint8_t * regs, int increment ) {
+  if ( _nDevices >= _maxDevices ) return;
+  Device & d = _devices [ _nDevices++ ];
+  d.address = address;
+  d.regs = regs;
+  d.increment = increment;
+  d.pointer = 0;
+  d.autoIncrement = increment == WIRE_INCREMENT_ALWAYS;
+}
+
+TwoWire::Device * TwoWire::_find ( uint8_t address ) {
+  for ( int i = 0; i < _nDevices; i++ ) {
+    if ( _devices [ i ].address == address ) return &_devices [ i ];
+  }
+  return NULL;
+}
+
+uint8_t TwoWire::_next ( Device * d ) {
+  uint8_t p = d->pointer;
+  if ( d->autoIncrement ) d->pointer = ( d->pointer + 1 ) & 0x7f;
+  return p;
+}
+
+void TwoWire::beginTransmission ( uint8_t address ) {
+  _txAddress = address;
+  _txLen = 0;
+}
+
+size_t TwoWire::write ( uint8_t c ) {
+  if ( _txLen >= sizeof ( _tx ) ) return 0;
+  _tx [ _txLen++ ] = c;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission ( bool sendStop ) {
+  // ( re ) start, address, data, and maybe stop
+  _bits += 1 + 9 + 9 * _txLen + ( sendStop ? 1 : 0 );
+  if ( ! _inTransaction ) _transactions++;
+  _inTransaction = ! sendStop;
+  Device * d = _find ( _txAddress );
+  if ( d == NULL ) return 2;              // address NAK
+  if ( _txLen > 0 ) {
+    d->pointer = _tx [ 0 ] & 0x7f;
+    d->autoIncrement = d->increment == WIRE_INCREMENT_ALWAYS || ( _tx [ 0 ] & 0x80 );
+    for ( size_t i = 1; i < _txLen; i++ ) d->regs [ _next ( d ) ] = _tx [ i ];
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom ( uint8_t address, uint8_t quantity, bool sendStop ) {
+  _bits += 1 + 9 + 9 * quantity + ( sendStop ? 1 : 0 );
+  if ( ! _inTransaction ) _transactions++;
+  _inTransaction = ! sendStop;
+  _rxLen = _rxPos = 0;
+  Device * d = _find ( address );
+  if ( d == NULL ) return 0;
+  if ( quantity > sizeof ( _rx ) ) quantity = sizeof ( _rx );
+  for ( uint8_t i = 0; i < quantity; i++ ) _rx [ _rxLen++ ] = d->regs [ _next ( d ) ];
+  return quantity;
+}
+
+int TwoWire::available () { return _rxLen - _rxPos; }
+int TwoWire::read () { return _rxPos < _rxLen ? _rx [ _rxPos++ ] : -1; }
+int TwoWire::peek () { return _rxPos < _rxLen ? _rx [ _rxPos ] : -1; }
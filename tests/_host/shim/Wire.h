@@ -0,0 +1,86 @@
+/*
+	Wire.h - host shim of the Arduino I2C library: a bus with simulated
+	  register-file devices on it, and a count of the bits clocked
+	Created by Charles B. Malloch, PhD, October 17, 2026
+	Released into the public domain
+
+	A device is 128 registers at a 7-bit address:
+	  uint8_t regs [ 128 ];
+	  Wire.attachDevice ( 0x18, regs, WIRE_INCREMENT_ON_MSB );
+	A write transaction's first byte sets the register pointer; further bytes
+	are written from there. Reads continue from the pointer. After each byte
+	the pointer advances if the device auto-increments always
+	( WIRE_INCREMENT_ALWAYS ), or only if the sub-address had its MSB set
+	( WIRE_INCREMENT_ON_MSB, as on ST's accelerometers ). Transactions to an
+	address with no device are NAKed.
+
+	busBits () counts the bit times the transactions would take on a real
+	bus: start, 9 per byte ( address or data, with its ack ), stop;
+	busTime_us () divides that by the clock set with setClock ( default
+	100 kHz ).
+*/
+
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <Arduino.h>
+
+#define WIRE_INCREMENT_ALWAYS 0
+#define WIRE_INCREMENT_ON_MSB 1
+
+class TwoWire : public Stream {
+  public:
+    TwoWire ();
+    void begin () {}
+    void begin ( int sda, int scl ) { (void) sda; (void) scl; }
+    void setClock ( uint32_t hz ) { _clock = hz; }
+
+    void beginTransmission ( uint8_t address );
+    void beginTransmission ( int address ) { beginTransmission ( ( uint8_t ) address ); }
+    uint8_t endTransmission ( bool sendStop = true );
+    uint8_t requestFrom ( uint8_t address, uint8_t quantity, bool sendStop = true );
+    uint8_t requestFrom ( int address, int quantity ) {
+      return requestFrom ( ( uint8_t ) address, ( uint8_t ) quantity );
+    }
+
+    size_t write ( uint8_t c );
+    using Print::write;
+    int available ();
+    int read ();
+    int peek ();
+    void flush () {}
+
+    // host-only
+    void attachDevice ( uint8_t address, uint8_t * regs, int increment );
+    unsigned long busBits () { return _bits; }
+    double busTime_us () { return _bits * 1e6 / _clock; }
+    unsigned long transactions () { return _transactions; }
+    void resetCounts () { _bits = _transactions = 0; }
+
+  private:
+    struct Device {
+      uint8_t address;
+      uint8_t * regs;
+      int increment;
+      uint8_t pointer;
+      bool autoIncrement;
+    };
+    Device * _find ( uint8_t address );
+    uint8_t _next ( Device * d );
+
+    static const int _maxDevices = 4;
+    Device _devices [ _maxDevices ];
+    int _nDevices;
+    uint8_t _txAddress;
+    uint8_t _tx [ 32 ];
+    size_t _txLen;
+    uint8_t _rx [ 32 ];
+    size_t _rxLen, _rxPos;
+    uint32_t _clock;
+    bool _inTransaction;             // no stop yet: the next start is a restart
+    unsigned long _bits, _transactions;
+};
+
+extern TwoWire Wire;
+
+#endif
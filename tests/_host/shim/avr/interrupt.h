@@ -0,0 +1,18 @@
+/*
+	avr/interrupt.h - host shim
+
+	ISR ( vector ) declares an ordinary function of that name, so a host
+	program can "fire" the interrupt simply by calling it.
+*/
+
+#ifndef HOST_INTERRUPT_h
+#define HOST_INTERRUPT_h
+
+#define ISR(vector) extern "C" void vector ( void ); extern "C" void vector ( void )
+
+#define sei()
+#define cli()
+#define interrupts()
+#define noInterrupts()
+
+#endif
@@ -0,0 +1,34 @@
+/*
+	avr/io.h - host shim
+
+	Only the ATmega328 registers and bit numbers that cbm_FFT touches are
+	provided. They are plain variables: writing them has no effect, and
+	anything that busy-waits on a hardware bit ( the EEPROM routines in
+	FFTloop, for instance ) will hang, so don't enable those paths on the host.
+*/
+
+#ifndef HOST_IO_h
+#define HOST_IO_h
+
+#include <stdint.h>
+
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, ASSR;
+extern volatile uint8_t TIMSK0, TIMSK1, TIMSK2;
+extern volatile uint8_t ADCSRA, ADMUX, ADCL, ADCH;
+extern volatile uint8_t EECR, EEDR;
+extern volatile uint16_t EEAR;
+
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define CS20  0
+#define CS21  1
+#define CS22  2
+#define AS2   5
+#define TOIE2 0
+#define ADSC  6
+#define EERE  0
+#define EEPE  1
+#define EEMPE 2
+
+#endif
@@ -0,0 +1,33 @@
+/*
+	avr/pgmspace.h - host shim; flash and RAM are the same address space here
+*/
+
+#ifndef HOST_PGMSPACE_h
+#define HOST_PGMSPACE_h
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) ( s )
+
+typedef int8_t   prog_int8_t;
+typedef uint8_t  prog_uint8_t;
+typedef int16_t  prog_int16_t;
+typedef uint16_t prog_uint16_t;
+typedef int32_t  prog_int32_t;
+typedef uint32_t prog_uint32_t;
+
+#define pgm_read_byte(addr)  ( * ( const uint8_t * ) ( addr ) )
+#define pgm_read_word(addr)  ( * ( const uint16_t * ) ( addr ) )
+#define pgm_read_dword(addr) ( * ( const uint32_t * ) ( addr ) )
+#define pgm_read_float(addr) ( * ( const float * ) ( addr ) )
+#define pgm_read_ptr(addr)   ( * ( const void * const * ) ( addr ) )
+
+#define memcpy_P  memcpy
+#define strcpy_P  strcpy
+#define strncpy_P strncpy
+#define strlen_P  strlen
+
+#endif